@@ -363,7 +363,7 @@ dingodb::pb::debug::DumpRegionResponse::Data DumpRawVectorIndex(DumpDbOptions co
         vector.set_ttl(ttl);
 
         if (flag == dingodb::mvcc::ValueFlag::kPut || flag == dingodb::mvcc::ValueFlag::kPutTTL) {
-          if (!vector.mutable_vector()->ParseFromArray(value.data(), value.size())) {
+          if (!dingodb::VectorCodec::DecodeVectorValue(value, *vector.mutable_vector())) {
             DINGO_LOG(FATAL) << fmt::format("Parse vector proto failed, value size: {}.", value.size());
           }
         }
@@ -110,6 +110,12 @@ class Constant {
   inline static const std::string kBlockSizeDefaultValue = "131072";  // 128KB
   inline static const std::string kBlockCache = "block_cache";
   inline static const std::string kBlockCacheDefaultValue = "2147483648";  // 2GB
+  // reserve a dedicated block cache for the column family, carved out of the store shared block cache, 0 is not reserve
+  inline static const std::string kBlockCacheReserved = "block_cache_reserved";
+  inline static const std::string kBlockCacheReservedDefaultValue = "0";
+  // cache index and filter blocks of the column family in the high priority pool of block cache
+  inline static const std::string kBlockCacheHighPriority = "block_cache_high_priority";
+  inline static const std::string kBlockCacheHighPriorityDefaultValue = "false";
   inline static const std::string kArenaBlockSize = "arena_block_size";
   inline static const std::string kArenaBlockSizeDefaultValue = "67108864";  // 64MB
   inline static const std::string kMinWriteBufferNumberToMerge = "min_write_buffer_number_to_merge";
@@ -122,6 +128,10 @@ class Constant {
   inline static const std::string kWriteBufferSizeDefaultValue = "67108864";  // 64MB
   inline static const std::string kPrefixExtractor = "prefix_extractor";
   inline static const std::string kPrefixExtractorDefaultValue = "24";
+  // prefix bloom filter on the user key part of mvcc encode key, replace prefix_extractor
+  // only enable it in store.<cf_name> for column family which all keys are mvcc encode key
+  inline static const std::string kMvccPrefixBloomFilter = "mvcc_prefix_bloom_filter";
+  inline static const std::string kMvccPrefixBloomFilterDefaultValue = "false";
   inline static const std::string kMaxBytesForLevelBase = "max_bytes_for_level_base";
   inline static const std::string kMaxBytesForLevelBaseDefaultValue = "134217728";  // 128MB
   inline static const std::string kTargetFileSizeBase = "target_file_size_base";
@@ -575,8 +575,13 @@ class CoordinatorControl : public MetaControl {
                                         pb::coordinator_internal::MetaIncrement &meta_increment);
 
   // UpdateRegionMapAndStoreOperation
-  void UpdateRegionMapAndStoreOperation(const pb::common::StoreMetrics &store_metrics,
-                                        pb::coordinator_internal::MetaIncrement &meta_increment);
+  // return -1 if the region metrics is rejected, e.g. illegal split/merge partial heartbeat.
+  int UpdateRegionMapAndStoreOperation(const pb::common::StoreMetrics &store_metrics,
+                                       pb::coordinator_internal::MetaIncrement &meta_increment);
+
+  // delta heartbeat only has changed regions, refresh last_update_timestamp of the unchanged regions which this store
+  // is leader, so they are not treated as offline before next full heartbeat.
+  void KeepAliveUnchangedRegionMetrics(const pb::common::StoreMetrics &store_metrics);
 
   // get executormap
   void GetExecutorMap(pb::common::ExecutorMap &executor_map, const std::string &filter_name);
@@ -714,7 +719,7 @@ class CoordinatorControl : public MetaControl {
   butil::Status GetIndexMetrics(int64_t schema_id, int64_t index_id, pb::meta::IndexMetricsWithId &index_metrics);
 
   // update store metrics with new metrics
-  // return new epoch
+  // return -1 if the region metrics is not applied, the store will report them again.
   int64_t UpdateStoreMetrics(const pb::common::StoreMetrics &store_metrics,
                              pb::coordinator_internal::MetaIncrement &meta_increment);
 
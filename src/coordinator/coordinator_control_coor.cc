@@ -4472,8 +4472,8 @@ pb::common::RegionStatus CoordinatorControl::GenRegionStatus(const pb::common::R
 }
 
 // Update RegionMap and StoreOperation
-void CoordinatorControl::UpdateRegionMapAndStoreOperation(const pb::common::StoreMetrics& store_metrics,
-                                                          pb::coordinator_internal::MetaIncrement& meta_increment) {
+int CoordinatorControl::UpdateRegionMapAndStoreOperation(const pb::common::StoreMetrics& store_metrics,
+                                                         pb::coordinator_internal::MetaIncrement& meta_increment) {
   // for split/merge partial heartbeat, only 2 region is legal.
   if (store_metrics.is_partial_region_metrics() && store_metrics.is_update_epoch_version()) {
     if (store_metrics.region_metrics_map_size() != 2) {
@@ -4486,7 +4486,7 @@ void CoordinatorControl::UpdateRegionMapAndStoreOperation(const pb::common::Stor
                          << it.second.ShortDebugString();
       }
 
-      return;
+      return -1;
     }
 
     DINGO_LOG(INFO) << "UpdateRegionMapAndStoreOperation partial heartbeat, split/merge, region_metrics_map_size = "
@@ -4732,6 +4732,51 @@ void CoordinatorControl::UpdateRegionMapAndStoreOperation(const pb::common::Stor
                                                         region_metrics.region_size());
     }
   }
+
+  return 0;
+}
+
+void CoordinatorControl::KeepAliveUnchangedRegionMetrics(const pb::common::StoreMetrics& store_metrics) {
+  std::vector<int64_t> unchanged_region_ids;
+  {
+    BAIDU_SCOPED_LOCK(store_region_metrics_map_mutex_);
+    auto it = store_region_metrics_map_.find(store_metrics.id());
+    if (it == store_region_metrics_map_.end()) {
+      return;
+    }
+
+    for (const auto& [region_id, region_metrics] : it->second.region_metrics_map()) {
+      if (store_metrics.region_metrics_map().find(region_id) == store_metrics.region_metrics_map().end()) {
+        unchanged_region_ids.push_back(region_id);
+      }
+    }
+  }
+
+  int64_t keep_alive_count = 0;
+  int64_t now_ms = butil::gettimeofday_ms();
+  for (auto region_id : unchanged_region_ids) {
+    pb::common::RegionMetrics region_metrics;
+    if (region_metrics_map_.Get(region_id, region_metrics) < 0) {
+      continue;
+    }
+
+    // same as full heartbeat, only leader store's region_metrics update region_metrics_map_.
+    if (region_metrics.leader_store_id() != store_metrics.id()) {
+      continue;
+    }
+
+    if (region_metrics.region_status().last_update_timestamp() + FLAGS_region_update_timeout * 1000 >= now_ms) {
+      continue;
+    }
+
+    region_metrics.mutable_region_status()->set_last_update_timestamp(now_ms);
+    region_metrics_map_.Put(region_id, region_metrics);
+    ++keep_alive_count;
+  }
+
+  DINGO_LOG(DEBUG) << "KeepAliveUnchangedRegionMetrics store_id=" << store_metrics.id()
+                   << ", unchanged_region_count=" << unchanged_region_ids.size()
+                   << ", keep_alive_count=" << keep_alive_count;
 }
 
 int64_t CoordinatorControl::UpdateStoreMetrics(const pb::common::StoreMetrics& store_metrics,
@@ -4757,6 +4802,18 @@ int64_t CoordinatorControl::UpdateStoreMetrics(const pb::common::StoreMetrics& s
 
     DINGO_LOG(INFO) << "UpdateStoreMetrics store_metrics.id=" << store_metrics.id()
                     << ", metrics: " << store_metrics.store_own_metrics().ShortDebugString();
+  } else {
+    // partial heartbeat only has part of regions, keep region_num and update store_own_metrics.
+    BAIDU_SCOPED_LOCK(store_metrics_map_mutex_);
+    auto it = store_metrics_map_.find(store_metrics.id());
+    if (it != store_metrics_map_.end()) {
+      it->second.store_own_metrics = store_metrics.store_own_metrics();
+      it->second.update_time = butil::gettimeofday_ms();
+    }
+  }
+
+  if (store_metrics.is_partial_region_metrics() && !store_metrics.is_update_epoch_version()) {
+    KeepAliveUnchangedRegionMetrics(store_metrics);
   }
 
   if (store_metrics.region_metrics_map_size() <= 0) {
@@ -4771,9 +4828,10 @@ int64_t CoordinatorControl::UpdateStoreMetrics(const pb::common::StoreMetrics& s
       if (store_region_metrics_map_.find(store_metrics.id()) == store_region_metrics_map_.end()) {
         store_region_metrics_map_.insert_or_assign(store_metrics.id(), store_metrics);
       } else {
+        // apply delta, the region metrics in partial heartbeat is newer than the old one.
+        auto* mut_region_metrics_map = store_region_metrics_map_[store_metrics.id()].mutable_region_metrics_map();
         for (const auto& region_metrics : store_metrics.region_metrics_map()) {
-          store_region_metrics_map_[store_metrics.id()].mutable_region_metrics_map()->insert(
-              {region_metrics.first, region_metrics.second});
+          (*mut_region_metrics_map)[region_metrics.first] = region_metrics.second;
         }
       }
     } else {
@@ -4787,11 +4845,11 @@ int64_t CoordinatorControl::UpdateStoreMetrics(const pb::common::StoreMetrics& s
                                                   store_metrics.store_own_metrics().system_free_capacity());
 
   // use region_metrics_map to update region_map and store_operation
-  UpdateRegionMapAndStoreOperation(store_metrics, meta_increment);
+  int ret = UpdateRegionMapAndStoreOperation(store_metrics, meta_increment);
 
-  DINGO_LOG(INFO) << "UpdateStoreMetricsMap store_metrics.id=" << store_metrics.id();
+  DINGO_LOG(INFO) << "UpdateStoreMetricsMap store_metrics.id=" << store_metrics.id() << ", ret=" << ret;
 
-  return 0;
+  return ret;
 }
 
 void CoordinatorControl::GetMemoryInfo(pb::coordinator::CoordinatorMemoryInfo& memory_info) {
@@ -20,18 +20,28 @@
 #include <string>
 
 #include "brpc/closure_guard.h"
+#include "bthread/execution_queue.h"
 #include "butil/status.h"
+#include "bvar/latency_recorder.h"
+#include "bvar/recorder.h"
 #include "common/constant.h"
 #include "common/helper.h"
 #include "common/logging.h"
 #include "common/synchronization.h"
 #include "engine/snapshot.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "proto/coordinator_internal.pb.h"
 #include "proto/error.pb.h"
 #include "proto/meta.pb.h"
 
 namespace dingodb {
 
+DEFINE_bool(tso_enable_coalesce, true, "coalesce concurrent gen tso requests into one allocation");
+
+bvar::LatencyRecorder g_tso_gen_latency("dingo_tso_gen_latency");
+bvar::IntRecorder g_tso_coalesce_batch_size("dingo_tso_coalesce_batch_size");
+
 void TsoClosure::Run() {
   // DINGO_LOG(INFO) << "TsoClosure run";
   if (!status().ok()) {
@@ -70,10 +80,11 @@ void TsoControl::UpdateTimestamp() {
   int64_t last_save = 0;
   {
     BAIDU_SCOPED_LOCK(tso_mutex_);
-    prev_physical = tso_obj_.current_timestamp.physical();
-    prev_logical = tso_obj_.current_timestamp.logical();
     last_save = tso_obj_.last_save_physical;
   }
+  int64_t current = tso_obj_.current_timestamp.load(std::memory_order_acquire);
+  prev_physical = TsoPhysical(current);
+  prev_logical = TsoLogical(current);
   int64_t delta = now - prev_physical;
   if (delta < 0) {
     DINGO_LOG(WARNING) << "physical time slow now: " << now << ", prev: " << prev_physical;
@@ -134,59 +145,172 @@ int TsoControl::SyncTimestamp(const pb::meta::TsoTimestamp& current_timestamp, i
   return 0;
 }
 
-void TsoControl::GenTso(const pb::meta::TsoRequest* request, pb::meta::TsoResponse* response) {
-  int64_t count = request->count();
+bool TsoControl::AllocTso(int64_t count, pb::meta::TsoTimestamp& start_timestamp) {
+  int64_t current = tso_obj_.current_timestamp.load(std::memory_order_acquire);
+  do {
+    if (TsoPhysical(current) == 0 || TsoLogical(current) + count >= kMaxLogical) {
+      return false;
+    }
+  } while (!tso_obj_.current_timestamp.compare_exchange_weak(current, current + count, std::memory_order_acq_rel,
+                                                              std::memory_order_acquire));
+
+  start_timestamp.set_physical(TsoPhysical(current));
+  start_timestamp.set_logical(TsoLogical(current));
+  return true;
+}
+
+butil::Status TsoControl::AllocTsoWithRetry(int64_t count, pb::meta::TsoTimestamp& start_timestamp) {
+  for (size_t i = 0; i < 50; i++) {
+    if (AllocTso(count, start_timestamp)) {
+      return butil::Status::OK();
+    }
+
+    int64_t current = tso_obj_.current_timestamp.load(std::memory_order_acquire);
+    if (TsoPhysical(current) == 0) {
+      DINGO_LOG(WARNING) << "timestamp not ok physical == 0, retry later";
+    } else {
+      DINGO_LOG(WARNING) << "logical part outside of max logical interval, retry later, please check ntp time";
+    }
+    bthread_usleep(kUpdateTimestampIntervalMs * 1000LL);
+  }
+
+  return butil::Status(pb::error::Errno::EEXEC_FAIL, "gen tso failed");
+}
+
+pb::meta::TsoTimestamp TsoControl::GetCurrentTimestamp() {
+  int64_t current = tso_obj_.current_timestamp.load(std::memory_order_acquire);
+
+  pb::meta::TsoTimestamp timestamp;
+  timestamp.set_physical(TsoPhysical(current));
+  timestamp.set_logical(TsoLogical(current));
+  return timestamp;
+}
+
+void TsoControl::SetCurrentTimestamp(const pb::meta::TsoTimestamp& timestamp, bool force) {
+  int64_t target = ComposeTso(timestamp.physical(), timestamp.logical());
+  if (force) {
+    tso_obj_.current_timestamp.store(target, std::memory_order_release);
+    return;
+  }
+
+  // the allocated timestamp may be ahead of target in the same physical, never fallback.
+  int64_t current = tso_obj_.current_timestamp.load(std::memory_order_acquire);
+  while (current < target && !tso_obj_.current_timestamp.compare_exchange_weak(
+                                 current, target, std::memory_order_acq_rel, std::memory_order_acquire)) {
+  }
+}
+
+static bool CheckGenTsoRequest(bool is_healty, const pb::meta::TsoRequest* request, pb::meta::TsoResponse* response) {
   response->set_op_type(request->op_type());
-  if (count == 0) {
+  if (request->count() <= 0 || request->count() >= kMaxLogical) {
     response->mutable_error()->set_errcode(pb::error::Errno::EILLEGAL_PARAMTETERS);
-    response->mutable_error()->set_errmsg("tso count should be positive");
-    return;
+    response->mutable_error()->set_errmsg("tso count should be positive and less than max logical");
+    return false;
   }
-  if (!is_healty_) {
+  if (!is_healty) {
     DINGO_LOG(ERROR) << "TSO has wrong status, retry later";
     response->mutable_error()->set_errcode(pb::error::Errno::ERETRY_LATER);
     response->mutable_error()->set_errmsg("timestamp not ok, retry later");
+    return false;
+  }
+
+  return true;
+}
+
+void TsoControl::GenTso(const pb::meta::TsoRequest* request, pb::meta::TsoResponse* response) {
+  BvarLatencyGuard bvar_guard(&g_tso_gen_latency);
+
+  if (!CheckGenTsoRequest(is_healty_, request, response)) {
     return;
   }
+
+  int64_t count = request->count();
   pb::meta::TsoTimestamp current;
-  bool need_retry = false;
-  for (size_t i = 0; i < 50; i++) {
-    {
-      BAIDU_SCOPED_LOCK(tso_mutex_);
-      int64_t physical = tso_obj_.current_timestamp.physical();
-      if (physical != 0) {
-        int64_t new_logical = tso_obj_.current_timestamp.logical() + count;
-        if (new_logical < kMaxLogical) {
-          current = tso_obj_.current_timestamp;
-          tso_obj_.current_timestamp.set_logical(new_logical);
-          need_retry = false;
-        } else {
-          DINGO_LOG(WARNING) << "logical part outside of max logical interval, retry later, please check ntp time";
-          need_retry = true;
-        }
-      } else {
-        DINGO_LOG(WARNING) << "timestamp not ok physical == 0, retry later";
-        need_retry = true;
-      }
-    }
-    if (!need_retry) {
-      break;
-    } else {
-      bthread_usleep(kUpdateTimestampIntervalMs * 1000LL);
-    }
-  }
-  if (need_retry) {
-    response->mutable_error()->set_errcode(pb::error::Errno::EEXEC_FAIL);
-    response->mutable_error()->set_errmsg("gen tso failed");
+  auto status = AllocTsoWithRetry(count, current);
+  if (!status.ok()) {
+    response->mutable_error()->set_errcode(static_cast<pb::error::Errno>(status.error_code()));
+    response->mutable_error()->set_errmsg(status.error_str());
     DINGO_LOG(ERROR) << "gen tso failed";
     return;
   }
-  DINGO_LOG(INFO) << "gen tso current: (" << current.physical() << ", " << current.logical() << ")";
+  DINGO_LOG(DEBUG) << "gen tso current: (" << current.physical() << ", " << current.logical() << ")";
   auto* timestamp = response->mutable_start_timestamp();
   *timestamp = current;
   response->set_count(count);
 }
 
+void TsoControl::GenTsoBatch(std::vector<GenTsoTask*>& tasks) {
+  BvarLatencyGuard bvar_guard(&g_tso_gen_latency);
+  g_tso_coalesce_batch_size << tasks.size();
+
+  int64_t total_count = 0;
+  std::vector<GenTsoTask*> valid_tasks;
+  valid_tasks.reserve(tasks.size());
+  for (auto* task : tasks) {
+    if (CheckGenTsoRequest(is_healty_, task->request, task->response)) {
+      total_count += task->request->count();
+      valid_tasks.push_back(task);
+    }
+  }
+
+  // the batch can't get one range, fallback to gen one by one.
+  if (total_count >= kMaxLogical) {
+    for (auto* task : valid_tasks) {
+      GenTso(task->request, task->response);
+    }
+    return;
+  }
+
+  pb::meta::TsoTimestamp start;
+  butil::Status status;
+  if (!valid_tasks.empty()) {
+    status = AllocTsoWithRetry(total_count, start);
+  }
+
+  int64_t logical = start.logical();
+  for (auto* task : valid_tasks) {
+    if (!status.ok()) {
+      task->response->mutable_error()->set_errcode(static_cast<pb::error::Errno>(status.error_code()));
+      task->response->mutable_error()->set_errmsg(status.error_str());
+      continue;
+    }
+
+    auto* timestamp = task->response->mutable_start_timestamp();
+    timestamp->set_physical(start.physical());
+    timestamp->set_logical(logical);
+    task->response->set_count(task->request->count());
+    logical += task->request->count();
+  }
+
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format("gen tso failed, batch size({}) count({}).", valid_tasks.size(), total_count);
+  }
+}
+
+static int GenTsoRoutine(void* meta, bthread::TaskIterator<GenTsoTask*>& iter) {  // NOLINT
+  TsoControl* tso_control = static_cast<TsoControl*>(meta);
+
+  std::vector<GenTsoTask*> tasks;
+  for (; iter; ++iter) {
+    tasks.push_back(*iter);
+  }
+
+  if (!iter.is_queue_stopped()) {
+    tso_control->GenTsoBatch(tasks);
+  }
+
+  for (auto* task : tasks) {
+    if (iter.is_queue_stopped()) {
+      task->response->mutable_error()->set_errcode(pb::error::Errno::ERAFT_NOTLEADER);
+      task->response->mutable_error()->set_errmsg("tso service is stopped");
+    }
+    brpc::ClosureGuard done_guard(task->done);
+    delete task;
+  }
+
+  return 0;
+}
+
 // This method is called by the gRPC server.
 // This method is used to process the request from the client.
 // The response is filled by the state machine and sent back to the client.
@@ -202,7 +326,7 @@ void TsoControl::Process(google::protobuf::RpcController* controller, const pb::
     response->set_system_time(ClockRealtimeMs());
     response->set_save_physical(tso_obj_.last_save_physical);
     auto* timestamp = response->mutable_start_timestamp();
-    *timestamp = tso_obj_.current_timestamp;
+    *timestamp = GetCurrentTimestamp();
     return;
   }
   brpc::Controller* cntl = (brpc::Controller*)controller;
@@ -223,6 +347,16 @@ void TsoControl::Process(google::protobuf::RpcController* controller, const pb::
   }
   // gen tso out of raft state machine
   if (request->op_type() == pb::meta::OP_GEN_TSO) {
+    if (FLAGS_tso_enable_coalesce && is_coalesce_queue_started_) {
+      auto* task = new GenTsoTask{request, response, done_guard.release()};
+      if (bthread::execution_queue_execute(coalesce_queue_id_, task) == 0) {
+        return;
+      }
+      done_guard.reset(task->done);
+      delete task;
+      DINGO_LOG(WARNING) << "execute gen tso coalesce queue failed, gen tso directly.";
+    }
+
     GenTso(request, response);
     return;
   }
@@ -250,16 +384,17 @@ void TsoControl::ResetTso(const pb::meta::TsoRequest& request, pb::meta::TsoResp
   if (request.has_current_timestamp() && request.save_physical() > 0) {
     int64_t physical = request.save_physical();
     const pb::meta::TsoTimestamp& current = request.current_timestamp();
-    if (physical < tso_obj_.last_save_physical || current.physical() < tso_obj_.current_timestamp.physical()) {
+    auto current_timestamp = GetCurrentTimestamp();
+    if (physical < tso_obj_.last_save_physical || current.physical() < current_timestamp.physical()) {
       if (!request.force()) {
         DINGO_LOG(WARNING) << "time fallback save_physical:(" << physical << ", " << tso_obj_.last_save_physical
-                           << ") current:(" << current.physical() << ", " << tso_obj_.current_timestamp.physical()
-                           << ", " << current.logical() << ", " << tso_obj_.current_timestamp.logical() << ")";
+                           << ") current:(" << current.physical() << ", " << current_timestamp.physical() << ", "
+                           << current.logical() << ", " << current_timestamp.logical() << ")";
         if (response) {
           response->mutable_error()->set_errcode(pb::error::Errno::EINTERNAL);
           response->mutable_error()->set_errmsg("time can't fallback");
           auto* timestamp = response->mutable_start_timestamp();
-          *timestamp = tso_obj_.current_timestamp;
+          *timestamp = current_timestamp;
           response->set_save_physical(tso_obj_.last_save_physical);
         }
         return;
@@ -271,8 +406,8 @@ void TsoControl::ResetTso(const pb::meta::TsoRequest& request, pb::meta::TsoResp
     {
       BAIDU_SCOPED_LOCK(tso_mutex_);
       tso_obj_.last_save_physical = physical;
-      tso_obj_.current_timestamp = current;
     }
+    SetCurrentTimestamp(current, request.force());
     if (response) {
       response->set_save_physical(physical);
       auto* timestamp = response->mutable_start_timestamp();
@@ -287,20 +422,21 @@ void TsoControl::UpdateTso(const pb::meta::TsoRequest& request, pb::meta::TsoRes
   int64_t physical = request.save_physical();
   const pb::meta::TsoTimestamp& current = request.current_timestamp();
   // can't rollback
-  if (physical < tso_obj_.last_save_physical || current.physical() < tso_obj_.current_timestamp.physical()) {
-    DINGO_LOG(WARNING) << "time fallback save_physical:(" << physical << ", " << tso_obj_.last_save_physical
-                       << ") current:(" << current.physical() << ", " << tso_obj_.current_timestamp.physical() << ", "
-                       << current.logical() << ", " << tso_obj_.current_timestamp.logical() << ")";
-    if (response) {
-      response->mutable_error()->set_errcode(pb::error::Errno::EINTERNAL);
-      response->mutable_error()->set_errmsg("time can't fallback");
-    }
-    return;
-  }
   {
     BAIDU_SCOPED_LOCK(tso_mutex_);
+    auto current_timestamp = GetCurrentTimestamp();
+    if (physical < tso_obj_.last_save_physical || current.physical() < current_timestamp.physical()) {
+      DINGO_LOG(WARNING) << "time fallback save_physical:(" << physical << ", " << tso_obj_.last_save_physical
+                         << ") current:(" << current.physical() << ", " << current_timestamp.physical() << ", "
+                         << current.logical() << ", " << current_timestamp.logical() << ")";
+      if (response) {
+        response->mutable_error()->set_errcode(pb::error::Errno::EINTERNAL);
+        response->mutable_error()->set_errmsg("time can't fallback");
+      }
+      return;
+    }
     tso_obj_.last_save_physical = physical;
-    tso_obj_.current_timestamp = current;
+    SetCurrentTimestamp(current, false);
   }
 
   if (response) {
@@ -316,16 +452,30 @@ TsoControl::TsoControl() {
   leader_term_.store(-1, butil::memory_order_release);
 }
 
+TsoControl::~TsoControl() {
+  if (is_coalesce_queue_started_) {
+    bthread::execution_queue_stop(coalesce_queue_id_);
+    bthread::execution_queue_join(coalesce_queue_id_);
+  }
+}
+
 // tso_update_timer_ is a timer to update timestamp
 // tso_update_timer_ is started when OnLeaderStart
 // and is stopped in OnLeaderStop
 bool TsoControl::Init() {
   DINGO_LOG(INFO) << "init";
   tso_update_timer_.init(this, kUpdateTimestampIntervalMs);
-  tso_obj_.current_timestamp.set_physical(0);
-  tso_obj_.current_timestamp.set_logical(0);
+  tso_obj_.current_timestamp.store(0, std::memory_order_release);
   tso_obj_.last_save_physical = 0;
 
+  bthread::ExecutionQueueOptions options;
+  options.bthread_attr = BTHREAD_ATTR_NORMAL;
+  if (bthread::execution_queue_start(&coalesce_queue_id_, &options, GenTsoRoutine, this) != 0) {
+    DINGO_LOG(ERROR) << "start gen tso coalesce queue failed.";
+    return false;
+  }
+  is_coalesce_queue_started_ = true;
+
   return true;
 }
 
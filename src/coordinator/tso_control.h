@@ -17,11 +17,14 @@
 
 #include <braft/repeated_timer_task.h>
 
+#include <atomic>
 #include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "bthread/execution_queue.h"
 #include "common/meta_control.h"
 #include "engine/engine.h"
 #include "proto/coordinator_internal.pb.h"
@@ -44,6 +47,11 @@ inline int64_t ClockRealtimeMs() {
 
 inline uint32_t GetTimestampInternal(int64_t offset) { return ((offset >> 18) + kBaseTimestampMs) / 1000; }
 
+// tso is packed as physical << kLogicalBits | logical in int64_t.
+inline int64_t ComposeTso(int64_t physical, int64_t logical) { return (physical << kLogicalBits) + logical; }
+inline int64_t TsoPhysical(int64_t tso) { return tso >> kLogicalBits; }
+inline int64_t TsoLogical(int64_t tso) { return tso & (kMaxLogical - 1); }
+
 class TimeCost {
  public:
   TimeCost() { start_ = butil::gettimeofday_us(); }
@@ -88,10 +96,18 @@ class TsoTimer : public braft::RepeatedTimerTask {
 };
 
 struct TsoObj {
-  pb::meta::TsoTimestamp current_timestamp;
+  // packed current timestamp, allocate by cas without lock.
+  std::atomic<int64_t> current_timestamp{0};
   int64_t last_save_physical;
 };
 
+// Gen tso request waiting in the coalesce queue.
+struct GenTsoTask {
+  const pb::meta::TsoRequest *request;
+  pb::meta::TsoResponse *response;
+  google::protobuf::Closure *done;
+};
+
 class TsoSnapshot : public dingodb::Snapshot {
  public:
   explicit TsoSnapshot(const int64_t *snapshot) : snapshot_(snapshot) {}
@@ -107,7 +123,7 @@ class TsoSnapshot : public dingodb::Snapshot {
 class TsoControl : public MetaControl {
  public:
   TsoControl();
-  ~TsoControl() override = default;
+  ~TsoControl() override;
 
   template <typename T>
   void RedirectResponse(T response) {
@@ -167,6 +183,12 @@ class TsoControl : public MetaControl {
                pb::meta::TsoResponse *response, google::protobuf::Closure *done);
 
   void GenTso(const pb::meta::TsoRequest *request, pb::meta::TsoResponse *response);
+  // Gen tso of the batch of tasks by one allocation, the tasks get the consecutive range in order.
+  void GenTsoBatch(std::vector<GenTsoTask *> &tasks);
+  // Allocate count timestamps without lock, return the start timestamp.
+  // Return false when timestamp is not ready or logical overflow.
+  bool AllocTso(int64_t count, pb::meta::TsoTimestamp &start_timestamp);
+  pb::meta::TsoTimestamp GetCurrentTimestamp();
   void ResetTso(const pb::meta::TsoRequest &request, pb::meta::TsoResponse *response);
   void UpdateTso(const pb::meta::TsoRequest &request, pb::meta::TsoResponse *response);
 
@@ -175,9 +197,18 @@ class TsoControl : public MetaControl {
   void OnApply(braft::Iterator &iter);
 
  private:
+  // allocate with retry when timestamp is not ready or logical overflow.
+  butil::Status AllocTsoWithRetry(int64_t count, pb::meta::TsoTimestamp &start_timestamp);
+  // advance current timestamp, not fallback unless force.
+  void SetCurrentTimestamp(const pb::meta::TsoTimestamp &timestamp, bool force);
+
   TsoTimer tso_update_timer_;
   TsoObj tso_obj_;
-  bthread_mutex_t tso_mutex_;  // for tso_obj_
+  bthread_mutex_t tso_mutex_;  // for tso_obj_.last_save_physical
+
+  // coalesce concurrent gen tso requests
+  bool is_coalesce_queue_started_{false};
+  bthread::ExecutionQueueId<GenTsoTask *> coalesce_queue_id_;
   bool is_healty_ = true;
 
   // node is leader or not
@@ -317,29 +317,43 @@ butil::Status AggregationManager::Open(
   return butil::Status();
 }
 
-butil::Status AggregationManager::Execute(const std::string& group_by_key,
-                                          const std::vector<std::any>& group_by_operator_record) {
-  butil::Status status;
-  std::shared_ptr<Aggregation> aggregation;
+butil::Status AggregationManager::GetOrCreateAggregation(const std::string& group_by_key, Aggregation*& aggregation) {
+  if (last_aggregation_ != nullptr && *last_group_by_key_ == group_by_key) {
+    aggregation = last_aggregation_;
+    return butil::Status();
+  }
 
   if (!aggregations_) {
-    using MapType = std::map<std::string, std::shared_ptr<Aggregation>>;
-    aggregations_ = std::make_shared<MapType>();
+    aggregations_ = std::make_shared<AggregationMap>();
   }
 
-  const auto& iter = aggregations_->find(group_by_key);
+  auto iter = aggregations_->find(group_by_key);
   if (iter == aggregations_->end()) {
-    const auto& [iter_new, _] = aggregations_->emplace(group_by_key, std::make_shared<Aggregation>());
-    aggregation = iter_new->second;
-
-    status = aggregation->Open(result_serial_schemas_->size() - group_by_operator_serial_schemas_->size(),
-                               result_serial_schemas_, aggregation_operators_);
+    auto new_aggregation = std::make_shared<Aggregation>();
+    auto status = new_aggregation->Open(result_serial_schemas_->size() - group_by_operator_serial_schemas_->size(),
+                                        result_serial_schemas_, aggregation_operators_);
     if (!status.ok()) {
       DINGO_LOG(ERROR) << fmt::format("Aggregation::Open failed");
       return status;
     }
-  } else {
-    aggregation = iter->second;
+
+    iter = aggregations_->emplace(group_by_key, std::move(new_aggregation)).first;
+  }
+
+  // key and value of unordered_map node is stable when rehash
+  last_group_by_key_ = &iter->first;
+  last_aggregation_ = iter->second.get();
+  aggregation = last_aggregation_;
+
+  return butil::Status();
+}
+
+butil::Status AggregationManager::Execute(const std::string& group_by_key,
+                                          const std::vector<std::any>& group_by_operator_record) {
+  Aggregation* aggregation = nullptr;
+  butil::Status status = GetOrCreateAggregation(group_by_key, aggregation);
+  if (!status.ok()) {
+    return status;
   }
 
   status = aggregation->Execute(aggregation_functions_, group_by_operator_record);
@@ -367,12 +381,13 @@ void AggregationManager::Close() {
   if (aggregations_) {
     aggregations_.reset();
   }
+  last_group_by_key_ = nullptr;
+  last_aggregation_ = nullptr;
 }
 
 std::shared_ptr<AggregationIterator> AggregationManager::CreateIterator() {
   if (!aggregations_) {
-    using MapType = std::map<std::string, std::shared_ptr<Aggregation>>;
-    aggregations_ = std::make_shared<MapType>();
+    aggregations_ = std::make_shared<AggregationMap>();
   }
   DINGO_LOG(DEBUG) << "aggregations  size : " << aggregations_->size();
   return std::make_shared<AggregationIterator>(aggregations_);
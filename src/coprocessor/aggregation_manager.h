@@ -17,11 +17,12 @@
 
 #include <serial/schema/base_schema.h>
 
+#include <algorithm>
 #include <any>
 #include <functional>
-#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "butil/status.h"
@@ -30,23 +31,32 @@
 
 namespace dingodb {
 
+using AggregationMap = std::unordered_map<std::string, std::shared_ptr<Aggregation>>;
+
 class AggregationIterator {
  public:
-  explicit AggregationIterator(const std::shared_ptr<std::map<std::string, std::shared_ptr<Aggregation>>>& aggregations)
-      : aggregations_(aggregations) {
-    iter_ = aggregations_->begin();
+  // iterate in order of group by key, same as the result order of ordered map.
+  explicit AggregationIterator(const std::shared_ptr<AggregationMap>& aggregations) : aggregations_(aggregations) {
+    sorted_aggregations_.reserve(aggregations_->size());
+    for (const auto& aggregation : *aggregations_) {
+      sorted_aggregations_.push_back(&aggregation);
+    }
+    std::sort(sorted_aggregations_.begin(), sorted_aggregations_.end(),
+              [](const auto* lhs, const auto* rhs) { return lhs->first < rhs->first; });
+    iter_ = sorted_aggregations_.begin();
   }
 
   ~AggregationIterator() { aggregations_.reset(); }
 
-  bool HasNext() { return (iter_ != aggregations_->end()); }
+  bool HasNext() { return (iter_ != sorted_aggregations_.end()); }
   void Next() { ++iter_; }
-  const std::string& GetKey() const { return iter_->first; }
-  const std::shared_ptr<std::vector<std::any>>& GetValue() const { return iter_->second->GetResult(); }
+  const std::string& GetKey() const { return (*iter_)->first; }
+  const std::shared_ptr<std::vector<std::any>>& GetValue() const { return (*iter_)->second->GetResult(); }
 
  private:
-  std::shared_ptr<std::map<std::string, std::shared_ptr<Aggregation>>> aggregations_;
-  std::map<std::string, std::shared_ptr<Aggregation>>::iterator iter_;
+  std::shared_ptr<AggregationMap> aggregations_;
+  std::vector<const AggregationMap::value_type*> sorted_aggregations_;
+  std::vector<const AggregationMap::value_type*>::iterator iter_;
 };
 
 class AggregationManager {
@@ -70,6 +80,8 @@ class AggregationManager {
   void Close();
 
  private:
+  butil::Status GetOrCreateAggregation(const std::string& group_by_key, Aggregation*& aggregation);  // NOLINT
+
   butil::Status AddSumFunction(BaseSchema::Type serial_schema_type, BaseSchema::Type result_schema_type);
   butil::Status AddCountFunction(BaseSchema::Type serial_schema_type, BaseSchema::Type result_schema_type);
   butil::Status AddCountWithNullFunction(BaseSchema::Type serial_schema_type, BaseSchema::Type result_schema_type);
@@ -80,7 +92,10 @@ class AggregationManager {
   ::google::protobuf::RepeatedPtrField<pb::store::AggregationOperator> aggregation_operators_;
   std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> result_serial_schemas_;
   std::vector<std::function<bool(const std::any&, std::any*)>> aggregation_functions_;
-  std::shared_ptr<std::map<std::string, std::shared_ptr<Aggregation>>> aggregations_;
+  std::shared_ptr<AggregationMap> aggregations_;
+  // rows of same group are usually adjacent, cache the last group to skip hash lookup.
+  const std::string* last_group_by_key_{nullptr};
+  Aggregation* last_aggregation_{nullptr};
 };
 
 }  // namespace dingodb
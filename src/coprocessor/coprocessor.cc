@@ -292,8 +292,10 @@ butil::Status Coprocessor::DoExecute(const pb::common::KeyValue& kv, bool* has_r
                                      pb::common::KeyValue* result_kv) {
   butil::Status status;
 
-  RecordDecoder original_record_decoder(coprocessor_.schema_version(), original_serial_schemas_,
-                                        coprocessor_.original_schema().common_id());
+  if (!original_record_decoder_) {
+    original_record_decoder_ = std::make_shared<RecordDecoder>(
+        coprocessor_.schema_version(), original_serial_schemas_, coprocessor_.original_schema().common_id());
+  }
 
   std::vector<std::any> original_record;
 
@@ -312,8 +314,8 @@ butil::Status Coprocessor::DoExecute(const pb::common::KeyValue& kv, bool* has_r
   int ret = 0;
   try {
     // decode some column. not decode all
-    ret = original_record_decoder.Decode(kv.key(), kv.value(), selection_column_indexes_,
-                                         selection_column_indexes_serial_, original_record);
+    ret = original_record_decoder_->Decode(kv.key(), kv.value(), selection_column_indexes_,
+                                           selection_column_indexes_serial_, original_record);
   } catch (const std::exception& my_exception) {
     std::string error_message = fmt::format("serial::Decode failed exception : {}", my_exception.what());
     DINGO_LOG(ERROR) << error_message;
@@ -446,12 +448,14 @@ butil::Status Coprocessor::DoExecuteForAggregation(const std::vector<std::any>&
 
   std::string group_by_key;
   if (group_by_key_serial_schemas_ && !group_by_key_serial_schemas_->empty()) {
-    RecordEncoder group_by_key_encoder(coprocessor_.schema_version(), group_by_key_serial_schemas_,
-                                       coprocessor_.result_schema().common_id());
+    if (!group_by_key_encoder_) {
+      group_by_key_encoder_ = std::make_shared<RecordEncoder>(
+          coprocessor_.schema_version(), group_by_key_serial_schemas_, coprocessor_.result_schema().common_id());
+    }
     int ret = 0;
     try {
       // group_by_key_record [0,1,2,3,4,5,6] sort, for group_by_key_serial_schemas_ in vector index no schema index
-      ret = group_by_key_encoder.EncodeKey(prefix_, group_by_key_record, group_by_key);
+      ret = group_by_key_encoder_->EncodeKey(prefix_, group_by_key_record, group_by_key);
     } catch (const std::exception& my_exception) {
       std::string error_message = fmt::format("serial::EncodeKey failed exception : {}", my_exception.what());
       DINGO_LOG(ERROR) << error_message;
@@ -656,6 +660,9 @@ void Coprocessor::Close() {
     aggregation_iterator_.reset();
   }
 
+  original_record_decoder_.reset();
+  group_by_key_encoder_.reset();
+
   original_column_indexes_.clear();
   selection_column_indexes_.clear();
   selection_column_indexes_serial_.clear();
@@ -27,6 +27,8 @@
 #include "coprocessor/raw_coprocessor.h"
 #include "engine/iterator.h"
 #include "proto/store.pb.h"
+#include "serial/record_decoder.h"
+#include "serial/record_encoder.h"
 
 namespace dingodb {
 
@@ -93,6 +95,11 @@ class Coprocessor : public RawCoprocessor {
   bool end_of_group_by_;
   std::shared_ptr<AggregationManager> aggregation_manager_;
   std::shared_ptr<AggregationIterator> aggregation_iterator_;
+
+  // created once and reused by every row
+  std::shared_ptr<RecordDecoder> original_record_decoder_;
+  std::shared_ptr<RecordEncoder> group_by_key_encoder_;
+
   std::vector<int> original_column_indexes_;
   std::vector<int> selection_column_indexes_;
   std::unordered_map<int, int> selection_column_indexes_serial_;
@@ -23,12 +23,15 @@
 #include "braft/protobuf_file.h"
 #include "bthread/bthread.h"
 #include "butil/status.h"
+#include "bvar/latency_recorder.h"
+#include "bvar/reducer.h"
 #include "common/constant.h"
 #include "common/helper.h"
 #include "common/logging.h"
 #include "document/codec.h"
 #include "document/document_index_factory.h"
 #include "fmt/core.h"
+#include "log/rocks_log_storage.h"
 #include "mvcc/codec.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
@@ -40,6 +43,17 @@ namespace dingodb {
 DEFINE_int32(document_index_save_log_gap, 10, "document index save log gap");
 BRPC_VALIDATE_GFLAG(document_index_save_log_gap, brpc::PositiveInteger);
 
+DEFINE_int64(document_index_group_commit_interval_ms, 1000,
+             "document index group commit max interval ms for raft apply writes, 0 means commit every write");
+DEFINE_int64(document_index_group_commit_doc_count, 10000,
+             "document index group commit when pending document count reach it");
+DEFINE_int64(document_index_reader_refresh_interval_ms, 500,
+             "document index near real time reader refresh interval ms, 0 means refresh after every commit");
+
+bvar::Adder<int64_t> g_document_index_commit_count("dingo_document_index_commit_count");
+bvar::LatencyRecorder g_document_index_commit_latency("dingo_document_index_commit_latency");
+bvar::LatencyRecorder g_document_index_reload_latency("dingo_document_index_reload_latency");
+
 butil::Status DocumentIndex::RemoveIndexFiles(int64_t id, const std::string& index_path) {
   // index_path: /home/dingo-store/dist/document1/data/document_index/80040/epoch_1
   // need remove index_path: /home/dingo-store/dist/document1/data/document_index/80040
@@ -92,6 +106,26 @@ int64_t DocumentIndex::ApplyLogId() const { return apply_log_id_.load(std::memor
 
 void DocumentIndex::SetApplyLogId(int64_t apply_log_id) {
   this->apply_log_id_.store(apply_log_id, std::memory_order_relaxed);
+
+  // load/build/catch up index, the data before apply_log_id is committed.
+  if (apply_log_id > write_log_id_.load(std::memory_order_relaxed)) {
+    write_log_id_.store(apply_log_id, std::memory_order_relaxed);
+  }
+  if (apply_log_id > commit_log_id_.load(std::memory_order_relaxed)) {
+    commit_log_id_.store(apply_log_id, std::memory_order_release);
+  }
+}
+
+void DocumentIndex::SetWriteLogId(int64_t log_id) {
+  RWLockWriteGuard guard(&rw_lock_);
+
+  if (log_id > write_log_id_.load(std::memory_order_relaxed)) {
+    write_log_id_.store(log_id, std::memory_order_relaxed);
+  }
+  // no pending writes, all writes before log_id are committed
+  if (pending_count_ == 0 && log_id > commit_log_id_.load(std::memory_order_relaxed)) {
+    commit_log_id_.store(log_id, std::memory_order_release);
+  }
 }
 
 pb::common::RegionEpoch DocumentIndex::Epoch() const { return epoch_; };
@@ -136,6 +170,14 @@ butil::Status DocumentIndex::SaveMeta(int64_t apply_log_id) {
 
   UnlockWrite();
 
+  // Load index replay raft log after apply_log_id, the uncommitted writes of group commit live only in raft log,
+  // so forbid truncate raft log after apply_log_id.
+  auto log_storage = Server::GetInstance().GetRaftLogStorage();
+  wal::LogIndexMeta log_index_meta;
+  if (log_storage != nullptr && log_storage->GetLogIndexMeta(id_, log_index_meta)) {
+    log_storage->TruncatePrefix(wal::ClientType::kDocumentIndex, id_, apply_log_id);
+  }
+
   return butil::Status::OK();
 }
 
@@ -193,7 +235,7 @@ std::shared_ptr<DocumentIndex> DocumentIndex::LoadIndex(int64_t id, const pb::co
 }
 
 butil::Status DocumentIndex::Upsert(const std::vector<pb::common::DocumentWithId>& document_with_ids,
-                                    bool reload_reader) {
+                                    bool reload_reader, bool is_group_commit) {
   if (document_with_ids.empty()) {
     return butil::Status::OK();
   }
@@ -210,10 +252,11 @@ butil::Status DocumentIndex::Upsert(const std::vector<pb::common::DocumentWithId
     return status;
   }
 
-  return Add(document_with_ids, reload_reader);
+  return Add(document_with_ids, reload_reader, is_group_commit);
 }
 
-butil::Status DocumentIndex::Add(const std::vector<pb::common::DocumentWithId>& document_with_ids, bool reload_reader) {
+butil::Status DocumentIndex::Add(const std::vector<pb::common::DocumentWithId>& document_with_ids, bool reload_reader,
+                                 bool is_group_commit) {
   DINGO_LOG(DEBUG) << fmt::format("[document_index.raw][id({})] add document count({})", id_, document_with_ids.size());
 
   if (document_with_ids.empty()) {
@@ -309,6 +352,38 @@ butil::Status DocumentIndex::Add(const std::vector<pb::common::DocumentWithId>&
     }
   }
 
+  pending_count_ += document_with_ids.size();
+  if (IsNeedCommit(is_group_commit)) {
+    auto status = Commit();
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  if (reload_reader) {
+    return Reload(!is_group_commit);
+  }
+
+  return butil::Status::OK();
+}
+
+bool DocumentIndex::IsNeedCommit(bool is_group_commit) const {
+  if (pending_count_ == 0) {
+    return false;
+  }
+  if (!is_group_commit || FLAGS_document_index_group_commit_interval_ms <= 0) {
+    return true;
+  }
+
+  return pending_count_ >= FLAGS_document_index_group_commit_doc_count ||
+         Helper::TimestampMs() - last_commit_time_ms_ >= FLAGS_document_index_group_commit_interval_ms;
+}
+
+butil::Status DocumentIndex::Commit() {
+  // writes before write_log_id are all in index writer
+  int64_t write_log_id = write_log_id_.load(std::memory_order_relaxed);
+  int64_t start_time = Helper::TimestampMs();
+
   auto bool_result = ffi_index_writer_commit(index_path_);
   if (!bool_result.result) {
     std::string err_msg = fmt::format("[document_index.raw][id({})] commit failed, error: {}, error_msg: {}", id_,
@@ -317,19 +392,63 @@ butil::Status DocumentIndex::Add(const std::vector<pb::common::DocumentWithId>&
     return butil::Status(pb::error::EINTERNAL, err_msg);
   }
 
-  if (reload_reader) {
-    bool_result = ffi_index_reader_reload(index_path_);
-    if (!bool_result.result) {
-      std::string err_msg = fmt::format("[document_index.raw][id({})] reload failed, error: {}, error_msg: {}", id_,
-                                        bool_result.error_code, bool_result.error_msg.c_str());
-      DINGO_LOG(ERROR) << err_msg;
-      return butil::Status(pb::error::EINTERNAL, err_msg);
-    }
+  last_commit_time_ms_ = Helper::TimestampMs();
+  g_document_index_commit_latency << (last_commit_time_ms_ - start_time) * 1000;
+  g_document_index_commit_count << 1;
+
+  DINGO_LOG(DEBUG) << fmt::format("[document_index.raw][id({})] commit pending count({}) write_log_id({})", id_,
+                                  pending_count_, write_log_id);
+
+  pending_count_ = 0;
+  need_reload_ = true;
+  if (write_log_id > commit_log_id_.load(std::memory_order_relaxed)) {
+    commit_log_id_.store(write_log_id, std::memory_order_release);
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status DocumentIndex::Reload(bool force) {
+  if (!need_reload_) {
+    return butil::Status::OK();
   }
+  int64_t now_ms = Helper::TimestampMs();
+  if (!force && now_ms - last_reload_time_ms_ < FLAGS_document_index_reader_refresh_interval_ms) {
+    return butil::Status::OK();
+  }
+
+  auto bool_result = ffi_index_reader_reload(index_path_);
+  if (!bool_result.result) {
+    std::string err_msg = fmt::format("[document_index.raw][id({})] reload failed, error: {}, error_msg: {}", id_,
+                                      bool_result.error_code, bool_result.error_msg.c_str());
+    DINGO_LOG(ERROR) << err_msg;
+    return butil::Status(pb::error::EINTERNAL, err_msg);
+  }
+
+  last_reload_time_ms_ = Helper::TimestampMs();
+  g_document_index_reload_latency << (last_reload_time_ms_ - now_ms) * 1000;
+  need_reload_ = false;
 
   return butil::Status::OK();
 }
 
+butil::Status DocumentIndex::Flush(bool force) {
+  RWLockWriteGuard guard(&rw_lock_);
+
+  if (is_destroyed_) {
+    return butil::Status::OK();
+  }
+
+  if (force ? pending_count_ > 0 : IsNeedCommit(true)) {
+    auto status = Commit();
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  return Reload(force);
+}
+
 butil::Status DocumentIndex::Delete(const std::vector<int64_t>& delete_ids) {
   DINGO_LOG(INFO) << fmt::format("[document_index.raw][id({})] delete document count({})", id_, delete_ids.size());
 
@@ -371,6 +490,9 @@ butil::Status DocumentIndex::Delete(const std::vector<int64_t>& delete_ids) {
     return butil::Status(pb::error::EINTERNAL, err_msg);
   }
 
+  // committed by next add or flush
+  pending_count_ += delete_ids_uint64.size();
+
   return butil::Status::OK();
 }
 
@@ -431,15 +553,7 @@ butil::Status DocumentIndex::Search(uint32_t topk, const std::string& query_stri
 
 butil::Status DocumentIndex::Save(const std::string& /*path*/) {
   // Save need the caller to do LockWrite() and UnlockWrite()
-  auto result = ffi_index_writer_commit(index_path_);
-  if (result.result) {
-    return butil::Status::OK();
-  } else {
-    std::string err_msg = fmt::format("[document_index.raw][id({})] save failed, error: {}, error_msg: {}", id_,
-                                      result.error_code, result.error_msg.c_str());
-    DINGO_LOG(ERROR) << err_msg;
-    return butil::Status(pb::error::EINTERNAL, err_msg);
-  }
+  return Commit();
 }
 
 butil::Status DocumentIndex::Load(const std::string& /*path*/) {
@@ -654,21 +768,58 @@ int64_t DocumentIndexWrapper::ApplyLogId() const { return apply_log_id_.load(std
 
 void DocumentIndexWrapper::SetApplyLogId(int64_t apply_log_id) {
   // update inner document index apply log id
-  if (apply_log_id - last_save_apply_log_id_.load(std::memory_order_relaxed) > FLAGS_document_index_save_log_gap) {
-    last_save_apply_log_id_.store(apply_log_id, std::memory_order_relaxed);
-
-    auto document_index = GetOwnDocumentIndex();
-    if (document_index != nullptr) {
-      auto status = document_index->SaveMeta(apply_log_id);
-      if (!status.ok()) {
-        DINGO_LOG(ERROR) << fmt::format("[document_index.raw][id({})] save meta fail.", id_);
-      }
-    }
+  auto document_index = GetOwnDocumentIndex();
+  if (document_index != nullptr) {
+    document_index->SetWriteLogId(apply_log_id);
+    SaveCommitLogId(document_index, false);
   }
 
   apply_log_id_.store(apply_log_id, std::memory_order_release);
 }
 
+// Only save the committed log id as apply log id of meta, the uncommitted writes of group commit is lost
+// when crash, load index will replay raft log after it.
+void DocumentIndexWrapper::SaveCommitLogId(DocumentIndexPtr document_index, bool force) {
+  int64_t commit_log_id = document_index->CommitLogId();
+  int64_t last_save_log_id = last_save_apply_log_id_.load(std::memory_order_relaxed);
+  if (commit_log_id <= last_save_log_id) {
+    return;
+  }
+  if (!force && commit_log_id - last_save_log_id <= FLAGS_document_index_save_log_gap) {
+    return;
+  }
+
+  last_save_apply_log_id_.store(commit_log_id, std::memory_order_relaxed);
+  auto status = document_index->SaveMeta(commit_log_id);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format("[document_index.raw][id({})] save meta fail.", id_);
+  }
+}
+
+butil::Status DocumentIndexWrapper::Flush(bool force) {
+  auto sibling_document_index = SiblingDocumentIndex();
+  if (sibling_document_index != nullptr) {
+    auto status = sibling_document_index->Flush(force);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  auto document_index = GetOwnDocumentIndex();
+  if (document_index == nullptr) {
+    return butil::Status::OK();
+  }
+
+  auto status = document_index->Flush(force);
+  if (!status.ok()) {
+    return status;
+  }
+
+  SaveCommitLogId(document_index, force);
+
+  return butil::Status::OK();
+}
+
 bool DocumentIndexWrapper::IsSwitchingDocumentIndex() { return is_switching_document_index_.load(); }
 
 void DocumentIndexWrapper::SetIsSwitchingDocumentIndex(bool is_switching) {
@@ -939,12 +1090,12 @@ butil::Status DocumentIndexWrapper::Upsert(const std::vector<pb::common::Documen
   auto sibling_document_index = SiblingDocumentIndex();
   if (sibling_document_index != nullptr) {
     auto status = sibling_document_index->Upsert(
-        FilterDocumentWithId(document_with_ids, sibling_document_index->Range(false)), true);
+        FilterDocumentWithId(document_with_ids, sibling_document_index->Range(false)), true, true);
     if (!status.ok()) {
       return status;
     }
 
-    status = document_index->Upsert(FilterDocumentWithId(document_with_ids, document_index->Range(false)), true);
+    status = document_index->Upsert(FilterDocumentWithId(document_with_ids, document_index->Range(false)), true, true);
     if (!status.ok()) {
       sibling_document_index->Delete(FilterDocumentId(document_with_ids, sibling_document_index->Range(false)));
       return status;
@@ -953,7 +1104,7 @@ butil::Status DocumentIndexWrapper::Upsert(const std::vector<pb::common::Documen
     return status;
   }
 
-  return document_index->Upsert(document_with_ids, true);
+  return document_index->Upsert(document_with_ids, true, true);
 }
 
 butil::Status DocumentIndexWrapper::Add(const std::vector<pb::common::DocumentWithId>& document_with_ids) {
@@ -980,12 +1131,12 @@ butil::Status DocumentIndexWrapper::Add(const std::vector<pb::common::DocumentWi
   auto sibling_document_index = SiblingDocumentIndex();
   if (sibling_document_index != nullptr) {
     auto status = sibling_document_index->Add(
-        FilterDocumentWithId(document_with_ids, sibling_document_index->Range(false)), true);
+        FilterDocumentWithId(document_with_ids, sibling_document_index->Range(false)), true, true);
     if (!status.ok()) {
       return status;
     }
 
-    status = document_index->Add(FilterDocumentWithId(document_with_ids, document_index->Range(false)), true);
+    status = document_index->Add(FilterDocumentWithId(document_with_ids, document_index->Range(false)), true, true);
     if (!status.ok()) {
       sibling_document_index->Delete(FilterDocumentId(document_with_ids, sibling_document_index->Range(false)));
       return status;
@@ -994,7 +1145,7 @@ butil::Status DocumentIndexWrapper::Add(const std::vector<pb::common::DocumentWi
     return status;
   }
 
-  return document_index->Add(document_with_ids, true);
+  return document_index->Add(document_with_ids, true, true);
 }
 
 butil::Status DocumentIndexWrapper::Delete(const std::vector<int64_t>& delete_ids) {
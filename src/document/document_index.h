@@ -56,12 +56,19 @@ class DocumentIndex {
 
   butil::Status GetJsonParameter(std::string& json);
 
-  butil::Status Upsert(const std::vector<pb::common::DocumentWithId>& document_with_ids, bool reload_reader);
+  // is_group_commit: not commit every write, commit when pending document count or interval reach threshold,
+  // and reload reader at its own interval. Used by raft apply, the uncommitted writes is replayed from raft log.
+  butil::Status Upsert(const std::vector<pb::common::DocumentWithId>& document_with_ids, bool reload_reader,
+                       bool is_group_commit = false);
 
-  butil::Status Add(const std::vector<pb::common::DocumentWithId>& document_with_ids, bool reload_reader);
+  butil::Status Add(const std::vector<pb::common::DocumentWithId>& document_with_ids, bool reload_reader,
+                    bool is_group_commit = false);
 
   butil::Status Delete(const std::vector<int64_t>& delete_ids);
 
+  // commit pending writes and reload reader when due, force means do it immediately.
+  butil::Status Flush(bool force);
+
   butil::Status Save(const std::string& path);
 
   butil::Status Load(const std::string& path);
@@ -84,6 +91,11 @@ class DocumentIndex {
   int64_t ApplyLogId() const;
   void SetApplyLogId(int64_t apply_log_id);
 
+  // the max raft log id which writes had written to index writer, maybe not committed.
+  void SetWriteLogId(int64_t log_id);
+  // durability watermark, the writes before it are committed.
+  int64_t CommitLogId() const { return commit_log_id_.load(std::memory_order_acquire); }
+
   pb::common::RegionEpoch Epoch() const;
   pb::common::Range Range(bool is_encode) const;
   std::string RangeString() const;
@@ -106,6 +118,11 @@ class DocumentIndex {
                                                   const pb::common::DocumentIndexParameter& param);
 
  private:
+  // need hold write lock
+  bool IsNeedCommit(bool is_group_commit) const;
+  butil::Status Commit();
+  butil::Status Reload(bool force);
+
   // document index id
   int64_t id_;
 
@@ -114,6 +131,16 @@ class DocumentIndex {
 
   // apply max log id
   std::atomic<int64_t> apply_log_id_;
+  // max log id written to index writer
+  std::atomic<int64_t> write_log_id_{0};
+  // max log id committed
+  std::atomic<int64_t> commit_log_id_{0};
+
+  // group commit state, protected by rw_lock_
+  int64_t pending_count_{0};
+  int64_t last_commit_time_ms_{0};
+  int64_t last_reload_time_ms_{0};
+  bool need_reload_{false};
 
   pb::common::RegionEpoch epoch_;
   pb::common::Range range_;
@@ -179,6 +206,9 @@ class DocumentIndexWrapper : public std::enable_shared_from_this<DocumentIndexWr
   int64_t ApplyLogId() const;
   void SetApplyLogId(int64_t apply_log_id);
 
+  // commit pending group commit writes and reload reader, then save durability watermark.
+  butil::Status Flush(bool force);
+
   bool IsSwitchingDocumentIndex();
   void SetIsSwitchingDocumentIndex(bool is_switching);
 
@@ -223,6 +253,8 @@ class DocumentIndexWrapper : public std::enable_shared_from_this<DocumentIndexWr
                        std::vector<pb::common::DocumentWithScore>& results);
 
  private:
+  void SaveCommitLogId(DocumentIndexPtr document_index, bool force);
+
   // document index id
   int64_t id_;
   // document index version
@@ -549,6 +549,12 @@ butil::Status DocumentIndexManager::ReplayWalToDocumentIndex(DocumentIndexPtr do
     document_index->Delete(ids);
   }
 
+  // commit the tail deletes, apply log id means the data before it is committed.
+  auto status = document_index->Flush(true);
+  if (!status.ok()) {
+    return status;
+  }
+
   if (last_log_id > document_index->ApplyLogId()) {
     document_index->SetApplyLogId(last_log_id);
   }
@@ -882,6 +888,25 @@ butil::Status DocumentIndexManager::CatchUpLogToDocumentIndex(DocumentIndexWrapp
   return butil::Status();
 }
 
+butil::Status DocumentIndexManager::FlushDocumentIndex() {
+  auto regions = Server::GetInstance().GetAllAliveRegion();
+  for (const auto& region : regions) {
+    auto document_index_wrapper = region->DocumentIndexWrapper();
+    if (document_index_wrapper == nullptr || !document_index_wrapper->IsReady() ||
+        document_index_wrapper->IsDestoryed()) {
+      continue;
+    }
+
+    auto status = document_index_wrapper->Flush(false);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[document_index.flush][id({})] flush document index fail, error: {}",
+                                      document_index_wrapper->Id(), Helper::PrintStatus(status));
+    }
+  }
+
+  return butil::Status::OK();
+}
+
 bool DocumentIndexManager::ExecuteTask(int64_t region_id, TaskRunnablePtr task) {
   if (workers_ == nullptr) {
     return false;
@@ -109,6 +109,9 @@ class DocumentIndexManager {
   static void LaunchRebuildDocumentIndex(DocumentIndexWrapperPtr document_index_wrapper, int64_t job_id, bool is_clear,
                                          const std::string& trace);
 
+  // Commit group commit pending writes and refresh reader of all document index, invoke by crontab.
+  static butil::Status FlushDocumentIndex();
+
   static bvar::Adder<uint64_t> bvar_document_index_task_running_num;
   static bvar::Adder<uint64_t> bvar_document_index_rebuild_task_running_num;
   static bvar::Adder<uint64_t> bvar_document_index_loadorbuild_task_running_num;
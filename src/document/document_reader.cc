@@ -47,6 +47,14 @@ butil::Status DocumentReader::QueryDocumentWithId(int64_t ts, const pb::common::
     return status;
   }
 
+  return ParseDocumentWithId(document_id, value, with_scalar_data, with_table_data, selected_scalar_keys,
+                             document_with_id);
+}
+
+butil::Status DocumentReader::ParseDocumentWithId(int64_t document_id, const std::string& value, bool with_scalar_data,
+                                                  bool with_table_data,
+                                                  const std::vector<std::string>& selected_scalar_keys,
+                                                  pb::common::DocumentWithId& document_with_id) {
   pb::common::Document document;
   if (!document.ParseFromString(value)) {
     return butil::Status(pb::error::EINTERNAL, "Parse proto from string error");
@@ -58,7 +66,7 @@ butil::Status DocumentReader::QueryDocumentWithId(int64_t ts, const pb::common::
       document_with_id.mutable_document()->Swap(&document);
       return butil::Status();
     } else {
-      for (auto& key : selected_scalar_keys) {
+      for (const auto& key : selected_scalar_keys) {
         auto scalar = document.document_data().find(key);
         if (scalar == document.document_data().end()) {
           continue;
@@ -155,17 +163,37 @@ butil::Status DocumentReader::DocumentSearchAll(std::shared_ptr<Engine::Document
 
 butil::Status DocumentReader::DocumentBatchQuery(std::shared_ptr<Engine::DocumentReader::Context> ctx,
                                                  std::vector<pb::common::DocumentWithId>& document_with_ids) {
+  std::vector<std::string> plain_keys;
+  plain_keys.reserve(ctx->document_ids.size());
   for (auto document_id : ctx->document_ids) {
+    plain_keys.push_back(
+        DocumentCodec::PackageDocumentKey(Helper::GetKeyPrefix(ctx->region_range), ctx->partition_id, document_id));
+  }
+
+  std::vector<std::string> values;
+  std::vector<bool> key_states;
+  auto status = reader_->KvBatchGet(Constant::kStoreDataCF, ctx->ts, plain_keys, values, key_states);
+  if (!status.ok()) {
+    DINGO_LOG(WARNING) << fmt::format("Batch query document_with_id failed, count: {} error: {}", plain_keys.size(),
+                                      status.error_str());
+    return status;
+  }
+
+  document_with_ids.reserve(document_with_ids.size() + ctx->document_ids.size());
+  for (size_t i = 0; i < ctx->document_ids.size(); ++i) {
+    int64_t document_id = ctx->document_ids[i];
     pb::common::DocumentWithId document_with_id;
-    auto status = QueryDocumentWithId(ctx->ts, ctx->region_range, ctx->partition_id, document_id, ctx->with_scalar_data,
-                                      ctx->with_table_data, ctx->selected_scalar_keys, document_with_id);
-    if ((!status.ok()) && status.error_code() != pb::error::EKEY_NOT_FOUND) {
-      DINGO_LOG(WARNING) << fmt::format("Query document_with_id failed, document_id: {} error: {}", document_id,
-                                        status.error_str());
+    if (key_states[i]) {
+      auto status = ParseDocumentWithId(document_id, values[i], ctx->with_scalar_data, ctx->with_table_data,
+                                        ctx->selected_scalar_keys, document_with_id);
+      if (!status.ok()) {
+        DINGO_LOG(WARNING) << fmt::format("Query document_with_id failed, document_id: {} error: {}", document_id,
+                                          status.error_str());
+      }
     }
 
     // if the id is not exist, the document_with_id will be empty, sdk client will handle this
-    document_with_ids.push_back(document_with_id);
+    document_with_ids.push_back(std::move(document_with_id));
   }
 
   return butil::Status::OK();
@@ -65,6 +65,9 @@ class DocumentReader {
                                     int64_t document_id, bool with_scalar_data, bool with_table_data,
                                     std::vector<std::string>& selected_scalar_keys,
                                     pb::common::DocumentWithId& document_with_id);
+  static butil::Status ParseDocumentWithId(int64_t document_id, const std::string& value, bool with_scalar_data,
+                                           bool with_table_data, const std::vector<std::string>& selected_scalar_keys,
+                                           pb::common::DocumentWithId& document_with_id);
   butil::Status SearchDocument(int64_t ts, int64_t partition_id, DocumentIndexWrapperPtr document_index,
                                pb::common::Range region_range, const pb::common::DocumentSearchParameter& parameter,
                                std::vector<pb::common::DocumentWithScore>& document_with_score_results);
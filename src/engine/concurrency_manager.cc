@@ -14,46 +14,43 @@
 
 #include "engine/concurrency_manager.h"
 
+#include <functional>
+
 #include "engine/txn_engine_helper.h"
 #include "proto/store.pb.h"
 
 namespace dingodb {
 
+ConcurrencyManager::Shard& ConcurrencyManager::GetShard(const std::string& key) {
+  return shards_[std::hash<std::string>{}(key) % kShardNum];
+}
+
 // lock_entry.rw_lock has already write locked
 void ConcurrencyManager::LockKey(const std::string& key, LockEntryPtr lock_entry) {
-  RWLockWriteGuard guard(&rw_lock_);
+  auto& shard = GetShard(key);
+  RWLockWriteGuard guard(&shard.rw_lock);
 
-  lock_table_[key] = lock_entry;
+  shard.lock_table[key] = lock_entry;
 }
 
 void ConcurrencyManager::UnlockKeys(const std::vector<std::string>& keys) {
-  RWLockWriteGuard guard(&rw_lock_);
-
   for (auto const& key : keys) {
-    auto it = lock_table_.find(key);
-    if (it != lock_table_.end()) {
+    auto& shard = GetShard(key);
+    RWLockWriteGuard guard(&shard.rw_lock);
+
+    auto it = shard.lock_table.find(key);
+    if (it != shard.lock_table.end()) {
       it->second->is_deleted.store(true, std::memory_order_release);
-      lock_table_.erase(it);
+      shard.lock_table.erase(it);
     }
   }
 }
 
-bool ConcurrencyManager::CheckKeys(const std::vector<std::string>& keys, pb::store::IsolationLevel isolation_level,
-                                   int64_t start_ts, const std::set<int64_t>& resolved_locks,
-                                   pb::store::TxnResultInfo& txn_result_info) {
-  std::vector<LockEntryPtr> lock_entrys;
-  {
-    RWLockReadGuard guard(&rw_lock_);
-
-    for (auto const& key : keys) {
-      auto it = lock_table_.find(key);
-      if (it != lock_table_.end()) {
-        lock_entrys.push_back(it->second);
-      }
-    }
-  }
-
-  for (auto& lock_entry : lock_entrys) {
+bool ConcurrencyManager::CheckLockEntrys(const std::vector<LockEntryPtr>& lock_entrys,
+                                         pb::store::IsolationLevel isolation_level, int64_t start_ts,
+                                         const std::set<int64_t>& resolved_locks,
+                                         pb::store::TxnResultInfo& txn_result_info) {
+  for (const auto& lock_entry : lock_entrys) {
     if (lock_entry->is_deleted.load(std::memory_order_acquire)) {
       continue;
     }
@@ -68,41 +65,49 @@ bool ConcurrencyManager::CheckKeys(const std::vector<std::string>& keys, pb::sto
   return false;
 }
 
+bool ConcurrencyManager::CheckKeys(const std::vector<std::string>& keys, pb::store::IsolationLevel isolation_level,
+                                   int64_t start_ts, const std::set<int64_t>& resolved_locks,
+                                   pb::store::TxnResultInfo& txn_result_info) {
+  std::vector<LockEntryPtr> lock_entrys;
+  for (auto const& key : keys) {
+    // Always take the shard lock, it orders this check with LockKey of prewrite, prewrite read TxnAccessMaxTs
+    // after LockKey, the reader update TxnAccessMaxTs before check, so one of them must see the other.
+    auto& shard = GetShard(key);
+    RWLockReadGuard guard(&shard.rw_lock);
+    auto it = shard.lock_table.find(key);
+    if (it != shard.lock_table.end()) {
+      lock_entrys.push_back(it->second);
+    }
+  }
+
+  return CheckLockEntrys(lock_entrys, isolation_level, start_ts, resolved_locks, txn_result_info);
+}
+
 bool ConcurrencyManager::CheckRange(const std::string& start_key, const std::string& end_key,
                                     pb::store::IsolationLevel isolation_level, int64_t start_ts,
                                     const std::set<int64_t>& resolved_locks,
                                     pb::store::TxnResultInfo& txn_result_info) {
   std::vector<LockEntryPtr> lock_entrys;
-  {
-    RWLockReadGuard guard(&rw_lock_);
-
-    auto it = lock_table_.lower_bound(start_key);
-    while (it != lock_table_.end() && it->first < end_key) {
+  for (auto& shard : shards_) {
+    RWLockReadGuard guard(&shard.rw_lock);
+    auto it = shard.lock_table.lower_bound(start_key);
+    while (it != shard.lock_table.end() && it->first < end_key) {
       lock_entrys.push_back(it->second);
       ++it;
     }
   }
 
-  for (auto& lock_entry : lock_entrys) {
-    if (lock_entry->is_deleted.load(std::memory_order_acquire)) {
-      continue;
-    }
-    RWLockReadGuard guard(&lock_entry->rw_lock);
-    if (TxnEngineHelper::CheckLockConflict(lock_entry->lock_info, isolation_level, start_ts, resolved_locks,
-                                           txn_result_info)) {
-      return true;
-    }
-  }
-
-  return false;
+  return CheckLockEntrys(lock_entrys, isolation_level, start_ts, resolved_locks, txn_result_info);
 }
 
 void ConcurrencyManager::GetKeys(std::map<std::string, pb::store::LockInfo>& lock_table) {
-  RWLockReadGuard guard(&rw_lock_);
+  for (auto& shard : shards_) {
+    RWLockReadGuard guard(&shard.rw_lock);
 
-  for (auto const& kv : lock_table_) {
-    RWLockReadGuard guard(&kv.second->rw_lock);
-    lock_table[kv.first] = kv.second->lock_info;
+    for (auto const& kv : shard.lock_table) {
+      RWLockReadGuard guard(&kv.second->rw_lock);
+      lock_table[kv.first] = kv.second->lock_info;
+    }
   }
 }
 
@@ -15,8 +15,13 @@
 #ifndef DINGODB_COMMON_CONCURRENCY_MANAGER_H_
 #define DINGODB_COMMON_CONCURRENCY_MANAGER_H_
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -58,12 +63,26 @@ class ConcurrencyManager {
   bool CheckRange(const std::string& start_key, const std::string& end_key, pb::store::IsolationLevel isolation_level,
                   int64_t start_ts, const std::set<int64_t>& resolved_locks, pb::store::TxnResultInfo& txn_result_info);
   
-  void GetKeys(std::map<std::string, pb::store::LockInfo>& lock_table);                
+  void GetKeys(std::map<std::string, pb::store::LockInfo>& lock_table);
 
  private:
-  // key->lock_info  Ordered storage of locked keys (supporting range queries)
-  std::map<std::string, LockEntryPtr> lock_table_;
-  RWLock rw_lock_;
+  // lock table is split into shards by key hash, every shard is ordered for range check.
+  // so concurrent prewrite/check of different keys not serialize on one lock.
+  struct Shard {
+    // key->lock_info  Ordered storage of locked keys (supporting range queries)
+    std::map<std::string, LockEntryPtr> lock_table;
+    RWLock rw_lock;
+  };
+
+  static constexpr size_t kShardNum = 16;
+
+  Shard& GetShard(const std::string& key);
+
+  bool CheckLockEntrys(const std::vector<LockEntryPtr>& lock_entrys, pb::store::IsolationLevel isolation_level,
+                       int64_t start_ts, const std::set<int64_t>& resolved_locks,
+                       pb::store::TxnResultInfo& txn_result_info);
+
+  std::array<Shard, kShardNum> shards_;
 };
 
 }  // namespace dingodb
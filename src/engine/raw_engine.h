@@ -45,6 +45,27 @@ class RawEngine : public std::enable_shared_from_this<RawEngine> {
     virtual butil::Status KvGet(const std::string& cf_name, std::shared_ptr<dingodb::Snapshot> snapshot,
                                 const std::string& key, std::string& value) = 0;
 
+    // point lookup a batch of keys on one snapshot
+    // values and key_states are aligned with keys, key_states[i] is false when keys[i] is not found
+    virtual butil::Status KvBatchGet(const std::string& cf_name, std::shared_ptr<dingodb::Snapshot> snapshot,
+                                     const std::vector<std::string>& keys, std::vector<std::string>& values,
+                                     std::vector<bool>& key_states) {
+      values.clear();
+      values.resize(keys.size());
+      key_states.clear();
+      key_states.resize(keys.size(), false);
+      for (size_t i = 0; i < keys.size(); ++i) {
+        auto status = KvGet(cf_name, snapshot, keys[i], values[i]);
+        if (status.ok()) {
+          key_states[i] = true;
+        } else if (status.error_code() != pb::error::EKEY_NOT_FOUND) {
+          return status;
+        }
+      }
+
+      return butil::Status();
+    }
+
     virtual butil::Status KvScan(const std::string& cf_name, const std::string& start_key, const std::string& end_key,
                                  std::vector<pb::common::KeyValue>& kvs) = 0;
     virtual butil::Status KvScan(const std::string& cf_name, std::shared_ptr<dingodb::Snapshot> snapshot,
@@ -134,6 +155,22 @@ class RawEngine : public std::enable_shared_from_this<RawEngine> {
   virtual std::vector<int64_t> GetApproximateSizes(const std::string& cf_name,
                                                    std::vector<pb::common::Range>& ranges) = 0;
 
+  // sample key of sst, size and count are the kvs between the previous sample key and this key.
+  struct RangeSample {
+    std::string key;
+    int64_t size{0};
+    int64_t count{0};
+    // user keys whose newest version in the sst is not deleted, -1 is unknown
+    int64_t key_count{-1};
+  };
+
+  // get the samples of range from sst properties, order by key, not contain the kvs of memtable.
+  // return error when some sst not have samples, e.g. sst built before support it.
+  virtual butil::Status GetRangeSamples(const std::vector<std::string>& /*cf_names*/,
+                                        const pb::common::Range& /*range*/, std::vector<RangeSample>& /*samples*/) {
+    return butil::Status(pb::error::ENOT_SUPPORT, "Not support range samples.");
+  }
+
   virtual void Flush(const std::string& cf_name) = 0;
   virtual butil::Status Compact(const std::string& cf_name) = 0;
 
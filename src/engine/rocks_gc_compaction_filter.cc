@@ -0,0 +1,291 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "engine/rocks_gc_compaction_filter.h"
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "butil/scoped_lock.h"
+#include "bvar/reducer.h"
+#include "common/constant.h"
+#include "common/helper.h"
+#include "common/logging.h"
+#include "common/serial_helper.h"
+#include "engine/rocks_raw_engine.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "mvcc/codec.h"
+#include "proto/store.pb.h"
+
+namespace dingodb {
+
+// the filter drop data by compaction, opt-in.
+DEFINE_bool(enable_mvcc_gc_compaction_filter, false, "enable gc mvcc old version by rocksdb compaction filter");
+
+namespace rocks {
+
+bvar::Adder<int64_t> g_gc_compaction_filter_reclaimed_keys("dingo_gc_compaction_filter_reclaimed_keys");
+bvar::Adder<int64_t> g_gc_compaction_filter_reclaimed_bytes("dingo_gc_compaction_filter_reclaimed_bytes");
+
+std::atomic<int64_t> MvccGcCompactionFilterFactory::safe_point_ts(0);
+bthread::Mutex MvccGcCompactionFilterFactory::tenant_mutex;
+std::set<int64_t> MvccGcCompactionFilterFactory::covered_tenant_ids;
+std::set<int64_t> MvccGcCompactionFilterFactory::uncovered_tenant_ids;
+
+MvccGcCompactionFilter::MvccGcCompactionFilter(Type type, int64_t safe_point_ts,
+                                               std::weak_ptr<RocksRawEngine> raw_engine)
+    : type_(type), safe_point_ts_(safe_point_ts), raw_engine_(raw_engine) {}
+
+MvccGcCompactionFilter::~MvccGcCompactionFilter() {
+  write_iter_ = nullptr;
+  lock_iter_ = nullptr;
+  snapshot_ = nullptr;
+
+  if (filter_count_ > 0) {
+    g_gc_compaction_filter_reclaimed_keys << filter_count_;
+    g_gc_compaction_filter_reclaimed_bytes << filter_bytes_;
+
+    DINGO_LOG(INFO) << fmt::format("[txn_gc][compaction_filter][type({})] safe_point_ts({}) filter count({}) bytes({})",
+                                   static_cast<int>(type_), safe_point_ts_, filter_count_, filter_bytes_);
+  }
+}
+
+bool MvccGcCompactionFilter::Filter(int /*level*/, const rocksdb::Slice& key, const rocksdb::Slice& existing_value,
+                                    std::string* /*new_value*/, bool* /*value_changed*/) const {
+  // not mvcc encode key with ts, keep it
+  std::string_view key_view(key.data(), key.size());
+  size_t encode_key_length = mvcc::Codec::GetEncodeBytesLength(key_view);
+  if (encode_key_length == 0 || encode_key_length == key_view.size()) {
+    return false;
+  }
+
+  std::string_view encode_key = key_view.substr(0, encode_key_length);
+  int64_t ts = mvcc::Codec::TruncateKeyForTs(key_view);
+
+  bool is_filter = false;
+  switch (type_) {
+    case Type::kNonTxn:
+      is_filter = FilterNonTxn(encode_key, ts);
+      break;
+    case Type::kTxnWrite:
+      is_filter = FilterTxnWrite(encode_key, ts, existing_value);
+      break;
+    case Type::kTxnData:
+      is_filter = FilterTxnData(encode_key, ts);
+      break;
+    default:
+      break;
+  }
+
+  if (is_filter) {
+    ++filter_count_;
+    filter_bytes_ += key.size() + existing_value.size();
+  }
+
+  return is_filter;
+}
+
+bool MvccGcCompactionFilter::FilterNonTxn(std::string_view encode_key, int64_t ts) const {
+  if (encode_key != last_encode_key_) {
+    last_encode_key_ = encode_key;
+    meet_gc_version_ = false;
+  }
+
+  if (ts > safe_point_ts_) {
+    return false;
+  }
+
+  // the newest version ts <= safe_point_ts, keep it
+  if (!meet_gc_version_) {
+    meet_gc_version_ = true;
+    return false;
+  }
+
+  return true;
+}
+
+bool MvccGcCompactionFilter::FilterTxnWrite(std::string_view encode_key, int64_t ts,
+                                            const rocksdb::Slice& value) const {
+  if (encode_key != last_encode_key_) {
+    last_encode_key_ = encode_key;
+    meet_gc_version_ = false;
+  }
+
+  if (ts > safe_point_ts_) {
+    return false;
+  }
+
+  if (meet_gc_version_) {
+    return true;
+  }
+
+  pb::store::WriteInfo write_info;
+  if (!write_info.ParseFromArray(value.data(), value.size())) {
+    DINGO_LOG(ERROR) << fmt::format("[txn_gc][compaction_filter] parse write info failed, key: {}",
+                                    Helper::StringToHex(encode_key));
+    return false;
+  }
+
+  switch (write_info.op()) {
+    case pb::store::Op::Put:
+      [[fallthrough]];
+    case pb::store::Op::Delete:
+      // the newest put/delete commit_ts <= safe_point_ts, keep it
+      meet_gc_version_ = true;
+      return false;
+    case pb::store::Op::Rollback:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool MvccGcCompactionFilter::FilterTxnData(std::string_view encode_key, int64_t ts) const {
+  if (ts >= safe_point_ts_) {
+    return false;
+  }
+
+  if (encode_key != last_encode_key_) {
+    last_encode_key_ = encode_key;
+    keep_start_ts_.clear();
+    is_keep_start_ts_valid_ = GetKeepStartTs(encode_key, keep_start_ts_);
+  }
+
+  // only drop the data which write is gc or not exist(rollback/gc already), and not locked.
+  return is_keep_start_ts_valid_ && keep_start_ts_.count(ts) == 0;
+}
+
+bool MvccGcCompactionFilter::GetKeepStartTs(std::string_view encode_key, std::set<int64_t>& keep_start_ts) const {
+  if (write_iter_ == nullptr || lock_iter_ == nullptr) {
+    auto raw_engine = raw_engine_.lock();
+    if (raw_engine == nullptr) {
+      return false;
+    }
+    auto reader = raw_engine->Reader();
+    if (reader == nullptr) {
+      return false;
+    }
+
+    snapshot_ = raw_engine->GetSnapshot();
+    write_iter_ = reader->NewIterator(Constant::kTxnWriteCF, snapshot_, IteratorOptions());
+    lock_iter_ = reader->NewIterator(Constant::kTxnLockCF, snapshot_, IteratorOptions());
+    if (write_iter_ == nullptr || lock_iter_ == nullptr) {
+      return false;
+    }
+  }
+
+  // the data of lock is not committed
+  std::string lock_key(encode_key);
+  SerialHelper::WriteLongWithNegation(Constant::kLockVer, lock_key);
+  lock_iter_->Seek(lock_key);
+  if (lock_iter_->Valid() && lock_iter_->Key() == lock_key) {
+    auto lock_value = lock_iter_->Value();
+    pb::store::LockInfo lock_info;
+    if (!lock_info.ParseFromArray(lock_value.data(), lock_value.size())) {
+      return false;
+    }
+    keep_start_ts.insert(lock_info.lock_ts());
+  }
+
+  // the write commit_ts > safe_point_ts and the newest put/delete write commit_ts <= safe_point_ts are keep,
+  // so the data they reference.
+  std::string seek_key(encode_key);
+  for (write_iter_->Seek(seek_key); write_iter_->Valid(); write_iter_->Next()) {
+    auto write_key = write_iter_->Key();
+    if (mvcc::Codec::TruncateTsForKey(write_key) != encode_key) {
+      break;
+    }
+
+    auto write_value = write_iter_->Value();
+    pb::store::WriteInfo write_info;
+    if (!write_info.ParseFromArray(write_value.data(), write_value.size())) {
+      return false;
+    }
+
+    if (write_info.op() != pb::store::Op::Put && write_info.op() != pb::store::Op::Delete) {
+      continue;
+    }
+
+    keep_start_ts.insert(write_info.start_ts());
+
+    int64_t commit_ts = mvcc::Codec::TruncateKeyForTs(write_key);
+    if (commit_ts <= safe_point_ts_) {
+      break;
+    }
+  }
+
+  return write_iter_->Status().ok() && lock_iter_->Status().ok();
+}
+
+std::unique_ptr<rocksdb::CompactionFilter> MvccGcCompactionFilterFactory::CreateCompactionFilter(
+    const rocksdb::CompactionFilter::Context& /*context*/) {
+  if (!FLAGS_enable_mvcc_gc_compaction_filter) {
+    return nullptr;
+  }
+
+  int64_t safe_point_ts = GetSafePointTs();
+  if (safe_point_ts <= 0) {
+    return nullptr;
+  }
+
+  return std::make_unique<MvccGcCompactionFilter>(type_, safe_point_ts, raw_engine_);
+}
+
+void MvccGcCompactionFilterFactory::SetSafePointTs(int64_t ts, const std::set<int64_t>& tenant_ids) {
+  BAIDU_SCOPED_LOCK(tenant_mutex);
+
+  // the tenant arrive when compute the safe point ts may be not included
+  for (auto it = uncovered_tenant_ids.begin(); it != uncovered_tenant_ids.end();) {
+    if (tenant_ids.count(*it) > 0) {
+      it = uncovered_tenant_ids.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (!uncovered_tenant_ids.empty()) {
+    ts = 0;
+  }
+  covered_tenant_ids = tenant_ids;
+
+  int64_t old_ts = safe_point_ts.exchange(ts, std::memory_order_relaxed);
+  if (old_ts != ts) {
+    DINGO_LOG(INFO) << fmt::format("[txn_gc][compaction_filter] update safe_point_ts {} -> {}", old_ts, ts);
+  }
+}
+
+void MvccGcCompactionFilterFactory::CheckTenant(int64_t tenant_id) {
+  BAIDU_SCOPED_LOCK(tenant_mutex);
+
+  if (covered_tenant_ids.count(tenant_id) > 0) {
+    return;
+  }
+
+  uncovered_tenant_ids.insert(tenant_id);
+  int64_t old_ts = safe_point_ts.exchange(0, std::memory_order_relaxed);
+  if (old_ts != 0) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[txn_gc][compaction_filter] tenant({}) not covered by safe_point_ts {}, disable until next update", tenant_id,
+        old_ts);
+  }
+}
+
+int64_t MvccGcCompactionFilterFactory::GetSafePointTs() { return safe_point_ts.load(std::memory_order_relaxed); }
+
+}  // namespace rocks
+
+}  // namespace dingodb
@@ -0,0 +1,128 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_ENGINE_ROCKS_GC_COMPACTION_FILTER_H_  // NOLINT
+#define DINGODB_ENGINE_ROCKS_GC_COMPACTION_FILTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "bthread/mutex.h"
+#include "engine/iterator.h"
+#include "engine/snapshot.h"
+#include "rocksdb/compaction_filter.h"
+#include "rocksdb/slice.h"
+
+namespace dingodb {
+
+class RocksRawEngine;
+
+namespace rocks {
+
+// Gc mvcc old versions when rocksdb compaction, replace the delete of raft gc.
+// Only drop the versions which are invisible to any read at or above the safe point,
+// so every replica keep the same visible data as long as they use the same safe point.
+// Version of a key:
+//   ts > safe_point_ts: keep
+//   the newest version ts <= safe_point_ts: keep, even it is a delete/expired version
+//   older versions: drop
+class MvccGcCompactionFilter : public rocksdb::CompactionFilter {
+ public:
+  enum class Type {
+    // mvcc value with flag, e.g. default/vector_scalar/vector_table cf
+    kNonTxn = 0,
+    // txn write cf, value is pb::store::WriteInfo
+    kTxnWrite = 1,
+    // txn data cf, the key ts is start_ts, depend on write cf
+    kTxnData = 2,
+  };
+
+  MvccGcCompactionFilter(Type type, int64_t safe_point_ts, std::weak_ptr<RocksRawEngine> raw_engine);
+  ~MvccGcCompactionFilter() override;
+
+  const char* Name() const override { return "dingo.MvccGcCompactionFilter"; }
+
+  bool Filter(int level, const rocksdb::Slice& key, const rocksdb::Slice& existing_value, std::string* new_value,
+              bool* value_changed) const override;
+
+ private:
+  bool FilterNonTxn(std::string_view encode_key, int64_t ts) const;
+  bool FilterTxnWrite(std::string_view encode_key, int64_t ts, const rocksdb::Slice& value) const;
+  bool FilterTxnData(std::string_view encode_key, int64_t ts) const;
+
+  // get the start_ts of data which must keep, they are referenced by the write not gc or the lock.
+  // commit order not follow start order, e.g. pessimistic txn, so decide by start_ts one by one.
+  // return false when read write/lock cf failed, then keep all data of the key.
+  bool GetKeepStartTs(std::string_view encode_key, std::set<int64_t>& keep_start_ts) const;
+
+  Type type_;
+  int64_t safe_point_ts_;
+  std::weak_ptr<RocksRawEngine> raw_engine_;
+
+  // filter is called in key order in one compaction
+  mutable std::string last_encode_key_;
+  // already meet the newest version ts <= safe_point_ts of last_encode_key_
+  mutable bool meet_gc_version_{false};
+  // used by txn data cf, write/lock iterator share one snapshot, so a txn is either locked or committed.
+  mutable bool is_keep_start_ts_valid_{false};
+  mutable std::set<int64_t> keep_start_ts_;
+  mutable dingodb::SnapshotPtr snapshot_;
+  mutable dingodb::IteratorPtr write_iter_;
+  mutable dingodb::IteratorPtr lock_iter_;
+
+  // statistics
+  mutable int64_t filter_count_{0};
+  mutable int64_t filter_bytes_{0};
+};
+
+class MvccGcCompactionFilterFactory : public rocksdb::CompactionFilterFactory {
+ public:
+  MvccGcCompactionFilterFactory(MvccGcCompactionFilter::Type type, std::weak_ptr<RocksRawEngine> raw_engine)
+      : type_(type), raw_engine_(raw_engine) {}
+  ~MvccGcCompactionFilterFactory() override = default;
+
+  const char* Name() const override { return "dingo.MvccGcCompactionFilterFactory"; }
+
+  std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
+      const rocksdb::CompactionFilter::Context& context) override;
+
+  // safe point ts used by compaction filter, it is the min safe point ts of the tenant_ids on this node.
+  // 0 means gc by compaction filter is disable.
+  static void SetSafePointTs(int64_t safe_point_ts, const std::set<int64_t>& tenant_ids);
+  static int64_t GetSafePointTs();
+
+  // region of a tenant not covered by the safe point ts arrive, e.g. by split or snapshot,
+  // disable gc by compaction filter until the safe point ts include the tenant.
+  static void CheckTenant(int64_t tenant_id);
+
+ private:
+  MvccGcCompactionFilter::Type type_;
+  std::weak_ptr<RocksRawEngine> raw_engine_;
+
+  static std::atomic<int64_t> safe_point_ts;
+  // protect covered_tenant_ids/uncovered_tenant_ids
+  static bthread::Mutex tenant_mutex;
+  static std::set<int64_t> covered_tenant_ids;
+  static std::set<int64_t> uncovered_tenant_ids;
+};
+
+}  // namespace rocks
+
+}  // namespace dingodb
+
+#endif  // DINGODB_ENGINE_ROCKS_GC_COMPACTION_FILTER_H_  // NOLINT
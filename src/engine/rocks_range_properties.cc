@@ -0,0 +1,216 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "engine/rocks_range_properties.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "mvcc/codec.h"
+#include "proto/store.pb.h"
+
+namespace dingodb {
+
+DEFINE_int64(rocksdb_range_properties_sample_size, 1 * 1024 * 1024, "sst range properties sample interval bytes");
+DEFINE_int64(rocksdb_range_properties_sample_keys, 16384, "sst range properties sample interval keys");
+
+namespace rocks {
+
+// version 2 add key count of sample
+static const uint8_t kRangePropertiesVersionV1 = 1;
+static const uint8_t kRangePropertiesVersion = 2;
+
+static void AppendFixed(std::string& dst, uint64_t value) {
+  char buf[sizeof(value)];
+  memcpy(buf, &value, sizeof(value));
+  dst.append(buf, sizeof(value));
+}
+
+static bool ReadFixed(const std::string& src, size_t& pos, uint64_t& value) {
+  if (pos + sizeof(value) > src.size()) {
+    return false;
+  }
+  memcpy(&value, src.data() + pos, sizeof(value));
+  pos += sizeof(value);
+  return true;
+}
+
+RangePropertiesCollector::RangePropertiesCollector(int64_t sample_size, int64_t sample_keys, KeyType key_type)
+    : sample_size_(sample_size), sample_keys_(sample_keys), key_type_(key_type) {}
+
+void RangePropertiesCollector::AddSample() {
+  RawEngine::RangeSample sample;
+  sample.key = last_key_;
+  sample.size = size_since_last_sample_;
+  sample.count = count_since_last_sample_;
+  sample.key_count = key_count_since_last_sample_;
+  samples_.push_back(std::move(sample));
+
+  size_since_last_sample_ = 0;
+  count_since_last_sample_ = 0;
+  key_count_since_last_sample_ = 0;
+}
+
+void RangePropertiesCollector::CountUserKey(const rocksdb::Slice& key, const rocksdb::Slice& value) {
+  if (key_type_ == KeyType::kRaw || key.size() <= 8) {
+    ++key_count_since_last_sample_;
+    return;
+  }
+
+  auto user_key = mvcc::Codec::TruncateTsForKey(std::string_view(key.data(), key.size()));
+  if (user_key != last_user_key_) {
+    last_user_key_.assign(user_key.data(), user_key.size());
+    is_user_key_decided_ = false;
+  }
+  if (is_user_key_decided_) {
+    return;
+  }
+
+  // not use mvcc::Codec::GetValueFlag, it check fail on the value not written by mvcc.
+  if (key_type_ == KeyType::kMvcc) {
+    is_user_key_decided_ = true;
+    auto flag = value.empty() ? mvcc::ValueFlag::kPut : static_cast<mvcc::ValueFlag>(value[value.size() - 1]);
+    if (flag != mvcc::ValueFlag::kDelete) {
+      ++key_count_since_last_sample_;
+    }
+    return;
+  }
+
+  // rollback and lock record not change the key, decide by the older version
+  pb::store::WriteInfo write_info;
+  if (!write_info.ParseFromArray(value.data(), value.size())) {
+    return;
+  }
+  if (write_info.op() == pb::store::Op::Put) {
+    is_user_key_decided_ = true;
+    ++key_count_since_last_sample_;
+  } else if (write_info.op() == pb::store::Op::Delete) {
+    is_user_key_decided_ = true;
+  }
+}
+
+rocksdb::Status RangePropertiesCollector::AddUserKey(const rocksdb::Slice& key, const rocksdb::Slice& value,
+                                                     rocksdb::EntryType type, rocksdb::SequenceNumber /*seq*/,
+                                                     uint64_t /*file_size*/) {
+  last_key_.assign(key.data(), key.size());
+  size_since_last_sample_ += key.size() + value.size();
+  ++count_since_last_sample_;
+  // the tombstone of gc old version not decide the user key
+  if (type == rocksdb::kEntryPut) {
+    CountUserKey(key, value);
+  }
+
+  if (size_since_last_sample_ >= sample_size_ || count_since_last_sample_ >= sample_keys_) {
+    AddSample();
+  }
+
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status RangePropertiesCollector::Finish(rocksdb::UserCollectedProperties* properties) {
+  // the last key of sst is always a sample
+  if (count_since_last_sample_ > 0) {
+    AddSample();
+  }
+
+  properties->emplace(kPropertyName(), Encode(samples_));
+  return rocksdb::Status::OK();
+}
+
+rocksdb::UserCollectedProperties RangePropertiesCollector::GetReadableProperties() const {
+  int64_t size = 0;
+  int64_t count = 0;
+  int64_t key_count = 0;
+  for (const auto& sample : samples_) {
+    size += sample.size;
+    count += sample.count;
+    key_count += sample.key_count;
+  }
+
+  return {{"dingo.range_properties.samples", std::to_string(samples_.size())},
+          {"dingo.range_properties.size", std::to_string(size)},
+          {"dingo.range_properties.count", std::to_string(count)},
+          {"dingo.range_properties.key_count", std::to_string(key_count)}};
+}
+
+// format: version(1 byte) + [key_size(8 bytes) + key + size(8 bytes) + count(8 bytes) + key_count(8 bytes)]...
+// version 1 not has key_count.
+std::string RangePropertiesCollector::Encode(const std::vector<RawEngine::RangeSample>& samples) {
+  std::string value;
+  value.push_back(static_cast<char>(kRangePropertiesVersion));
+  for (const auto& sample : samples) {
+    AppendFixed(value, sample.key.size());
+    value.append(sample.key);
+    AppendFixed(value, sample.size);
+    AppendFixed(value, sample.count);
+    AppendFixed(value, sample.key_count);
+  }
+
+  return value;
+}
+
+bool RangePropertiesCollector::Decode(const std::string& value, std::vector<RawEngine::RangeSample>& samples) {
+  if (value.empty()) {
+    return false;
+  }
+  uint8_t version = static_cast<uint8_t>(value[0]);
+  if (version != kRangePropertiesVersionV1 && version != kRangePropertiesVersion) {
+    return false;
+  }
+
+  size_t pos = 1;
+  while (pos < value.size()) {
+    uint64_t key_size = 0;
+    if (!ReadFixed(value, pos, key_size) || pos + key_size > value.size()) {
+      return false;
+    }
+
+    RawEngine::RangeSample sample;
+    sample.key = value.substr(pos, key_size);
+    pos += key_size;
+
+    uint64_t size = 0;
+    uint64_t count = 0;
+    if (!ReadFixed(value, pos, size) || !ReadFixed(value, pos, count)) {
+      return false;
+    }
+    sample.size = static_cast<int64_t>(size);
+    sample.count = static_cast<int64_t>(count);
+
+    if (version != kRangePropertiesVersionV1) {
+      uint64_t key_count = 0;
+      if (!ReadFixed(value, pos, key_count)) {
+        return false;
+      }
+      sample.key_count = static_cast<int64_t>(key_count);
+    }
+    samples.push_back(std::move(sample));
+  }
+
+  return true;
+}
+
+rocksdb::TablePropertiesCollector* RangePropertiesCollectorFactory::CreateTablePropertiesCollector(
+    rocksdb::TablePropertiesCollectorFactory::Context /*context*/) {
+  return new RangePropertiesCollector(FLAGS_rocksdb_range_properties_sample_size,
+                                      FLAGS_rocksdb_range_properties_sample_keys, key_type_);
+}
+
+}  // namespace rocks
+
+}  // namespace dingodb
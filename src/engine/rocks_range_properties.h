@@ -0,0 +1,100 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_ENGINE_ROCKS_RANGE_PROPERTIES_H_  // NOLINT
+#define DINGODB_ENGINE_ROCKS_RANGE_PROPERTIES_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/raw_engine.h"
+#include "rocksdb/table_properties.h"
+
+namespace dingodb {
+
+namespace rocks {
+
+// Sample the keys of sst when build it, every sample_size bytes or sample_keys keys record one sample key with
+// the size and count of kvs since the previous sample key, save into the user collected properties of sst.
+// Split check use the samples of all sst in the region range to find the split key, instead of scan the region.
+// Every sample also count the user keys whose newest version in the sst is not deleted, region metrics use it to
+// correct the drift of key count, instead of count the region.
+class RangePropertiesCollector : public rocksdb::TablePropertiesCollector {
+ public:
+  // how to count the user keys of cf
+  enum class KeyType {
+    // not mvcc key, every key is a user key
+    kRaw = 0,
+    // mvcc key and value with flag, e.g. default cf of store
+    kMvcc = 1,
+    // txn write cf, value is pb::store::WriteInfo
+    kTxnWrite = 2,
+  };
+
+  RangePropertiesCollector(int64_t sample_size, int64_t sample_keys, KeyType key_type);
+  ~RangePropertiesCollector() override = default;
+
+  static const char* kPropertyName() { return "dingo.range_properties"; }
+
+  const char* Name() const override { return "dingo.RangePropertiesCollector"; }
+
+  rocksdb::Status AddUserKey(const rocksdb::Slice& key, const rocksdb::Slice& value, rocksdb::EntryType type,
+                             rocksdb::SequenceNumber seq, uint64_t file_size) override;
+
+  rocksdb::Status Finish(rocksdb::UserCollectedProperties* properties) override;
+
+  rocksdb::UserCollectedProperties GetReadableProperties() const override;
+
+  static std::string Encode(const std::vector<RawEngine::RangeSample>& samples);
+  static bool Decode(const std::string& value, std::vector<RawEngine::RangeSample>& samples);
+
+ private:
+  void AddSample();
+  void CountUserKey(const rocksdb::Slice& key, const rocksdb::Slice& value);
+
+  int64_t sample_size_;
+  int64_t sample_keys_;
+  KeyType key_type_;
+
+  std::string last_key_;
+  int64_t size_since_last_sample_{0};
+  int64_t count_since_last_sample_{0};
+  int64_t key_count_since_last_sample_{0};
+
+  // versions of user key are adjacent from new to old, the newest put/delete version decide the key is alive.
+  std::string last_user_key_;
+  bool is_user_key_decided_{false};
+  std::vector<RawEngine::RangeSample> samples_;
+};
+
+class RangePropertiesCollectorFactory : public rocksdb::TablePropertiesCollectorFactory {
+ public:
+  explicit RangePropertiesCollectorFactory(RangePropertiesCollector::KeyType key_type) : key_type_(key_type) {}
+  ~RangePropertiesCollectorFactory() override = default;
+
+  const char* Name() const override { return "dingo.RangePropertiesCollectorFactory"; }
+
+  rocksdb::TablePropertiesCollector* CreateTablePropertiesCollector(
+      rocksdb::TablePropertiesCollectorFactory::Context context) override;
+
+ private:
+  RangePropertiesCollector::KeyType key_type_;
+};
+
+}  // namespace rocks
+
+}  // namespace dingodb
+
+#endif  // DINGODB_ENGINE_ROCKS_RANGE_PROPERTIES_H_  // NOLINT
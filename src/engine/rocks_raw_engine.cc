@@ -16,6 +16,7 @@
 
 #include <elf.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -34,11 +35,16 @@
 #include "common/constant.h"
 #include "common/helper.h"
 #include "common/logging.h"
+#include "common/role.h"
 #include "config/config_helper.h"
 #include "engine/raw_engine.h"
+#include "engine/rocks_gc_compaction_filter.h"
+#include "engine/rocks_range_properties.h"
 #include "engine/snapshot.h"
 #include "fmt/core.h"
 #include "gflags/gflags.h"
+#include "metrics/store_bvar_metrics.h"
+#include "mvcc/codec.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "rocksdb/advanced_options.h"
@@ -53,6 +59,15 @@
 namespace dingodb {
 DEFINE_bool(enable_rocksdb_sync, false, "enable rocksdb sync");
 
+DEFINE_bool(rocksdb_enable_shared_block_cache, true,
+            "column families share one block cache of store.block_cache_size, otherwise one block cache per cf");
+DEFINE_string(rocksdb_block_cache_type, "lru", "shared block cache type, lru or hyper_clock");
+DEFINE_double(rocksdb_block_cache_high_pri_pool_ratio, 0.1,
+              "high priority pool ratio of lru shared block cache, for index and filter blocks");
+
+// shared block cache min capacity when the column families reserved too much
+static const int64_t kMinSharedBlockCacheSize = 64 * 1024 * 1024;  // 64MB
+
 namespace rocks {
 
 ColumnFamily::ColumnFamily(const std::string& cf_name, const ColumnFamilyConfig& config,
@@ -89,6 +104,35 @@ void ColumnFamily::Dump() {
   DINGO_LOG(INFO) << fmt::format("[rocksdb.dump][column_family({})] end.....................", Name());
 }
 
+rocksdb::Slice MvccUserKeyTransform::Transform(const rocksdb::Slice& key) const {
+  size_t length = mvcc::Codec::GetEncodeBytesLength(std::string_view(key.data(), key.size()));
+  DCHECK(length > 0) << fmt::format("[rocksdb] key({}) not in domain.", Helper::StringToHex(key.ToStringView()));
+
+  return rocksdb::Slice(key.data(), length);
+}
+
+bool MvccUserKeyTransform::InDomain(const rocksdb::Slice& key) const {
+  return mvcc::Codec::GetEncodeBytesLength(std::string_view(key.data(), key.size())) > 0;
+}
+
+BlockCacheStatsWrapper::BlockCacheStatsWrapper(std::shared_ptr<rocksdb::Cache> target, const std::string& cf_name)
+    : rocksdb::CacheWrapper(std::move(target)),
+      hit_count_(StoreBvarMetrics::GetInstance().GetBlockCacheHitCounter(cf_name)),
+      miss_count_(StoreBvarMetrics::GetInstance().GetBlockCacheMissCounter(cf_name)) {}
+
+rocksdb::Cache::Handle* BlockCacheStatsWrapper::Lookup(const rocksdb::Slice& key, const CacheItemHelper* helper,
+                                                       CreateContext* create_context, Priority priority,
+                                                       rocksdb::Statistics* stats) {
+  auto* handle = target_->Lookup(key, helper, create_context, priority, stats);
+  if (handle != nullptr) {
+    if (hit_count_ != nullptr) *hit_count_ << 1;
+  } else {
+    if (miss_count_ != nullptr) *miss_count_ << 1;
+  }
+
+  return handle;
+}
+
 bool Iterator::Valid() const {
   if (!iter_->Valid()) {
     return false;
@@ -361,6 +405,51 @@ butil::Status Reader::KvGet(ColumnFamilyPtr column_family, dingodb::SnapshotPtr
   return butil::Status();
 }
 
+butil::Status Reader::KvBatchGet(const std::string& cf_name, dingodb::SnapshotPtr snapshot,
+                                 const std::vector<std::string>& keys, std::vector<std::string>& values,
+                                 std::vector<bool>& key_states) {
+  values.clear();
+  values.resize(keys.size());
+  key_states.clear();
+  key_states.resize(keys.size(), false);
+  if (keys.empty()) {
+    return butil::Status();
+  }
+
+  for (const auto& key : keys) {
+    if (BAIDU_UNLIKELY(key.empty())) {
+      DINGO_LOG(ERROR) << fmt::format("[rocksdb] not support empty key.");
+      return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
+    }
+  }
+
+  std::vector<rocksdb::Slice> key_slices;
+  key_slices.reserve(keys.size());
+  for (const auto& key : keys) {
+    key_slices.emplace_back(key);
+  }
+  std::vector<rocksdb::PinnableSlice> value_slices(keys.size());
+  std::vector<rocksdb::Status> statuses(keys.size());
+
+  rocksdb::ReadOptions read_option;
+  read_option.snapshot = static_cast<const rocksdb::Snapshot*>(snapshot->Inner());
+  GetDB()->MultiGet(read_option, GetColumnFamily(cf_name)->GetHandle(), keys.size(), key_slices.data(),
+                    value_slices.data(), statuses.data());
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const auto& s = statuses[i];
+    if (s.ok()) {
+      values[i].assign(value_slices[i].data(), value_slices[i].size());
+      key_states[i] = true;
+    } else if (!s.IsNotFound()) {
+      DINGO_LOG(ERROR) << fmt::format("[rocksdb] multi get key failed, error: {}", s.ToString());
+      return butil::Status(pb::error::EINTERNAL, "Internal multi get error");
+    }
+  }
+
+  return butil::Status();
+}
+
 butil::Status Reader::KvScan(ColumnFamilyPtr column_family, std::shared_ptr<dingodb::Snapshot> snapshot,
                              const std::string& start_key, const std::string& end_key,
                              std::vector<pb::common::KeyValue>& kvs) {
@@ -739,6 +828,8 @@ static rocks::ColumnFamilyMap GenColumnFamilyByDefaultConfig(const std::vector<s
   rocks::ColumnFamily::ColumnFamilyConfig default_config;
   default_config.emplace(Constant::kBlockSize, Constant::kBlockSizeDefaultValue);
   default_config.emplace(Constant::kBlockCache, ConfigHelper::GetBlockCacheValue());
+  default_config.emplace(Constant::kBlockCacheReserved, Constant::kBlockCacheReservedDefaultValue);
+  default_config.emplace(Constant::kBlockCacheHighPriority, Constant::kBlockCacheHighPriorityDefaultValue);
   default_config.emplace(Constant::kArenaBlockSize, Constant::kArenaBlockSizeDefaultValue);
   default_config.emplace(Constant::kMinWriteBufferNumberToMerge, Constant::kMinWriteBufferNumberToMergeDefaultValue);
   default_config.emplace(Constant::kMaxWriteBufferNumber, Constant::kMaxWriteBufferNumberDefaultValue);
@@ -749,9 +840,16 @@ static rocks::ColumnFamilyMap GenColumnFamilyByDefaultConfig(const std::vector<s
   default_config.emplace(Constant::kTargetFileSizeBase, Constant::kTargetFileSizeBaseDefaultValue);
   default_config.emplace(Constant::kMaxBytesForLevelMultiplier, Constant::kMaxBytesForLevelMultiplierDefaultValue);
 
+  default_config.emplace(Constant::kMvccPrefixBloomFilter, Constant::kMvccPrefixBloomFilterDefaultValue);
+
   rocks::ColumnFamilyMap column_families;
   for (const auto& cf_name : column_family_names) {
-    column_families.emplace(cf_name, rocks::ColumnFamily::New(cf_name, default_config));
+    auto column_family = rocks::ColumnFamily::New(cf_name, default_config);
+    // small and hot column family, keep index and filter blocks in block cache
+    if (cf_name == Constant::kTxnLockCF || cf_name == Constant::kTxnWriteCF || cf_name == Constant::kStoreMetaCF) {
+      column_family->SetConfItem(Constant::kBlockCacheHighPriority, "true");
+    }
+    column_families.emplace(cf_name, column_family);
   }
 
   return column_families;
@@ -832,20 +930,75 @@ bool CastValue(std::string value, std::string& dst_value) {
   return true;
 }
 
+// column family which old mvcc versions can be gc by compaction filter
+static bool GetMvccGcCompactionFilterType(const std::string& cf_name, rocks::MvccGcCompactionFilter::Type& type) {
+  if (GetRole() == pb::common::ClusterRole::COORDINATOR) {
+    return false;
+  }
+
+  if (cf_name == Constant::kTxnWriteCF) {
+    type = rocks::MvccGcCompactionFilter::Type::kTxnWrite;
+    return true;
+  } else if (cf_name == Constant::kTxnDataCF) {
+    type = rocks::MvccGcCompactionFilter::Type::kTxnData;
+    return true;
+  } else if (cf_name == Constant::kStoreDataCF || cf_name == Constant::kVectorScalarCF ||
+             cf_name == Constant::kVectorScalarKeySpeedUpCF || cf_name == Constant::kVectorTableCF) {
+    type = rocks::MvccGcCompactionFilter::Type::kNonTxn;
+    return true;
+  }
+
+  return false;
+}
+
+// The key layout of cf decide how range properties count the user key.
+static rocks::RangePropertiesCollector::KeyType GetRangePropertiesKeyType(const std::string& cf_name) {
+  if (GetRole() == pb::common::ClusterRole::COORDINATOR) {
+    return rocks::RangePropertiesCollector::KeyType::kRaw;
+  }
+
+  if (cf_name == Constant::kTxnWriteCF) {
+    return rocks::RangePropertiesCollector::KeyType::kTxnWrite;
+  } else if (cf_name == Constant::kStoreDataCF || cf_name == Constant::kVectorScalarCF ||
+             cf_name == Constant::kVectorScalarKeySpeedUpCF || cf_name == Constant::kVectorTableCF) {
+    return rocks::RangePropertiesCollector::KeyType::kMvcc;
+  }
+
+  return rocks::RangePropertiesCollector::KeyType::kRaw;
+}
+
 // set cf config
-static rocksdb::ColumnFamilyOptions GenRocksDBColumnFamilyOptions(rocks::ColumnFamilyPtr column_family) {
+static rocksdb::ColumnFamilyOptions GenRocksDBColumnFamilyOptions(rocks::ColumnFamilyPtr column_family,
+                                                                  std::weak_ptr<RocksRawEngine> raw_engine,
+                                                                  std::shared_ptr<rocksdb::Cache> shared_block_cache) {
   rocksdb::ColumnFamilyOptions family_options;
   rocksdb::BlockBasedTableOptions table_options;
 
   // block_size
   CastValue(column_family->GetConfItem(Constant::kBlockSize), table_options.block_size);
 
-  // block_cache
+  // block_cache, column family with reserved use a dedicated cache, others use the shared cache
   {
-    size_t option_value = 0;
-    CastValue(column_family->GetConfItem(Constant::kBlockCache), option_value);
+    size_t reserved = 0;
+    CastValue(column_family->GetConfItem(Constant::kBlockCacheReserved), reserved);
+
+    std::shared_ptr<rocksdb::Cache> block_cache = shared_block_cache;
+    if (block_cache == nullptr || reserved > 0) {
+      size_t option_value = reserved;
+      if (option_value == 0) {
+        CastValue(column_family->GetConfItem(Constant::kBlockCache), option_value);
+      }
+      block_cache = rocksdb::NewLRUCache(option_value);  // LRUcache
+    }
 
-    table_options.block_cache = rocksdb::NewLRUCache(option_value);  // LRUcache
+    table_options.block_cache = std::make_shared<rocks::BlockCacheStatsWrapper>(block_cache, column_family->Name());
+  }
+
+  // index and filter blocks in the high priority pool, not evicted by data blocks of other column families
+  if (column_family->GetConfItem(Constant::kBlockCacheHighPriority) == "true") {
+    table_options.cache_index_and_filter_blocks = true;
+    table_options.cache_index_and_filter_blocks_with_high_priority = true;
+    table_options.pin_l0_filter_and_index_blocks_in_cache = true;
   }
 
   // arena_block_size
@@ -869,13 +1022,27 @@ static rocksdb::ColumnFamilyOptions GenRocksDBColumnFamilyOptions(rocks::ColumnF
             family_options.max_bytes_for_level_multiplier);
 
   // prefix_extractor
-  {
+  if (column_family->GetConfItem(Constant::kMvccPrefixBloomFilter) == "true") {
+    // prefix bloom filter on user key, negative point lookup of mvcc key can skip sst
+    family_options.prefix_extractor = std::make_shared<rocks::MvccUserKeyTransform>();
+  } else {
     size_t value = 0;
     CastValue(column_family->GetConfItem(Constant::kPrefixExtractor), value);
 
     family_options.prefix_extractor.reset(rocksdb::NewCappedPrefixTransform(value));
   }
 
+  // compaction_filter_factory, gc mvcc old versions by compaction
+  rocks::MvccGcCompactionFilter::Type gc_filter_type;
+  if (GetMvccGcCompactionFilterType(column_family->Name(), gc_filter_type)) {
+    family_options.compaction_filter_factory =
+        std::make_shared<rocks::MvccGcCompactionFilterFactory>(gc_filter_type, raw_engine);
+  }
+
+  // sample keys of sst for split check
+  family_options.table_properties_collector_factories.push_back(
+      std::make_shared<rocks::RangePropertiesCollectorFactory>(GetRangePropertiesKeyType(column_family->Name())));
+
   // max_bytes_for_level_base
   CastValue(column_family->GetConfItem(Constant::kMaxBytesForLevelBase), family_options.max_bytes_for_level_base);
 
@@ -898,12 +1065,52 @@ static rocksdb::ColumnFamilyOptions GenRocksDBColumnFamilyOptions(rocks::ColumnF
   return family_options;
 }
 
+void RocksRawEngine::InitBlockCache(rocks::ColumnFamilyMap& column_families) {
+  if (!FLAGS_rocksdb_enable_shared_block_cache) {
+    return;
+  }
+
+  int64_t capacity = Helper::StringToInt64(ConfigHelper::GetBlockCacheValue());
+  for (auto& [cf_name, column_family] : column_families) {
+    size_t reserved = 0;
+    CastValue(column_family->GetConfItem(Constant::kBlockCacheReserved), reserved);
+    capacity -= static_cast<int64_t>(reserved);
+  }
+  if (capacity < kMinSharedBlockCacheSize) {
+    DINGO_LOG(WARNING) << fmt::format("[rocksdb] column families reserved too much block cache, shared capacity({})",
+                                      capacity);
+    capacity = kMinSharedBlockCacheSize;
+  }
+
+  if (FLAGS_rocksdb_block_cache_type == "hyper_clock") {
+    size_t estimated_entry_charge = 0;
+    CastValue(Constant::kBlockSizeDefaultValue, estimated_entry_charge);
+    rocksdb::HyperClockCacheOptions options(capacity, estimated_entry_charge);
+    block_cache_ = options.MakeSharedCache();
+  } else {
+    if (FLAGS_rocksdb_block_cache_type != "lru") {
+      DINGO_LOG(WARNING) << fmt::format("[rocksdb] unknown block cache type({}), use lru",
+                                        FLAGS_rocksdb_block_cache_type);
+    }
+    rocksdb::LRUCacheOptions options;
+    options.capacity = capacity;
+    options.high_pri_pool_ratio = FLAGS_rocksdb_block_cache_high_pri_pool_ratio;
+    block_cache_ = rocksdb::NewLRUCache(options);
+  }
+
+  DINGO_LOG(INFO) << fmt::format("[rocksdb] shared block cache type({}) capacity({})", FLAGS_rocksdb_block_cache_type,
+                                 capacity);
+}
+
 rocksdb::DB* RocksRawEngine::InitDB(const std::string& db_path, rocks::ColumnFamilyMap& column_families) {
+  InitBlockCache(column_families);
+
   // Cast ColumnFamily to rocksdb::ColumnFamilyOptions
   std::vector<rocksdb::ColumnFamilyDescriptor> column_family_descs;
   for (auto [cf_name, column_family] : column_families) {
     column_family->Dump();
-    rocksdb::ColumnFamilyOptions family_options = GenRocksDBColumnFamilyOptions(column_family);
+    rocksdb::ColumnFamilyOptions family_options =
+        GenRocksDBColumnFamilyOptions(column_family, GetSelfPtr(), block_cache_);
     column_family_descs.push_back(rocksdb::ColumnFamilyDescriptor(cf_name, family_options));
   }
 
@@ -1219,4 +1426,45 @@ std::vector<int64_t> RocksRawEngine::GetApproximateSizes(const std::string& cf_n
   return result;
 }
 
+uint64_t RocksRawEngine::GetTickerCount(rocksdb::Tickers ticker) {
+  auto statistics = db_->GetDBOptions().statistics;
+  return statistics != nullptr ? statistics->getTickerCount(ticker) : 0;
+}
+
+butil::Status RocksRawEngine::GetRangeSamples(const std::vector<std::string>& cf_names, const pb::common::Range& range,
+                                              std::vector<RangeSample>& samples) {
+  rocksdb::Range inner_range(range.start_key(), range.end_key());
+  for (const auto& cf_name : cf_names) {
+    rocksdb::TablePropertiesCollection props;
+    rocksdb::Status s =
+        db_->GetPropertiesOfTablesInRange(GetColumnFamily(cf_name)->GetHandle(), &inner_range, 1, &props);
+    if (!s.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[rocksdb] get properties of tables failed, cf({}) error: {}", cf_name,
+                                      s.ToString());
+      return butil::Status(pb::error::EINTERNAL, "get properties of tables failed, %s", s.ToString().c_str());
+    }
+
+    for (const auto& [file_name, prop] : props) {
+      const auto& user_props = prop->user_collected_properties;
+      auto it = user_props.find(rocks::RangePropertiesCollector::kPropertyName());
+      std::vector<RangeSample> file_samples;
+      if (it == user_props.end() || !rocks::RangePropertiesCollector::Decode(it->second, file_samples)) {
+        return butil::Status(pb::error::ENOT_SUPPORT, "sst %s not have range properties", file_name.c_str());
+      }
+
+      for (auto& sample : file_samples) {
+        if (sample.key < range.start_key() || (!range.end_key().empty() && sample.key >= range.end_key())) {
+          continue;
+        }
+        samples.push_back(std::move(sample));
+      }
+    }
+  }
+
+  std::sort(samples.begin(), samples.end(),
+            [](const RangeSample& lhs, const RangeSample& rhs) { return lhs.key < rhs.key; });
+
+  return butil::Status::OK();
+}
+
 }  // namespace dingodb
@@ -21,18 +21,21 @@
 #include <string>
 #include <vector>
 
+#include "bvar/reducer.h"
 #include "config/config.h"
 #include "engine/iterator.h"
 #include "engine/raw_engine.h"
 #include "engine/snapshot.h"
 #include "proto/common.pb.h"
 #include "proto/store_internal.pb.h"
+#include "rocksdb/advanced_cache.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
 #include "rocksdb/listener.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/utilities/checkpoint.h"
 
 namespace dingodb {
@@ -76,6 +79,43 @@ class ColumnFamily {
 using ColumnFamilyPtr = std::shared_ptr<ColumnFamily>;
 using ColumnFamilyMap = std::map<std::string, ColumnFamilyPtr>;
 
+// Prefix extractor for mvcc encode key(EncodeBytes(user_key)|ts), the prefix is the EncodeBytes(user_key) part.
+// So prefix bloom filter is built on user key, seek a user key with upper bound EncodeKey(user_key, 0) has the
+// same prefix, so auto_prefix_mode can skip sst.
+// Both encode key with ts and without ts are in domain.
+class MvccUserKeyTransform : public rocksdb::SliceTransform {
+ public:
+  MvccUserKeyTransform() = default;
+  ~MvccUserKeyTransform() override = default;
+
+  static const char* kClassName() { return "dingo.MvccUserKeyTransform"; }
+  const char* Name() const override { return kClassName(); }
+
+  rocksdb::Slice Transform(const rocksdb::Slice& key) const override;
+  bool InDomain(const rocksdb::Slice& key) const override;
+
+  // prefix length is variable, upper bound must be in the same prefix to use the filter
+  bool FullLengthEnabled(size_t* /*len*/) const override { return false; }
+};
+
+// Column families share one block cache, wrap the shared cache for each column family to count the hit/miss of it.
+class BlockCacheStatsWrapper : public rocksdb::CacheWrapper {
+ public:
+  BlockCacheStatsWrapper(std::shared_ptr<rocksdb::Cache> target, const std::string& cf_name);
+  ~BlockCacheStatsWrapper() override = default;
+
+  static const char* kClassName() { return "dingo.BlockCacheStatsWrapper"; }
+  const char* Name() const override { return kClassName(); }
+
+  Handle* Lookup(const rocksdb::Slice& key, const CacheItemHelper* helper = nullptr,
+                 CreateContext* create_context = nullptr, Priority priority = Priority::LOW,
+                 rocksdb::Statistics* stats = nullptr) override;
+
+ private:
+  bvar::Adder<int64_t>* hit_count_;
+  bvar::Adder<int64_t>* miss_count_;
+};
+
 class Iterator : public dingodb::Iterator {
  public:
   explicit Iterator(IteratorOptionsPtr options, rocksdb::Iterator* iter)
@@ -187,6 +227,10 @@ class Reader : public RawEngine::Reader {
   butil::Status KvGet(const std::string& cf_name, dingodb::SnapshotPtr snapshot, const std::string& key,
                       std::string& value) override;
 
+  butil::Status KvBatchGet(const std::string& cf_name, dingodb::SnapshotPtr snapshot,
+                           const std::vector<std::string>& keys, std::vector<std::string>& values,
+                           std::vector<bool>& key_states) override;
+
   butil::Status KvScan(const std::string& cf_name, const std::string& start_key, const std::string& end_key,
                        std::vector<pb::common::KeyValue>& kvs) override;
   butil::Status KvScan(const std::string& cf_name, std::shared_ptr<dingodb::Snapshot> snapshot,
@@ -291,12 +335,20 @@ class RocksRawEngine : public RawEngine {
 
   std::vector<int64_t> GetApproximateSizes(const std::string& cf_name, std::vector<pb::common::Range>& ranges) override;
 
+  // rocksdb statistics ticker count, e.g. rocksdb::BLOOM_FILTER_PREFIX_USEFUL
+  uint64_t GetTickerCount(rocksdb::Tickers ticker);
+
+  butil::Status GetRangeSamples(const std::vector<std::string>& cf_names, const pb::common::Range& range,
+                                std::vector<RangeSample>& samples) override;
+
  private:
   friend rocks::Reader;
   friend rocks::Writer;
   friend rocks::Checkpoint;
 
   rocksdb::DB* InitDB(const std::string& db_path, rocks::ColumnFamilyMap& column_families);
+  // store shared block cache, capacity is store.block_cache_size minus the reserved of column families.
+  void InitBlockCache(rocks::ColumnFamilyMap& column_families);
   std::shared_ptr<rocksdb::DB> GetDB();
 
   rocks::ColumnFamilyPtr GetDefaultColumnFamily();
@@ -307,6 +359,7 @@ class RocksRawEngine : public RawEngine {
   std::shared_ptr<rocksdb::DB> db_;
   rocks::ColumnFamilyMap column_families_;
   std::shared_ptr<rocksdb::RateLimiter> rate_limiter_;
+  std::shared_ptr<rocksdb::Cache> block_cache_;
 
   RawEngine::ReaderPtr reader_;
   RawEngine::WriterPtr writer_;
@@ -208,21 +208,24 @@ butil::Status Storage::KvGet(std::shared_ptr<Context> ctx, const std::vector<std
 
   auto reader = GetEngineMVCCReader(ctx->StoreEngineType(), ctx->RawEngineType());
 
-  for (const auto& key : keys) {
-    std::string value;
-    auto status = reader->KvGet(ctx->CfName(), ctx->Ts(), key, value);
-    if (BAIDU_UNLIKELY(!status.ok())) {
-      if (pb::error::EKEY_NOT_FOUND == status.error_code()) {
-        continue;
-      }
-      kvs.clear();
-      return status;
+  std::vector<std::string> values;
+  std::vector<bool> key_states;
+  status = reader->KvBatchGet(ctx->CfName(), ctx->Ts(), keys, values, key_states);
+  if (BAIDU_UNLIKELY(!status.ok())) {
+    kvs.clear();
+    return status;
+  }
+
+  kvs.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (!key_states[i]) {
+      continue;
     }
 
     pb::common::KeyValue kv;
-    kv.set_key(key);
-    kv.set_value(value);
-    kvs.emplace_back(kv);
+    kv.set_key(keys[i]);
+    kv.set_value(std::move(values[i]));
+    kvs.emplace_back(std::move(kv));
   }
 
   return butil::Status();
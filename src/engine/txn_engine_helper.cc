@@ -23,24 +23,30 @@
 #include <filesystem>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "bthread/mutex.h"
 #include "butil/compiler_specific.h"
 #include "butil/status.h"
 #include "bvar/latency_recorder.h"
+#include "bvar/reducer.h"
 #include "common/constant.h"
 #include "common/gflag_validator.h"
 #include "common/helper.h"
 #include "common/logging.h"
 #include "common/stream.h"
+#include "common/synchronization.h"
 #include "common/uuid.h"
 #include "coprocessor/coprocessor_v2.h"
 #include "document/codec.h"
 #include "engine/gc_safe_point.h"
+#include "engine/rocks_gc_compaction_filter.h"
 #include "engine/rocks_raw_engine.h"
+#include "engine/txn_lock_waiter.h"
 #include "fmt/core.h"
 #include "fmt/format.h"
 #include "glog/logging.h"
@@ -59,12 +65,15 @@ namespace dingodb {
 DEFINE_int64(max_short_value_in_write_cf, 256, "max short value in write cf");
 DEFINE_int64(max_batch_get_count, 4096, "max batch get count");
 DEFINE_int64(max_batch_get_memory_size, 60 * 1024 * 1024, "max batch get memory size");
+DEFINE_int64(batch_get_data_lookup_count, 128, "max data cf keys of one batch lookup in batch get");
 DEFINE_int64(max_prewrite_count, 4096, "max prewrite count");
 DEFINE_int64(max_commit_count, 4096, "max commit count");
 DEFINE_int64(max_rollback_count, 4096, "max rollback count");
 DEFINE_int64(max_resolve_count, 4096, "max rollback count");
 DEFINE_int64(max_pessimistic_count, 4096, "max pessimistic count");
 DEFINE_int64(gc_delete_batch_count, 32768, "gc delete batch count");
+DEFINE_int64(txn_pessimistic_lock_wait_timeout_ms, 1000,
+             "pessimistic lock wait timeout when meet lock conflict, 0 is not wait");
 
 DEFINE_bool(dingo_log_switch_txn_detail, false, "txn detail log");
 DEFINE_bool(dingo_log_switch_txn_gc_detail, false, "txn gc detail log");
@@ -72,6 +81,7 @@ DEFINE_bool(dingo_log_switch_backup_detail, false, "backup detail log");
 
 DEFINE_int64(max_restore_data_memory_size, 20 * 1024 * 1024, "max restore data memory size");
 DEFINE_int64(max_restore_count, 100000, "max restore count");
+DEFINE_int64(max_restore_inflight_write_count, 4, "max inflight raft write count of restore one region");
 
 DECLARE_int64(stream_message_max_bytes);
 DECLARE_int64(stream_message_max_limit_size);
@@ -154,6 +164,45 @@ butil::Status TxnReader::GetLockInfo(const std::string &key, pb::store::LockInfo
   return butil::Status::OK();
 }
 
+butil::Status TxnReader::BatchGetLockInfo(const std::vector<std::string> &keys,
+                                          std::vector<pb::store::LockInfo> &lock_infos) {
+  if (!is_initialized_) {
+    return butil::Status(pb::error::Errno::EINTERNAL, "txn reader is not initialized");
+  }
+
+  std::vector<std::string> lock_keys;
+  lock_keys.reserve(keys.size());
+  for (const auto &key : keys) {
+    lock_keys.push_back(mvcc::Codec::EncodeKey(key, Constant::kLockVer));
+  }
+
+  std::vector<std::string> lock_values;
+  std::vector<bool> key_states;
+  auto status = reader_->KvBatchGet(Constant::kTxnLockCF, snapshot_, lock_keys, lock_values, key_states);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << "[txn]BatchGetLockInfo read lock_key failed, keys_count: " << keys.size()
+                     << ", status: " << status.error_str();
+    return butil::Status(status.error_code(), status.error_str());
+  }
+
+  lock_infos.clear();
+  lock_infos.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    // if lock_value is not found or it is empty, then the key is not locked
+    if (!key_states[i] || lock_values[i].empty()) {
+      continue;
+    }
+
+    auto ret = lock_infos[i].ParseFromString(lock_values[i]);
+    if (!ret) {
+      DINGO_LOG(FATAL) << "[txn]BatchGetLockInfo parse lock info failed, lock_key: " << Helper::StringToHex(keys[i])
+                       << ", lock_value: " << Helper::StringToHex(lock_values[i]);
+    }
+  }
+
+  return butil::Status::OK();
+}
+
 butil::Status TxnReader::GetDataValue(const std::string &key, std::string &value) {
   if (!is_initialized_) {
     return butil::Status(pb::error::Errno::EINTERNAL, "txn reader is not initialized");
@@ -187,6 +236,15 @@ butil::Status TxnReader::GetDataValue(const std::string &key, std::string &value
   return butil::Status::OK();
 }
 
+butil::Status TxnReader::BatchGetDataValue(const std::vector<std::string> &keys, std::vector<std::string> &values,
+                                           std::vector<bool> &key_states) {
+  if (!is_initialized_) {
+    return butil::Status(pb::error::Errno::EINTERNAL, "txn reader is not initialized");
+  }
+
+  return reader_->KvBatchGet(Constant::kTxnDataCF, snapshot_, keys, values, key_states);
+}
+
 butil::Status TxnReader::GetWriteInfo(int64_t min_commit_ts, int64_t max_commit_ts, int64_t start_ts,
                                       const std::string &key, bool include_rollback, bool include_delete,
                                       bool include_put, pb::store::WriteInfo &write_info, int64_t &commit_ts) {
@@ -1152,34 +1210,84 @@ butil::Status TxnEngineHelper::BatchGet(RawEnginePtr engine, const pb::store::Is
     return butil::Status(pb::error::Errno::EINTERNAL, "txn_reader.Init failed");
   }
 
-  int64_t response_memory_size = 0;
-
   auto write_iter = txn_reader.GetWriteIter();
   if (write_iter == nullptr) {
     DINGO_LOG(ERROR) << "[txn]BatchGet GetWriteIter failed, start_ts: " << start_ts;
     return butil::Status(pb::error::Errno::EINTERNAL, "GetWriteIter failed");
   }
 
+  // get all lock info with one batch lookup
+  std::vector<pb::store::LockInfo> lock_infos;
+  auto ret_lock = txn_reader.BatchGetLockInfo(keys, lock_infos);
+  if (!ret_lock.ok()) {
+    DINGO_LOG(FATAL) << "[txn]BatchGet BatchGetLockInfo failed, keys_count: " << keys.size()
+                     << ", status: " << ret_lock.error_str();
+  }
+
+  // the data cf values which are not short value, read them with one batch lookup after write cf is resolved
+  std::vector<size_t> data_kv_indexes;
+  std::vector<std::string> data_keys;
+  auto fill_data_values = [&]() {
+    if (data_keys.empty()) {
+      return;
+    }
+
+    std::vector<std::string> data_values;
+    std::vector<bool> key_states;
+    auto ret = txn_reader.BatchGetDataValue(data_keys, data_values, key_states);
+    if (!ret.ok()) {
+      DINGO_LOG(FATAL) << "[txn]BatchGet read data failed, keys_count: " << data_keys.size()
+                       << ", status: " << ret.error_str();
+    }
+
+    for (size_t i = 0; i < data_keys.size(); ++i) {
+      if (!key_states[i]) {
+        DINGO_LOG(ERROR) << "[txn]BatchGet read data failed, data is illegally not found, key: "
+                         << Helper::StringToHex(kvs[data_kv_indexes[i]].key())
+                         << ", data_key: " << Helper::StringToHex(data_keys[i]);
+        continue;
+      }
+      kvs[data_kv_indexes[i]].set_value(std::move(data_values[i]));
+    }
+
+    data_kv_indexes.clear();
+    data_keys.clear();
+  };
+
+  // account the size of kvs which value is filled, stop when exceed max_batch_get_memory_size
+  int64_t response_memory_size = 0;
+  size_t accounted_count = 0;
+  auto is_exceed_memory_size = [&]() -> bool {
+    for (; accounted_count < kvs.size(); ++accounted_count) {
+      response_memory_size += kvs[accounted_count].ByteSizeLong();
+      if (response_memory_size >= FLAGS_max_batch_get_memory_size) {
+        kvs.resize(accounted_count + 1);
+        DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_detail)
+            << "[txn]BatchGet kvs.size: " << kvs.size() << ", response_memory_size: " << response_memory_size
+            << ", max_batch_get_count: " << FLAGS_max_batch_get_count
+            << ", max_batch_get_memory_size: " << FLAGS_max_batch_get_memory_size;
+        return true;
+      }
+    }
+    return false;
+  };
+
   // for every key in keys, get lock info, if lock_ts < start_ts, return LockInfo
   // else find the latest write below our start_ts
   // then read data from data_cf
-  for (const auto &key : keys) {
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const auto &key = keys[i];
     pb::common::KeyValue kv;
     kv.set_key(key);
 
-    pb::store::LockInfo lock_info;
-    auto ret = txn_reader.GetLockInfo(key, lock_info);
-    if (!ret.ok()) {
-      DINGO_LOG(FATAL) << "[txn]BatchGet GetLockInfo failed, key: " << Helper::StringToHex(key)
-                       << ", status: " << ret.error_str();
-    }
-
+    const auto &lock_info = lock_infos[i];
     auto is_lock_conflict = CheckLockConflict(lock_info, isolation_level, start_ts, resolved_locks, txn_result_info);
     if (is_lock_conflict) {
       DINGO_LOG(WARNING) << "[txn]BatchGet CheckLockConflict return conflict, key: " << Helper::StringToHex(key)
                          << ", isolation_level: " << isolation_level << ", start_ts: " << start_ts
                          << ", lock_info: " << lock_info.ShortDebugString()
                          << ", txn_result_info: " << txn_result_info.ShortDebugString();
+      fill_data_values();
       return butil::Status::OK();
     }
 
@@ -1269,15 +1377,8 @@ butil::Status TxnEngineHelper::BatchGet(RawEnginePtr engine, const pb::store::Is
           break;
         }
 
-        auto ret1 = txn_reader.GetDataValue(mvcc::Codec::EncodeKey(key, write_info.start_ts()), *kv.mutable_value());
-        if (!ret1.ok() && ret1.error_code() != pb::error::Errno::EKEY_NOT_FOUND) {
-          DINGO_LOG(FATAL) << "[txn]BatchGet read data failed, key: " << Helper::StringToHex(key)
-                           << ", status: " << ret1.error_str();
-        } else if (ret1.error_code() == pb::error::Errno::EKEY_NOT_FOUND) {
-          DINGO_LOG(ERROR) << "[txn]BatchGet read data failed, data is illegally not found, key: "
-                           << Helper::StringToHex(key) << ", status: " << ret1.error_str()
-                           << ", ts: " << write_info.start_ts();
-        }
+        data_kv_indexes.push_back(kvs.size());
+        data_keys.push_back(mvcc::Codec::EncodeKey(key, write_info.start_ts()));
         break;
       } else {
         DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_detail)
@@ -1288,18 +1389,20 @@ butil::Status TxnEngineHelper::BatchGet(RawEnginePtr engine, const pb::store::Is
       write_iter->Next();
     }
 
-    kvs.emplace_back(kv);
-    response_memory_size += kv.ByteSizeLong();
+    kvs.emplace_back(std::move(kv));
 
-    if (response_memory_size >= FLAGS_max_batch_get_memory_size) {
-      DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_detail)
-          << "[txn]BatchGet kvs.size: " << kvs.size() << ", response_memory_size: " << response_memory_size
-          << ", max_batch_get_count: " << FLAGS_max_batch_get_count
-          << ", max_batch_get_memory_size: " << FLAGS_max_batch_get_memory_size;
-      break;
+    // the value of data cf is read by batch, so account memory size when the values are filled
+    if (static_cast<int64_t>(data_keys.size()) >= FLAGS_batch_get_data_lookup_count) {
+      fill_data_values();
+    }
+    if (data_keys.empty() && is_exceed_memory_size()) {
+      return butil::Status::OK();
     }
   }
 
+  fill_data_values();
+  is_exceed_memory_size();
+
   return butil::Status::OK();
 }
 
@@ -1485,38 +1588,36 @@ butil::Status TxnEngineHelper::Scan(StreamPtr stream, RawEnginePtr raw_engine,
 
 bvar::LatencyRecorder g_txn_pessimistic_lock_latency("dingo_txn_pessimistic_lock");
 
-butil::Status TxnEngineHelper::PessimisticLock(RawEnginePtr raw_engine, std::shared_ptr<Engine> raft_engine,
-                                               std::shared_ptr<Context> ctx,
-                                               const std::vector<pb::store::Mutation> &mutations,
-                                               const std::string &primary_lock, int64_t start_ts, int64_t lock_ttl,
-                                               int64_t for_update_ts, bool return_values,
-                                               std::vector<pb::common::KeyValue> &kvs) {
-  BvarLatencyGuard bvar_guard(&g_txn_pessimistic_lock_latency);
+// only all txn_result are lock conflict of other txn can wait, return the first locked key and its lock_ts
+static bool GetPessimisticLockWaitKey(const pb::store::TxnPessimisticLockResponse *response, int64_t start_ts,
+                                      std::string &key, int64_t &lock_ts) {
+  for (const auto &txn_result : response->txn_result()) {
+    if (txn_result.has_write_conflict() || !txn_result.has_locked()) {
+      return false;
+    }
 
-  DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_detail)
-      << fmt::format("[txn][region({})] PessimisticLock, start_ts: {}", ctx->RegionId(), start_ts)
-      << ", region_epoch: " << ctx->RegionEpoch().ShortDebugString() << ", mutations_size: " << mutations.size()
-      << ", primary_lock: " << Helper::StringToHex(primary_lock) << ", lock_ttl: " << lock_ttl
-      << ", for_update_ts: " << for_update_ts << ", return_values: " << return_values;
+    const auto &lock_info = txn_result.locked();
+    if (lock_info.lock_ts() == start_ts) {
+      return false;
+    }
 
-  if (BAIDU_UNLIKELY(mutations.size() > FLAGS_max_pessimistic_count)) {
-    DINGO_LOG(ERROR) << fmt::format("[txn][region({})] PessimisticLock, start_ts: {}", ctx->RegionId(), start_ts)
-                     << ", region_epoch: " << ctx->RegionEpoch().ShortDebugString()
-                     << ", mutations_size: " << mutations.size()
-                     << ", primary_lock: " << Helper::StringToHex(primary_lock) << ", lock_ttl: " << lock_ttl
-                     << ", for_update_ts: " << for_update_ts << ", mutations.size() > FLAGS_max_pessimistic_count";
-    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS,
-                         "pessimistic lock mutations.size() > FLAGS_max_pessimistic_count");
+    if (key.empty()) {
+      key = lock_info.key();
+      lock_ts = lock_info.lock_ts();
+    }
   }
 
-  std::vector<pb::common::KeyValue> kv_puts_lock;
-  auto *response = dynamic_cast<pb::store::TxnPessimisticLockResponse *>(ctx->Response());
-  if (response == nullptr) {
-    DINGO_LOG(ERROR) << fmt::format("[txn][region({})] PessimisticLock, start_ts: {}", ctx->RegionId(), start_ts)
-                     << ", for_update_ts: " << for_update_ts << ", response is nullptr";
-    return butil::Status(pb::error::Errno::EINTERNAL, "response is nullptr");
-  }
+  return !key.empty();
+}
 
+// check every mutation with a fresh snapshot, put the lock kvs into kv_puts_lock, the conflicts into txn_result
+static butil::Status CheckPessimisticLockMutations(RawEnginePtr raw_engine, std::shared_ptr<Context> ctx,
+                                                   const std::vector<pb::store::Mutation> &mutations,
+                                                   const std::string &primary_lock, int64_t start_ts, int64_t lock_ttl,
+                                                   int64_t for_update_ts, bool return_values,
+                                                   pb::store::TxnPessimisticLockResponse *response,
+                                                   std::vector<pb::common::KeyValue> &kv_puts_lock,
+                                                   std::vector<pb::common::KeyValue> &kvs) {
   auto *error = response->mutable_error();
   TxnReader txn_reader(raw_engine);
   auto ret_init = txn_reader.Init();
@@ -1729,6 +1830,100 @@ butil::Status TxnEngineHelper::PessimisticLock(RawEnginePtr raw_engine, std::sha
     }
   }
 
+  return butil::Status::OK();
+}
+
+butil::Status TxnEngineHelper::PessimisticLock(RawEnginePtr raw_engine, std::shared_ptr<Engine> raft_engine,
+                                               std::shared_ptr<Context> ctx,
+                                               const std::vector<pb::store::Mutation> &mutations,
+                                               const std::string &primary_lock, int64_t start_ts, int64_t lock_ttl,
+                                               int64_t for_update_ts, bool return_values,
+                                               std::vector<pb::common::KeyValue> &kvs) {
+  BvarLatencyGuard bvar_guard(&g_txn_pessimistic_lock_latency);
+
+  DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_detail)
+      << fmt::format("[txn][region({})] PessimisticLock, start_ts: {}", ctx->RegionId(), start_ts)
+      << ", region_epoch: " << ctx->RegionEpoch().ShortDebugString() << ", mutations_size: " << mutations.size()
+      << ", primary_lock: " << Helper::StringToHex(primary_lock) << ", lock_ttl: " << lock_ttl
+      << ", for_update_ts: " << for_update_ts << ", return_values: " << return_values;
+
+  if (BAIDU_UNLIKELY(mutations.size() > FLAGS_max_pessimistic_count)) {
+    DINGO_LOG(ERROR) << fmt::format("[txn][region({})] PessimisticLock, start_ts: {}", ctx->RegionId(), start_ts)
+                     << ", region_epoch: " << ctx->RegionEpoch().ShortDebugString()
+                     << ", mutations_size: " << mutations.size()
+                     << ", primary_lock: " << Helper::StringToHex(primary_lock) << ", lock_ttl: " << lock_ttl
+                     << ", for_update_ts: " << for_update_ts << ", mutations.size() > FLAGS_max_pessimistic_count";
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS,
+                         "pessimistic lock mutations.size() > FLAGS_max_pessimistic_count");
+  }
+
+  std::vector<pb::common::KeyValue> kv_puts_lock;
+  auto *response = dynamic_cast<pb::store::TxnPessimisticLockResponse *>(ctx->Response());
+  if (response == nullptr) {
+    DINGO_LOG(ERROR) << fmt::format("[txn][region({})] PessimisticLock, start_ts: {}", ctx->RegionId(), start_ts)
+                     << ", for_update_ts: " << for_update_ts << ", response is nullptr";
+    return butil::Status(pb::error::Errno::EINTERNAL, "response is nullptr");
+  }
+
+  // when meet lock conflict of other txn, wait the lock released and check again, instead of return to client at once
+  int64_t wait_deadline_ms = Helper::TimestampMs() + FLAGS_txn_pessimistic_lock_wait_timeout_ms;
+  size_t kvs_size = kvs.size();
+  for (;;) {
+    int64_t check_time_us = Helper::TimestampUs();
+    auto ret_check = CheckPessimisticLockMutations(raw_engine, ctx, mutations, primary_lock, start_ts, lock_ttl,
+                                                   for_update_ts, return_values, response, kv_puts_lock, kvs);
+    if (!ret_check.ok()) {
+      return ret_check;
+    }
+
+    std::string wait_key;
+    int64_t wait_lock_ts = 0;
+    int64_t wait_timeout_ms = wait_deadline_ms - Helper::TimestampMs();
+    if (response->txn_result_size() == 0 || wait_timeout_ms <= 0 ||
+        !GetPessimisticLockWaitKey(response, start_ts, wait_key, wait_lock_ts)) {
+      break;
+    }
+
+    auto wait_result =
+        TxnLockWaiterManager::GetInstance().Wait(wait_key, start_ts, wait_lock_ts, check_time_us, wait_timeout_ms);
+    if (wait_result == TxnLockWaiterManager::WaitResult::kDeadlock) {
+      // this txn is the deadlock victim, replace the lock_info with a write_conflict on the waited key, so client
+      // abort the txn instead of resolving the lock and retrying, the reason is left unset, not PessimisticRetry.
+      std::string primary_key;
+      for (const auto &txn_result : response->txn_result()) {
+        if (txn_result.locked().key() == wait_key) {
+          primary_key = txn_result.locked().primary_lock();
+          break;
+        }
+      }
+
+      DINGO_LOG(WARNING) << fmt::format("[txn][region({})] PessimisticLock deadlock,", ctx->RegionId())
+                         << " start_ts: " << start_ts << ", lock_ts: " << wait_lock_ts
+                         << ", key: " << Helper::StringToHex(wait_key);
+
+      response->clear_txn_result();
+      kvs.resize(kvs_size);
+      auto *write_conflict = response->add_txn_result()->mutable_write_conflict();
+      write_conflict->set_start_ts(start_ts);
+      write_conflict->set_conflict_ts(wait_lock_ts);
+      write_conflict->set_key(wait_key);
+      write_conflict->set_primary_key(primary_key);
+      return butil::Status::OK();
+    }
+
+    if (wait_result != TxnLockWaiterManager::WaitResult::kWakeUp) {
+      DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_detail)
+          << fmt::format("[txn][region({})] PessimisticLock wait lock timeout,", ctx->RegionId())
+          << ", start_ts: " << start_ts << ", lock_ts: " << wait_lock_ts
+          << ", key: " << Helper::StringToHex(wait_key);
+      break;
+    }
+
+    response->clear_txn_result();
+    kvs.resize(kvs_size);
+    kv_puts_lock.clear();
+  }
+
   if (response->txn_result_size() > 0) {
     DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_detail)
         << fmt::format("[txn][region({})] PessimisticLock return txn_result,", ctx->RegionId())
@@ -1978,6 +2173,10 @@ butil::Status TxnEngineHelper::PessimisticRollback(RawEnginePtr raw_engine, std:
     return butil::Status(pb::error::Errno::ERAFT_NOTLEADER, ret.error_str());
   }
 
+  if (ret.ok()) {
+    TxnLockWaiterManager::GetInstance().WakeUp(keys);
+  }
+
   return ret;
 }
 
@@ -3376,6 +3575,15 @@ butil::Status TxnEngineHelper::DoTxnCommit(RawEnginePtr raw_engine, std::shared_
     return butil::Status(pb::error::Errno::ERAFT_NOTLEADER, ret.error_str());
   }
 
+  if (ret.ok()) {
+    std::vector<std::string> released_keys;
+    released_keys.reserve(lock_infos.size());
+    for (const auto &lock_info : lock_infos) {
+      released_keys.push_back(lock_info.key());
+    }
+    TxnLockWaiterManager::GetInstance().WakeUp(released_keys);
+  }
+
   return ret;
 }
 
@@ -3845,6 +4053,11 @@ butil::Status TxnEngineHelper::DoRollback(RawEnginePtr /*raw_engine*/, std::shar
     return butil::Status(pb::error::Errno::ERAFT_NOTLEADER, ret.error_str());
   }
 
+  if (ret.ok()) {
+    TxnLockWaiterManager::GetInstance().WakeUp(keys_to_rollback_without_data);
+    TxnLockWaiterManager::GetInstance().WakeUp(keys_to_rollback_with_data);
+  }
+
   return ret;
 }
 
@@ -4398,6 +4611,10 @@ butil::Status TxnEngineHelper::DoGc(RawEnginePtr raw_engine, std::shared_ptr<Eng
   return butil::Status(pb::error::Errno::ENOT_SUPPORT, s);
 }
 
+// compare with dingo_gc_compaction_filter_reclaimed_keys/bytes
+bvar::Adder<int64_t> g_gc_raft_reclaimed_keys("dingo_gc_raft_reclaimed_keys");
+bvar::Adder<int64_t> g_gc_raft_reclaimed_bytes("dingo_gc_raft_reclaimed_bytes");
+
 butil::Status TxnEngineHelper::DoGcCoreTxn(RawEnginePtr raw_engine, std::shared_ptr<Engine> raft_engine,
                                            std::shared_ptr<Context> ctx, pb::common::RegionType type,
                                            int64_t safe_point_ts, std::shared_ptr<GCSafePoint> gc_safe_point,
@@ -4406,6 +4623,8 @@ butil::Status TxnEngineHelper::DoGcCoreTxn(RawEnginePtr raw_engine, std::shared_
   int64_t end_time_ms = 0;
   int64_t total_delete_count = 0;
   int64_t total_iter_count = 0;
+  int64_t delete_bytes = 0;
+  int64_t total_delete_bytes = 0;
   int64_t region_id = ctx->RegionId();
 
   DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_gc_detail) << fmt::format(
@@ -4521,12 +4740,14 @@ butil::Status TxnEngineHelper::DoGcCoreTxn(RawEnginePtr raw_engine, std::shared_
           }
         }
         kv_deletes_write.emplace_back(write_iter_key);
+        delete_bytes += write_iter_key.size() + write_iter_value.size();
         if (write_info.short_value().empty()) {
           // try get key from data column family. if not exist , do not delete.
           std::string data_key = mvcc::Codec::EncodeKey(write_key, write_info.start_ts());
           std::string data_value;
           auto status = reader->KvGet(Constant::kTxnDataCF, snapshot, data_key, data_value);
           if (status.ok()) {
+            delete_bytes += data_key.size() + data_value.size();
             kv_deletes_data.emplace_back(data_key);
           } else {
             if (pb::error::Errno::EKEY_NOT_FOUND == status.error_code()) {
@@ -4560,11 +4781,13 @@ butil::Status TxnEngineHelper::DoGcCoreTxn(RawEnginePtr raw_engine, std::shared_
           }
         }
         kv_deletes_write.emplace_back(write_iter_key);
+        delete_bytes += write_iter_key.size() + write_iter_value.size();
         break;
       }
 
       case pb::store::Rollback: {
         kv_deletes_write.emplace_back(write_iter_key);
+        delete_bytes += write_iter_key.size() + write_iter_value.size();
         break;
       }
       case pb::store::Lock:
@@ -4608,6 +4831,8 @@ butil::Status TxnEngineHelper::DoGcCoreTxn(RawEnginePtr raw_engine, std::shared_
       }
 
       total_delete_count += (kv_deletes_lock.size() + kv_deletes_write.size() + kv_deletes_data.size());
+      total_delete_bytes += delete_bytes;
+      delete_bytes = 0;
       DoFinalWorkForTxnGc(raft_engine, ctx, reader, snapshot, write_key, gc_safe_point->GetTenantId(), type,
                           safe_point_ts, kv_deletes_lock, kv_deletes_data, kv_deletes_write, lock_start_key,
                           lock_end_key, last_lock_start_key, last_lock_end_key);
@@ -4634,6 +4859,7 @@ _interrupt1:
   }
 
   total_delete_count += (kv_deletes_lock.size() + kv_deletes_write.size() + kv_deletes_data.size());
+  total_delete_bytes += delete_bytes;
   DoFinalWorkForTxnGc(raft_engine, ctx, reader, snapshot, write_key, gc_safe_point->GetTenantId(), type, safe_point_ts,
                       kv_deletes_lock, kv_deletes_data, kv_deletes_write, lock_start_key, lock_end_key,
                       last_lock_start_key, last_lock_end_key);
@@ -4641,6 +4867,9 @@ _interrupt1:
 _interrupt2:
   end_time_ms = Helper::TimestampMs();
 
+  g_gc_raft_reclaimed_keys << total_delete_count;
+  g_gc_raft_reclaimed_bytes << total_delete_bytes;
+
   DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_gc_detail) << fmt::format(
       "[txn_gc][statics][tenant({})][region({})][type({})][txn] end region start_key: {} end_key: {} safe_point_ts "
       ": {} time consuming : {} ms total_delete_count : {} total_iter_count : {} ",
@@ -4667,6 +4896,8 @@ butil::Status TxnEngineHelper::DoGcCoreNonTxn(RawEnginePtr raw_engine, std::shar
   int64_t end_time_ms = 0;
   int64_t total_delete_count = 0;
   int64_t total_iter_count = 0;
+  int64_t delete_bytes = 0;
+  int64_t total_delete_bytes = 0;
   int64_t region_id = ctx->RegionId();
 
   DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_gc_detail) << fmt::format(
@@ -4718,10 +4949,11 @@ butil::Status TxnEngineHelper::DoGcCoreNonTxn(RawEnginePtr raw_engine, std::shar
   }
 
   auto lambda_emplace_back_function = [&region, &prefix, &region_part_id, &kv_deletes_default, &kv_deletes_scalar,
-                                       &kv_deletes_table, &kv_deletes_scalar_speedup](
+                                       &kv_deletes_table, &kv_deletes_scalar_speedup, &delete_bytes](
                                           pb::common::RegionType type, std::string_view default_iter_key,
-                                          int64_t vector_id, int64_t default_ts) {
+                                          std::string_view default_iter_value, int64_t vector_id, int64_t default_ts) {
     kv_deletes_default.emplace_back(std::string(default_iter_key));
+    delete_bytes += default_iter_key.size() + default_iter_value.size();
     if (type == pb::common::RegionType::INDEX_REGION) {
       kv_deletes_scalar.emplace_back(std::string(default_iter_key));
       kv_deletes_table.emplace_back(std::string(default_iter_key));
@@ -4795,7 +5027,7 @@ butil::Status TxnEngineHelper::DoGcCoreNonTxn(RawEnginePtr raw_engine, std::shar
           }
         }
 
-        lambda_emplace_back_function(type, default_iter_key, vector_id, default_ts);
+        lambda_emplace_back_function(type, default_iter_key, default_iter_value, vector_id, default_ts);
         break;
       }
       case mvcc::ValueFlag::kPutTTL: {
@@ -4812,7 +5044,7 @@ butil::Status TxnEngineHelper::DoGcCoreNonTxn(RawEnginePtr raw_engine, std::shar
             }
           }
         }
-        lambda_emplace_back_function(type, default_iter_key, vector_id, default_ts);
+        lambda_emplace_back_function(type, default_iter_key, default_iter_value, vector_id, default_ts);
         break;
       }
 
@@ -4823,7 +5055,7 @@ butil::Status TxnEngineHelper::DoGcCoreNonTxn(RawEnginePtr raw_engine, std::shar
             is_exist_default_key_if_ts_gt_safe_point_ts = true;
           }
         }
-        lambda_emplace_back_function(type, default_iter_key, vector_id, default_ts);
+        lambda_emplace_back_function(type, default_iter_key, default_iter_value, vector_id, default_ts);
         break;
       }
 
@@ -4859,6 +5091,8 @@ butil::Status TxnEngineHelper::DoGcCoreNonTxn(RawEnginePtr raw_engine, std::shar
 
       total_delete_count += kv_deletes_default.size() + kv_deletes_scalar.size() + kv_deletes_table.size() +
                             kv_deletes_scalar_speedup.size();
+      total_delete_bytes += delete_bytes;
+      delete_bytes = 0;
       DoFinalWorkForNonTxnGc(raft_engine, ctx, gc_safe_point->GetTenantId(), type, kv_deletes_default,
                              kv_deletes_scalar, kv_deletes_table, kv_deletes_scalar_speedup);
     }
@@ -4887,12 +5121,16 @@ _interrupt1:
 
   total_delete_count +=
       kv_deletes_default.size() + kv_deletes_scalar.size() + kv_deletes_table.size() + kv_deletes_scalar_speedup.size();
+  total_delete_bytes += delete_bytes;
   DoFinalWorkForNonTxnGc(raft_engine, ctx, gc_safe_point->GetTenantId(), type, kv_deletes_default, kv_deletes_scalar,
                          kv_deletes_table, kv_deletes_scalar_speedup);
 
 _interrupt2:
   end_time_ms = Helper::TimestampMs();
 
+  g_gc_raft_reclaimed_keys << total_delete_count;
+  g_gc_raft_reclaimed_bytes << total_delete_bytes;
+
   DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_gc_detail) << fmt::format(
       "[txn_gc][statics][tenant({})][region({})][type({})][nontxn] end region start_key: {} end_key: {} "
       "safe_point_ts "
@@ -5378,6 +5616,26 @@ void TxnEngineHelper::RegularUpdateSafePointTsHandler(void * /*arg*/) {
   }
 
   gc_safe_point_manager->SetGcFlagAndSafePointTs(safe_point_ts_group, gc_stop);
+
+  // publish safe point ts for compaction filter gc, it is the min safe point ts of the tenants on this node.
+  // all replicas get the same safe point ts from coordinator, so they drop the same invisible versions.
+  int64_t compaction_filter_safe_point_ts = 0;
+  std::set<int64_t> compaction_filter_tenant_ids;
+  if (!gc_stop) {
+    compaction_filter_safe_point_ts = INT64_MAX;
+    for (const auto &region : Server::GetInstance().GetAllAliveRegion()) {
+      compaction_filter_tenant_ids.insert(region->Definition().tenant_id());
+      auto iter = safe_point_ts_group.find(region->Definition().tenant_id());
+      int64_t tenant_safe_point_ts = (iter != safe_point_ts_group.end()) ? iter->second : 0;
+      compaction_filter_safe_point_ts = std::min(compaction_filter_safe_point_ts, tenant_safe_point_ts);
+    }
+
+    if (compaction_filter_safe_point_ts == INT64_MAX || compaction_filter_safe_point_ts < 0) {
+      compaction_filter_safe_point_ts = 0;
+    }
+  }
+
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(compaction_filter_safe_point_ts, compaction_filter_tenant_ids);
 }
 
 // readme .
@@ -6364,6 +6622,82 @@ std::map<std::string, pb::common::KeyValue> GenKvPutsDataMap(const std::vector<p
   return kv_puts_data_map;
 }
 
+// Restore write the batches of one region through raft in order, the sync write wait every batch replicated and
+// applied before build the next one. Pipeline the batches, keep at most FLAGS_max_restore_inflight_write_count
+// batches in flight, raft log keep the order of the batches.
+class RestoreWritePipeline {
+ public:
+  RestoreWritePipeline(std::shared_ptr<Context> ctx, std::shared_ptr<Engine> raft_engine)
+      : ctx_(ctx), raft_engine_(raft_engine), state_(std::make_shared<State>()) {}
+  ~RestoreWritePipeline() { state_->cond.Wait(0); }
+
+  butil::Status Write(std::shared_ptr<WriteData> write_data) {
+    // mono store has no raft log replication, keep sync write.
+    if (ctx_->StoreEngineType() != pb::common::StorageEngine::STORE_ENG_RAFT_STORE ||
+        FLAGS_max_restore_inflight_write_count <= 1) {
+      return raft_engine_->Write(ctx_, write_data);
+    }
+
+    auto status = state_->FirstError();
+    if (!status.ok()) {
+      return status;
+    }
+
+    state_->cond.IncreaseWait(FLAGS_max_restore_inflight_write_count);
+
+    auto write_ctx = std::make_shared<Context>();
+    write_ctx->SetRegionId(ctx_->RegionId()).SetRegionEpoch(ctx_->RegionEpoch()).SetCfName(ctx_->CfName());
+    write_ctx->SetIsolationLevel(ctx_->IsolationLevel());
+    write_ctx->SetRawEngineType(ctx_->RawEngineType());
+    write_ctx->SetStoreEngineType(ctx_->StoreEngineType());
+
+    auto state = state_;
+    status = raft_engine_->AsyncWrite(write_ctx, write_data,
+                                      [state](std::shared_ptr<Context> /*ctx*/, butil::Status write_status) {
+                                        state->SetError(write_status);
+                                        state->cond.DecreaseSignal();
+                                      });
+    if (!status.ok()) {
+      // write callback is not called when commit failed.
+      state_->cond.DecreaseSignal();
+    }
+
+    return status;
+  }
+
+  // wait all inflight writes done, return the first error.
+  butil::Status Finish() {
+    state_->cond.Wait(0);
+    return state_->FirstError();
+  }
+
+ private:
+  struct State {
+    State() { bthread_mutex_init(&mutex, nullptr); }
+    ~State() { bthread_mutex_destroy(&mutex); }
+
+    void SetError(const butil::Status &status) {
+      BAIDU_SCOPED_LOCK(mutex);
+      if (!status.ok() && error.ok()) {
+        error = status;
+      }
+    }
+
+    butil::Status FirstError() {
+      BAIDU_SCOPED_LOCK(mutex);
+      return error;
+    }
+
+    BthreadCond cond;
+    bthread_mutex_t mutex;
+    butil::Status error;
+  };
+
+  std::shared_ptr<Context> ctx_;
+  std::shared_ptr<Engine> raft_engine_;
+  std::shared_ptr<State> state_;
+};
+
 butil::Status TxnEngineHelper::RestoreTxn(std::shared_ptr<Context> ctx, store::RegionPtr region,
                                           std::shared_ptr<Engine> raft_engine,
                                           const std::vector<pb::common::KeyValue> &kv_puts_data,
@@ -6379,6 +6713,7 @@ butil::Status TxnEngineHelper::RestoreTxn(std::shared_ptr<Context> ctx, store::R
 
   int64_t total_size = 0;
   int64_t total_count = 0;
+  RestoreWritePipeline write_pipeline(ctx, raft_engine);
 
   if (kv_puts_data.empty() && kv_puts_write.empty()) {
     DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_backup_detail)
@@ -6485,7 +6820,7 @@ butil::Status TxnEngineHelper::RestoreTxn(std::shared_ptr<Context> ctx, store::R
       }
 
       if (total_size > FLAGS_max_restore_data_memory_size || total_count > FLAGS_max_restore_count) {
-        auto ret = raft_engine->Write(ctx, WriteDataBuilder::BuildWrite(txn_raft_request));
+        auto ret = write_pipeline.Write(WriteDataBuilder::BuildWrite(txn_raft_request));
         if (ret.error_code() == EPERM) {
           DINGO_LOG(ERROR) << fmt::format(
               "[backupdata][region({})][region_type({})] write raft engine failed, status:{}", region->Id(),
@@ -6517,7 +6852,7 @@ butil::Status TxnEngineHelper::RestoreTxn(std::shared_ptr<Context> ctx, store::R
       total_size += kv_put.value().size();
 
       if (total_size > FLAGS_max_restore_data_memory_size || total_count > FLAGS_max_restore_count) {
-        auto ret = raft_engine->Write(ctx, WriteDataBuilder::BuildWrite(txn_raft_request));
+        auto ret = write_pipeline.Write(WriteDataBuilder::BuildWrite(txn_raft_request));
         if (ret.error_code() == EPERM) {
           DINGO_LOG(ERROR) << fmt::format(
               "[backupdata][region({})][region_type({})] write raft engine failed, status:{}", region->Id(),
@@ -6546,7 +6881,7 @@ butil::Status TxnEngineHelper::RestoreTxn(std::shared_ptr<Context> ctx, store::R
       total_size += kv_put.value().size();
 
       if (total_size > FLAGS_max_restore_data_memory_size || total_count > FLAGS_max_restore_count) {
-        auto ret = raft_engine->Write(ctx, WriteDataBuilder::BuildWrite(txn_raft_request));
+        auto ret = write_pipeline.Write(WriteDataBuilder::BuildWrite(txn_raft_request));
         if (ret.error_code() == EPERM) {
           DINGO_LOG(ERROR) << fmt::format(
               "[backupdata][region({})][region_type({})] write raft engine failed, status:{}", region->Id(),
@@ -6567,7 +6902,10 @@ butil::Status TxnEngineHelper::RestoreTxn(std::shared_ptr<Context> ctx, store::R
       "[backupdata][region({})][region_type({})] kv_puts_data_size:{}, kv_puts_write_size:{}", region->Id(),
       pb::common::RegionType_Name(region->Type()), kv_puts_data.size(), kv_puts_write.size());
 
-  auto ret = raft_engine->Write(ctx, WriteDataBuilder::BuildWrite(txn_raft_request));
+  auto ret = write_pipeline.Write(WriteDataBuilder::BuildWrite(txn_raft_request));
+  if (ret.ok()) {
+    ret = write_pipeline.Finish();
+  }
   if (ret.error_code() == EPERM) {
     DINGO_LOG(ERROR) << fmt::format("[backupdata][region({})][region_type({})] write raft engine failed, status:{}",
                                     region->Id(), pb::common::RegionType_Name(region->Type()), ret.error_str());
@@ -6595,6 +6933,7 @@ butil::Status TxnEngineHelper::RestoreNonTxnStore(std::shared_ptr<Context> ctx,
   int64_t total_count = 0;
   std::vector<pb::common::KeyValue> send_kvs;
   butil::Status ret;
+  RestoreWritePipeline write_pipeline(ctx, raft_engine);
   for (auto const &kv_data : kv_default) {
     send_kvs.push_back(kv_data);
     total_count++;
@@ -6602,8 +6941,7 @@ butil::Status TxnEngineHelper::RestoreNonTxnStore(std::shared_ptr<Context> ctx,
     total_size += kv_data.value().size();
 
     if (total_size > FLAGS_max_restore_data_memory_size || total_count > FLAGS_max_restore_count) {
-      ret = raft_engine->Write(ctx, WriteDataBuilder::BuildWrite(
-                                        ctx->CfName(), const_cast<std::vector<pb::common::KeyValue> &>(send_kvs), ts));
+      ret = write_pipeline.Write(WriteDataBuilder::BuildWrite(ctx->CfName(), send_kvs, ts));
       if (ret.error_code() == EPERM) {
         DINGO_LOG(ERROR) << fmt::format("[backupdata][region({})][region_type({})] write raft engine failed, status:{}",
                                         region->Id(), pb::common::RegionType_Name(region->Type()), ret.error_str());
@@ -6616,8 +6954,11 @@ butil::Status TxnEngineHelper::RestoreNonTxnStore(std::shared_ptr<Context> ctx,
   }
 
   if (!send_kvs.empty()) {
-    ret = raft_engine->Write(ctx, WriteDataBuilder::BuildWrite(
-                                      ctx->CfName(), const_cast<std::vector<pb::common::KeyValue> &>(send_kvs), ts));
+    ret = write_pipeline.Write(WriteDataBuilder::BuildWrite(ctx->CfName(), send_kvs, ts));
+  }
+
+  if (ret.ok()) {
+    ret = write_pipeline.Finish();
     if (ret.error_code() == EPERM) {
       DINGO_LOG(ERROR) << fmt::format("[backupdata][region({})][region_type({})] write raft engine failed, status:{}",
                                       region->Id(), pb::common::RegionType_Name(region->Type()), ret.error_str());
@@ -6753,7 +7094,8 @@ butil::Status TxnEngineHelper::OptimizePreProcessVectorIndex(const std::vector<p
     int64_t ttl;
     auto value = dingodb::mvcc::Codec::UnPackageValue(kv.value(), flag, ttl);
     if (flag == dingodb::mvcc::ValueFlag::kPut || flag == dingodb::mvcc::ValueFlag::kPutTTL) {
-      if (!vector_with_key.mutable_vector_with_id()->mutable_vector()->ParseFromArray(value.data(), value.size())) {
+      auto *vector = vector_with_key.mutable_vector_with_id()->mutable_vector();
+      if (!dingodb::VectorCodec::DecodeVectorValue(value, *vector)) {
         DINGO_LOG(FATAL) << fmt::format("Parse vector proto failed, value size: {}.", value.size());
       }
     } else {
@@ -6871,7 +7213,7 @@ butil::Status TxnEngineHelper::PreProcessVectorIndex(const std::vector<pb::commo
     if (flag == dingodb::mvcc::ValueFlag::kPut || flag == dingodb::mvcc::ValueFlag::kPutTTL) {
       vector_with_id.set_id(vector_id);
 
-      if (!vector_with_id.mutable_vector()->ParseFromArray(value.data(), value.size())) {
+      if (!dingodb::VectorCodec::DecodeVectorValue(value, *vector_with_id.mutable_vector())) {
         DINGO_LOG(FATAL) << fmt::format("Parse vector proto failed, value size: {}.", value.size());
       }
 
@@ -7172,9 +7514,9 @@ butil::Status TxnEngineHelper::DoReadSstFileForTxn(std::shared_ptr<Context> ctx,
       kv.set_key(iter->key().data(), iter->key().size());
       kv.set_value(iter->value().data(), iter->value().size());
       if (sst_meta.cf() == Constant::kTxnDataCF) {
-        kv_puts_data.emplace_back(kv);
+        kv_puts_data.emplace_back(std::move(kv));
       } else if (sst_meta.cf() == Constant::kTxnWriteCF) {
-        kv_puts_write.emplace_back(kv);
+        kv_puts_write.emplace_back(std::move(kv));
       } else {
         DINGO_LOG(FATAL) << "Unsupport cf: " << sst_meta.cf();
       }
@@ -7182,7 +7524,7 @@ butil::Status TxnEngineHelper::DoReadSstFileForTxn(std::shared_ptr<Context> ctx,
   }
   if (!kv_puts_data.empty() || !kv_puts_write.empty()) {
     butil_status = RestoreTxn(ctx, region, raft_engine, kv_puts_data, kv_puts_write);
-    if (BAIDU_UNLIKELY(!status.ok())) {
+    if (BAIDU_UNLIKELY(!butil_status.ok())) {
       DINGO_LOG(ERROR) << fmt::format(
           "[restoredata][region({})][region_type({})] RestoreTxn failed, status "
           "code: {}, "
@@ -7258,7 +7600,7 @@ butil::Status TxnEngineHelper::DoReadSstFileForNonTxn(
   // vector index must handle kv_default, kv_scalar, kv_table, and kv_scalar_speed_up simultaneously.
   if (!kv_default.empty() || !kv_scalar.empty() || !kv_table.empty() || !kv_scalar_speed_up.empty()) {
     butil_status = RestoreNonTxn(ctx, region, raft_engine, kv_default, kv_scalar, kv_table, kv_scalar_speed_up);
-    if (BAIDU_UNLIKELY(!status.ok())) {
+    if (BAIDU_UNLIKELY(!butil_status.ok())) {
       DINGO_LOG(ERROR) << fmt::format(
           "[restoredata] RestoreNontxn failed,  status code: {}, "
           "message: {}",
@@ -41,7 +41,12 @@ class TxnReader {
 
   butil::Status Init();
   butil::Status GetLockInfo(const std::string &key, pb::store::LockInfo &lock_info);
+  // lock_infos is aligned with keys, an unlocked key get an empty lock_info
+  butil::Status BatchGetLockInfo(const std::vector<std::string> &keys, std::vector<pb::store::LockInfo> &lock_infos);
   butil::Status GetDataValue(const std::string &key, std::string &value);
+  // keys is data cf key, values and key_states is aligned with keys
+  butil::Status BatchGetDataValue(const std::vector<std::string> &keys, std::vector<std::string> &values,
+                                  std::vector<bool> &key_states);
   butil::Status GetWriteInfo(int64_t min_commit_ts, int64_t max_commit_ts, int64_t start_ts, const std::string &key,
                              bool include_rollback, bool include_delete, bool include_put,
                              pb::store::WriteInfo &write_info, int64_t &commit_ts);
@@ -0,0 +1,184 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "engine/txn_lock_waiter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "bthread/mutex.h"
+#include "bvar/latency_recorder.h"
+#include "bvar/reducer.h"
+#include "common/helper.h"
+#include "common/logging.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+
+namespace dingodb {
+
+// waiter park the write worker, keep some workers for commit/rollback which release the lock.
+DEFINE_int64(txn_lock_wait_max_waiter_num, 64, "max waiter num of pessimistic lock wait");
+
+bvar::LatencyRecorder g_txn_lock_wait_latency("dingo_txn_lock_wait_latency");
+bvar::Adder<int64_t> g_txn_lock_wait_timeout_count("dingo_txn_lock_wait_timeout_count");
+bvar::Adder<int64_t> g_txn_lock_wait_deadlock_count("dingo_txn_lock_wait_deadlock_count");
+
+TxnLockWaiterManager& TxnLockWaiterManager::GetInstance() {
+  static TxnLockWaiterManager instance;
+  return instance;
+}
+
+TxnLockWaiterManager::TxnLockWaiterManager() { bthread_mutex_init(&mutex_, nullptr); }
+
+TxnLockWaiterManager::~TxnLockWaiterManager() { bthread_mutex_destroy(&mutex_); }
+
+bool TxnLockWaiterManager::IsWaitFor(int64_t lock_ts, int64_t start_ts) {
+  std::set<int64_t> visited;
+  std::vector<int64_t> stack = {lock_ts};
+  while (!stack.empty()) {
+    int64_t txn_ts = stack.back();
+    stack.pop_back();
+    if (txn_ts == start_ts) {
+      return true;
+    }
+    if (!visited.insert(txn_ts).second) {
+      continue;
+    }
+
+    auto it = wait_for_graph_.find(txn_ts);
+    if (it == wait_for_graph_.end()) {
+      continue;
+    }
+    for (const auto& [holder_ts, count] : it->second) {
+      stack.push_back(holder_ts);
+    }
+  }
+
+  return false;
+}
+
+void TxnLockWaiterManager::AddWaitFor(int64_t start_ts, int64_t lock_ts) { ++wait_for_graph_[start_ts][lock_ts]; }
+
+void TxnLockWaiterManager::RemoveWaitFor(int64_t start_ts, int64_t lock_ts) {
+  auto it = wait_for_graph_.find(start_ts);
+  if (it == wait_for_graph_.end()) {
+    return;
+  }
+
+  auto holder_it = it->second.find(lock_ts);
+  if (holder_it != it->second.end() && --holder_it->second <= 0) {
+    it->second.erase(holder_it);
+  }
+  if (it->second.empty()) {
+    wait_for_graph_.erase(it);
+  }
+}
+
+TxnLockWaiterManager::WaitResult TxnLockWaiterManager::Wait(const std::string& key, int64_t start_ts,
+                                                            int64_t lock_ts, int64_t check_time_us,
+                                                            int64_t timeout_ms) {
+  if (timeout_ms <= 0) {
+    return WaitResult::kTimeout;
+  }
+
+  auto waiter = std::make_shared<Waiter>();
+  waiter->start_ts = start_ts;
+  waiter->lock_ts = lock_ts;
+
+  {
+    BAIDU_SCOPED_LOCK(mutex_);
+    // the lock released between read lock and wait, not miss the wake up
+    if (release_times_[std::hash<std::string>{}(key) % kReleaseSlotNum] >= check_time_us) {
+      return WaitResult::kWakeUp;
+    }
+
+    if (waiter_count_ >= FLAGS_txn_lock_wait_max_waiter_num) {
+      DINGO_LOG(WARNING) << fmt::format("[txn][lock_wait] too many waiters({}), txn({}) not wait txn({}) key({})",
+                                        waiter_count_, start_ts, lock_ts, Helper::StringToHex(key));
+      return WaitResult::kTimeout;
+    }
+
+    if (IsWaitFor(lock_ts, start_ts)) {
+      g_txn_lock_wait_deadlock_count << 1;
+      DINGO_LOG(WARNING) << fmt::format("[txn][lock_wait] deadlock, txn({}) wait txn({}) key({}), abort the waiter",
+                                        start_ts, lock_ts, Helper::StringToHex(key));
+      return WaitResult::kDeadlock;
+    }
+
+    AddWaitFor(start_ts, lock_ts);
+    key_waiters_[key].push_back(waiter);
+    ++waiter_count_;
+  }
+
+  int64_t start_time_us = Helper::TimestampUs();
+  int ret = waiter->cond.TimedWait(timeout_ms * 1000);
+  g_txn_lock_wait_latency << Helper::TimestampUs() - start_time_us;
+
+  {
+    BAIDU_SCOPED_LOCK(mutex_);
+    RemoveWaitFor(start_ts, lock_ts);
+    --waiter_count_;
+
+    // waked up waiter is already removed from key_waiters_
+    auto it = key_waiters_.find(key);
+    if (it != key_waiters_.end()) {
+      auto& waiters = it->second;
+      waiters.erase(std::remove(waiters.begin(), waiters.end(), waiter), waiters.end());
+      if (waiters.empty()) {
+        key_waiters_.erase(it);
+      }
+    }
+  }
+
+  if (ret != 0) {
+    g_txn_lock_wait_timeout_count << 1;
+    return WaitResult::kTimeout;
+  }
+
+  return WaitResult::kWakeUp;
+}
+
+void TxnLockWaiterManager::WakeUp(const std::vector<std::string>& keys) {
+  std::vector<WaiterPtr> waiters;
+  int64_t now_us = Helper::TimestampUs();
+  {
+    BAIDU_SCOPED_LOCK(mutex_);
+    for (const auto& key : keys) {
+      release_times_[std::hash<std::string>{}(key) % kReleaseSlotNum] = now_us;
+
+      auto it = key_waiters_.find(key);
+      if (it == key_waiters_.end()) {
+        continue;
+      }
+
+      waiters.insert(waiters.end(), it->second.begin(), it->second.end());
+      key_waiters_.erase(it);
+    }
+  }
+
+  for (auto& waiter : waiters) {
+    waiter->cond.DecreaseSignal();
+  }
+}
+
+int64_t TxnLockWaiterManager::WaiterCount() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return waiter_count_;
+}
+
+}  // namespace dingodb
@@ -0,0 +1,94 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_ENGINE_TXN_LOCK_WAITER_H_  // NOLINT
+#define DINGODB_ENGINE_TXN_LOCK_WAITER_H_
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bthread/types.h"
+#include "common/synchronization.h"
+
+namespace dingodb {
+
+// Pessimistic lock request which meet the lock of other txn wait here until the lock released, instead of return
+// lock conflict to client at once and let client sleep and retry.
+// Commit/Rollback/ResolveLock/PessimisticRollback wake up the waiters of the released keys, the waiter check the lock
+// again, so spurious wake up is ok.
+// Keep a wait-for graph (waiter txn -> lock holder txn) of all waiters on this store, the waiter which make a cycle
+// is the deadlock victim, it not wait and return kDeadlock at once.
+class TxnLockWaiterManager {
+ public:
+  enum class WaitResult {
+    kWakeUp = 0,
+    kTimeout = 1,
+    kDeadlock = 2,
+  };
+
+  static TxnLockWaiterManager& GetInstance();
+
+  TxnLockWaiterManager(const TxnLockWaiterManager&) = delete;
+  TxnLockWaiterManager& operator=(const TxnLockWaiterManager&) = delete;
+
+  // txn start_ts wait the key locked by txn lock_ts released.
+  // check_time_us is the time before read the lock, if the key maybe released after it, return kWakeUp at once.
+  WaitResult Wait(const std::string& key, int64_t start_ts, int64_t lock_ts, int64_t check_time_us,
+                  int64_t timeout_ms);
+
+  // the locks of keys are released, wake up their waiters.
+  void WakeUp(const std::vector<std::string>& keys);
+
+  int64_t WaiterCount();
+
+ private:
+  TxnLockWaiterManager();
+  ~TxnLockWaiterManager();
+
+  struct Waiter {
+    int64_t start_ts;
+    int64_t lock_ts;
+    // count 1 is waiting, wake up set 0
+    BthreadCond cond{1};
+  };
+  using WaiterPtr = std::shared_ptr<Waiter>;
+
+  // whether txn lock_ts already wait for txn start_ts directly or indirectly, need hold mutex_.
+  bool IsWaitFor(int64_t lock_ts, int64_t start_ts);
+
+  void AddWaitFor(int64_t start_ts, int64_t lock_ts);
+  void RemoveWaitFor(int64_t start_ts, int64_t lock_ts);
+
+  static constexpr size_t kReleaseSlotNum = 1024;
+
+  bthread_mutex_t mutex_;
+
+  // last release time(us) of keys, key hash to slot
+  std::array<int64_t, kReleaseSlotNum> release_times_{};
+
+  // key -> waiters of the key
+  std::unordered_map<std::string, std::vector<WaiterPtr>> key_waiters_;
+  // wait-for graph, waiter txn -> (lock holder txn -> wait count)
+  std::map<int64_t, std::map<int64_t, int64_t>> wait_for_graph_;
+  int64_t waiter_count_{0};
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_ENGINE_TXN_LOCK_WAITER_H_  // NOLINT
@@ -14,6 +14,7 @@
 
 #include "handler/raft_apply_handler.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -39,6 +40,7 @@
 #include "glog/logging.h"
 #include "meta/store_meta_manager.h"
 #include "mvcc/codec.h"
+#include "mvcc/reader.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "proto/index.pb.h"
@@ -51,6 +53,20 @@ DECLARE_int32(init_election_timeout_ms);
 
 namespace dingodb {
 DECLARE_bool(dingo_log_switch_scalar_speed_up_detail);
+DECLARE_bool(enable_region_metrics_collect_key_count);
+
+// Scalar index is maintained by vector add/delete apply, raw write to speed up cf need rebuild it.
+static void ResetVectorScalarIndex(store::RegionPtr region, const std::string &cf_name) {
+  if (region == nullptr || region->Type() != pb::common::RegionType::INDEX_REGION ||
+      cf_name != Constant::kVectorScalarKeySpeedUpCF) {
+    return;
+  }
+
+  auto vector_index_wrapper = region->VectorIndexWrapper();
+  if (vector_index_wrapper != nullptr) {
+    vector_index_wrapper->ScalarIndex()->Reset();
+  }
+}
 
 int PutHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr region, std::shared_ptr<RawEngine> engine,
                        const pb::raft::Request &req, store::RegionMetricsPtr region_metrics, int64_t /*term_id*/,
@@ -72,19 +88,27 @@ int PutHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr region, st
     DINGO_LOG(FATAL) << fmt::format("[raft.apply][region({})] put failed, error: {}", region->Id(), status.error_str());
   }
 
+  ApplySideEffect(region, request, region_metrics);
+
   if (ctx) {
     ctx->SetStatus(status);
   }
 
-  // Update region metrics min/max key
+  return 0;
+}
+
+void PutHandler::ApplySideEffect(store::RegionPtr region, const pb::raft::PutRequest &request,
+                                 store::RegionMetricsPtr region_metrics) {
+  ResetVectorScalarIndex(region, request.cf_name());
+
+  // Update region metrics min/max key and key count
   if (BAIDU_LIKELY(region_metrics != nullptr)) {
     region_metrics->UpdateMaxAndMinKey(request.kvs());
+    region_metrics->UpdateKeyCount(request.kvs());
   }
-
-  return 0;
 }
 
-int DeleteRangeHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr /*region*/,
+int DeleteRangeHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr region,
                                std::shared_ptr<RawEngine> engine, const pb::raft::Request &req,
                                store::RegionMetricsPtr region_metrics, int64_t /*term_id*/, int64_t /*log_id*/) {
   butil::Status status;
@@ -102,24 +126,57 @@ int DeleteRangeHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr /*
     status = writer->KvBatchDeleteRange(range_with_cfs);
   }
 
+  ResetVectorScalarIndex(region, request.cf_name());
+
   if (ctx && ctx->Response()) {
     ctx->SetStatus(status);
   }
 
-  // Update region metrics min/max key policy
+  // Update region metrics min/max key policy, the deleted key count is unknown, so rebase key count
   if (region_metrics != nullptr) {
     region_metrics->UpdateMaxAndMinKeyPolicy(request.ranges());
+    region_metrics->SetNeedUpdateKeyCount(true);
   }
 
   return 0;
 }
 
+// Count the keys which exist before delete, delete a not exist key not change the key count.
+static int64_t CountExistKeys(std::shared_ptr<RawEngine> engine, const pb::raft::DeleteBatchRequest &request) {
+  std::vector<std::string> plain_keys;
+  plain_keys.reserve(request.keys().size());
+  for (const auto &key : request.keys()) {
+    std::string plain_key;
+    mvcc::Codec::DecodeKey(key, plain_key);
+    plain_keys.push_back(std::move(plain_key));
+  }
+  std::sort(plain_keys.begin(), plain_keys.end());
+  plain_keys.erase(std::unique(plain_keys.begin(), plain_keys.end()), plain_keys.end());
+
+  std::vector<std::string> plain_values;
+  std::vector<bool> key_states;
+  auto status = mvcc::KvReader::New(engine->Reader())->KvBatchGet(request.cf_name(), 0, plain_keys, plain_values,
+                                                                    key_states);
+  if (!status.ok()) {
+    DINGO_LOG(WARNING) << fmt::format("[raft.apply] count exist keys failed, error: {}", status.error_str());
+    return static_cast<int64_t>(plain_keys.size());
+  }
+
+  return std::count(key_states.begin(), key_states.end(), true);
+}
+
 int DeleteBatchHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr region, std::shared_ptr<RawEngine> engine,
                                const pb::raft::Request &req, store::RegionMetricsPtr region_metrics,
                                int64_t /*term_id*/, int64_t /*log_id*/) {
   butil::Status status;
   const auto &request = req.delete_batch();
 
+  // must count before write the delete mark
+  int64_t exist_key_count = 0;
+  if (region_metrics != nullptr && FLAGS_enable_region_metrics_collect_key_count) {
+    exist_key_count = CountExistKeys(engine, request);
+  }
+
   auto writer = engine->Writer();
 
   if (request.keys().size() == 1) {
@@ -145,13 +202,16 @@ int DeleteBatchHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr re
                                     status.error_str());
   }
 
+  ResetVectorScalarIndex(region, request.cf_name());
+
   if (ctx && ctx->Response()) {
     ctx->SetStatus(status);
   }
 
-  // Update region metrics min/max key policy
+  // Update region metrics min/max key policy and key count, every key put a delete mark version
   if (region_metrics != nullptr) {
     region_metrics->UpdateMaxAndMinKeyPolicy(request.keys());
+    region_metrics->AddKeyCountDelta(-exist_key_count, request.keys().size());
   }
 
   return 0;
@@ -1065,7 +1125,7 @@ int VectorAddHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr regi
       pb::common::KeyValue kv;
 
       kv.set_key(encode_key_with_ts);
-      std::string value = vector.vector().SerializeAsString();
+      std::string value = VectorCodec::EncodeVectorValue(vector.vector());
       if (req.ttl() == 0) {
         mvcc::Codec::PackageValue(mvcc::ValueFlag::kPut, value);
       } else {
@@ -1155,6 +1215,14 @@ int VectorAddHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr regi
   int64_t vector_index_id = vector_index_wrapper->Id();
   bool is_ready = vector_index_wrapper->IsReady();
 
+  // Handle scalar index
+  if (status.ok()) {
+    auto scalar_index = vector_index_wrapper->ScalarIndex();
+    for (const auto &vector : request.vectors()) {
+      scalar_index->Upsert(vector.id(), vector.scalar_data(), ts);
+    }
+  }
+
   if (is_ready) {
     // Check if the log_id is greater than the ApplyLogIndex of the vector index
     if (log_id > vector_index_wrapper->ApplyLogId() ||
@@ -1276,6 +1344,12 @@ int VectorDeleteHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr r
   auto vector_index_wrapper = region->VectorIndexWrapper();
   int64_t vector_index_id = vector_index_wrapper->Id();
   bool is_ready = vector_index_wrapper->IsReady();
+
+  // Handle scalar index
+  if (status.ok()) {
+    vector_index_wrapper->ScalarIndex()->Delete(Helper::PbRepeatedToVector(request.ids()), ts);
+  }
+
   if (is_ready && !request.ids().empty()) {
     if (log_id > vector_index_wrapper->ApplyLogId() ||
         region->GetStoreEngineType() == pb::common::STORE_ENG_MONO_STORE) {
@@ -1395,6 +1469,9 @@ int VectorBatchAddHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr
   int64_t vector_index_id = vector_index_wrapper->Id();
   bool is_ready = vector_index_wrapper->IsReady();
 
+  // Batch add write raw kvs, rebuild scalar index at next search
+  vector_index_wrapper->ScalarIndex()->Reset();
+
   if (is_ready) {
     // Check if the log_id is greater than the ApplyLogIndex of the vector index
     if (log_id > vector_index_wrapper->ApplyLogId() ||
@@ -32,6 +32,10 @@ class PutHandler : public BaseHandler {
   int Handle(std::shared_ptr<Context> ctx, store::RegionPtr region, std::shared_ptr<RawEngine> engine,
              const pb::raft::Request &req, store::RegionMetricsPtr region_metrics, int64_t term_id,
              int64_t log_id) override;
+
+  // Side effects of the put out of raw engine, also used by the state machine batch apply.
+  static void ApplySideEffect(store::RegionPtr region, const pb::raft::PutRequest &request,
+                              store::RegionMetricsPtr region_metrics);
 };
 
 // DeleteRangeRequest
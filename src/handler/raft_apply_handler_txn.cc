@@ -40,7 +40,7 @@ DECLARE_bool(dingo_log_switch_txn_detail);
 void TxnHandler::HandleMultiCfPutAndDeleteRequest(std::shared_ptr<Context> ctx, store::RegionPtr region,
                                                   std::shared_ptr<RawEngine> engine,
                                                   const pb::raft::MultiCfPutAndDeleteRequest &request,
-                                                  [[maybe_unused]] store::RegionMetricsPtr region_metrics,
+                                                  store::RegionMetricsPtr region_metrics,
                                                   int64_t term_id, int64_t log_id) {
   DINGO_LOG(DEBUG) << fmt::format("[txn][region({})] HandleMultiCfPutAndDelete, term: {} apply_log_id: {}",
                                   region->Id(), term_id, log_id)
@@ -100,6 +100,11 @@ void TxnHandler::HandleMultiCfPutAndDeleteRequest(std::shared_ptr<Context> ctx,
           "[txn][region({})] HandleMultiCfPutAndDelete fail, term: {} apply_log_id: {}, error: {} request: {}.",
           region->Id(), term_id, log_id, status.error_str(), request.ShortDebugString());
     }
+
+    // Update region metrics key count
+    if (region_metrics != nullptr) {
+      region_metrics->UpdateKeyCount(kv_puts_with_cf, kv_deletes_with_cf);
+    }
   }
 
   auto tracker = ctx ? ctx->Tracker() : nullptr;
@@ -257,7 +262,7 @@ void TxnHandler::HandleMultiCfPutAndDeleteRequest(std::shared_ptr<Context> ctx,
 void TxnHandler::HandleTxnDeleteRangeRequest(std::shared_ptr<Context> ctx, store::RegionPtr region,
                                              std::shared_ptr<RawEngine> engine,
                                              const pb::raft::TxnDeleteRangeRequest &request,
-                                             store::RegionMetricsPtr /*region_metrics*/, int64_t term_id,
+                                             store::RegionMetricsPtr region_metrics, int64_t term_id,
                                              int64_t log_id) {
   DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_txn_detail)
       << fmt::format("[txn][region({})] HandleTxnDeleteRange, term: {} apply_log_id: {}", region->Id(), term_id, log_id)
@@ -289,6 +294,11 @@ void TxnHandler::HandleTxnDeleteRangeRequest(std::shared_ptr<Context> ctx, store
                                     term_id, log_id)
                      << ", write failed, request: " << request.ShortDebugString() << ", status: " << status.error_str();
   }
+
+  // the deleted key count is unknown, so rebase key count
+  if (region_metrics != nullptr) {
+    region_metrics->SetNeedUpdateKeyCount(true);
+  }
 }
 
 int TxnHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr region, std::shared_ptr<RawEngine> engine,
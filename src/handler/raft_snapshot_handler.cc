@@ -527,6 +527,9 @@ int RaftLoadSnapshotHandler::Handle(store::RegionPtr region, std::shared_ptr<Raw
       return -1;
     }
 
+    // region data is replaced, rebuild scalar index at next search
+    vector_index_wrapper->ScalarIndex()->Reset();
+
     if (!vector_index_wrapper->IsPermanentHoldVectorIndex(vector_index_wrapper->Id()) &&
         !vector_index_wrapper->IsTempHoldVectorIndex()) {
       DINGO_LOG(INFO) << fmt::format("[raft.snapshot][region({})] vector index is not hold, skip load.", region->Id());
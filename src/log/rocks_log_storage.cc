@@ -229,6 +229,8 @@ std::string ClientTypeName(ClientType client_type) {
       return "Raft";
     case ClientType::kVectorIndex:
       return "VectorIndex";
+    case ClientType::kDocumentIndex:
+      return "DocumentIndex";
     default:
       break;
   }
@@ -671,6 +673,19 @@ bool RocksLogStorage::RegisterRegion(int64_t region_id) {
         log_index_meta.truncate_prefixs.push_back(std::make_pair(client_type, 0));
       }
       log_index_metas_.insert(std::make_pair(region_id, log_index_meta));
+    } else {
+      // region meta saved before client type registered, e.g. upgrade.
+      for (auto& client_type : client_types_) {
+        auto& truncate_prefixs = it->second.truncate_prefixs;
+        if (std::none_of(truncate_prefixs.begin(), truncate_prefixs.end(),
+                         [client_type](const auto& truncate_prefix) { return truncate_prefix.first == client_type; })) {
+          is_save = true;
+          truncate_prefixs.push_back(std::make_pair(client_type, 0));
+        }
+      }
+      if (is_save) {
+        log_index_meta = it->second;
+      }
     }
   }
 
@@ -43,6 +43,7 @@ namespace wal {
 enum class ClientType {
   kRaft,
   kVectorIndex,
+  kDocumentIndex,
 };
 
 std::string ClientTypeName(ClientType client_type);
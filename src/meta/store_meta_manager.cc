@@ -32,6 +32,7 @@
 #include "common/synchronization.h"
 #include "config/config_helper.h"
 #include "engine/gc_safe_point.h"
+#include "engine/rocks_gc_compaction_filter.h"
 #include "fmt/core.h"
 #include "mvcc/codec.h"
 #include "proto/common.pb.h"
@@ -834,6 +835,9 @@ void StoreRegionMeta::AddRegion(store::RegionPtr region) {
     return;
   }
 
+  // the safe point ts of compaction filter gc may not include the tenant of new region
+  rocks::MvccGcCompactionFilterFactory::CheckTenant(region->Definition().tenant_id());
+
   region->AppendHistoryState(pb::common::StoreRegionState::NEW);
   regions_.Put(region->Id(), region);
 
@@ -31,7 +31,9 @@ class StoreBvarMetrics {
       : leader_switch_time_("dingo_metrics_store_raft_leader_switch_time", {"region"}),
         leader_switch_count_("dingo_metrics_store_raft_leader_switch_count", {"region"}),
         commit_count_per_second_("dingo_metrics_store_raft_commit_count_per_second", {"region"}),
-        apply_count_per_second_("dingo_metrics_store_raft_apply_count_per_second", {"region"}) {}
+        apply_count_per_second_("dingo_metrics_store_raft_apply_count_per_second", {"region"}),
+        block_cache_hit_count_("dingo_metrics_store_block_cache_hit_count", {"cf"}),
+        block_cache_miss_count_("dingo_metrics_store_block_cache_miss_count", {"cf"}) {}
   ~StoreBvarMetrics() = default;
 
   StoreBvarMetrics(const StoreBvarMetrics&) = delete;
@@ -67,6 +69,15 @@ class StoreBvarMetrics {
     }
   }
 
+  // counter of column family, lookup once and keep it, not delete
+  bvar::Adder<int64_t>* GetBlockCacheHitCounter(const std::string& cf_name) {
+    return block_cache_hit_count_.get_stats({cf_name});
+  }
+
+  bvar::Adder<int64_t>* GetBlockCacheMissCounter(const std::string& cf_name) {
+    return block_cache_miss_count_.get_stats({cf_name});
+  }
+
   void DeleteMetrics(std::string region_id) {
     if (leader_switch_time_.has_stats({region_id})) {
       leader_switch_time_.delete_stats({region_id});
@@ -87,6 +98,8 @@ class StoreBvarMetrics {
   bvar::MultiDimension<bvar::Status<int64_t>> leader_switch_count_;
   bvar::MultiDimension<bvar::PerSecondEx<bvar::Adder<int64_t>>> commit_count_per_second_;
   bvar::MultiDimension<bvar::PerSecondEx<bvar::Adder<int64_t>>> apply_count_per_second_;
+  bvar::MultiDimension<bvar::Adder<int64_t>> block_cache_hit_count_;
+  bvar::MultiDimension<bvar::Adder<int64_t>> block_cache_miss_count_;
 };
 
 }  // namespace dingodb
@@ -14,6 +14,7 @@
 
 #include "metrics/store_metrics_manager.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -31,6 +32,7 @@
 #include "mvcc/codec.h"
 #include "mvcc/reader.h"
 #include "proto/common.pb.h"
+#include "proto/store.pb.h"
 #include "server/server.h"
 
 namespace dingodb {
@@ -40,6 +42,9 @@ DEFINE_double(min_system_memory_capacity_free_ratio, 0.10, "Min system memory ca
 DEFINE_bool(enable_region_metrics_collect_key_count, true, "Enable region metrics collect key count");
 DEFINE_bool(enable_region_metrics_collect_key_max, false, "Enable region metrics collect key max");
 DEFINE_bool(enable_region_metrics_collect_key_min, false, "Enable region metrics collect key min");
+DEFINE_int64(region_metrics_key_count_rebase_interval_s, 600,
+             "Region key count is maintained by apply delta, rebase it by sst range properties at this interval, "
+             "every region is jittered in [interval/2, interval*3/2]");
 
 namespace store {
 
@@ -89,6 +94,79 @@ void RegionMetrics::UpdateMaxAndMinKey(const PbKeyValues& kvs) {
   }
 }
 
+static int64_t GenNextRebaseKeyCountTimestamp() {
+  int64_t interval_ms = std::max(int64_t(1), FLAGS_region_metrics_key_count_rebase_interval_s) * 1000;
+  return Helper::TimestampMs() + Helper::GenerateRealRandomInteger(interval_ms / 2, interval_ms * 3 / 2);
+}
+
+void RegionMetrics::SetKeyCount(int64_t key_count) {
+  int64_t next_rebase_timestamp = GenNextRebaseKeyCountTimestamp();
+
+  BAIDU_SCOPED_LOCK(mutex_);
+  inner_region_metrics_.set_row_count(key_count);
+  key_count_delta_ = 0;
+  need_update_key_count_ = false;
+  next_rebase_key_count_timestamp_ = next_rebase_timestamp;
+}
+
+void RegionMetrics::RebaseKeyCount(int64_t key_count, int64_t version_count) {
+  int64_t next_rebase_timestamp = GenNextRebaseKeyCountTimestamp();
+
+  BAIDU_SCOPED_LOCK(mutex_);
+  inner_region_metrics_.set_row_count(key_count);
+  version_count_ = version_count;
+  key_count_delta_ = 0;
+  version_count_delta_ = 0;
+  need_update_key_count_ = false;
+  next_rebase_key_count_timestamp_ = next_rebase_timestamp;
+}
+
+void RegionMetrics::UpdateKeyCount(const PbKeyValues& kvs) {
+  int64_t key_count_delta = 0;
+  for (const auto& kv : kvs) {
+    if (mvcc::Codec::GetValueFlag(kv.value()) == mvcc::ValueFlag::kDelete) {
+      --key_count_delta;
+    } else {
+      ++key_count_delta;
+    }
+  }
+
+  AddKeyCountDelta(key_count_delta, kvs.size());
+}
+
+void RegionMetrics::UpdateKeyCount(const std::map<std::string, std::vector<pb::common::KeyValue>>& kv_puts_with_cf,
+                                   const std::map<std::string, std::vector<std::string>>& kv_deletes_with_cf) {
+  int64_t key_count_delta = 0;
+  int64_t version_count_delta = 0;
+
+  // commit put a write record, the op of write info decide put or delete the key.
+  auto puts_it = kv_puts_with_cf.find(Constant::kTxnWriteCF);
+  if (puts_it != kv_puts_with_cf.end()) {
+    version_count_delta += static_cast<int64_t>(puts_it->second.size());
+    for (const auto& kv : puts_it->second) {
+      pb::store::WriteInfo write_info;
+      if (!write_info.ParseFromString(kv.value())) {
+        continue;
+      }
+      if (write_info.op() == pb::store::Op::Put) {
+        ++key_count_delta;
+      } else if (write_info.op() == pb::store::Op::Delete) {
+        --key_count_delta;
+      }
+    }
+  }
+
+  // gc only delete the old write record, the newest version is kept, so not change key count.
+  auto deletes_it = kv_deletes_with_cf.find(Constant::kTxnWriteCF);
+  if (deletes_it != kv_deletes_with_cf.end()) {
+    version_count_delta -= static_cast<int64_t>(deletes_it->second.size());
+  }
+
+  if (key_count_delta != 0 || version_count_delta != 0) {
+    AddKeyCountDelta(key_count_delta, version_count_delta);
+  }
+}
+
 void RegionMetrics::UpdateMaxAndMinKeyPolicy(const PbKeys& keys) {
   BAIDU_SCOPED_LOCK(mutex_);
 
@@ -286,7 +364,7 @@ std::string StoreRegionMetrics::GetRegionMaxKey(store::RegionPtr region) {
 }
 
 int64_t StoreRegionMetrics::GetRegionKeyCount(store::RegionPtr region) {
-  // todo: support txn
+  // txn region key count is estimated in RebaseRegionKeyCount
   if (region->IsTxn()) {
     DINGO_LOG(WARNING) << fmt::format("[metrics.region][region({})] Not support txn region.", region->Id());
     return 0;
@@ -315,6 +393,50 @@ int64_t StoreRegionMetrics::GetRegionKeyCount(store::RegionPtr region) {
   return count;
 }
 
+void StoreRegionMetrics::RebaseRegionKeyCount(store::RegionPtr region, store::RegionMetricsPtr region_metrics) {
+  auto raw_engine = Server::GetInstance().GetRawEngine(region->GetRawEngineType());
+
+  // the sample of sst not contain memtable, and the version of one key in different level is counted repeatedly,
+  // so it is just a estimate.
+  const std::string& cf_name = region->IsTxn() ? Constant::kTxnWriteCF : Constant::kStoreDataCF;
+  std::vector<RawEngine::RangeSample> samples;
+  auto status = raw_engine->GetRangeSamples({cf_name}, region->Range(true), samples);
+  bool is_estimated = status.ok();
+  int64_t key_count = 0;
+  int64_t version_count = 0;
+  for (const auto& sample : samples) {
+    // the sst is written by old version collector, not has key count
+    if (sample.key_count < 0) {
+      is_estimated = false;
+      break;
+    }
+    key_count += sample.key_count;
+    version_count += sample.count;
+  }
+
+  if (is_estimated) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[metrics.region][region({})] rebase key count, key_count({}/{}) version_count({}/{}).", region->Id(),
+        region_metrics->KeyCount(), key_count, region_metrics->VersionCount(), version_count);
+    region_metrics->RebaseKeyCount(key_count, version_count);
+    return;
+  }
+
+  DINGO_LOG(WARNING) << fmt::format(
+      "[metrics.region][region({})] estimate key count by range properties failed, error: {}", region->Id(),
+      status.ok() ? "sample without key count" : status.error_str());
+
+  // the delta is relative to an unknown base, only full count can correct it.
+  if (!region->IsTxn() && region_metrics->NeedUpdateKeyCount()) {
+    region_metrics->SetKeyCount(GetRegionKeyCount(region));
+    return;
+  }
+
+  // keep the value maintained by delta, and retry at the next rebase time.
+  key_count = region_metrics->ApplyKeyCountDelta();
+  region_metrics->RebaseKeyCount(key_count, region_metrics->VersionCount());
+}
+
 std::vector<std::pair<int64_t, int64_t>> StoreRegionMetrics::GetRegionApproximateSize(
     std::vector<store::RegionPtr> regions) {
   std::vector<pb::common::Range> ranges;
@@ -551,12 +673,13 @@ bool StoreRegionMetrics::CollectMetrics() {
       }
     }
 
-    // Get region key counts
+    // Get region key counts, maintained by the delta of apply, only rebase when needed.
     if (FLAGS_enable_region_metrics_collect_key_count) {
-      if (region_metrics->NeedUpdateKeyCount()) {
-        region_metrics->SetKeyCount(GetRegionKeyCount(region));
+      if (region_metrics->NeedUpdateKeyCount() ||
+          Helper::TimestampMs() >= region_metrics->NextRebaseKeyCountTimestamp()) {
+        RebaseRegionKeyCount(region, region_metrics);
       } else {
-        region_metrics->SetNeedUpdateKeyCount(true);
+        region_metrics->ApplyKeyCountDelta();
       }
     }
 
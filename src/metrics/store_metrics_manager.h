@@ -17,8 +17,10 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -60,6 +62,9 @@ class RegionMetrics {
     // UpdateMaxAndMinKeyPolicy
     need_update_min_key_ = true;
     need_update_max_key_ = true;
+
+    // the key count delta is relative to the old range, rebase it
+    need_update_key_count_ = true;
   }
 
   int64_t LastLogIndex() {
@@ -197,9 +202,40 @@ class RegionMetrics {
     return inner_region_metrics_.row_count();
   }
 
-  void SetKeyCount(int64_t key_count) {
+  // Set key count by full count, discard the recorded key count delta and schedule the next rebase.
+  void SetKeyCount(int64_t key_count);
+
+  int64_t VersionCount() {
+    BAIDU_SCOPED_LOCK(mutex_);
+    return version_count_;
+  }
+
+  // Reset key count and version count by the estimate of sst range properties, discard the recorded delta
+  // and schedule the next rebase.
+  void RebaseKeyCount(int64_t key_count, int64_t version_count);
+
+  int64_t NextRebaseKeyCountTimestamp() {
     BAIDU_SCOPED_LOCK(mutex_);
-    inner_region_metrics_.set_row_count(key_count);
+    return next_rebase_key_count_timestamp_;
+  }
+
+  // Record the delta of key count and mvcc version count when apply write, it is approximate,
+  // e.g. put a exist key is counted as a new key, the drift is corrected by RebaseKeyCount.
+  void AddKeyCountDelta(int64_t key_count_delta, int64_t version_count_delta) {
+    BAIDU_SCOPED_LOCK(mutex_);
+    key_count_delta_ += key_count_delta;
+    version_count_delta_ += version_count_delta;
+  }
+
+  // Fold the recorded delta into key count and version count, return the key count.
+  int64_t ApplyKeyCountDelta() {
+    BAIDU_SCOPED_LOCK(mutex_);
+    inner_region_metrics_.set_row_count(std::max(int64_t(0), inner_region_metrics_.row_count() + key_count_delta_));
+    version_count_ = std::max(int64_t(0), version_count_ + version_count_delta_);
+    key_count_delta_ = 0;
+    version_count_delta_ = 0;
+
+    return inner_region_metrics_.row_count();
   }
 
   // vector index start
@@ -279,6 +315,12 @@ class RegionMetrics {
   void UpdateMaxAndMinKeyPolicy(const PbRanges& ranges);
   void UpdateMaxAndMinKeyPolicy();
 
+  // Record key count delta of raw kv write, the value flag of mvcc value decide put or delete.
+  void UpdateKeyCount(const PbKeyValues& kvs);
+  // Record key count delta of txn write, only the commit/gc of write cf change the key count.
+  void UpdateKeyCount(const std::map<std::string, std::vector<pb::common::KeyValue>>& kv_puts_with_cf,
+                      const std::map<std::string, std::vector<std::string>>& kv_deletes_with_cf);
+
  private:
   // update metrics until raft log index
   int64_t last_log_index_{0};
@@ -288,8 +330,15 @@ class RegionMetrics {
   bool need_update_min_key_{true};
   // need update region max key
   bool need_update_max_key_{true};
-  // need update region key count
+  // need rebase region key count
   bool need_update_key_count_{true};
+  // the delta of key count/version count since last collect, recorded by apply handler
+  int64_t key_count_delta_{0};
+  int64_t version_count_delta_{0};
+  // region mvcc version count, include delete mark and old version, only in memory
+  int64_t version_count_{0};
+  // the timestamp(ms) of next rebase key count, jittered so regions not rebase at the same time
+  int64_t next_rebase_key_count_timestamp_{0};
 
   pb::common::RegionMetrics inner_region_metrics_;
   // protect inner_region_metrics_
@@ -354,8 +403,9 @@ class StoreRegionMetrics : public TransformKvAble {
   std::shared_ptr<pb::common::KeyValue> TransformToKv(std::any obj) override;
   void TransformFromKv(const std::vector<pb::common::KeyValue>& kvs) override;
 
-  // TODO: later optimize
   static int64_t GetRegionKeyCount(store::RegionPtr region);
+  // Rebase key count and version count by the sst range properties, fall back to full count for raw region.
+  static void RebaseRegionKeyCount(store::RegionPtr region, store::RegionMetricsPtr region_metrics);
   static std::vector<std::pair<int64_t, int64_t>> GetRegionApproximateSize(std::vector<store::RegionPtr> regions);
 
   // Read meta data from persistence storage.
@@ -179,6 +179,24 @@ std::string_view Codec::TruncateTsForKey(const std::string_view& encode_key_with
   return encode_key_with_ts.substr(0, encode_key_with_ts.size() - 8);
 }
 
+size_t Codec::GetEncodeBytesLength(const std::string_view& encode_key) {
+  size_t length = 0;
+  if (encode_key.size() >= kPadGroupSize && encode_key.size() % kPadGroupSize == 0) {
+    length = encode_key.size();
+  } else if (encode_key.size() >= kValidEncodeKeyMinLength && (encode_key.size() - kTsLength) % kPadGroupSize == 0) {
+    length = encode_key.size() - kTsLength;
+  } else {
+    return 0;
+  }
+
+  // the last group marker must not be kMarker
+  if (static_cast<uint8_t>(encode_key[length - 1]) == kMarker) {
+    return 0;
+  }
+
+  return length;
+}
+
 int64_t Codec::TruncateKeyForTs(const std::string& encode_key_with_ts) {
   CHECK(encode_key_with_ts.size() >= kValidEncodeKeyMinLength)
       << fmt::format("Key({}) is invalid.", Helper::StringToHex(encode_key_with_ts));
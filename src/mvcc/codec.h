@@ -59,6 +59,10 @@ class Codec {
   static std::string_view TruncateTsForKey(const std::string& encode_key_with_ts);
   static std::string_view TruncateTsForKey(const std::string_view& encode_key_with_ts);
 
+  // get the length of EncodeBytes part, encode key may be with ts or without ts
+  // return 0 when it is not a valid encode key
+  static size_t GetEncodeBytesLength(const std::string_view& encode_key);
+
   // truncate key from ts
   // encode key: plain_key|ts: 8bytes
   static int64_t TruncateKeyForTs(const std::string& encode_key_with_ts);
@@ -19,11 +19,16 @@
 
 #include "butil/status.h"
 #include "common/helper.h"
+#include "common/serial_helper.h"
+#include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "mvcc/codec.h"
 
 namespace dingodb {
 
+DEFINE_int64(mvcc_max_sequential_skip_in_iterations, 8,
+             "max sequential skip versions of the same key before reseek on mvcc iterate");
+
 namespace mvcc {
 
 bool Iterator::Valid() const {
@@ -88,29 +93,54 @@ butil::Status Iterator::Status() const { return butil::Status::OK(); }
 // 1. key > ts
 // 2. deleted key
 // 3. ttl expires
+// when skip too many versions of the same key, reseek instead of next step by step.
 void Iterator::NextVisibleKey() {
-  for (; iter_->Valid(); iter_->Next()) {
+  int64_t sequential_skip_count = 0;
+  while (iter_->Valid()) {
     auto key = iter_->Key();
     auto encode_key = Codec::TruncateTsForKey(key);
     if (encode_key == prev_encode_key_) {
+      // older version of the already visited key, seek to next key
+      if (++sequential_skip_count > FLAGS_mvcc_max_sequential_skip_in_iterations) {
+        sequential_skip_count = 0;
+        ++reseek_count_;
+        iter_->Seek(Helper::PrefixNext(prev_encode_key_));
+      } else {
+        ++skip_version_count_;
+        iter_->Next();
+      }
       continue;
     }
 
     int64_t ts = Codec::TruncateKeyForTs(key);
     if (ts > ts_) {
+      // newer version than read ts, seek to the version of read ts
+      if (++sequential_skip_count > FLAGS_mvcc_max_sequential_skip_in_iterations) {
+        sequential_skip_count = 0;
+        ++reseek_count_;
+        std::string seek_key(encode_key);
+        SerialHelper::WriteLongWithNegation(ts_, seek_key);
+        iter_->Seek(seek_key);
+      } else {
+        ++skip_version_count_;
+        iter_->Next();
+      }
       continue;
     }
 
     prev_encode_key_ = encode_key;
+    sequential_skip_count = 0;
 
     auto value = iter_->Value();
     auto flag = Codec::GetValueFlag(value);
     if (flag == ValueFlag::kDelete) {
+      iter_->Next();
       continue;
 
     } else if (flag == ValueFlag::kPutTTL) {
       int64_t ttl = Codec::GetValueTTL(value);
       if (ttl < now_time_) {
+        iter_->Next();
         continue;
       }
     }
@@ -49,6 +49,10 @@ class Iterator : public dingodb::Iterator {
 
   butil::Status Status() const override;
 
+  // versions skipped by step next and reseek count, for observe the effect of reseek
+  int64_t SkipVersionCount() const { return skip_version_count_; }
+  int64_t ReseekCount() const { return reseek_count_; }
+
  private:
   void NextVisibleKey();
   void PrevVisibleKey();
@@ -70,6 +74,10 @@ class Iterator : public dingodb::Iterator {
   // used by forward iterate
   std::string key_;
   std::string value_;
+
+  // statistics
+  int64_t skip_version_count_{0};
+  int64_t reseek_count_{0};
 };
 
 using IteratorPtr = std::shared_ptr<Iterator>;
@@ -14,16 +14,19 @@
 
 #include "mvcc/reader.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "butil/status.h"
 #include "common/helper.h"
 #include "common/logging.h"
 #include "document/codec.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "mvcc/codec.h"
 #include "mvcc/iterator.h"
 #include "vector/codec.h"
@@ -32,6 +35,88 @@ namespace dingodb {
 
 namespace mvcc {
 
+DEFINE_int64(mvcc_batch_get_max_sequential_next, 8, "max next step before reseek on mvcc batch get");
+
+// Point lookup a batch of plain keys with one raw iterator, so all keys share one snapshot.
+// Keys are visited in encode order and the iterator only moves forward, for dense keys
+// it steps with Next() to the following key instead of reseeking.
+static butil::Status BatchGetVisibleValue(RawEngine::ReaderPtr reader, const std::string& cf_name, int64_t ts,
+                                          const std::vector<std::string>& plain_keys,
+                                          std::vector<std::string>& plain_values, std::vector<bool>& key_states) {
+  plain_values.clear();
+  plain_values.resize(plain_keys.size());
+  key_states.clear();
+  key_states.resize(plain_keys.size(), false);
+  if (plain_keys.empty()) {
+    return butil::Status();
+  }
+
+  // encode key -> index of plain_keys
+  std::vector<std::pair<std::string, size_t>> encode_keys;
+  encode_keys.reserve(plain_keys.size());
+  for (size_t i = 0; i < plain_keys.size(); ++i) {
+    if (BAIDU_UNLIKELY(plain_keys[i].empty())) {
+      return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
+    }
+    encode_keys.emplace_back(Codec::EncodeBytes(plain_keys[i]), i);
+  }
+  std::sort(encode_keys.begin(), encode_keys.end());
+
+  dingodb::IteratorOptions options;
+  options.upper_bound = Helper::PrefixNext(encode_keys.back().first);
+
+  ts = ts > 0 ? ts : INT64_MAX;
+  int64_t now_time = Helper::TimestampMs();
+  auto iter = reader->NewIterator(cf_name, options);
+  for (size_t i = 0; i < encode_keys.size(); ++i) {
+    const auto& [encode_key, index] = encode_keys[i];
+    if (i > 0 && encode_key == encode_keys[i - 1].first) {
+      size_t prev_index = encode_keys[i - 1].second;
+      plain_values[index] = plain_values[prev_index];
+      key_states[index] = key_states[prev_index];
+      continue;
+    }
+
+    if (i == 0) {
+      iter->Seek(encode_key);
+    } else {
+      for (int64_t step = 0; iter->Valid() && iter->Key() < encode_key; ++step) {
+        if (step >= FLAGS_mvcc_batch_get_max_sequential_next) {
+          iter->Seek(encode_key);
+          break;
+        }
+        iter->Next();
+      }
+    }
+    if (!iter->Valid()) {
+      // remain keys are all beyond the last key
+      break;
+    }
+
+    for (; iter->Valid(); iter->Next()) {
+      auto key = iter->Key();
+      if (Codec::TruncateTsForKey(key) != encode_key) {
+        break;
+      }
+
+      if (Codec::TruncateKeyForTs(key) > ts) {
+        continue;
+      }
+
+      // the newest visible version decide the key, deleted or expired means not found
+      auto value = iter->Value();
+      auto flag = Codec::GetValueFlag(value);
+      if (flag == ValueFlag::kPut || (flag == ValueFlag::kPutTTL && Codec::GetValueTTL(value) >= now_time)) {
+        plain_values[index] = Codec::UnPackageValue(value);
+        key_states[index] = true;
+      }
+      break;
+    }
+  }
+
+  return iter->Status();
+}
+
 butil::Status KvReader::KvGet(const std::string& cf_name, int64_t ts, const std::string& plain_key,
                               std::string& plain_value) {
   if (plain_key.empty()) {
@@ -40,8 +125,9 @@ butil::Status KvReader::KvGet(const std::string& cf_name, int64_t ts, const std:
 
   std::string encode_key = Codec::EncodeBytes(plain_key);
 
+  // upper bound has the same user key prefix, so prefix bloom filter can be used.
   dingodb::IteratorOptions options;
-  options.upper_bound = Helper::PrefixNext(encode_key);
+  options.upper_bound = Codec::EncodeKey(plain_key, 0);
 
   ts = ts > 0 ? ts : INT64_MAX;
   auto iter = std::make_shared<mvcc::Iterator>(ts, reader_->NewIterator(cf_name, options));
@@ -55,6 +141,12 @@ butil::Status KvReader::KvGet(const std::string& cf_name, int64_t ts, const std:
   return butil::Status().OK();
 }
 
+butil::Status KvReader::KvBatchGet(const std::string& cf_name, int64_t ts,
+                                   const std::vector<std::string>& plain_keys, std::vector<std::string>& plain_values,
+                                   std::vector<bool>& key_states) {
+  return BatchGetVisibleValue(reader_, cf_name, ts, plain_keys, plain_values, key_states);
+}
+
 butil::Status KvReader::KvScan(const std::string& cf_name, int64_t ts, const std::string& plain_start_key,
                                const std::string& plain_end_key, std::vector<pb::common::KeyValue>& plain_kvs) {
   if (BAIDU_UNLIKELY(plain_start_key.empty())) {
@@ -218,8 +310,9 @@ butil::Status VectorReader::KvGet(const std::string& cf_name, int64_t ts, const
 
   std::string encode_key = Codec::EncodeBytes(plain_key);
 
+  // upper bound has the same user key prefix, so prefix bloom filter can be used.
   dingodb::IteratorOptions options;
-  options.upper_bound = Helper::PrefixNext(encode_key);
+  options.upper_bound = Codec::EncodeKey(plain_key, 0);
 
   ts = ts > 0 ? ts : INT64_MAX;
   auto iter = std::make_shared<mvcc::Iterator>(ts, reader_->NewIterator(cf_name, options));
@@ -233,6 +326,12 @@ butil::Status VectorReader::KvGet(const std::string& cf_name, int64_t ts, const
   return butil::Status().OK();
 }
 
+butil::Status VectorReader::KvBatchGet(const std::string& cf_name, int64_t ts,
+                                       const std::vector<std::string>& plain_keys,
+                                       std::vector<std::string>& plain_values, std::vector<bool>& key_states) {
+  return BatchGetVisibleValue(reader_, cf_name, ts, plain_keys, plain_values, key_states);
+}
+
 // plain_start_key and plain_end_key is user key
 // output plain_kvs is user key
 butil::Status VectorReader::KvScan(const std::string& cf_name, int64_t ts, const std::string& plain_start_key,
@@ -399,8 +498,9 @@ butil::Status DocumentReader::KvGet(const std::string& cf_name, int64_t ts, cons
 
   std::string encode_key = Codec::EncodeBytes(plain_key);
 
+  // upper bound has the same user key prefix, so prefix bloom filter can be used.
   dingodb::IteratorOptions options;
-  options.upper_bound = Helper::PrefixNext(encode_key);
+  options.upper_bound = Codec::EncodeKey(plain_key, 0);
 
   ts = ts > 0 ? ts : INT64_MAX;
   auto iter = std::make_shared<mvcc::Iterator>(ts, reader_->NewIterator(cf_name, options));
@@ -414,6 +514,12 @@ butil::Status DocumentReader::KvGet(const std::string& cf_name, int64_t ts, cons
   return butil::Status().OK();
 }
 
+butil::Status DocumentReader::KvBatchGet(const std::string& cf_name, int64_t ts,
+                                         const std::vector<std::string>& plain_keys,
+                                         std::vector<std::string>& plain_values, std::vector<bool>& key_states) {
+  return BatchGetVisibleValue(reader_, cf_name, ts, plain_keys, plain_values, key_states);
+}
+
 // plain_start_key and plain_end_key is user key
 // output plain_kvs is user key
 butil::Status DocumentReader::KvScan(const std::string& cf_name, int64_t ts, const std::string& plain_start_key,
@@ -19,6 +19,7 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "engine/raw_engine.h"
 
@@ -35,6 +36,11 @@ class Reader {
   virtual butil::Status KvGet(const std::string& cf_name, int64_t ts, const std::string& plain_key,
                               std::string& plain_value) = 0;
 
+  // point lookup a batch of plain keys on one snapshot
+  // plain_values and key_states are aligned with plain_keys, key_states[i] is false when not found
+  virtual butil::Status KvBatchGet(const std::string& cf_name, int64_t ts, const std::vector<std::string>& plain_keys,
+                                   std::vector<std::string>& plain_values, std::vector<bool>& key_states) = 0;
+
   // start_key and end_key is plain key
   // output plain_kvs is plain key
   virtual butil::Status KvScan(const std::string& cf_name, int64_t ts, const std::string& plain_start_key,
@@ -68,6 +74,9 @@ class KvReader : public Reader {
   butil::Status KvGet(const std::string& cf_name, int64_t ts, const std::string& plain_key,
                       std::string& plain_value) override;
 
+  butil::Status KvBatchGet(const std::string& cf_name, int64_t ts, const std::vector<std::string>& plain_keys,
+                           std::vector<std::string>& plain_values, std::vector<bool>& key_states) override;
+
   // start_key and end_key is plain key
   // output plain_kvs is plain key
   butil::Status KvScan(const std::string& cf_name, int64_t ts, const std::string& plain_start_key,
@@ -106,6 +115,9 @@ class VectorReader : public Reader {
   butil::Status KvGet(const std::string& cf_name, int64_t ts, const std::string& plain_key,
                       std::string& plain_value) override;
 
+  butil::Status KvBatchGet(const std::string& cf_name, int64_t ts, const std::vector<std::string>& plain_keys,
+                           std::vector<std::string>& plain_values, std::vector<bool>& key_states) override;
+
   // start_key and end_key is plain key
   // output plain_kvs is plain key
   butil::Status KvScan(const std::string& cf_name, int64_t ts, const std::string& plain_start_key,
@@ -144,6 +156,9 @@ class DocumentReader : public Reader {
   butil::Status KvGet(const std::string& cf_name, int64_t ts, const std::string& plain_key,
                       std::string& plain_value) override;
 
+  butil::Status KvBatchGet(const std::string& cf_name, int64_t ts, const std::vector<std::string>& plain_keys,
+                           std::vector<std::string>& plain_values, std::vector<bool>& key_states) override;
+
   // start_key and end_key is plain key
   // output plain_kvs is plain key
   butil::Status KvScan(const std::string& cf_name, int64_t ts, const std::string& plain_start_key,
@@ -15,8 +15,10 @@
 #include "raft/store_state_machine.h"
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "braft/util.h"
 #include "butil/compiler_specific.h"
@@ -26,6 +28,8 @@
 #include "common/synchronization.h"
 #include "event/store_state_machine_event.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "handler/raft_apply_handler.h"
 #include "meta/store_meta_manager.h"
 #include "metrics/store_bvar_metrics.h"
 #include "proto/common.pb.h"
@@ -38,6 +42,9 @@ const int kSaveAppliedIndexStep = 10;
 
 namespace dingodb {
 
+DEFINE_bool(enable_raft_batch_apply, true, "enable merge consecutive put log entries into one write batch on apply");
+DEFINE_int32(raft_batch_apply_max_entries, 64, "max log entries of one raft batch apply");
+
 StoreStateMachine::StoreStateMachine(RawEnginePtr engine, store::RegionPtr region, store::RaftMetaPtr raft_meta,
                                      store::RegionMetricsPtr region_metrics, EventListenerCollectionPtr listeners,
                                      WorkerSetPtr worker_set)
@@ -91,9 +98,99 @@ int StoreStateMachine::DispatchEvent(dingodb::EventType event_type, std::shared_
   return 0;
 }
 
+// Only pure put entries can be merged into one write batch, other cmds may read the data written by the prior
+// entries or have side effects out of raw engine.
+bool StoreStateMachine::IsBatchApplyCmd(const pb::raft::RaftCmdRequest& raft_cmd) {
+  if (!FLAGS_enable_raft_batch_apply || raft_cmd.requests().empty()) {
+    return false;
+  }
+
+  for (const auto& request : raft_cmd.requests()) {
+    if (request.cmd_type() != pb::raft::CmdType::PUT || request.put().kvs().empty()) {
+      return false;
+    }
+    // empty key fail the whole write batch, let it apply alone
+    for (const auto& kv : request.put().kvs()) {
+      if (BAIDU_UNLIKELY(kv.key().empty())) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void StoreStateMachine::BatchApply(std::vector<BatchApplyEntry>& entries) {
+  if (entries.empty()) {
+    return;
+  }
+
+  std::map<std::string, std::vector<pb::common::KeyValue>> kv_puts_with_cf;
+  for (const auto& entry : entries) {
+    for (const auto& request : entry.raft_cmd->requests()) {
+      auto& kvs = kv_puts_with_cf[request.put().cf_name()];
+      kvs.insert(kvs.end(), request.put().kvs().begin(), request.put().kvs().end());
+    }
+  }
+
+  auto writer = raw_engine_->Writer();
+  if (BAIDU_UNLIKELY(!writer)) {
+    DINGO_LOG(FATAL) << fmt::format("[raft.sm][region({})] get writer failed.", region_->Id());
+  }
+  auto status = writer->KvBatchPutAndDelete(kv_puts_with_cf, {});
+  if (BAIDU_UNLIKELY(status.error_code() == pb::error::Errno::EINTERNAL)) {
+    DINGO_LOG(FATAL) << fmt::format("[raft.sm][region({})] batch apply put failed, error: {}", region_->Id(),
+                                    status.error_str());
+  }
+
+  DINGO_LOG(DEBUG) << fmt::format("[raft.sm][region({})] batch apply log [{}, {}] count({})", region_->Id(),
+                                  entries.front().index, entries.back().index, entries.size());
+
+  for (auto& entry : entries) {
+    if (entry.ctx != nullptr) {
+      entry.ctx->SetStatus(status);
+      if (entry.ctx->Tracker() != nullptr) {
+        entry.ctx->Tracker()->SetRaftApplyTime();
+      }
+    }
+
+    // same side effects as PutHandler, e.g. reset scalar index and update region metrics
+    for (const auto& request : entry.raft_cmd->requests()) {
+      PutHandler::ApplySideEffect(region_, request.put(), region_metrics_);
+    }
+
+    AdvanceAppliedIndex(entry.term, entry.index);
+
+    if (entry.done != nullptr) {
+      braft::run_closure_in_bthread(entry.done);
+    }
+  }
+
+  entries.clear();
+}
+
+void StoreStateMachine::AdvanceAppliedIndex(int64_t term, int64_t index) {
+  applied_term_ = term;
+  applied_index_ = index;
+  raft_meta_->SetTermAndAppliedId(applied_term_, applied_index_);
+
+  // bvar metrics
+  StoreBvarMetrics::GetInstance().IncApplyCountPerSecond(str_node_id_);
+
+  // Persistence applied index
+  // If operation is idempotent, it's ok.
+  // If not, must be stored with the data.
+  if (applied_index_ % kSaveAppliedIndexStep == 0) {
+    Server::GetInstance().GetStoreMetaManager()->GetStoreRaftMeta()->UpdateRaftMeta(raft_meta_);
+  }
+}
+
 void StoreStateMachine::on_apply(braft::Iterator& iter) {
   BAIDU_SCOPED_LOCK(apply_mutex_);
 
+  // consecutive put entries wait for batch apply
+  std::vector<BatchApplyEntry> batch_entries;
+
   for (; iter.valid(); iter.next()) {
     braft::AsyncClosureGuard done_guard(iter.done());
 
@@ -164,6 +261,18 @@ void StoreStateMachine::on_apply(braft::Iterator& iter) {
         iter.index(), applied_index_,
         raft_cmd->requests().empty() ? "" : pb::raft::CmdType_Name(raft_cmd->requests().at(0).cmd_type()));
 
+    if (BAIDU_LIKELY(need_apply) && IsBatchApplyCmd(*raft_cmd)) {
+      batch_entries.push_back({iter.done(), raft_cmd, ctx, iter.term(), iter.index()});
+      done_guard.release();
+      if (batch_entries.size() >= static_cast<size_t>(FLAGS_raft_batch_apply_max_entries)) {
+        BatchApply(batch_entries);
+      }
+      continue;
+    }
+
+    // apply the waiting put entries first, keep apply order
+    BatchApply(batch_entries);
+
     if (BAIDU_LIKELY(need_apply)) {
       // Build event
       auto event = std::make_shared<SmApplyEvent>();
@@ -203,20 +312,10 @@ void StoreStateMachine::on_apply(braft::Iterator& iter) {
       tracker->SetRaftApplyTime();
     }
 
-    applied_term_ = iter.term();
-    applied_index_ = iter.index();
-    raft_meta_->SetTermAndAppliedId(applied_term_, applied_index_);
-
-    // bvar metrics
-    StoreBvarMetrics::GetInstance().IncApplyCountPerSecond(str_node_id_);
-
-    // Persistence applied index
-    // If operation is idempotent, it's ok.
-    // If not, must be stored with the data.
-    if (applied_index_ % kSaveAppliedIndexStep == 0) {
-      Server::GetInstance().GetStoreMetaManager()->GetStoreRaftMeta()->UpdateRaftMeta(raft_meta_);
-    }
+    AdvanceAppliedIndex(iter.term(), iter.index());
   }
+
+  BatchApply(batch_entries);
 }
 
 int32_t StoreStateMachine::CatchUpApplyLog(const std::vector<pb::raft::LogEntry>& entries) {
@@ -16,10 +16,12 @@
 #define DINGODB_RAFT_STATE_MACHINE_H_
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "braft/raft.h"
+#include "common/context.h"
 #include "common/runnable.h"
 #include "engine/raw_engine.h"
 #include "event/event.h"
@@ -82,6 +84,20 @@ class StoreStateMachine : public BaseStateMachine {
  private:
   int DispatchEvent(dingodb::EventType, std::shared_ptr<dingodb::Event> event);
 
+  // Committed put entry wait for batch apply, done is run after the batch written.
+  struct BatchApplyEntry {
+    braft::Closure* done;
+    std::shared_ptr<pb::raft::RaftCmdRequest> raft_cmd;
+    std::shared_ptr<Context> ctx;
+    int64_t term;
+    int64_t index;
+  };
+
+  static bool IsBatchApplyCmd(const pb::raft::RaftCmdRequest& raft_cmd);
+  // Write the put entries with one write batch, then complete their closures and advance applied index.
+  void BatchApply(std::vector<BatchApplyEntry>& entries);
+  void AdvanceAppliedIndex(int64_t term, int64_t index);
+
   std::string str_node_id_;
   store::RegionPtr region_;
 
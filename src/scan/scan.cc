@@ -18,8 +18,10 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "bthread/mutex.h"
@@ -28,11 +30,14 @@
 #include "common/constant.h"  // IWYU pragma: keep
 #include "common/helper.h"    // IWYU pragma: keep
 #include "common/logging.h"
+#include "common/synchronization.h"
 #include "coprocessor/coprocessor.h"
 #include "coprocessor/coprocessor_v2.h"
 #include "coprocessor/utils.h"
 #include "engine/write_data.h"  // IWYU pragma: keep
+#include "gflags/gflags.h"
 #include "mvcc/codec.h"
+#include "mvcc/iterator.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "scan/scan_filter.h"
@@ -42,6 +47,8 @@
 
 namespace dingodb {
 
+DEFINE_bool(scan_enable_prefetch, true, "read ahead the next page of scan in background");
+
 ScanContext::ScanContext(bvar::LatencyRecorder* scan_latency)
     : region_id_(0),
       max_fetch_cnt_(0),
@@ -56,6 +63,8 @@ ScanContext::ScanContext(bvar::LatencyRecorder* scan_latency)
 #endif
       ,
       disable_coprocessor_(true),
+      prefetch_state_(PrefetchState::kNone),
+      prefetch_has_more_(false),
       timeout_ms_(0),
       max_bytes_rpc_(0),
       max_fetch_cnt_by_server_(0),
@@ -104,7 +113,14 @@ butil::Status ScanContext::Open(const std::string& scan_id, mvcc::ReaderPtr read
   return butil::Status();
 }
 
+bvar::IntRecorder ScanContext::scan_context_mvcc_skip_versions("dingo_scan_context_mvcc_skip_versions");
+bvar::IntRecorder ScanContext::scan_context_mvcc_reseeks("dingo_scan_context_mvcc_reseeks");
+bvar::Adder<int64_t> ScanContext::scan_context_prefetch_hits("dingo_scan_context_prefetch_hits");
+bvar::Adder<int64_t> ScanContext::scan_context_prefetch_misses("dingo_scan_context_prefetch_misses");
+
 void ScanContext::Close() {
+  RecordIteratorMetrics();
+
   scan_id_.clear();
   region_id_ = 0;
   ts_ = 0;
@@ -116,11 +132,25 @@ void ScanContext::Close() {
   reader_ = nullptr;
   cf_name_.clear();
   iter_ = nullptr;
+  ClearPrefetched();
   last_time_ms_.zero();
   coprocessor_.reset();
   bthread_mutex_destroy(&mutex_);
 }
 
+void ScanContext::RecordIteratorMetrics() {
+  if (iter_ == nullptr || iter_->GetID() != IteratorType::kMVCC) {
+    return;
+  }
+
+  auto mvcc_iter = std::static_pointer_cast<mvcc::Iterator>(iter_);
+  scan_context_mvcc_skip_versions << mvcc_iter->SkipVersionCount();
+  scan_context_mvcc_reseeks << mvcc_iter->ReseekCount();
+
+  DINGO_LOG(DEBUG) << fmt::format("[scan][scan_id({})] mvcc skip versions: {} reseeks: {}", scan_id_,
+                                  mvcc_iter->SkipVersionCount(), mvcc_iter->ReseekCount());
+}
+
 std::chrono::milliseconds ScanContext::GetCurrentTime() {
   std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
   std::chrono::nanoseconds nanosec = now.time_since_epoch();
@@ -144,17 +174,15 @@ butil::Status ScanContext::GetKeyValue(std::vector<pb::common::KeyValue>& kvs, b
 
   has_more = false;
   while (iter_->Valid()) {
-    pb::common::KeyValue kv;
+    // decode in place, avoid copy kv to the vector
+    auto& kv = kvs.emplace_back();
 
-    std::string plain_key;
-    mvcc::Codec::DecodeKey(iter_->Key(), plain_key);
-    kv.mutable_key()->swap(plain_key);
+    mvcc::Codec::DecodeKey(iter_->Key(), *kv.mutable_key());
     if (!key_only_) {
-      std::string value(mvcc::Codec::UnPackageValue(iter_->Value()));
-      kv.mutable_value()->swap(value);
+      auto value = mvcc::Codec::UnPackageValue(iter_->Value());
+      kv.set_value(value.data(), value.size());
     }
 
-    kvs.emplace_back(kv);
     if (scan_filter.UptoLimit(kv)) {
       has_more = true;
       iter_->Next();
@@ -167,6 +195,73 @@ butil::Status ScanContext::GetKeyValue(std::vector<pb::common::KeyValue>& kvs, b
   return butil::Status();
 }
 
+void ScanContext::StartPrefetch(std::shared_ptr<ScanContext> context) {
+  if (!FLAGS_scan_enable_prefetch || context->prefetch_state_ != PrefetchState::kNone) {
+    return;
+  }
+
+  context->prefetch_state_ = PrefetchState::kPending;
+  // the bthread will block on mutex_ until the caller release it.
+  Bthread bth(&BTHREAD_ATTR_SMALL);
+  bth.Run([context]() { context->DoPrefetch(); });
+}
+
+void ScanContext::DoPrefetch() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  // canceled by continue or release
+  if (prefetch_state_ != PrefetchState::kPending) {
+    return;
+  }
+
+  if (ScanState::kBegun != state_ && ScanState::kContinued != state_) {
+    prefetch_state_ = PrefetchState::kNone;
+    return;
+  }
+
+  prefetch_kvs_.clear();
+  prefetch_has_more_ = false;
+  prefetch_status_ = GetKeyValue(prefetch_kvs_, prefetch_has_more_);
+  prefetch_state_ = PrefetchState::kReady;
+
+  DINGO_LOG(DEBUG) << fmt::format("[scan][scan_id({})] prefetch kv count: {} has_more: {}", scan_id_,
+                                  prefetch_kvs_.size(), prefetch_has_more_);
+}
+
+butil::Status ScanContext::TakePrefetched(std::vector<pb::common::KeyValue>& kvs, bool& has_more) {
+  if (!prefetch_status_.ok()) {
+    auto status = prefetch_status_;
+    ClearPrefetched();
+    return status;
+  }
+
+  // the client may shrink max_fetch_cnt, the rest is kept for next continue.
+  size_t max_fetch_cnt = std::min(max_fetch_cnt_, max_fetch_cnt_by_server_);
+  if (prefetch_kvs_.size() <= max_fetch_cnt) {
+    if (kvs.empty()) {
+      kvs.swap(prefetch_kvs_);
+    } else {
+      kvs.insert(kvs.end(), std::make_move_iterator(prefetch_kvs_.begin()),
+                 std::make_move_iterator(prefetch_kvs_.end()));
+    }
+    has_more = prefetch_has_more_;
+    ClearPrefetched();
+  } else {
+    auto split_it = prefetch_kvs_.begin() + max_fetch_cnt;
+    kvs.insert(kvs.end(), std::make_move_iterator(prefetch_kvs_.begin()), std::make_move_iterator(split_it));
+    prefetch_kvs_.erase(prefetch_kvs_.begin(), split_it);
+    has_more = true;
+  }
+
+  return butil::Status();
+}
+
+void ScanContext::ClearPrefetched() {
+  prefetch_state_ = PrefetchState::kNone;
+  prefetch_kvs_.clear();
+  prefetch_has_more_ = false;
+  prefetch_status_ = butil::Status();
+}
+
 #if defined(ENABLE_SCAN_OPTIMIZATION)
 butil::Status ScanContext::AsyncWork() {
   auto lambda_call = [this]() {
@@ -220,6 +315,11 @@ butil::Status ScanContext::SeekCheck() {
 }
 #endif
 
+bool ScanContext::IsPrefetchReady() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return prefetch_state_ == PrefetchState::kReady;
+}
+
 bool ScanContext::IsRecyclable() {
   bool ret = false;
   // speedup
@@ -442,6 +542,10 @@ butil::Status ScanHandler::ScanBegin(std::shared_ptr<ScanContext> context, int64
       return s;
     }
 
+    if (has_more) {
+      ScanContext::StartPrefetch(context);
+    }
+
 #if defined(ENABLE_SCAN_OPTIMIZATION)
     context->seek_state_ = ScanContext::SeekState::kInitted;
 #endif
@@ -502,7 +606,17 @@ butil::Status ScanHandler::ScanContinue(std::shared_ptr<ScanContext> context, co
 
   context->state_ = ScanState::kContinuing;
 
-  s = context->GetKeyValue(*kvs, has_more);
+  if (context->prefetch_state_ == ScanContext::PrefetchState::kReady) {
+    ScanContext::scan_context_prefetch_hits << 1;
+    s = context->TakePrefetched(*kvs, has_more);
+  } else {
+    if (context->prefetch_state_ == ScanContext::PrefetchState::kPending) {
+      // prefetch bthread not run yet, cancel it and read by self.
+      ScanContext::scan_context_prefetch_misses << 1;
+      context->prefetch_state_ = ScanContext::PrefetchState::kNone;
+    }
+    s = context->GetKeyValue(*kvs, has_more);
+  }
   if (!s.ok()) {
     context->state_ = ScanState::kError;
     DINGO_LOG(ERROR) << fmt::format("ScanContext::GetKeyValue failed");
@@ -512,6 +626,10 @@ butil::Status ScanHandler::ScanContinue(std::shared_ptr<ScanContext> context, co
   context->state_ = ScanState::kContinued;
   context->last_time_ms_ = context->GetCurrentTime();
 
+  if (has_more) {
+    ScanContext::StartPrefetch(context);
+  }
+
   return butil::Status();
 }
 
@@ -547,6 +665,9 @@ butil::Status ScanHandler::ScanRelease(std::shared_ptr<ScanContext> context,
 
   context->state_ = ScanState::kReleasing;
 
+  // drop the page read ahead, release memory as soon as possible.
+  context->ClearPrefetched();
+
   if (!context->disable_auto_release_) {
     context->state_ = ScanState::kAllowImmediateRecycling;
   } else {
@@ -23,6 +23,7 @@
 
 #include "bthread/types.h"
 #include "butil/status.h"
+#include "bvar/bvar.h"
 #include "coprocessor/raw_coprocessor.h"
 #include "engine/iterator.h"
 #include "mvcc/reader.h"
@@ -76,6 +77,9 @@ class ScanContext {
   // Is it possible to delete this object
   virtual bool IsRecyclable();
 
+  // the next page is read ahead and waiting for continue
+  bool IsPrefetchReady();
+
   static const char* GetScanState(ScanState state);
 
  protected:
@@ -83,8 +87,17 @@ class ScanContext {
 
  private:
   void Close();
+  // record the mvcc iterator statistics of this scan
+  void RecordIteratorMetrics();
   static std::chrono::milliseconds GetCurrentTime();
   butil::Status GetKeyValue(std::vector<pb::common::KeyValue>& kvs, bool& has_more);  // NOLINT
+  // read ahead the next page in background while the client is consuming the current page,
+  // must be called with mutex_ held.
+  static void StartPrefetch(std::shared_ptr<ScanContext> context);
+  void DoPrefetch();
+  // move the prefetched page to kvs, must be called with mutex_ held and prefetch is ready.
+  butil::Status TakePrefetched(std::vector<pb::common::KeyValue>& kvs, bool& has_more);  // NOLINT
+  void ClearPrefetched();
 #if defined(ENABLE_SCAN_OPTIMIZATION)
   butil::Status AsyncWork();
   void WaitForReady();
@@ -131,6 +144,23 @@ class ScanContext {
 
   bool disable_coprocessor_;
 
+  enum class PrefetchState : unsigned char {
+    kNone = 0,
+    // prefetch bthread is launched, but not run yet
+    kPending = 1,
+    // the next page is in prefetch_kvs_
+    kReady = 2,
+  };
+
+  PrefetchState prefetch_state_;
+
+  // buffer of the next page, bounded by max_fetch_cnt and max_bytes_rpc
+  std::vector<pb::common::KeyValue> prefetch_kvs_;
+
+  bool prefetch_has_more_;
+
+  butil::Status prefetch_status_;
+
   // coprocessor
   std::shared_ptr<RawCoprocessor> coprocessor_;
 
@@ -145,6 +175,14 @@ class ScanContext {
 
   bvar::LatencyRecorder* scan_latency_;
   BvarLatencyGuard bvar_guard_;
+
+  // per scan mvcc versions skipped by step next and reseek count
+  static bvar::IntRecorder scan_context_mvcc_skip_versions;
+  static bvar::IntRecorder scan_context_mvcc_reseeks;
+
+  // continue served by prefetched page or not
+  static bvar::Adder<int64_t> scan_context_prefetch_hits;
+  static bvar::Adder<int64_t> scan_context_prefetch_misses;
 };
 
 class ScanContextV1 : public ScanContext {
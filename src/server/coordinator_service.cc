@@ -690,8 +690,9 @@ void DoStoreHeartbeat(google::protobuf::RpcController * /*controller*/,
   int const new_storemap_epoch = coordinator_control->UpdateStoreMap(request->store(), meta_increment);
 
   // update store metrics
+  bool is_store_metrics_applied = true;
   if (request->has_store_metrics()) {
-    coordinator_control->UpdateStoreMetrics(request->store_metrics(), meta_increment);
+    is_store_metrics_applied = coordinator_control->UpdateStoreMetrics(request->store_metrics(), meta_increment) >= 0;
 
     // update is_read_only
     auto is_read_only_from_store = request->store_metrics().store_own_metrics().is_ready_only();
@@ -739,6 +740,12 @@ void DoStoreHeartbeat(google::protobuf::RpcController * /*controller*/,
   coordinator_control->GetStoreMap(*new_storemap);
 
   response->set_storemap_epoch(new_storemap_epoch);
+
+  // let store report the region metrics again
+  if (!is_store_metrics_applied) {
+    ServiceHelper::SetError(response->mutable_error(), pb::error::Errno::EILLEGAL_PARAMTETERS,
+                            "StoreHeartbeat region metrics not applied");
+  }
 }
 
 void DoGetStoreMap(google::protobuf::RpcController * /*controller*/, const pb::coordinator::GetStoreMapRequest *request,
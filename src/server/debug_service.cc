@@ -1043,7 +1043,7 @@ std::vector<pb::debug::DumpRegionResponse::Vector> DumpRawVectorRegion(RawEngine
       vector.set_ttl(ttl);
 
       if (flag == mvcc::ValueFlag::kPut || flag == mvcc::ValueFlag::kPutTTL) {
-        if (!vector.mutable_vector()->ParseFromArray(value.data(), value.size())) {
+        if (!VectorCodec::DecodeVectorValue(value, *vector.mutable_vector())) {
           DINGO_LOG(FATAL) << fmt::format("Parse vector proto failed, value size: {}.", value.size());
         }
       }
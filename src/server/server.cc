@@ -103,6 +103,7 @@ DEFINE_int32(balance_region_interval_s, 120, "balance region interval seconds");
 DEFINE_int32(recycle_job_interval_s, 60, "recycle job list interval seconds");
 
 DEFINE_int32(server_scrub_document_index_interval_s, 60, "scrub document index interval seconds");
+DEFINE_int32(server_flush_document_index_interval_ms, 200, "flush document index group commit interval ms");
 
 DEFINE_bool(enable_balance_leader, true, "enable balance leader");
 DEFINE_bool(enable_balance_region, true, "enable balance region");
@@ -467,6 +468,8 @@ bool Server::InitLogStorage() {
 
   if (GetRole() == pb::common::ClusterRole::INDEX) {
     log_storage_->RegisterClientType(wal::ClientType::kVectorIndex);
+  } else if (GetRole() == pb::common::ClusterRole::DOCUMENT) {
+    log_storage_->RegisterClientType(wal::ClientType::kDocumentIndex);
   }
 
   return log_storage_->Init();
@@ -722,6 +725,15 @@ bool Server::InitCrontabManager() {
       [](void*) { Heartbeat::TriggerScrubVectorIndex(nullptr); },
   });
 
+  // Add flush document index crontab, commit group commit writes and refresh reader
+  crontab_configs_.push_back({
+      "FLUSH_DOCUMENT_INDEX",
+      {pb::common::DOCUMENT},
+      FLAGS_server_flush_document_index_interval_ms,
+      true,
+      [](void*) { Heartbeat::TriggerFlushDocumentIndex(nullptr); },
+  });
+
   auto raft_store_engine = GetRaftStoreEngine();
   if (raft_store_engine != nullptr) {
     // Add raft snapshot controller crontab
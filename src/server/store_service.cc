@@ -18,6 +18,7 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "butil/compiler_specific.h"
@@ -1183,7 +1184,7 @@ void DoKvScanBegin(StoragePtr storage, google::protobuf::RpcController* controll
   }
 
   if (!kvs.empty()) {
-    Helper::VectorToPbRepeated(kvs, response->mutable_kvs());
+    Helper::VectorToPbRepeated(std::move(kvs), response->mutable_kvs());
   }
 
   *response->mutable_scan_id() = scan_id;
@@ -1272,7 +1273,7 @@ void DoKvScanContinue(StoragePtr storage, google::protobuf::RpcController* contr
   }
 
   if (!kvs.empty()) {
-    Helper::VectorToPbRepeated(kvs, response->mutable_kvs());
+    Helper::VectorToPbRepeated(std::move(kvs), response->mutable_kvs());
   }
 }
 
@@ -1475,7 +1476,7 @@ void DoKvScanBeginV2(StoragePtr storage, google::protobuf::RpcController* contro
   }
 
   if (!kvs.empty()) {
-    Helper::VectorToPbRepeated(kvs, response->mutable_kvs());
+    Helper::VectorToPbRepeated(std::move(kvs), response->mutable_kvs());
   }
 
   response->set_scan_id(scan_id);
@@ -1565,7 +1566,7 @@ void DoKvScanContinueV2(StoragePtr storage, google::protobuf::RpcController* con
   }
 
   if (!kvs.empty()) {
-    Helper::VectorToPbRepeated(kvs, response->mutable_kvs());
+    Helper::VectorToPbRepeated(std::move(kvs), response->mutable_kvs());
   }
 
   response->set_has_more(has_more);
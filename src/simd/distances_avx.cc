@@ -195,5 +195,81 @@ float fvec_Linf_avx(const float* x, const float* y, size_t d) {
   return _mm_cvtss_f32(msum2);
 }
 
+// convert one fp16 to float by f16c
+static inline float fp16_read(uint16_t x) { return _mm_cvtss_f32(_mm_cvtph_ps(_mm_cvtsi32_si128(x))); }
+
+int32_t int8vec_inner_product_avx(const int8_t* x, const int8_t* y, size_t d) {
+  __m256i msum = _mm256_setzero_si256();
+
+  while (d >= 16) {
+    __m256i mx = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x)));
+    x += 16;
+    __m256i my = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y)));
+    y += 16;
+    msum = _mm256_add_epi32(msum, _mm256_madd_epi16(mx, my));
+    d -= 16;
+  }
+
+  __m128i msum2 = _mm_add_epi32(_mm256_extracti128_si256(msum, 1), _mm256_castsi256_si128(msum));
+  msum2 = _mm_hadd_epi32(msum2, msum2);
+  msum2 = _mm_hadd_epi32(msum2, msum2);
+  int32_t res = _mm_cvtsi128_si32(msum2);
+
+  for (size_t i = 0; i < d; i++) {
+    res += static_cast<int32_t>(x[i]) * static_cast<int32_t>(y[i]);
+  }
+  return res;
+}
+
+float fp16vec_L2sqr_avx(const uint16_t* x, const uint16_t* y, size_t d) {
+  __m256 msum1 = _mm256_setzero_ps();
+
+  while (d >= 8) {
+    __m256 mx = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x)));
+    x += 8;
+    __m256 my = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y)));
+    y += 8;
+    const __m256 a_m_b1 = _mm256_sub_ps(mx, my);
+    msum1 = _mm256_add_ps(msum1, _mm256_mul_ps(a_m_b1, a_m_b1));
+    d -= 8;
+  }
+
+  __m128 msum2 = _mm256_extractf128_ps(msum1, 1);
+  msum2 = _mm_add_ps(msum2, _mm256_extractf128_ps(msum1, 0));
+  msum2 = _mm_hadd_ps(msum2, msum2);
+  msum2 = _mm_hadd_ps(msum2, msum2);
+  float res = _mm_cvtss_f32(msum2);
+
+  for (size_t i = 0; i < d; i++) {
+    const float tmp = fp16_read(x[i]) - fp16_read(y[i]);
+    res += tmp * tmp;
+  }
+  return res;
+}
+
+float fp16vec_inner_product_avx(const uint16_t* x, const uint16_t* y, size_t d) {
+  __m256 msum1 = _mm256_setzero_ps();
+
+  while (d >= 8) {
+    __m256 mx = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x)));
+    x += 8;
+    __m256 my = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y)));
+    y += 8;
+    msum1 = _mm256_add_ps(msum1, _mm256_mul_ps(mx, my));
+    d -= 8;
+  }
+
+  __m128 msum2 = _mm256_extractf128_ps(msum1, 1);
+  msum2 = _mm_add_ps(msum2, _mm256_extractf128_ps(msum1, 0));
+  msum2 = _mm_hadd_ps(msum2, msum2);
+  msum2 = _mm_hadd_ps(msum2, msum2);
+  float res = _mm_cvtss_f32(msum2);
+
+  for (size_t i = 0; i < d; i++) {
+    res += fp16_read(x[i]) * fp16_read(y[i]);
+  }
+  return res;
+}
+
 }  // namespace dingodb
 #endif
@@ -34,6 +34,15 @@ float fvec_L1_avx(const float* x, const float* y, size_t d);
 /// infinity distance
 float fvec_Linf_avx(const float* x, const float* y, size_t d);
 
+/// inner product of two int8 vectors
+int32_t int8vec_inner_product_avx(const int8_t* x, const int8_t* y, size_t d);
+
+/// Squared L2 distance between two fp16 vectors
+float fp16vec_L2sqr_avx(const uint16_t* x, const uint16_t* y, size_t d);
+
+/// inner product of two fp16 vectors
+float fp16vec_inner_product_avx(const uint16_t* x, const uint16_t* y, size_t d);
+
 }  // namespace dingodb
 
 #endif  // DINGODB_SIMD_DISTANCES_AVX_H_ //NOLINT
@@ -249,6 +249,68 @@ float fvec_Linf_avx512(const float* x, const float* y, size_t d) {
   return _mm_cvtss_f32(msum2);
 }
 
+// convert one fp16 to float by f16c
+static inline float fp16_read(uint16_t x) { return _mm_cvtss_f32(_mm_cvtph_ps(_mm_cvtsi32_si128(x))); }
+
+int32_t int8vec_inner_product_avx512(const int8_t* x, const int8_t* y, size_t d) {
+  __m512i msum = _mm512_setzero_si512();
+
+  while (d >= 32) {
+    __m512i mx = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x)));
+    x += 32;
+    __m512i my = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y)));
+    y += 32;
+    msum = _mm512_add_epi32(msum, _mm512_madd_epi16(mx, my));
+    d -= 32;
+  }
+
+  int32_t res = _mm512_reduce_add_epi32(msum);
+  for (size_t i = 0; i < d; i++) {
+    res += static_cast<int32_t>(x[i]) * static_cast<int32_t>(y[i]);
+  }
+  return res;
+}
+
+float fp16vec_L2sqr_avx512(const uint16_t* x, const uint16_t* y, size_t d) {
+  __m512 msum = _mm512_setzero_ps();
+
+  while (d >= 16) {
+    __m512 mx = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x)));
+    x += 16;
+    __m512 my = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y)));
+    y += 16;
+    const __m512 a_m_b1 = _mm512_sub_ps(mx, my);
+    msum = _mm512_fmadd_ps(a_m_b1, a_m_b1, msum);
+    d -= 16;
+  }
+
+  float res = _mm512_reduce_add_ps(msum);
+  for (size_t i = 0; i < d; i++) {
+    const float tmp = fp16_read(x[i]) - fp16_read(y[i]);
+    res += tmp * tmp;
+  }
+  return res;
+}
+
+float fp16vec_inner_product_avx512(const uint16_t* x, const uint16_t* y, size_t d) {
+  __m512 msum = _mm512_setzero_ps();
+
+  while (d >= 16) {
+    __m512 mx = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x)));
+    x += 16;
+    __m512 my = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y)));
+    y += 16;
+    msum = _mm512_fmadd_ps(mx, my, msum);
+    d -= 16;
+  }
+
+  float res = _mm512_reduce_add_ps(msum);
+  for (size_t i = 0; i < d; i++) {
+    res += fp16_read(x[i]) * fp16_read(y[i]);
+  }
+  return res;
+}
+
 }  // namespace dingodb
 
 #endif
@@ -33,6 +33,15 @@ float fvec_L1_avx512(const float* x, const float* y, size_t d);
 /// infinity distance
 float fvec_Linf_avx512(const float* x, const float* y, size_t d);
 
+/// inner product of two int8 vectors
+int32_t int8vec_inner_product_avx512(const int8_t* x, const int8_t* y, size_t d);
+
+/// Squared L2 distance between two fp16 vectors
+float fp16vec_L2sqr_avx512(const uint16_t* x, const uint16_t* y, size_t d);
+
+/// inner product of two fp16 vectors
+float fp16vec_inner_product_avx512(const uint16_t* x, const uint16_t* y, size_t d);
+
 }  // namespace dingodb
 
 #endif  // DINGODB_SIMD_DISTANCES_AVX512_H_  //NOLINT
@@ -19,6 +19,9 @@
 #include "simd/distances_ref.h"
 
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+
 namespace dingodb {
 
 float fvec_L2sqr_ref(const float* x, const float* y, size_t d) {
@@ -96,4 +99,103 @@ int fvec_madd_and_argmin_ref(size_t n, const float* a, float bf, const float* b,
   return imin;
 }
 
+int32_t int8vec_inner_product_ref(const int8_t* x, const int8_t* y, size_t d) {
+  int32_t res = 0;
+  for (size_t i = 0; i < d; i++) {
+    res += static_cast<int32_t>(x[i]) * static_cast<int32_t>(y[i]);
+  }
+  return res;
+}
+
+float fp16vec_L2sqr_ref(const uint16_t* x, const uint16_t* y, size_t d) {
+  float res = 0;
+  for (size_t i = 0; i < d; i++) {
+    const float tmp = fp16_to_fp32(x[i]) - fp16_to_fp32(y[i]);
+    res += tmp * tmp;
+  }
+  return res;
+}
+
+float fp16vec_inner_product_ref(const uint16_t* x, const uint16_t* y, size_t d) {
+  float res = 0;
+  for (size_t i = 0; i < d; i++) {
+    res += fp16_to_fp32(x[i]) * fp16_to_fp32(y[i]);
+  }
+  return res;
+}
+
+uint16_t fp32_to_fp16(float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+
+  uint32_t sign = (x >> 16) & 0x8000;
+  uint32_t mantissa = x & 0x007fffff;
+  int32_t exp = static_cast<int32_t>((x >> 23) & 0xff);
+
+  // inf or nan
+  if (exp == 0xff) {
+    return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+  }
+
+  exp = exp - 127 + 15;
+  // overflow to inf
+  if (exp >= 0x1f) {
+    return sign | 0x7c00;
+  }
+
+  // subnormal or underflow to zero
+  if (exp <= 0) {
+    if (exp < -10) {
+      return sign;
+    }
+    mantissa |= 0x00800000;
+    uint32_t shift = 14 - exp;
+    uint32_t half = mantissa >> shift;
+    uint32_t remain = mantissa & ((1U << shift) - 1);
+    uint32_t halfway = 1U << (shift - 1);
+    if (remain > halfway || (remain == halfway && (half & 1) != 0)) {
+      ++half;
+    }
+    return sign | half;
+  }
+
+  // carry of rounding may go into exponent, it is still correct
+  uint32_t half = (static_cast<uint32_t>(exp) << 10) | (mantissa >> 13);
+  uint32_t remain = mantissa & 0x1fff;
+  if (remain > 0x1000 || (remain == 0x1000 && (half & 1) != 0)) {
+    ++half;
+  }
+  return sign | half;
+}
+
+float fp16_to_fp32(uint16_t h) {
+  uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+  uint32_t exp = (h >> 10) & 0x1f;
+  uint32_t mantissa = h & 0x3ff;
+
+  uint32_t x;
+  if (exp == 0x1f) {
+    x = sign | 0x7f800000 | (mantissa << 13);
+  } else if (exp == 0) {
+    if (mantissa == 0) {
+      x = sign;
+    } else {
+      // subnormal, normalize it
+      exp = 127 - 15 + 1;
+      while ((mantissa & 0x400) == 0) {
+        mantissa <<= 1;
+        --exp;
+      }
+      mantissa &= 0x3ff;
+      x = sign | (exp << 23) | (mantissa << 13);
+    }
+  } else {
+    x = sign | ((exp + 127 - 15) << 23) | (mantissa << 13);
+  }
+
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
 }  // namespace dingodb
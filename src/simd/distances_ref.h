@@ -17,6 +17,7 @@
 #ifndef DINGODB_SIMD_DISTANCES_REF_H_
 #define DINGODB_SIMD_DISTANCES_REF_H_
 
+#include <cstdint>
 #include <cstdio>
 
 namespace dingodb {
@@ -46,6 +47,19 @@ void fvec_madd_ref(size_t n, const float* a, float bf, const float* b, float* c)
 
 int fvec_madd_and_argmin_ref(size_t n, const float* a, float bf, const float* b, float* c);
 
+/// inner product of two int8 vectors
+int32_t int8vec_inner_product_ref(const int8_t* x, const int8_t* y, size_t d);
+
+/// Squared L2 distance between two fp16 vectors
+float fp16vec_L2sqr_ref(const uint16_t* x, const uint16_t* y, size_t d);
+
+/// inner product of two fp16 vectors
+float fp16vec_inner_product_ref(const uint16_t* x, const uint16_t* y, size_t d);
+
+/// convert between fp32 and IEEE 754 half precision, round to nearest even
+uint16_t fp32_to_fp16(float f);
+float fp16_to_fp32(uint16_t h);
+
 }  // namespace dingodb
 
 #endif  // DINGODB_SIMD_DISTANCES_REF_H_ //NOLINT
@@ -355,5 +355,27 @@ int fvec_madd_and_argmin_sse(size_t n, const float* a, float bf, const float* b,
   return _mm_cvtsi128_si32(imin4);
 }
 
+int32_t int8vec_inner_product_sse(const int8_t* x, const int8_t* y, size_t d) {
+  __m128i msum = _mm_setzero_si128();
+
+  while (d >= 8) {
+    __m128i mx = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(x)));
+    x += 8;
+    __m128i my = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y)));
+    y += 8;
+    msum = _mm_add_epi32(msum, _mm_madd_epi16(mx, my));
+    d -= 8;
+  }
+
+  msum = _mm_hadd_epi32(msum, msum);
+  msum = _mm_hadd_epi32(msum, msum);
+  int32_t res = _mm_cvtsi128_si32(msum);
+
+  for (size_t i = 0; i < d; i++) {
+    res += static_cast<int32_t>(x[i]) * static_cast<int32_t>(y[i]);
+  }
+  return res;
+}
+
 }  // namespace dingodb
 #endif
@@ -17,6 +17,7 @@
 #ifndef DINGODB_SIMD_DISTANCES_SSE_H_
 #define DINGODB_SIMD_DISTANCES_SSE_H_
 
+#include <cstdint>
 #include <cstdio>
 namespace dingodb {
 
@@ -42,6 +43,9 @@ void fvec_madd_sse(size_t n, const float* a, float bf, const float* b, float* c)
 
 int fvec_madd_and_argmin_sse(size_t n, const float* a, float bf, const float* b, float* c);
 
+/// inner product of two int8 vectors
+int32_t int8vec_inner_product_sse(const int8_t* x, const int8_t* y, size_t d);
+
 }  // namespace dingodb
 
 #endif /* DINGODB_SIMD_DISTANCES_SSE_H_ */
@@ -48,6 +48,10 @@ decltype(fvec_inner_products_ny) fvec_inner_products_ny = fvec_inner_products_ny
 decltype(fvec_madd) fvec_madd = fvec_madd_ref;
 decltype(fvec_madd_and_argmin) fvec_madd_and_argmin = fvec_madd_and_argmin_ref;
 
+decltype(int8vec_inner_product) int8vec_inner_product = int8vec_inner_product_ref;
+decltype(fp16vec_L2sqr) fp16vec_L2sqr = fp16vec_L2sqr_ref;
+decltype(fp16vec_inner_product) fp16vec_inner_product = fp16vec_inner_product_ref;
+
 #if defined(__x86_64__)
 bool cpu_support_avx512() {
   InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
@@ -81,6 +85,10 @@ void fvec_hook(std::string& simd_type) {
     fvec_madd = fvec_madd_sse;
     fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
 
+    int8vec_inner_product = int8vec_inner_product_avx512;
+    fp16vec_L2sqr = fp16vec_L2sqr_avx512;
+    fp16vec_inner_product = fp16vec_inner_product_avx512;
+
     simd_type = "AVX512";
   } else if (use_avx2 && cpu_support_avx2()) {
     fvec_inner_product = fvec_inner_product_avx;
@@ -94,6 +102,10 @@ void fvec_hook(std::string& simd_type) {
     fvec_madd = fvec_madd_sse;
     fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
 
+    int8vec_inner_product = int8vec_inner_product_avx;
+    fp16vec_L2sqr = fp16vec_L2sqr_avx;
+    fp16vec_inner_product = fp16vec_inner_product_avx;
+
     simd_type = "AVX2";
   } else if (use_sse4_2 && cpu_support_sse4_2()) {
     fvec_inner_product = fvec_inner_product_sse;
@@ -107,6 +119,10 @@ void fvec_hook(std::string& simd_type) {
     fvec_madd = fvec_madd_sse;
     fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
 
+    int8vec_inner_product = int8vec_inner_product_sse;
+    fp16vec_L2sqr = fp16vec_L2sqr_ref;
+    fp16vec_inner_product = fp16vec_inner_product_ref;
+
     simd_type = "SSE4_2";
   } else {
     fvec_inner_product = fvec_inner_product_ref;
@@ -120,6 +136,10 @@ void fvec_hook(std::string& simd_type) {
     fvec_madd = fvec_madd_ref;
     fvec_madd_and_argmin = fvec_madd_and_argmin_ref;
 
+    int8vec_inner_product = int8vec_inner_product_ref;
+    fp16vec_L2sqr = fp16vec_L2sqr_ref;
+    fp16vec_inner_product = fp16vec_inner_product_ref;
+
     simd_type = "GENERIC";
   }
 #endif
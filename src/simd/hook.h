@@ -17,7 +17,10 @@
 #ifndef DINGODB_SIMD_HOOK_H_
 #define DINGODB_SIMD_HOOK_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+
 namespace dingodb {
 
 extern float (*fvec_inner_product)(const float*, const float*, size_t);
@@ -30,6 +33,11 @@ extern void (*fvec_inner_products_ny)(float*, const float*, const float*, size_t
 extern void (*fvec_madd)(size_t, const float*, float, const float*, float*);
 extern int (*fvec_madd_and_argmin)(size_t, const float*, float, const float*, float*);
 
+// kernels of scalar quantized vectors, fp16 is IEEE 754 half precision stored in uint16_t
+extern int32_t (*int8vec_inner_product)(const int8_t*, const int8_t*, size_t);
+extern float (*fp16vec_L2sqr)(const uint16_t*, const uint16_t*, size_t);
+extern float (*fp16vec_inner_product)(const uint16_t*, const uint16_t*, size_t);
+
 #if defined(__x86_64__)
 extern bool use_avx512;
 extern bool use_avx2;
@@ -16,6 +16,8 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <queue>
@@ -28,6 +30,7 @@
 #include "config/config_helper.h"
 #include "engine/iterator.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "meta/store_meta_manager.h"
 #include "mvcc/codec.h"
 #include "proto/common.pb.h"
@@ -41,6 +44,12 @@ namespace dingodb {
 DECLARE_bool(enable_region_split_and_merge_for_lite);
 DECLARE_bool(region_enable_auto_split);
 
+DEFINE_bool(split_check_use_range_properties, true,
+            "get split key from the range properties of sst first, fall back to scan region when estimate is poor");
+DEFINE_int32(split_check_min_range_samples, 16, "min range samples num of region to estimate split key");
+DEFINE_double(split_check_range_properties_tolerance, 0.2,
+              "max deviation of split key position between range samples and approximate sizes");
+
 MergedIterator::MergedIterator(RawEnginePtr raw_engine, const std::vector<std::string>& cf_names,
                                const std::string& end_key)
     : raw_engine_(raw_engine) {
@@ -96,9 +105,145 @@ void MergedIterator::Next(IteratorPtr iter, int iter_pos) {
   }
 }
 
+// Get the range samples of region from sst properties, return false if can't estimate by them.
+static bool GetRegionRangeSamples(RawEnginePtr raw_engine, store::RegionPtr region, const pb::common::Range& range,
+                                  const std::vector<std::string>& cf_names,
+                                  std::vector<RawEngine::RangeSample>& samples, int64_t& count, int64_t& size) {
+  if (!FLAGS_split_check_use_range_properties) {
+    return false;
+  }
+
+  auto status = raw_engine->GetRangeSamples(cf_names, range, samples);
+  if (!status.ok()) {
+    DINGO_LOG(INFO) << fmt::format("[split.check][region({})] get range samples failed, error: {}", region->Id(),
+                                   status.error_str());
+    return false;
+  }
+  if (samples.size() < FLAGS_split_check_min_range_samples) {
+    DINGO_LOG(INFO) << fmt::format("[split.check][region({})] range samples({}) too few", region->Id(),
+                                   samples.size());
+    return false;
+  }
+
+  count = 0;
+  size = 0;
+  for (const auto& sample : samples) {
+    count += sample.count;
+    size += sample.size;
+  }
+
+  return true;
+}
+
+// Find the first sample key which accumulate count/size reach position, key_size is the accumulate size at the key.
+static std::string FindSampleKey(const std::vector<RawEngine::RangeSample>& samples, bool by_count, int64_t position,
+                                 int64_t& key_size) {
+  int64_t accumulate = 0;
+  key_size = 0;
+  for (const auto& sample : samples) {
+    accumulate += by_count ? sample.count : sample.size;
+    key_size += sample.size;
+    if (accumulate >= position) {
+      return sample.key;
+    }
+  }
+
+  return "";
+}
+
+// The position of split key by samples should be near the position by approximate sizes of sst,
+// otherwise the samples are not accurate, e.g. a lot of sst overlap the region boundary.
+static bool CheckSplitKeyPosition(RawEnginePtr raw_engine, store::RegionPtr region, const pb::common::Range& range,
+                                  const std::vector<std::string>& cf_names, const std::string& split_key,
+                                  double sample_ratio) {
+  std::vector<pb::common::Range> ranges(2);
+  ranges[0].set_start_key(range.start_key());
+  ranges[0].set_end_key(split_key);
+  ranges[1] = range;
+
+  int64_t left_size = 0;
+  int64_t total_size = 0;
+  for (const auto& cf_name : cf_names) {
+    auto sizes = raw_engine->GetApproximateSizes(cf_name, ranges);
+    left_size += sizes[0];
+    total_size += sizes[1];
+  }
+  if (total_size <= 0) {
+    return false;
+  }
+
+  double approximate_ratio = static_cast<double>(left_size) / total_size;
+  bool is_valid = std::abs(approximate_ratio - sample_ratio) <= FLAGS_split_check_range_properties_tolerance;
+  if (!is_valid) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[split.check][region({})] split key position by samples({:.3f}) deviate from approximate sizes({:.3f})",
+        region->Id(), sample_ratio, approximate_ratio);
+  }
+
+  return is_valid;
+}
+
+// The column family for estimate key count, the txn write cf or the raw data cf.
+// Sum count of all column families count a user key more than once, e.g. txn data and write cf.
+static std::string GetKeyCountColumnFamily(const std::vector<std::string>& cf_names) {
+  auto it = std::find(cf_names.begin(), cf_names.end(), Constant::kTxnWriteCF);
+  return it != cf_names.end() ? *it : cf_names.front();
+}
+
+// Split key by range samples, return false if need scan region.
+static bool SampleSplitKey(RawEnginePtr raw_engine, store::RegionPtr region, const pb::common::Range& range,
+                           const std::vector<std::string>& cf_names, bool by_count, int64_t threshold,
+                           int64_t position, int64_t& count, int64_t& size, std::string& split_key) {
+  std::vector<RawEngine::RangeSample> samples;
+  int64_t sample_count = 0;
+  int64_t sample_size = 0;
+  if (!GetRegionRangeSamples(raw_engine, region, range, cf_names, samples, sample_count, sample_size)) {
+    return false;
+  }
+
+  std::vector<std::string> count_cf_names = {GetKeyCountColumnFamily(cf_names)};
+  std::vector<RawEngine::RangeSample> count_samples;
+  int64_t key_count = sample_count;
+  int64_t count_cf_size = sample_size;
+  if (cf_names.size() > 1 && !GetRegionRangeSamples(raw_engine, region, range, count_cf_names, count_samples,
+                                                    key_count, count_cf_size)) {
+    return false;
+  }
+
+  split_key.clear();
+  if ((by_count ? key_count : sample_size) >= threshold) {
+    // position <= 0 is the half
+    if (position <= 0) {
+      position = (by_count ? key_count : sample_size) / 2;
+    }
+    // split by count locate the key in samples of the count column family
+    bool is_count_cf = by_count && cf_names.size() > 1;
+    int64_t key_size = 0;
+    split_key = FindSampleKey(is_count_cf ? count_samples : samples, by_count, position, key_size);
+    if (split_key.empty() ||
+        !CheckSplitKeyPosition(raw_engine, region, range, is_count_cf ? count_cf_names : cf_names, split_key,
+                               static_cast<double>(key_size) / (is_count_cf ? count_cf_size : sample_size))) {
+      return false;
+    }
+  }
+
+  count = key_count;
+  size = sample_size;
+  return true;
+}
+
 // base physics key, contain key of multi version.
 std::string HalfSplitChecker::SplitKey(store::RegionPtr region, const pb::common::Range& range,
-                                       const std::vector<std::string>& cf_names, uint32_t& count, int64_t& size) {
+                                       const std::vector<std::string>& cf_names, int64_t& count, int64_t& size) {
+  std::string sample_split_key;
+  if (SampleSplitKey(raw_engine_, region, range, cf_names, false, split_threshold_size_, 0, count, size,
+                     sample_split_key)) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[split.check][region({})] policy(HALF) by range samples split_threshold_size({}) actual_size({}) count({})",
+        region->Id(), split_threshold_size_, size, count);
+    return sample_split_key;
+  }
+
   MergedIterator iter(raw_engine_, cf_names, range.end_key());
   iter.Seek(range.start_key());
 
@@ -135,14 +280,25 @@ std::string HalfSplitChecker::SplitKey(store::RegionPtr region, const pb::common
 
 // base physics key, contain key of multi version.
 std::string SizeSplitChecker::SplitKey(store::RegionPtr region, const pb::common::Range& range,
-                                       const std::vector<std::string>& cf_names, uint32_t& count, int64_t& size) {
+                                       const std::vector<std::string>& cf_names, int64_t& count, int64_t& size) {
+  int64_t split_pos = split_size_ * split_ratio_;
+
+  std::string sample_split_key;
+  if (SampleSplitKey(raw_engine_, region, range, cf_names, false, split_size_, split_pos, count, size,
+                     sample_split_key)) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[split.check][region({})] policy(SIZE) by range samples split_size({}) split_ratio({}) actual_size({}) "
+        "count({})",
+        region->Id(), split_size_, split_ratio_, size, count);
+    return sample_split_key;
+  }
+
   MergedIterator iter(raw_engine_, cf_names, range.end_key());
   iter.Seek(range.start_key());
 
   std::string prev_key;
   std::string split_key;
   bool is_split = false;
-  int64_t split_pos = split_size_ * split_ratio_;
   for (; iter.Valid(); iter.Next()) {
     size += iter.KeyValueSize();
     if (split_key.empty() && size >= split_pos) {
@@ -166,7 +322,19 @@ std::string SizeSplitChecker::SplitKey(store::RegionPtr region, const pb::common
 
 // base logic key, ignore key of multi version.
 std::string KeysSplitChecker::SplitKey(store::RegionPtr region, const pb::common::Range& range,
-                                       const std::vector<std::string>& cf_names, uint32_t& count, int64_t& size) {
+                                       const std::vector<std::string>& cf_names, int64_t& count, int64_t& size) {
+  uint32_t split_key_number = split_keys_number_ * split_keys_ratio_;
+
+  std::string sample_split_key;
+  if (SampleSplitKey(raw_engine_, region, range, cf_names, true, split_keys_number_, split_key_number, count, size,
+                     sample_split_key)) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[split.check][region({})] policy(KEYS) by range samples split_key_number({}) split_key_ratio({}) "
+        "actual_size({}) count({})",
+        region->Id(), split_keys_number_, split_keys_ratio_, size, count);
+    return sample_split_key;
+  }
+
   MergedIterator iter(raw_engine_, cf_names, range.end_key());
   iter.Seek(range.start_key());
 
@@ -174,7 +342,6 @@ std::string KeysSplitChecker::SplitKey(store::RegionPtr region, const pb::common
   std::string prev_key;
   std::string split_key;
   bool is_split = false;
-  uint32_t split_key_number = split_keys_number_ * split_keys_ratio_;
   for (; iter.Valid(); iter.Next()) {
     if (prev_key != iter.Key()) {
       prev_key = iter.Key();
@@ -260,7 +427,7 @@ void SplitCheckTask::SplitCheck() {
   // todo: transform range?
   DINGO_LOG(INFO) << fmt::format("[split.check][region({})] Will check SplitKey for raw_range{} cf_names({})",
                                  region_->Id(), Helper::RangeToString(plain_range), Helper::VectorToString(cf_names));
-  uint32_t key_count = 0;
+  int64_t key_count = 0;
   int64_t size = 0;
   std::string encode_split_key = split_checker_->SplitKey(region_, encode_range, cf_names, key_count, size);
 
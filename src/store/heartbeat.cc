@@ -18,9 +18,11 @@
 
 #include <atomic>
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 #include "butil/compiler_specific.h"
@@ -34,6 +36,8 @@
 #include "coordinator/coordinator_control.h"
 #include "fmt/core.h"
 #include "gflags/gflags.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 #include "proto/common.pb.h"
 #include "proto/coordinator.pb.h"
 #include "proto/error.pb.h"
@@ -52,12 +56,62 @@ DECLARE_string(raft_snapshot_policy);
 DEFINE_int64(store_heartbeat_report_region_multiple, 3,
              "store heartbeat report region multiple, this defines how many times of heartbeat will report "
              "region_metrics once to coordinator");
+DEFINE_int64(store_heartbeat_full_region_multiple, 10,
+             "store heartbeat full region multiple, this defines how many times of region_metrics report will report "
+             "all regions once, others only report the regions changed since the last acknowledged heartbeat, "
+             "1 means always report all regions");
 
 DECLARE_bool(enable_balance_leader);
 DECLARE_bool(enable_balance_region);
 
 std::atomic<uint64_t> HeartbeatTask::heartbeat_counter = 0;
 
+bthread::Mutex HeartbeatTask::delta_mutex;
+std::map<int64_t, HeartbeatTask::AckedRegion> HeartbeatTask::acked_regions;
+uint64_t HeartbeatTask::region_report_counter = 0;
+bool HeartbeatTask::need_full_region_report = true;
+
+// same as coordinator GenRegionStatus, follower consecutive error times more than it is treated as error
+static const int64_t kFollowerConsecutiveErrorTimes = 10;
+
+uint64_t HeartbeatTask::GenRegionMetricsFingerprint(const pb::common::RegionMetrics& region_metrics) {
+  // braft status has volatile fields like next_index/last_rpc_send_timestamp, only keep the fields decide region status
+  pb::common::RegionMetrics stable_region_metrics = region_metrics;
+  stable_region_metrics.clear_braft_status();
+  stable_region_metrics.set_last_update_metrics_timestamp(0);
+
+  std::string buf;
+  {
+    google::protobuf::io::StringOutputStream string_stream(&buf);
+    google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    stable_region_metrics.SerializeToCodedStream(&coded_stream);
+  }
+
+  const auto& braft_status = region_metrics.braft_status();
+  buf.append(fmt::format("|{}|{}|{}", static_cast<int>(braft_status.raft_state()), braft_status.term(),
+                         braft_status.leader_peer_id()));
+
+  std::map<std::string, const pb::common::RaftPeerStatus*> stable_followers;
+  for (const auto& [peer_id, peer_status] : braft_status.stable_followers()) {
+    stable_followers.insert({peer_id, &peer_status});
+  }
+  for (const auto& [peer_id, peer_status] : stable_followers) {
+    buf.append(fmt::format("|{}:{}:{}", peer_id, peer_status->installing_snapshot(),
+                           peer_status->consecutive_error_times() > kFollowerConsecutiveErrorTimes));
+  }
+
+  std::set<std::string> unstable_followers;
+  for (const auto& [peer_id, peer_status] : braft_status.unstable_followers()) {
+    unstable_followers.insert(peer_id);
+  }
+  for (const auto& peer_id : unstable_followers) {
+    buf.append(fmt::format("|{}", peer_id));
+  }
+
+  return std::hash<std::string>{}(buf);
+}
+
 void HeartbeatTask::SendStoreHeartbeat(std::shared_ptr<CoordinatorInteraction> coordinator_interaction,
                                        std::vector<int64_t> region_ids, bool is_update_epoch_version) {
   auto start_time = Helper::TimestampMs();
@@ -97,15 +151,30 @@ void HeartbeatTask::SendStoreHeartbeat(std::shared_ptr<CoordinatorInteraction> c
                                  Helper::TimestampMs() - start_time)
                   << ", metrics: " << request.mutable_store_metrics()->ShortDebugString();
 
+  // periodic region_metrics report is delta, only the regions changed since the last acknowledged heartbeat are
+  // reported as a partial heartbeat, and every FLAGS_store_heartbeat_full_region_multiple times report all regions
+  // to resync coordinator. After a failed heartbeat, next report is full because we don't know what coordinator has.
+  // Coordinator not update region definition by partial heartbeat, so epoch change or new region need full report.
+  bool is_delta_report = false;
+  std::map<int64_t, AckedRegion> report_regions;
+  std::vector<pb::common::RegionMetrics> all_region_metrics;
+  if (need_report_region_metrics && region_ids.empty()) {
+    BAIDU_SCOPED_LOCK(delta_mutex);
+    is_delta_report = !need_full_region_report && FLAGS_store_heartbeat_full_region_multiple > 1 &&
+                      (region_report_counter % FLAGS_store_heartbeat_full_region_multiple != 0);
+    ++region_report_counter;
+  }
+
   if (need_report_region_metrics) {
-    DINGO_LOG(INFO) << fmt::format("[heartbeat.store] start_time({}) heartbeat_counter: {}", first_start_time,
-                                   temp_heartbeat_count);
+    DINGO_LOG(INFO) << fmt::format("[heartbeat.store] start_time({}) heartbeat_counter: {} is_delta_report: {}",
+                                   first_start_time, temp_heartbeat_count, is_delta_report);
 
     auto* mut_region_metrics_map = request.mutable_store_metrics()->mutable_region_metrics_map();
     auto region_metrics = store_metrics_manager->GetStoreRegionMetrics();
     std::vector<store::RegionPtr> region_metas;
     if (region_ids.empty()) {
       region_metas = store_meta_manager->GetStoreRegionMeta()->GetAllRegion();
+      all_region_metrics.reserve(region_metas.size());
     } else {
       request.mutable_store_metrics()->set_is_partial_region_metrics(true);
       for (auto region_id : region_ids) {
@@ -186,13 +255,58 @@ void HeartbeatTask::SendStoreHeartbeat(std::shared_ptr<CoordinatorInteraction> c
         }
       }
 
+      if (region_ids.empty()) {
+        AckedRegion report_region;
+        report_region.fingerprint = GenRegionMetricsFingerprint(tmp_region_metrics);
+        report_region.epoch_version = inner_region.definition().epoch().version();
+        report_region.epoch_conf_version = inner_region.definition().epoch().conf_version();
+        report_regions.insert({inner_region.id(), report_region});
+        all_region_metrics.push_back(std::move(tmp_region_metrics));
+        continue;
+      }
+
       mut_region_metrics_map->insert({inner_region.id(), tmp_region_metrics});
     }
 
+    if (region_ids.empty()) {
+      if (is_delta_report) {
+        BAIDU_SCOPED_LOCK(delta_mutex);
+        for (const auto& [region_id, report_region] : report_regions) {
+          auto it = acked_regions.find(region_id);
+          if (it == acked_regions.end() || it->second.epoch_version != report_region.epoch_version ||
+              it->second.epoch_conf_version != report_region.epoch_conf_version) {
+            is_delta_report = false;
+            break;
+          }
+        }
+      }
+
+      for (auto& tmp_region_metrics : all_region_metrics) {
+        if (is_delta_report) {
+          BAIDU_SCOPED_LOCK(delta_mutex);
+          auto it = acked_regions.find(tmp_region_metrics.id());
+          if (it != acked_regions.end() &&
+              it->second.fingerprint == report_regions[tmp_region_metrics.id()].fingerprint) {
+            continue;
+          }
+        }
+
+        int64_t region_id = tmp_region_metrics.id();
+        mut_region_metrics_map->insert({region_id, std::move(tmp_region_metrics)});
+      }
+
+      // delta report is not split/merge, coordinator treat partial heartbeat with epoch version as split/merge.
+      if (is_delta_report) {
+        request.mutable_store_metrics()->set_is_partial_region_metrics(true);
+        request.mutable_store_metrics()->set_is_update_epoch_version(false);
+      }
+    }
+
     DINGO_LOG(INFO) << fmt::format(
-        "[heartbeat.store] start_time({}) request region count({}) size({}) region_ids_count({}), elapsed time({} ms)",
+        "[heartbeat.store] start_time({}) request region count({}) size({}) region_ids_count({}) total region "
+        "count({}), elapsed time({} ms)",
         first_start_time, mut_region_metrics_map->size(), request.ByteSizeLong(), region_ids.size(),
-        Helper::TimestampMs() - start_time);
+        region_metas.size(), Helper::TimestampMs() - start_time);
   }
 
   if (!region_ids.empty()) {
@@ -212,9 +326,27 @@ void HeartbeatTask::SendStoreHeartbeat(std::shared_ptr<CoordinatorInteraction> c
   if (!status.ok()) {
     DINGO_LOG(WARNING) << fmt::format("[heartbeat.store] start_time({}) store heartbeat failed, error: {}",
                                       first_start_time, Helper::PrintStatus(status));
+    if (need_report_region_metrics && region_ids.empty()) {
+      BAIDU_SCOPED_LOCK(delta_mutex);
+      need_full_region_report = true;
+    }
     return;
   }
 
+  // coordinator return error if the region metrics is not applied, so here they are all applied.
+  if (need_report_region_metrics && region_ids.empty()) {
+    BAIDU_SCOPED_LOCK(delta_mutex);
+    if (is_delta_report) {
+      for (const auto& [region_id, region_metrics] : request.store_metrics().region_metrics_map()) {
+        acked_regions[region_id] = report_regions[region_id];
+      }
+    } else {
+      // full report replace all, the regions not exist any more are dropped.
+      acked_regions.swap(report_regions);
+      need_full_region_report = false;
+    }
+  }
+
   DINGO_LOG(INFO) << fmt::format("[heartbeat.store] start_time({}) response size({}) elapsed time({} ms)",
                                  first_start_time, response.ByteSizeLong(), Helper::TimestampMs() - start_time);
 
@@ -535,6 +667,14 @@ void VectorIndexScrubTask::ScrubVectorIndex() {
   }
 }
 
+// this is for document
+void DocumentIndexFlushTask::FlushDocumentIndex() {
+  auto status = DocumentIndexManager::FlushDocumentIndex();
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format("Flush document index failed, error: {}", status.error_str());
+  }
+}
+
 void BalanceLeaderTask::DoBalanceLeader() {
   auto coordinator_controller = Server::GetInstance().GetCoordinatorControl();
   if (!coordinator_controller->IsLeader()) {
@@ -689,6 +829,12 @@ void Heartbeat::TriggerScrubVectorIndex(void*) {
   Server::GetInstance().GetHeartbeat()->Execute(task);
 }
 
+void Heartbeat::TriggerFlushDocumentIndex(void*) {
+  // Free at ExecuteRoutine()
+  auto task = std::make_shared<DocumentIndexFlushTask>();
+  Server::GetInstance().GetHeartbeat()->Execute(task);
+}
+
 void Heartbeat::TriggerBalanceLeader(void*) {
   if (!FLAGS_enable_balance_leader) {
     DINGO_LOG(INFO) << "disable balance leader";
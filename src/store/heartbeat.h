@@ -16,8 +16,10 @@
 #define DINGODB_SERVER_HEARTBEAT_H_
 
 #include <cstdint>
+#include <map>
 #include <memory>
 
+#include "bthread/mutex.h"
 #include "common/logging.h"
 #include "common/runnable.h"
 #include "coordinator/coordinator_control.h"
@@ -50,7 +52,24 @@ class HeartbeatTask : public TaskRunnable {
 
   static std::atomic<uint64_t> heartbeat_counter;
 
+  // fingerprint of the region metrics fields which coordinator care about, e.g. epoch/leader/state/metrics.
+  static uint64_t GenRegionMetricsFingerprint(const pb::common::RegionMetrics& region_metrics);
+
  private:
+  // the region metrics in the last acknowledged heartbeat.
+  struct AckedRegion {
+    uint64_t fingerprint{0};
+    // coordinator only update region definition in full heartbeat, so epoch change need full report.
+    int64_t epoch_version{0};
+    int64_t epoch_conf_version{0};
+  };
+
+  // delta heartbeat state, region id -> the region metrics in the last acknowledged heartbeat.
+  static bthread::Mutex delta_mutex;
+  static std::map<int64_t, AckedRegion> acked_regions;
+  static uint64_t region_report_counter;
+  static bool need_full_region_report;
+
   bool is_update_epoch_version_;
   std::vector<int64_t> region_ids_;
   std::shared_ptr<CoordinatorInteraction> coordinator_interaction_;
@@ -208,6 +227,18 @@ class VectorIndexScrubTask : public TaskRunnable {
   static void ScrubVectorIndex();
 };
 
+class DocumentIndexFlushTask : public TaskRunnable {
+ public:
+  DocumentIndexFlushTask() = default;
+  ~DocumentIndexFlushTask() override = default;
+
+  std::string Type() override { return "DOCUMENT_INDEX_FLUSH"; }
+
+  void Run() override { FlushDocumentIndex(); }
+
+  static void FlushDocumentIndex();
+};
+
 class BalanceLeaderTask : public TaskRunnable {
  public:
   BalanceLeaderTask() = default;
@@ -251,6 +282,7 @@ class Heartbeat {
   static void TriggerKvRemoveOneTimeWatch(void*);
   static void TriggerCalculateTableMetrics(void*);
   static void TriggerScrubVectorIndex(void*);
+  static void TriggerFlushDocumentIndex(void*);
   static void TriggerLeaseTask(void*);
   static void TriggerCompactionTask(void*);
   static void TriggerBalanceLeader(void*);
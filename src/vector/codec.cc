@@ -15,7 +15,9 @@
 #include "vector/codec.h"
 
 #include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include "common/constant.h"
@@ -23,11 +25,22 @@
 #include "common/logging.h"
 #include "common/serial_helper.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "glog/logging.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
 #include "mvcc/codec.h"
 
 namespace dingodb {
 
+// old version store can not read raw format, turn on after all stores of cluster are upgraded.
+DEFINE_bool(vector_data_enable_raw_format, false, "enable write vector data with raw format instead of protobuf");
+
+// field number 0 and wire type 7 is invalid for protobuf, so it never be the first byte of serialized proto
+constexpr char kVectorValueRawFormatFlag = 0x07;
+constexpr char kVectorValueRawFormatVersion = 0x01;
+constexpr size_t kVectorValueRawFormatHeaderSize = 7;
+
 std::string VectorCodec::PackageVectorKey(char prefix, int64_t partition_id) {
   CHECK(prefix != 0) << fmt::format("Invalid prefix {}.", prefix);
   CHECK(partition_id > 0) << fmt::format("Invalid partition_id {}.", partition_id);
@@ -309,6 +322,172 @@ void VectorCodec::DecodeRangeToVectorId(bool is_encode, const pb::common::Range&
   }
 }
 
+static void WriteUint32LE(uint32_t value, std::string& output) {
+  for (int i = 0; i < 4; ++i) {
+    output.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+  }
+}
+
+static uint32_t ReadUint32LE(const char* data) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) {
+    value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (i * 8);
+  }
+  return value;
+}
+
+static bool CanUseRawFormat(const pb::common::Vector& vector) {
+  if (vector.value_type() == pb::common::ValueType::FLOAT) {
+    return vector.binary_values().empty();
+  }
+
+  if (vector.value_type() == pb::common::ValueType::UINT8) {
+    if (!vector.float_values().empty()) {
+      return false;
+    }
+    for (const auto& binary_value : vector.binary_values()) {
+      if (binary_value.size() != 1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  return false;
+}
+
+std::string VectorCodec::EncodeVectorValue(const pb::common::Vector& vector) {
+  if (!FLAGS_vector_data_enable_raw_format || !CanUseRawFormat(vector)) {
+    return vector.SerializeAsString();
+  }
+
+  std::string value;
+  if (vector.value_type() == pb::common::ValueType::FLOAT) {
+    value.reserve(kVectorValueRawFormatHeaderSize + vector.float_values_size() * sizeof(float));
+  } else {
+    value.reserve(kVectorValueRawFormatHeaderSize + vector.binary_values_size());
+  }
+
+  value.push_back(kVectorValueRawFormatFlag);
+  value.push_back(kVectorValueRawFormatVersion);
+  value.push_back(static_cast<char>(vector.value_type()));
+  WriteUint32LE(static_cast<uint32_t>(vector.dimension()), value);
+
+  if (vector.value_type() == pb::common::ValueType::FLOAT) {
+    if (SerialHelper::IsLE()) {
+      value.append(reinterpret_cast<const char*>(vector.float_values().data()),
+                   vector.float_values_size() * sizeof(float));
+    } else {
+      for (float float_value : vector.float_values()) {
+        uint32_t bits = 0;
+        memcpy(&bits, &float_value, sizeof(float));
+        WriteUint32LE(bits, value);
+      }
+    }
+  } else {
+    for (const auto& binary_value : vector.binary_values()) {
+      value.push_back(binary_value[0]);
+    }
+  }
+
+  return value;
+}
+
+bool VectorCodec::IsRawVectorValue(std::string_view vector_value) {
+  return !vector_value.empty() && vector_value[0] == kVectorValueRawFormatFlag;
+}
+
+bool VectorCodec::DecodeVectorValue(std::string_view vector_value, pb::common::Vector& vector) {
+  if (!IsRawVectorValue(vector_value)) {
+    return vector.ParseFromArray(vector_value.data(), vector_value.size());
+  }
+
+  if (vector_value.size() < kVectorValueRawFormatHeaderSize || vector_value[1] != kVectorValueRawFormatVersion) {
+    return false;
+  }
+
+  vector.Clear();
+  vector.set_value_type(static_cast<pb::common::ValueType>(vector_value[2]));
+  vector.set_dimension(static_cast<int32_t>(ReadUint32LE(vector_value.data() + 3)));
+
+  std::string_view values = vector_value.substr(kVectorValueRawFormatHeaderSize);
+  if (vector.value_type() == pb::common::ValueType::FLOAT) {
+    if (values.size() % sizeof(float) != 0) {
+      return false;
+    }
+
+    size_t count = values.size() / sizeof(float);
+    vector.mutable_float_values()->Resize(count, 0.0F);
+    float* dst = vector.mutable_float_values()->mutable_data();
+    if (SerialHelper::IsLE()) {
+      memcpy(dst, values.data(), values.size());
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        uint32_t bits = ReadUint32LE(values.data() + i * sizeof(float));
+        memcpy(dst + i, &bits, sizeof(float));
+      }
+    }
+
+  } else if (vector.value_type() == pb::common::ValueType::UINT8) {
+    vector.mutable_binary_values()->Reserve(values.size());
+    for (char c : values) {
+      vector.add_binary_values(std::string(1, c));
+    }
+
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+bool VectorCodec::DecodeFloatValuesView(std::string_view vector_value, std::string_view& float_values) {
+  using google::protobuf::internal::WireFormatLite;
+
+  float_values = std::string_view();
+
+  if (IsRawVectorValue(vector_value)) {
+    if (vector_value.size() < kVectorValueRawFormatHeaderSize || vector_value[1] != kVectorValueRawFormatVersion ||
+        vector_value[2] != static_cast<char>(pb::common::ValueType::FLOAT) || !SerialHelper::IsLE()) {
+      return false;
+    }
+
+    float_values = vector_value.substr(kVectorValueRawFormatHeaderSize);
+    return float_values.size() % sizeof(float) == 0;
+  }
+
+  google::protobuf::io::CodedInputStream input(reinterpret_cast<const uint8_t*>(vector_value.data()),
+                                               static_cast<int>(vector_value.size()));
+  bool found = false;
+  for (uint32_t tag = input.ReadTag(); tag != 0; tag = input.ReadTag()) {
+    if (WireFormatLite::GetTagFieldNumber(tag) != pb::common::Vector::kFloatValuesFieldNumber) {
+      if (!WireFormatLite::SkipField(&input, tag)) {
+        return false;
+      }
+      continue;
+    }
+
+    // only support packed repeated float, the default encoding of proto3
+    if (found || WireFormatLite::GetTagWireType(tag) != WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      return false;
+    }
+
+    uint32_t length = 0;
+    if (!input.ReadVarint32(&length) || length % sizeof(float) != 0) {
+      return false;
+    }
+    int offset = input.CurrentPosition();
+    if (!input.Skip(static_cast<int>(length))) {
+      return false;
+    }
+
+    float_values = vector_value.substr(offset, length);
+    found = true;
+  }
+
+  return found && static_cast<size_t>(input.CurrentPosition()) == vector_value.size();
+}
+
 bool VectorCodec::IsValidKey(const std::string& key) {
   return (key.size() == Constant::kVectorKeyMinLenWithPrefix || key.size() >= Constant::kVectorKeyMaxLenWithPrefix);
 }
@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 #include "proto/common.pb.h"
 
@@ -74,6 +75,18 @@ class VectorCodec {
   static void DecodeRangeToVectorId(bool is_encode, const pb::common::Range& range, int64_t& begin_vector_id,
                                     int64_t& end_vector_id);
 
+  // vector value of vector data cf, raw format:
+  // | flag(1byte) | version(1byte) | value_type(1byte) | dimension(4byte) | values |
+  // float values are little endian float32, binary values are one byte per element.
+  // value which can't be expressed by raw format or written before raw format is serialized pb::common::Vector.
+  static std::string EncodeVectorValue(const pb::common::Vector& vector);
+  static bool DecodeVectorValue(std::string_view vector_value, pb::common::Vector& vector);
+  static bool IsRawVectorValue(std::string_view vector_value);
+
+  // get float values of vector value without parse the whole proto,
+  // float_values point to the memory of vector_value, return false when not found packed float values.
+  static bool DecodeFloatValuesView(std::string_view vector_value, std::string_view& float_values);
+
   // key is plain key
   static bool IsValidKey(const std::string& key);
 
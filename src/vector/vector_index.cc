@@ -55,6 +55,9 @@ DEFINE_uint32(vector_read_batch_size_per_task, 1, "vector read batch size per ta
 
 DEFINE_uint32(parallel_log_threshold_time_ms, 5000, "parallel log elapsed time");
 
+DEFINE_uint32(vector_train_sample_count_per_centroid, 256,
+              "sample count per centroid of ivf train data when build, faiss use at most 256 per centroid");
+
 // split VectorWithId set to multi batch
 static void SplitVectorWithId(const std::vector<pb::common::VectorWithId>& vector_with_ids, int batch_size,
                               std::vector<std::vector<pb::common::VectorWithId>>& vector_with_id_batchs) {
@@ -355,6 +358,7 @@ VectorIndexWrapper::VectorIndexWrapper(int64_t id, pb::common::VectorIndexParame
       saving_num_(0),
       save_snapshot_threshold_write_key_num_(save_snapshot_threshold_write_key_num) {
   snapshot_set_ = vector_index::SnapshotMetaSet::New(id, VectorIndexSnapshotManager::GetSnapshotParentPath(id));
+  scalar_index_ = VectorScalarIndex::New();
   bthread_mutex_init(&vector_index_mutex_, nullptr);
   DINGO_LOG(DEBUG) << fmt::format("[new.VectorIndexWrapper][id({})]", id_);
 }
@@ -630,6 +634,8 @@ void VectorIndexWrapper::UpdateVectorIndex(VectorIndexPtr vector_index, const st
 void VectorIndexWrapper::ClearVectorIndex(const std::string& trace) {
   DINGO_LOG(INFO) << fmt::format("[vector_index.wrapper][index_id({})][trace({})] Clear all vector index", Id(), trace);
 
+  scalar_index_->Reset();
+
   BAIDU_SCOPED_LOCK(vector_index_mutex_);
 
   ready_.store(false);
@@ -821,6 +827,33 @@ bool VectorIndexWrapper::SupportSave() {
   return vector_index->SupportSave();
 }
 
+uint32_t VectorIndexWrapper::RerankCandidateMultiple() {
+  auto vector_index = GetVectorIndex();
+  if (vector_index == nullptr) {
+    return 0;
+  }
+
+  return vector_index->RerankCandidateMultiple();
+}
+
+bool VectorIndexWrapper::NeedToRepair() {
+  auto vector_index = GetOwnVectorIndex();
+  if (vector_index == nullptr) {
+    return false;
+  }
+
+  return vector_index->NeedToRepair();
+}
+
+butil::Status VectorIndexWrapper::Repair() {
+  auto vector_index = GetOwnVectorIndex();
+  if (vector_index == nullptr) {
+    return butil::Status(pb::error::EVECTOR_INDEX_NOT_FOUND, "vector index %lu is not ready.", Id());
+  }
+
+  return vector_index->Repair();
+}
+
 bool VectorIndexWrapper::NeedToSave(std::string& reason) {
   auto vector_index = GetOwnVectorIndex();
   if (vector_index == nullptr) {
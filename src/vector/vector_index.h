@@ -35,8 +35,10 @@
 #include "faiss/impl/IDSelector.h"
 #include "fmt/core.h"
 #include "proto/common.pb.h"
+#include "proto/error.pb.h"
 #include "proto/index.pb.h"
 #include "vector/vector_index_snapshot.h"
+#include "vector/vector_scalar_index.h"
 
 namespace dingodb {
 
@@ -69,6 +71,11 @@ class VectorIndex {
     virtual ~FilterFunctor() = default;
     virtual void Build(std::vector<faiss::idx_t>& id_map) {}
     virtual bool Check(int64_t vector_id) = 0;
+
+    // count of allowed vector ids, -1 means unknown, e.g. range filter or negation filter.
+    virtual int64_t AllowedCount() { return -1; }
+    // get sorted allowed vector ids, only valid when AllowedCount() >= 0.
+    virtual void GetAllowedVectorIds(std::vector<int64_t>& /*vector_ids*/) {}
   };
 
   // Range filter
@@ -123,6 +130,14 @@ class VectorIndex {
       return !is_negation_ ? exist : !exist;
     }
 
+    int64_t AllowedCount() override { return !is_negation_ ? vector_ids_.size() : -1; }
+
+    void GetAllowedVectorIds(std::vector<int64_t>& vector_ids) override {
+      if (!is_negation_) {
+        vector_ids = vector_ids_;
+      }
+    }
+
    private:
     bool IsExist(int64_t vector_id) const {
       int64_t begin = 0, end = vector_ids_.size() - 1;
@@ -145,6 +160,85 @@ class VectorIndex {
     std::vector<int64_t> vector_ids_;
   };
 
+  // dense bitmap over [min_vector_id, max_vector_id], Check is O(1) and cache friendly in hnsw inner loop.
+  // Only use it when vector ids are dense enough, otherwise bitmap memory is too large, use SortFilterFunctor.
+  class BitmapFilterFunctor : public FilterFunctor {
+   public:
+    BitmapFilterFunctor(const BitmapFilterFunctor&) = delete;
+    BitmapFilterFunctor(BitmapFilterFunctor&&) = delete;
+    BitmapFilterFunctor& operator=(const BitmapFilterFunctor&) = delete;
+    BitmapFilterFunctor& operator=(BitmapFilterFunctor&&) = delete;
+
+    // vector_ids must be sorted
+    explicit BitmapFilterFunctor(const std::vector<int64_t>& vector_ids, bool is_negation = false)
+        : is_negation_(is_negation) {
+      if (vector_ids.empty()) {
+        return;
+      }
+
+      min_vector_id_ = vector_ids.front();
+      max_vector_id_ = vector_ids.back();
+      bits_.resize(BitmapWordCount(min_vector_id_, max_vector_id_), 0);
+      for (int64_t vector_id : vector_ids) {
+        uint64_t offset = static_cast<uint64_t>(vector_id) - static_cast<uint64_t>(min_vector_id_);
+        uint64_t& word = bits_[offset >> 6];
+        uint64_t mask = 1ULL << (offset & 63);
+        if ((word & mask) == 0) {
+          word |= mask;
+          ++count_;
+        }
+      }
+    }
+
+    ~BitmapFilterFunctor() override = default;
+
+    // bitmap uint64 word count of the vector id span
+    static uint64_t BitmapWordCount(int64_t min_vector_id, int64_t max_vector_id) {
+      return ((static_cast<uint64_t>(max_vector_id) - static_cast<uint64_t>(min_vector_id)) >> 6) + 1;
+    }
+
+    bool Check(int64_t vector_id) override {
+      bool exist = IsExist(vector_id);
+      return !is_negation_ ? exist : !exist;
+    }
+
+    int64_t AllowedCount() override { return !is_negation_ ? count_ : -1; }
+
+    void GetAllowedVectorIds(std::vector<int64_t>& vector_ids) override {
+      if (is_negation_) {
+        return;
+      }
+
+      vector_ids.clear();
+      vector_ids.reserve(count_);
+      for (size_t i = 0; i < bits_.size(); ++i) {
+        uint64_t word = bits_[i];
+        while (word != 0) {
+          int bit = __builtin_ctzll(word);
+          vector_ids.push_back(min_vector_id_ + static_cast<int64_t>((i << 6) + bit));
+          word &= word - 1;
+        }
+      }
+    }
+
+   private:
+    bool IsExist(int64_t vector_id) const {
+      if (vector_id < min_vector_id_ || vector_id > max_vector_id_ || bits_.empty()) {
+        return false;
+      }
+
+      uint64_t offset = static_cast<uint64_t>(vector_id) - static_cast<uint64_t>(min_vector_id_);
+      return (bits_[offset >> 6] >> (offset & 63)) & 1;
+    }
+
+    bool is_negation_{false};
+
+    int64_t min_vector_id_{0};
+    int64_t max_vector_id_{0};
+    int64_t count_{0};
+    std::vector<uint64_t> bits_;
+  };
+
   virtual int32_t GetDimension() = 0;
   virtual pb::common::MetricType GetMetricType() = 0;
   virtual butil::Status GetCount(int64_t& count);
@@ -198,6 +292,14 @@ class VectorIndex {
   virtual bool NeedToRebuild() = 0;
   virtual bool NeedTrain() { return false; }
   virtual bool IsTrained() { return true; }
+  // Sample count of train data for build, 0 means train by all data.
+  virtual int64_t TrainSampleCount() { return 0; }
+  // Train data is sampled from total_count vectors, record it to decide whether rebuild when data grow.
+  virtual void SetTrainDataSize(int64_t /*total_count*/) {}
+  // Reuse the trained model(e.g. ivf centroids) of other index which has same parameter, e.g. parent after split.
+  virtual butil::Status TrainByIndex(std::shared_ptr<VectorIndex> /*trained_index*/) {
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "this vector index do not support train by index");
+  }
   virtual bool NeedToSave(int64_t last_save_log_behind) = 0;
   virtual bool SupportSave() { return false; }
   virtual butil::Status Build(const pb::common::Range& /*region_range*/, mvcc::ReaderPtr /*reader*/,
@@ -228,6 +330,14 @@ class VectorIndex {
 
   virtual uint32_t WriteOpParallelNum() { return 1; }
 
+  // Index keep the lossy code of vector, the search distance is approximate.
+  // >0 means search should fetch topk * multiple candidates and re-rank them by the exact vector.
+  virtual uint32_t RerankCandidateMultiple() { return 0; }
+
+  // Repair index in place incrementally, e.g. the graph degraded by deleted vectors, instead of a full rebuild.
+  virtual bool NeedToRepair() { return false; }
+  virtual butil::Status Repair() { return butil::Status::OK(); }
+
   int64_t Id() const { return id; }
 
   pb::common::VectorIndexType VectorIndexType() { return vector_index_type; }
@@ -384,6 +494,8 @@ class VectorIndexWrapper : public std::enable_shared_from_this<VectorIndexWrappe
   VectorIndexPtr SiblingVectorIndex();
   void SetSiblingVectorIndex(VectorIndexPtr vector_index);
 
+  VectorScalarIndexPtr ScalarIndex() { return scalar_index_; }
+
   bool ExecuteTask(TaskRunnablePtr task);
 
   int32_t PendingTaskNum();
@@ -412,6 +524,9 @@ class VectorIndexWrapper : public std::enable_shared_from_this<VectorIndexWrappe
   bool NeedToRebuild();
   bool NeedToSave(std::string& reason);
   bool SupportSave();
+  uint32_t RerankCandidateMultiple();
+  bool NeedToRepair();
+  butil::Status Repair();
 
   butil::Status Add(const std::vector<pb::common::VectorWithId>& vector_with_ids);
   butil::Status Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids);
@@ -485,6 +600,9 @@ class VectorIndexWrapper : public std::enable_shared_from_this<VectorIndexWrappe
   // Snapshot set
   vector_index::SnapshotMetaSetPtr snapshot_set_;
 
+  // Scalar speed up key postings, for scalar pre filter search
+  VectorScalarIndexPtr scalar_index_;
+
   std::atomic<int32_t> pending_task_num_;
   // vector index loadorbuilding num
   std::atomic<int32_t> loadorbuilding_num_;
@@ -828,7 +828,7 @@ butil::Status VectorIndexDiskANN::DoBuild(const pb::common::Range& region_range,
     std::string value(mvcc::Codec::UnPackageValue(iter->Value()));
 
     pb::common::Vector vector;
-    CHECK(vector.ParseFromString(value)) << "Parse vector proto error";
+    CHECK(VectorCodec::DecodeVectorValue(value, vector)) << "Parse vector proto error";
     // std::cout << "key : " << Helper::StringToHex(key) << ", vector_id : " << vector_id << std::endl;
     vector_push_data_request.add_vectors()->Swap(&vector);
     vector_push_data_request.add_vector_ids(vector_id);
@@ -24,6 +24,7 @@
 #include "faiss/IndexIDMap.h"
 #include "faiss/IndexIVF.h"
 #include "faiss/IndexIVFFlat.h"
+#include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "server/server.h"
 #include "vector/vector_index.h"
@@ -37,6 +38,8 @@
 
 namespace dingodb {
 
+DECLARE_string(hnsw_quantization_type);
+
 std::shared_ptr<VectorIndex> VectorIndexFactory::New(int64_t id,
                                                      const pb::common::VectorIndexParameter& index_parameter,
                                                      const pb::common::RegionEpoch& epoch,
@@ -121,15 +124,24 @@ std::shared_ptr<VectorIndex> VectorIndexFactory::NewHnsw(int64_t id,
     return nullptr;
   }
 
+  // int8/fp16 quantization keep the code of vector in hnsw graph, save memory but lose some precision.
+  VectorIndexHnsw::QuantizationType quantization_type = VectorIndexHnsw::QuantizationType::kNone;
+  if (!VectorIndexHnsw::ParseQuantizationType(FLAGS_hnsw_quantization_type, quantization_type)) {
+    DINGO_LOG(ERROR) << "hnsw_quantization_type is illegal, " << FLAGS_hnsw_quantization_type;
+    return nullptr;
+  }
+
   // create index may throw exeception, so we need to catch it
   try {
-    auto new_hnsw_index = std::make_shared<VectorIndexHnsw>(id, index_parameter, epoch, range, thread_pool);
+    auto new_hnsw_index =
+        std::make_shared<VectorIndexHnsw>(id, index_parameter, epoch, range, thread_pool, quantization_type);
     if (new_hnsw_index == nullptr) {
       DINGO_LOG(ERROR) << "create hnsw index failed of new_hnsw_index is nullptr, id=" << id
                        << ", parameter=" << index_parameter.ShortDebugString();
       return nullptr;
     } else {
-      DINGO_LOG(INFO) << "create hnsw index success, id=" << id << ", parameter=" << index_parameter.ShortDebugString();
+      DINGO_LOG(INFO) << "create hnsw index success, id=" << id << ", parameter=" << index_parameter.ShortDebugString()
+                      << ", quantization_type=" << VectorIndexHnsw::QuantizationTypeName(quantization_type);
     }
     return new_hnsw_index;
   } catch (std::exception& e) {
@@ -16,14 +16,23 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
 #include <memory>
+#include <mutex>
+#include <queue>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "bthread/bthread.h"
 #include "butil/status.h"
 #include "bvar/latency_recorder.h"
 #include "common/constant.h"
@@ -35,6 +44,8 @@
 #include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
+#include "simd/distances_ref.h"
+#include "simd/hook.h"
 #include "vector/vector_index.h"
 #include "vector/vector_index_utils.h"
 
@@ -54,11 +65,22 @@ DEFINE_uint32(hnsw_vector_write_batch_size_per_task, 16, "hnsw vector write batc
 DECLARE_uint32(vector_read_batch_size_per_task);
 DECLARE_uint32(parallel_log_threshold_time_ms);
 
+// not reloadable, the type of an index is fixed at creation and saved with its snapshot.
+DEFINE_string(hnsw_quantization_type, "none", "hnsw element data quantization type of new index, none/int8/fp16");
+
+DEFINE_uint32(hnsw_quantization_rerank_multiple, 4,
+              "quantized hnsw search topk * multiple candidates and re-rank them by exact vector, 0 is not re-rank");
+
+DEFINE_bool(hnsw_enable_replace_deleted, true, "hnsw new vector reuse the slot of deleted vector");
+DEFINE_int64(hnsw_repair_min_delete_count, 1000, "hnsw repair graph when deleted count since last repair reach it");
+DEFINE_uint32(hnsw_repair_batch_node_count, 1000, "hnsw repair graph node count per batch, hold write lock per batch");
+
 bvar::LatencyRecorder g_hnsw_upsert_latency("dingo_hnsw_upsert_latency");
 bvar::LatencyRecorder g_hnsw_search_latency("dingo_hnsw_search_latency");
 bvar::LatencyRecorder g_hnsw_range_search_latency("dingo_hnsw_range_search_latency");
 bvar::LatencyRecorder g_hnsw_delete_latency("dingo_hnsw_delete_latency");
 bvar::LatencyRecorder g_hnsw_load_latency("dingo_hnsw_load_latency");
+bvar::LatencyRecorder g_hnsw_repair_latency("dingo_hnsw_repair_latency");
 
 // Filter vector id used by region range.
 class HnswRangeFilterFunctor : public hnswlib::BaseFilterFunctor {
@@ -82,6 +104,130 @@ class HnswRangeFilterFunctor : public hnswlib::BaseFilterFunctor {
   std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters_;
 };
 
+// Visited list of search owned by one thread, reused by the searches run in this thread.
+// Element is visited when its mark equal to the tag of current search, so reset is only increase the tag.
+class HnswVisitedList {
+ public:
+  uint16_t Reset(size_t max_elements) {
+    if (marks_.size() < max_elements) {
+      marks_.assign(max_elements, 0);
+      tag_ = 0;
+    }
+
+    ++tag_;
+    if (tag_ == 0) {
+      std::fill(marks_.begin(), marks_.end(), 0);
+      ++tag_;
+    }
+
+    return tag_;
+  }
+
+  uint16_t* Marks() { return marks_.data(); }
+
+ private:
+  std::vector<uint16_t> marks_;
+  uint16_t tag_{0};
+};
+
+static thread_local HnswVisitedList tls_hnsw_visited_list;
+
+// Hnsw space of scalar quantized element data, the query and the elements are both codes.
+// int8 code: scale(float) + squared norm(float) + int8 * dimension, value[i] = scale * code[i].
+// fp16 code: fp16 * dimension.
+class HnswQuantizedSpace : public hnswlib::SpaceInterface<float> {
+ public:
+  HnswQuantizedSpace(VectorIndexHnsw::QuantizationType quantization_type, bool is_inner_product, size_t dimension)
+      : quantization_type_(quantization_type), dimension_(dimension) {
+    data_size_ = VectorIndexHnsw::CalcElementDataSize(quantization_type, dimension);
+    if (quantization_type_ == VectorIndexHnsw::QuantizationType::kInt8) {
+      dist_func_ = is_inner_product ? Int8InnerProductDistance : Int8L2Distance;
+    } else {
+      dist_func_ = is_inner_product ? Fp16InnerProductDistance : Fp16L2Distance;
+    }
+  }
+  ~HnswQuantizedSpace() override = default;
+
+  size_t get_data_size() override { return data_size_; }
+  hnswlib::DISTFUNC<float> get_dist_func() override { return dist_func_; }
+  // getDataByLabel read the first size_t of param as dimension
+  void* get_dist_func_param() override { return &dimension_; }
+
+  // code must have get_data_size() bytes
+  void Encode(const float* vector, char* code) const {
+    if (quantization_type_ == VectorIndexHnsw::QuantizationType::kInt8) {
+      float max_abs = 0.0F;
+      for (size_t i = 0; i < dimension_; ++i) {
+        max_abs = std::max(max_abs, std::fabs(vector[i]));
+      }
+      float scale = max_abs > 0.0F ? max_abs / 127.0F : 1.0F;
+
+      auto* values = reinterpret_cast<int8_t*>(code + kInt8HeaderSize);
+      int64_t norm = 0;
+      for (size_t i = 0; i < dimension_; ++i) {
+        int32_t value = std::clamp(static_cast<int32_t>(std::lround(vector[i] / scale)), -127, 127);
+        values[i] = static_cast<int8_t>(value);
+        norm += value * value;
+      }
+      float norm_sq = scale * scale * static_cast<float>(norm);
+
+      memcpy(code, &scale, sizeof(float));
+      memcpy(code + sizeof(float), &norm_sq, sizeof(float));
+    } else {
+      auto* values = reinterpret_cast<uint16_t*>(code);
+      for (size_t i = 0; i < dimension_; ++i) {
+        values[i] = fp32_to_fp16(vector[i]);
+      }
+    }
+  }
+
+  static constexpr size_t kInt8HeaderSize = 2 * sizeof(float);
+
+ private:
+  // return scale_a * scale_b * ip(code_a, code_b), and the squared norm of a and b
+  static float Int8InnerProduct(const void* a, const void* b, const void* param, float& norm_a, float& norm_b) {
+    size_t dimension = *static_cast<const size_t*>(param);
+    const auto* code_a = static_cast<const char*>(a);
+    const auto* code_b = static_cast<const char*>(b);
+
+    float scale_a, scale_b;
+    memcpy(&scale_a, code_a, sizeof(float));
+    memcpy(&norm_a, code_a + sizeof(float), sizeof(float));
+    memcpy(&scale_b, code_b, sizeof(float));
+    memcpy(&norm_b, code_b + sizeof(float), sizeof(float));
+
+    int32_t ip = int8vec_inner_product(reinterpret_cast<const int8_t*>(code_a + kInt8HeaderSize),
+                                       reinterpret_cast<const int8_t*>(code_b + kInt8HeaderSize), dimension);
+    return scale_a * scale_b * static_cast<float>(ip);
+  }
+
+  static float Int8L2Distance(const void* a, const void* b, const void* param) {
+    float norm_a, norm_b;
+    float ip = Int8InnerProduct(a, b, param, norm_a, norm_b);
+    return norm_a + norm_b - 2.0F * ip;
+  }
+
+  static float Int8InnerProductDistance(const void* a, const void* b, const void* param) {
+    float norm_a, norm_b;
+    return 1.0F - Int8InnerProduct(a, b, param, norm_a, norm_b);
+  }
+
+  static float Fp16L2Distance(const void* a, const void* b, const void* param) {
+    return fp16vec_L2sqr(static_cast<const uint16_t*>(a), static_cast<const uint16_t*>(b),
+                         *static_cast<const size_t*>(param));
+  }
+
+  static float Fp16InnerProductDistance(const void* a, const void* b, const void* param) {
+    return 1.0F - fp16vec_inner_product(static_cast<const uint16_t*>(a), static_cast<const uint16_t*>(b),
+                                        *static_cast<const size_t*>(param));
+  }
+
+  VectorIndexHnsw::QuantizationType quantization_type_;
+  size_t dimension_;
+  size_t data_size_;
+  hnswlib::DISTFUNC<float> dist_func_;
+};
+
 template <typename Function>
 inline void ParallelFor(ThreadPoolPtr thread_pool, int64_t vector_index_id, size_t start, size_t end,
                         uint32_t batch_size, bool is_priority, Function fn) {
@@ -134,8 +280,11 @@ inline void ParallelFor(ThreadPoolPtr thread_pool, int64_t vector_index_id, size
 
 VectorIndexHnsw::VectorIndexHnsw(int64_t id, const pb::common::VectorIndexParameter& vector_index_parameter,
                                  const pb::common::RegionEpoch& epoch, const pb::common::Range& range,
-                                 ThreadPoolPtr thread_pool)
-    : VectorIndex(id, vector_index_parameter, epoch, range, thread_pool), hnsw_space_(nullptr), hnsw_index_(nullptr) {
+                                 ThreadPoolPtr thread_pool, QuantizationType quantization_type)
+    : VectorIndex(id, vector_index_parameter, epoch, range, thread_pool),
+      hnsw_space_(nullptr),
+      hnsw_index_(nullptr),
+      quantization_type_(quantization_type) {
   if (vector_index_type == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW) {
     // const auto& hnsw_parameter = vector_index_parameter.hnsw_parameter();
     auto& hnsw_parameter = const_cast<pb::common::CreateHnswParam&>(vector_index_parameter.hnsw_parameter());
@@ -150,7 +299,13 @@ VectorIndexHnsw::VectorIndexHnsw(int64_t id, const pb::common::VectorIndexParame
 
     normalize_ = false;
 
-    if (hnsw_parameter.metric_type() == pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT) {
+    if (quantization_type_ != QuantizationType::kNone) {
+      // cosine is inner product of normalized vector, same as no quantization
+      normalize_ = hnsw_parameter.metric_type() == pb::common::MetricType::METRIC_TYPE_COSINE;
+      bool is_inner_product = hnsw_parameter.metric_type() != pb::common::MetricType::METRIC_TYPE_L2;
+      quantized_space_ = new HnswQuantizedSpace(quantization_type_, is_inner_product, hnsw_parameter.dimension());
+      hnsw_space_ = quantized_space_;
+    } else if (hnsw_parameter.metric_type() == pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT) {
       hnsw_space_ = new hnswlib::InnerProductSpace(hnsw_parameter.dimension());
     } else if (hnsw_parameter.metric_type() == pb::common::MetricType::METRIC_TYPE_COSINE) {
       normalize_ = true;
@@ -166,10 +321,10 @@ VectorIndexHnsw::VectorIndexHnsw(int64_t id, const pb::common::VectorIndexParame
     DINGO_LOG(INFO) << fmt::format(
         "[vector_index.hnsw][id({})] create index, init_max_elements={} max_element_limit={} nlinks={} "
         "efconstruction={} "
-        "metric_type={} dimension={}",
+        "metric_type={} dimension={} quantization_type={}",
         Id(), FLAGS_hnsw_max_init_max_elements, max_element_limit_, hnsw_parameter.nlinks(),
         hnsw_parameter.efconstruction(), pb::common::MetricType_Name(hnsw_parameter.metric_type()),
-        hnsw_parameter.dimension());
+        hnsw_parameter.dimension(), QuantizationTypeName(quantization_type_));
 
     uint32_t hnsw_init_max_elements = 0;
     if (max_element_limit_ < FLAGS_hnsw_max_init_max_elements) {
@@ -179,7 +334,8 @@ VectorIndexHnsw::VectorIndexHnsw(int64_t id, const pb::common::VectorIndexParame
     }
 
     hnsw_index_ = new hnswlib::HierarchicalNSW<float>(hnsw_space_, hnsw_init_max_elements, hnsw_parameter.nlinks(),
-                                                      hnsw_parameter.efconstruction(), 100, false);
+                                                      hnsw_parameter.efconstruction(), 100,
+                                                      FLAGS_hnsw_enable_replace_deleted);
   }
 }
 
@@ -188,6 +344,25 @@ VectorIndexHnsw::~VectorIndexHnsw() {
   delete hnsw_space_;
 }
 
+// Rows of the batch to upsert, only the last row of the same id is kept as it overwrites the prior ones.
+static std::vector<size_t> LastRowOfIds(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  std::unordered_map<int64_t, size_t> id_rows;
+  id_rows.reserve(vector_with_ids.size());
+  for (size_t row = 0; row < vector_with_ids.size(); ++row) {
+    id_rows[vector_with_ids[row].id()] = row;
+  }
+
+  std::vector<size_t> rows;
+  rows.reserve(id_rows.size());
+  for (size_t row = 0; row < vector_with_ids.size(); ++row) {
+    if (id_rows[vector_with_ids[row].id()] == row) {
+      rows.push_back(row);
+    }
+  }
+
+  return rows;
+}
+
 butil::Status VectorIndexHnsw::Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
   return Upsert(vector_with_ids, true);
 }
@@ -225,21 +400,28 @@ butil::Status VectorIndexHnsw::Upsert(const std::vector<pb::common::VectorWithId
       hnsw_index_->resizeIndex(new_max_elements);
     }
 
+    // UpsertPoint check the label then add it, the same id must not be upserted concurrently in one batch.
+    auto rows = LastRowOfIds(vector_with_ids);
+
     if (!normalize_) {
-      ParallelFor(thread_pool, Id(), 0, vector_with_ids.size(), FLAGS_hnsw_vector_write_batch_size_per_task,
-                  is_priority, [&](size_t row) {
-                    this->hnsw_index_->addPoint((void*)vector_with_ids[row].vector().float_values().data(),
-                                                vector_with_ids[row].id(), false);
+      ParallelFor(thread_pool, Id(), 0, rows.size(), FLAGS_hnsw_vector_write_batch_size_per_task, is_priority,
+                  [&](size_t i) {
+                    size_t row = rows[i];
+                    std::vector<char> code;
+                    const auto* vector = vector_with_ids[row].vector().float_values().data();
+                    UpsertPoint(ToElementData(vector, code), vector_with_ids[row].id());
                   });
     } else {
-      ParallelFor(thread_pool, Id(), 0, vector_with_ids.size(), FLAGS_hnsw_vector_write_batch_size_per_task,
-                  is_priority, [&](size_t row) {
+      ParallelFor(thread_pool, Id(), 0, rows.size(), FLAGS_hnsw_vector_write_batch_size_per_task, is_priority,
+                  [&](size_t i) {
+                    size_t row = rows[i];
                     // normalize vector
                     std::vector<float> norm_array(dimension_);
                     VectorIndexUtils::NormalizeVectorForHnsw(
                         (float*)vector_with_ids[row].vector().float_values().data(), dimension_, norm_array.data());
 
-                    this->hnsw_index_->addPoint((void*)norm_array.data(), vector_with_ids[row].id(), false);
+                    std::vector<char> code;
+                    UpsertPoint(ToElementData(norm_array.data(), code), vector_with_ids[row].id());
                   });
     }
     return butil::Status();
@@ -268,7 +450,10 @@ butil::Status VectorIndexHnsw::Delete(const std::vector<int64_t>& delete_ids, bo
   // Add data to index
   try {
     ParallelFor(thread_pool, Id(), 0, delete_ids.size(), FLAGS_hnsw_vector_write_batch_size_per_task, is_priority,
-                [&](size_t row) { hnsw_index_->markDelete(delete_ids[row]); });
+                [&](size_t row) {
+                  hnsw_index_->markDelete(delete_ids[row]);
+                  unrepaired_delete_count_.fetch_add(1, std::memory_order_relaxed);
+                });
   } catch (std::runtime_error& e) {
     std::string s = fmt::format("delete vector failed, error: {}", e.what());
     DINGO_LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
@@ -288,6 +473,12 @@ butil::Status VectorIndexHnsw::Save(const std::string& path) {
   // Save need the caller to do LockWrite() and UnlockWrite()
   if (vector_index_type == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW) {
     hnsw_index_->saveIndex(path);
+    // the quantization type is saved beside the index file, load check it.
+    if (!Helper::SaveFile(QuantizationMetaPath(path), QuantizationTypeName(quantization_type_))) {
+      std::string s = fmt::format("save quantization meta failed, path({})", QuantizationMetaPath(path));
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
+      return butil::Status(pb::error::Errno::EINTERNAL, s);
+    }
     return butil::Status::OK();
   } else {
     return butil::Status(pb::error::Errno::EINTERNAL, "vector index type is not supported");
@@ -304,10 +495,37 @@ butil::Status VectorIndexHnsw::Load(const std::string& path) {
 
   // FIXME: need to prevent SEGV when delete old_hnsw_index
   if (vector_index_type == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW) {
-    auto* old_hnsw_index = hnsw_index_;
+    // the quantization type may be changed after saved, the index is rebuilt when not match.
+    QuantizationType file_quantization_type;
+    auto status = LoadQuantizationType(path, file_quantization_type);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), status.error_str());
+      return status;
+    }
+    if (file_quantization_type != quantization_type_) {
+      std::string s =
+          fmt::format("quantization type not match, file({}) index({})", QuantizationTypeName(file_quantization_type),
+                      QuantizationTypeName(quantization_type_));
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
+      return butil::Status(pb::error::Errno::EINTERNAL, s);
+    }
+
     uint32_t actual_max_elements =
         vector_index_parameter.hnsw_parameter().max_elements() + Constant::kHnswMaxElementsExpandNum;
-    hnsw_index_ = new hnswlib::HierarchicalNSW<float>(hnsw_space_, path, false, actual_max_elements, true);
+    auto* new_hnsw_index = new hnswlib::HierarchicalNSW<float>(hnsw_space_, path, false, actual_max_elements, true);
+
+    // element data of file must match the space, guard against a broken file.
+    size_t file_data_size = new_hnsw_index->label_offset_ - new_hnsw_index->offsetData_;
+    if (file_data_size != new_hnsw_index->data_size_) {
+      std::string s = fmt::format("element data size not match, file({}) space({}) quantization_type({})",
+                                  file_data_size, new_hnsw_index->data_size_, QuantizationTypeName(quantization_type_));
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
+      delete new_hnsw_index;
+      return butil::Status(pb::error::Errno::EINTERNAL, s);
+    }
+
+    auto* old_hnsw_index = hnsw_index_;
+    hnsw_index_ = new_hnsw_index;
     delete old_hnsw_index;
     return butil::Status::OK();
   } else {
@@ -423,17 +641,18 @@ butil::Status VectorIndexHnsw::Search(const std::vector<pb::common::VectorWithId
   BvarLatencyGuard bvar_guard(&g_hnsw_search_latency);
   RWLockReadGuard guard(&rw_lock_);
 
-  if (search_parameter.hnsw().efsearch() > 0) {
-    hnsw_index_->setEf(search_parameter.hnsw().efsearch());
-  }
+  // ef only work for this search, not change the ef of hnsw index.
+  size_t ef = search_parameter.hnsw().efsearch() > 0 ? search_parameter.hnsw().efsearch() : hnsw_index_->ef_;
 
   if (!normalize_) {
     ParallelFor(thread_pool, Id(), 0, vector_with_ids.size(), FLAGS_vector_read_batch_size_per_task, true,
                 [&](size_t row) {
                   std::priority_queue<std::pair<float, hnswlib::labeltype>> result;
 
+                  std::vector<char> code;
                   try {
-                    result = hnsw_index_->searchKnn(data.get() + dimension_ * row, topk, hnsw_filter.get());
+                    result = SearchKnn(hnsw_index_, ToElementData(data.get() + dimension_ * row, code), topk, ef,
+                                       hnsw_filter.get());
                   } catch (std::runtime_error& e) {
                     std::string s = fmt::format("parallel search vector failed, error: {}", e.what());
                     LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
@@ -442,8 +661,9 @@ butil::Status VectorIndexHnsw::Search(const std::vector<pb::common::VectorWithId
                   }
 
                   statuses[row] = lambda_reverse_rse_result_function(result, row, topk);
+                  // quantized element data is not the vector, caller reconstruct it from vector data
                   if (statuses[row].ok()) {
-                    statuses[row] = lambda_fill_results_function(row, topk, reconstruct);
+                    statuses[row] = lambda_fill_results_function(row, topk, reconstruct && quantized_space_ == nullptr);
                   }
                 });
   } else {  // normalize_
@@ -455,8 +675,9 @@ butil::Status VectorIndexHnsw::Search(const std::vector<pb::common::VectorWithId
 
           std::priority_queue<std::pair<float, hnswlib::labeltype>> result;
 
+          std::vector<char> code;
           try {
-            result = hnsw_index_->searchKnn(norm_array.data(), topk, hnsw_filter.get());
+            result = SearchKnn(hnsw_index_, ToElementData(norm_array.data(), code), topk, ef, hnsw_filter.get());
           } catch (std::runtime_error& e) {
             std::string s = fmt::format("parallel search vector failed, error: {}", e.what());
             LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
@@ -533,7 +754,12 @@ bool VectorIndexHnsw::IsExceedsMaxElements(int64_t vector_size) {
     return true;
   }
   RWLockReadGuard guard(&rw_lock_);
-  bool is_exceeds = hnsw_index_->getCurrentElementCount() + vector_size > max_element_limit_;
+  int64_t element_count = hnsw_index_->getCurrentElementCount();
+  if (IsReplaceDeleted()) {
+    // the slot of deleted vector will be reused
+    element_count -= hnsw_index_->getDeletedCount();
+  }
+  bool is_exceeds = element_count + vector_size > max_element_limit_;
   if (is_exceeds) {
     DINGO_LOG(ERROR) << fmt::format(
         "[vector_index.hnsw][id({})] exceeds max elements, current_element_count({}) , delete_element_count({}) , "
@@ -547,6 +773,156 @@ bool VectorIndexHnsw::IsExceedsMaxElements(int64_t vector_size) {
 
 hnswlib::HierarchicalNSW<float>* VectorIndexHnsw::GetHnswIndex() { return this->hnsw_index_; }
 
+uint32_t VectorIndexHnsw::RerankCandidateMultiple() {
+  return quantized_space_ != nullptr ? FLAGS_hnsw_quantization_rerank_multiple : 0;
+}
+
+bool VectorIndexHnsw::IsReplaceDeleted() const {
+  return FLAGS_hnsw_enable_replace_deleted && hnsw_index_->allow_replace_deleted_;
+}
+
+void VectorIndexHnsw::UpsertPoint(const void* data, hnswlib::labeltype label) {
+  bool is_exist = false;
+  hnswlib::tableint internal_id = 0;
+  {
+    std::unique_lock<std::mutex> lock(hnsw_index_->label_lookup_lock);
+    auto it = hnsw_index_->label_lookup_.find(label);
+    if (it != hnsw_index_->label_lookup_.end()) {
+      is_exist = true;
+      internal_id = it->second;
+    }
+  }
+
+  if (is_exist) {
+    // hnswlib replace deleted take a vacant slot even if the label exist, so update it in place.
+    if (hnsw_index_->allow_replace_deleted_ && hnsw_index_->isMarkedDeleted(internal_id)) {
+      hnsw_index_->unmarkDelete(label);
+    }
+    hnsw_index_->addPoint(data, label, false);
+    return;
+  }
+
+  hnsw_index_->addPoint(data, label, IsReplaceDeleted());
+}
+
+const void* VectorIndexHnsw::ToElementData(const float* vector, std::vector<char>& code) const {
+  if (quantized_space_ == nullptr) {
+    return vector;
+  }
+
+  code.resize(quantized_space_->get_data_size());
+  quantized_space_->Encode(vector, code.data());
+  return code.data();
+}
+
+std::priority_queue<std::pair<float, hnswlib::labeltype>> VectorIndexHnsw::SearchKnn(
+    const hnswlib::HierarchicalNSW<float>* hnsw_index, const void* query, size_t topk, size_t ef,
+    hnswlib::BaseFilterFunctor* filter) {
+  std::priority_queue<std::pair<float, hnswlib::labeltype>> result;
+  if (hnsw_index->cur_element_count == 0 || topk == 0) {
+    return result;
+  }
+
+  ef = std::max(ef, topk);
+  auto dist_func = hnsw_index->fstdistfunc_;
+  auto* dist_func_param = hnsw_index->dist_func_param_;
+
+  // greedy search from the top level to level 1
+  hnswlib::tableint cur_node = hnsw_index->enterpoint_node_;
+  float cur_dist = dist_func(query, hnsw_index->getDataByInternalId(cur_node), dist_func_param);
+  for (int level = hnsw_index->maxlevel_; level > 0; --level) {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      hnswlib::linklistsizeint* link_list = hnsw_index->get_linklist(cur_node, level);
+      int size = hnsw_index->getListCount(link_list);
+      auto* neighbors = reinterpret_cast<hnswlib::tableint*>(link_list + 1);
+      for (int i = 0; i < size; ++i) {
+        hnswlib::tableint neighbor = neighbors[i];
+        if (neighbor > hnsw_index->max_elements_) {
+          throw std::runtime_error("cand error");
+        }
+
+        float dist = dist_func(query, hnsw_index->getDataByInternalId(neighbor), dist_func_param);
+        if (dist < cur_dist) {
+          cur_dist = dist;
+          cur_node = neighbor;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  // beam search level 0 with ef
+  bool has_deletions = hnsw_index->num_deleted_ > 0;
+  auto is_allowed = [&](hnswlib::tableint node) {
+    return (!has_deletions || !hnsw_index->isMarkedDeleted(node)) &&
+           (filter == nullptr || (*filter)(hnsw_index->getExternalLabel(node)));
+  };
+  bool is_bare_bone = !has_deletions && filter == nullptr;
+
+  uint16_t visited_tag = tls_hnsw_visited_list.Reset(hnsw_index->max_elements_);
+  uint16_t* visited_marks = tls_hnsw_visited_list.Marks();
+
+  // max heap of the nearest ef nodes
+  std::priority_queue<std::pair<float, hnswlib::tableint>> top_candidates;
+  // max heap of the nodes to expand with negative distance
+  std::priority_queue<std::pair<float, hnswlib::tableint>> candidate_set;
+
+  float lower_bound = std::numeric_limits<float>::max();
+  if (is_allowed(cur_node)) {
+    lower_bound = cur_dist;
+    top_candidates.emplace(cur_dist, cur_node);
+  }
+  candidate_set.emplace(-cur_dist, cur_node);
+  visited_marks[cur_node] = visited_tag;
+
+  while (!candidate_set.empty()) {
+    auto candidate = candidate_set.top();
+    // without filter/deletions every visited node is in top_candidates, stop when candidate is further than all
+    if (-candidate.first > lower_bound && (top_candidates.size() == ef || is_bare_bone)) {
+      break;
+    }
+    candidate_set.pop();
+
+    hnswlib::linklistsizeint* link_list = hnsw_index->get_linklist0(candidate.second);
+    int size = hnsw_index->getListCount(link_list);
+    auto* neighbors = reinterpret_cast<hnswlib::tableint*>(link_list + 1);
+    for (int i = 0; i < size; ++i) {
+      hnswlib::tableint neighbor = neighbors[i];
+      if (visited_marks[neighbor] == visited_tag) {
+        continue;
+      }
+      visited_marks[neighbor] = visited_tag;
+
+      float dist = dist_func(query, hnsw_index->getDataByInternalId(neighbor), dist_func_param);
+      if (top_candidates.size() < ef || dist < lower_bound) {
+        candidate_set.emplace(-dist, neighbor);
+        if (is_allowed(neighbor)) {
+          top_candidates.emplace(dist, neighbor);
+        }
+        if (top_candidates.size() > ef) {
+          top_candidates.pop();
+        }
+        if (!top_candidates.empty()) {
+          lower_bound = top_candidates.top().first;
+        }
+      }
+    }
+  }
+
+  while (top_candidates.size() > topk) {
+    top_candidates.pop();
+  }
+  while (!top_candidates.empty()) {
+    const auto& [dist, node] = top_candidates.top();
+    result.emplace(dist, hnsw_index->getExternalLabel(node));
+    top_candidates.pop();
+  }
+
+  return result;
+}
+
 int32_t VectorIndexHnsw::GetDimension() { return this->dimension_; }
 
 pb::common::MetricType VectorIndexHnsw::GetMetricType() {
@@ -608,13 +984,208 @@ bool VectorIndexHnsw::NeedToSave(int64_t last_save_log_behind) {
   return false;
 }
 
+bool VectorIndexHnsw::NeedToRepair() {
+  return !is_repairing_.load() && unrepaired_delete_count_.load() >= FLAGS_hnsw_repair_min_delete_count;
+}
+
+// Reconnect the node at level whose neighbors contain deleted node, the candidates are the live neighbors of node
+// and the live neighbors of the deleted neighbors, then select by heuristic as hnswlib does when insert.
+static bool RepairNodeLinks(hnswlib::HierarchicalNSW<float>* hnsw_index, hnswlib::tableint node, int level) {
+  auto* link_list = level == 0 ? hnsw_index->get_linklist0(node) : hnsw_index->get_linklist_at_level(node, level);
+  size_t size = hnsw_index->getListCount(link_list);
+  auto* neighbors = reinterpret_cast<hnswlib::tableint*>(link_list + 1);
+
+  bool has_deleted = false;
+  for (size_t i = 0; i < size; ++i) {
+    if (hnsw_index->isMarkedDeleted(neighbors[i])) {
+      has_deleted = true;
+      break;
+    }
+  }
+  if (!has_deleted) {
+    return false;
+  }
+
+  std::unordered_set<hnswlib::tableint> visited = {node};
+  std::priority_queue<std::pair<float, hnswlib::tableint>, std::vector<std::pair<float, hnswlib::tableint>>,
+                      hnswlib::HierarchicalNSW<float>::CompareByFirst>
+      candidates;
+  const char* node_data = hnsw_index->getDataByInternalId(node);
+  auto add_candidate = [&](hnswlib::tableint candidate) {
+    if (hnsw_index->isMarkedDeleted(candidate) || !visited.insert(candidate).second) {
+      return;
+    }
+    float distance = hnsw_index->fstdistfunc_(node_data, hnsw_index->getDataByInternalId(candidate),
+                                              hnsw_index->dist_func_param_);
+    candidates.emplace(distance, candidate);
+  };
+
+  for (size_t i = 0; i < size; ++i) {
+    if (!hnsw_index->isMarkedDeleted(neighbors[i])) {
+      add_candidate(neighbors[i]);
+      continue;
+    }
+
+    // the deleted neighbor has the same level, as the link is bidirectional when insert.
+    auto deleted_neighbor = neighbors[i];
+    if (hnsw_index->element_levels_[deleted_neighbor] < level) {
+      continue;
+    }
+    auto* deleted_link_list = level == 0 ? hnsw_index->get_linklist0(deleted_neighbor)
+                                         : hnsw_index->get_linklist_at_level(deleted_neighbor, level);
+    size_t deleted_size = hnsw_index->getListCount(deleted_link_list);
+    auto* deleted_neighbors = reinterpret_cast<hnswlib::tableint*>(deleted_link_list + 1);
+    for (size_t j = 0; j < deleted_size; ++j) {
+      add_candidate(deleted_neighbors[j]);
+    }
+  }
+
+  // keep the links to deleted node, which still route the search.
+  if (candidates.empty()) {
+    return false;
+  }
+
+  hnsw_index->getNeighborsByHeuristic2(candidates, level == 0 ? hnsw_index->maxM0_ : hnsw_index->maxM_);
+
+  size = 0;
+  while (!candidates.empty()) {
+    neighbors[size++] = candidates.top().second;
+    candidates.pop();
+  }
+  hnsw_index->setListCount(link_list, size);
+
+  return true;
+}
+
+butil::Status VectorIndexHnsw::Repair() {
+  if (is_repairing_.exchange(true)) {
+    return butil::Status(pb::error::EINTERNAL, "vector index is repairing");
+  }
+  ON_SCOPE_EXIT([&]() { is_repairing_.store(false); });
+
+  BvarLatencyGuard bvar_guard(&g_hnsw_repair_latency);
+
+  int64_t start_time = Helper::TimestampMs();
+  // deleted after here will be repaired at next time.
+  int64_t delete_count = unrepaired_delete_count_.load();
+
+  int64_t element_count = 0;
+  {
+    RWLockReadGuard guard(&rw_lock_);
+    element_count = hnsw_index_->cur_element_count;
+  }
+
+  int64_t repaired_count = 0;
+  uint32_t batch_node_count = std::max(FLAGS_hnsw_repair_batch_node_count, static_cast<uint32_t>(1));
+  for (int64_t start = 0; start < element_count; start += batch_node_count) {
+    {
+      RWLockWriteGuard guard(&rw_lock_);
+
+      int64_t end = std::min(start + static_cast<int64_t>(batch_node_count),
+                             static_cast<int64_t>(hnsw_index_->cur_element_count));
+      for (int64_t i = start; i < end; ++i) {
+        auto node = static_cast<hnswlib::tableint>(i);
+        if (hnsw_index_->isMarkedDeleted(node)) {
+          continue;
+        }
+
+        bool is_repaired = false;
+        for (int level = 0; level <= hnsw_index_->element_levels_[node]; ++level) {
+          is_repaired = RepairNodeLinks(hnsw_index_, node, level) || is_repaired;
+        }
+        repaired_count += is_repaired ? 1 : 0;
+      }
+    }
+
+    // let the waiting upsert/search go between batches
+    bthread_yield();
+  }
+
+  unrepaired_delete_count_.fetch_sub(delete_count);
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.hnsw][id({})] repair finish, element_count({}) delete_count({}) repaired_count({}) elapsed "
+      "time({}ms).",
+      Id(), element_count, delete_count, repaired_count, Helper::TimestampMs() - start_time);
+
+  return butil::Status::OK();
+}
+
+std::string VectorIndexHnsw::QuantizationMetaPath(const std::string& index_path) {
+  return fmt::format("{}.quantization", index_path);
+}
+
+butil::Status VectorIndexHnsw::LoadQuantizationType(const std::string& index_path,
+                                                    QuantizationType& quantization_type) {
+  std::string meta_path = QuantizationMetaPath(index_path);
+  if (!Helper::IsExistPath(meta_path)) {
+    quantization_type = QuantizationType::kNone;
+    return butil::Status::OK();
+  }
+
+  std::ifstream file(meta_path);
+  std::string name;
+  if (!file.is_open() || !(file >> name)) {
+    return butil::Status(pb::error::Errno::EINTERNAL,
+                         fmt::format("read quantization meta failed, path({})", meta_path));
+  }
+  if (!ParseQuantizationType(name, quantization_type)) {
+    return butil::Status(pb::error::Errno::EINTERNAL,
+                         fmt::format("quantization meta is illegal, path({}) type({})", meta_path, name));
+  }
+
+  return butil::Status::OK();
+}
+
+bool VectorIndexHnsw::ParseQuantizationType(const std::string& name, QuantizationType& quantization_type) {
+  if (name == "none") {
+    quantization_type = QuantizationType::kNone;
+  } else if (name == "int8") {
+    quantization_type = QuantizationType::kInt8;
+  } else if (name == "fp16") {
+    quantization_type = QuantizationType::kFp16;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+const char* VectorIndexHnsw::QuantizationTypeName(QuantizationType quantization_type) {
+  switch (quantization_type) {
+    case QuantizationType::kNone:
+      return "none";
+    case QuantizationType::kInt8:
+      return "int8";
+    case QuantizationType::kFp16:
+      return "fp16";
+    default:
+      return "unknown";
+  }
+}
+
+int64_t VectorIndexHnsw::CalcElementDataSize(QuantizationType quantization_type, int64_t dimension) {
+  switch (quantization_type) {
+    case QuantizationType::kInt8:
+      return HnswQuantizedSpace::kInt8HeaderSize + sizeof(int8_t) * dimension;
+    case QuantizationType::kFp16:
+      return sizeof(uint16_t) * dimension;
+    default:
+      return sizeof(float) * dimension;
+  }
+}
+
 // calc hnsw count from memory
 uint32_t VectorIndexHnsw::CalcHnswCountFromMemory(int64_t memory_size_limit, int64_t dimension, int64_t nlinks) {
   // size_links_level0_ = maxM0_ * sizeof(tableint) + sizeof(linklistsizeint);
   int64_t size_links_level0 = nlinks * 2 + sizeof(int64_t) + sizeof(int64_t);
 
+  QuantizationType quantization_type = QuantizationType::kNone;
+  ParseQuantizationType(FLAGS_hnsw_quantization_type, quantization_type);
+
   // int64_t size_data_per_element_ = size_links_level0_ + data_size_ + sizeof(labeltype);
-  int64_t size_data_per_element = size_links_level0 + sizeof(float_t) * dimension + sizeof(int64_t);
+  int64_t size_data_per_element =
+      size_links_level0 + CalcElementDataSize(quantization_type, dimension) + sizeof(int64_t);
 
   // int64_t size_link_list_per_element =  sizeof(void*);
   int64_t size_link_list_per_element = sizeof(int64_t);
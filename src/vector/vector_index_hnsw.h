@@ -15,9 +15,12 @@
 #ifndef DINGODB_VECTOR_INDEX_HNSW_H_  // NOLINT
 #define DINGODB_VECTOR_INDEX_HNSW_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
+#include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "butil/status.h"
@@ -28,14 +31,32 @@
 
 namespace dingodb {
 
+class HnswQuantizedSpace;
+
 class VectorIndexHnsw : public VectorIndex {
  public:
+  // Element data type stored in hnsw graph, quantized data is smaller but the distance is approximate.
+  enum class QuantizationType {
+    kNone,
+    kInt8,
+    kFp16,
+  };
+
   explicit VectorIndexHnsw(int64_t id, const pb::common::VectorIndexParameter& vector_index_parameter,
                            const pb::common::RegionEpoch& epoch, const pb::common::Range& range,
-                           ThreadPoolPtr thread_pool);
+                           ThreadPoolPtr thread_pool, QuantizationType quantization_type = QuantizationType::kNone);
 
   ~VectorIndexHnsw() override;
 
+  static bool ParseQuantizationType(const std::string& name, QuantizationType& quantization_type);
+  static const char* QuantizationTypeName(QuantizationType quantization_type);
+  // bytes of one element data in hnsw graph
+  static int64_t CalcElementDataSize(QuantizationType quantization_type, int64_t dimension);
+  // the quantization type of index file is saved in the meta file beside it.
+  static std::string QuantizationMetaPath(const std::string& index_path);
+  // index file without meta file is saved before quantization, type is none.
+  static butil::Status LoadQuantizationType(const std::string& index_path, QuantizationType& quantization_type);
+
   static uint32_t CalcHnswCountFromMemory(int64_t memory_size_limit, int64_t dimension, int64_t nlinks);
   static butil::Status CheckAndSetHnswParameter(pb::common::CreateHnswParam& hnsw_parameter);
 
@@ -87,16 +108,45 @@ class VectorIndexHnsw : public VectorIndex {
   bool NeedToRebuild() override;
   bool NeedToSave(int64_t last_save_log_behind) override;
   bool SupportSave() override;
+  uint32_t RerankCandidateMultiple() override;
+
+  bool NeedToRepair() override;
+  // Reconnect the live nodes which link to deleted nodes, scan the whole graph by batch, hold write lock per batch.
+  butil::Status Repair() override;
+
+  QuantizationType GetQuantizationType() const { return quantization_type_; }
 
   hnswlib::HierarchicalNSW<float>* GetHnswIndex();
 
+  // knn search with ef of this call, same as HierarchicalNSW::searchKnn but not use the shared ef_ and visited list
+  // pool, so concurrent searches with different ef not affect each other. caller need hold read lock of the index.
+  // query must be in the element data format of the index space.
+  static std::priority_queue<std::pair<float, hnswlib::labeltype>> SearchKnn(
+      const hnswlib::HierarchicalNSW<float>* hnsw_index, const void* query, size_t topk, size_t ef,
+      hnswlib::BaseFilterFunctor* filter);
+
   // void NormalizeVector(const float* data, float* norm_array) const;
 
  private:
+  // return the element data of vector for hnsw, encode into code when quantized, else the vector itself.
+  const void* ToElementData(const float* vector, std::vector<char>& code) const;
+
+  // add or update point of label, the new label reuse the slot of deleted vector if enable replace deleted.
+  void UpsertPoint(const void* data, hnswlib::labeltype label);
+  bool IsReplaceDeleted() const;
+
   // hnsw members
   hnswlib::HierarchicalNSW<float>* hnsw_index_;
   hnswlib::SpaceInterface<float>* hnsw_space_;
 
+  QuantizationType quantization_type_;
+  // same object as hnsw_space_ when quantized, else nullptr
+  HnswQuantizedSpace* quantized_space_{nullptr};
+
+  // deleted count since last repair
+  std::atomic<int64_t> unrepaired_delete_count_{0};
+  std::atomic<bool> is_repairing_{false};
+
   // Dimension of the elements
   uint32_t dimension_;
 
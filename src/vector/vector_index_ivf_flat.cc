@@ -40,6 +40,7 @@
 #include "faiss/impl/AuxIndexStructures.h"
 #include "faiss/index_io.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "proto/common.pb.h"
 #include "proto/debug.pb.h"
@@ -49,6 +50,7 @@
 
 namespace dingodb {
 DEFINE_int64(ivf_flat_need_save_count, 10000, "ivf flat need save count");
+DECLARE_uint32(vector_train_sample_count_per_centroid);
 
 bvar::LatencyRecorder g_ivf_flat_upsert_latency("dingo_ivf_flat_upsert_latency");
 bvar::LatencyRecorder g_ivf_flat_search_latency("dingo_ivf_flat_search_latency");
@@ -801,6 +803,70 @@ bool VectorIndexIvfFlat<T, U>::NeedToSave(int64_t last_save_log_behind) {
   return false;
 }
 
+template <typename T, typename U>
+int64_t VectorIndexIvfFlat<T, U>::TrainSampleCount() {
+  return static_cast<int64_t>(nlist_org_) * FLAGS_vector_train_sample_count_per_centroid;
+}
+
+template <typename T, typename U>
+void VectorIndexIvfFlat<T, U>::SetTrainDataSize(int64_t total_count) {
+  RWLockWriteGuard guard(&rw_lock_);
+  if (IsTrainedImpl()) {
+    train_data_size_ = std::max(static_cast<faiss::idx_t>(total_count), train_data_size_);
+  }
+}
+
+template <typename T, typename U>
+butil::Status VectorIndexIvfFlat<T, U>::TrainByIndex(std::shared_ptr<VectorIndex> trained_index) {
+  if constexpr (!std::is_same<T, faiss::Index>::value) {
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "binary ivf flat not support train by index");
+  } else {
+    auto other = std::dynamic_pointer_cast<VectorIndexIvfFlat<T, U>>(trained_index);
+    if (other == nullptr || other.get() == this) {
+      return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "not same type vector index");
+    }
+
+    // copy the centroids of coarse quantizer, ivf flat has no other trained data.
+    std::vector<float> centroids;
+    faiss::idx_t other_train_data_size = 0;
+    {
+      RWLockReadGuard other_guard(&other->rw_lock_);
+      if (!other->IsTrainedImpl() || other->nlist_ != other->nlist_org_ || other->nlist_org_ != nlist_org_ ||
+          other->dimension_ != dimension_ || other->metric_type_ != metric_type_) {
+        return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "vector index parameter or train state not match");
+      }
+
+      centroids.resize(other->nlist_ * dimension_);
+      other->index_->quantizer->reconstruct_n(0, other->nlist_, centroids.data());
+      other_train_data_size = other->train_data_size_;
+    }
+
+    BvarLatencyGuard bvar_guard(&g_ivf_flat_train_latency);
+    RWLockWriteGuard guard(&rw_lock_);
+
+    if (BAIDU_UNLIKELY(IsTrainedImpl())) {
+      return butil::Status::OK();
+    }
+
+    Init();
+
+    try {
+      quantizer_->add(nlist_, centroids.data());
+      index_->is_trained = true;
+    } catch (std::exception& e) {
+      Reset();
+      return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("train ivf_flat by index exception: {}", e.what()));
+    }
+
+    train_data_size_ = other_train_data_size;
+
+    DINGO_LOG(INFO) << fmt::format("[vector_index.ivf_flat][id({})] train by index({}), nlist({}) train_data_size({}).",
+                                   Id(), other->Id(), nlist_, train_data_size_);
+
+    return butil::Status::OK();
+  }
+}
+
 template <typename T, typename U>
 void VectorIndexIvfFlat<T, U>::Init() {
   if constexpr (std::is_same<T, faiss::Index>::value) {
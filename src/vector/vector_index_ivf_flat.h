@@ -108,6 +108,9 @@ class VectorIndexIvfFlat : public VectorIndex {
   bool NeedToRebuild() override;
   bool NeedTrain() override { return true; }
   bool IsTrained() override;
+  int64_t TrainSampleCount() override;
+  void SetTrainDataSize(int64_t total_count) override;
+  butil::Status TrainByIndex(std::shared_ptr<VectorIndex> trained_index) override;
   bool NeedToSave(int64_t last_save_log_behind) override;
 
  private:
@@ -31,6 +31,7 @@
 #include "faiss/impl/ProductQuantizer.h"
 #include "faiss/index_io.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "proto/debug.pb.h"
 #include "proto/error.pb.h"
@@ -39,6 +40,8 @@
 
 namespace dingodb {
 
+DECLARE_uint32(vector_train_sample_count_per_centroid);
+
 bvar::LatencyRecorder g_ivf_pq_upsert_latency("dingo_ivf_pq_upsert_latency");
 bvar::LatencyRecorder g_ivf_pq_search_latency("dingo_ivf_pq_search_latency");
 bvar::LatencyRecorder g_ivf_pq_range_search_latency("dingo_ivf_pq_range_search_latency");
@@ -442,6 +445,55 @@ bool VectorIndexIvfPq::NeedToRebuild() {
   return false;
 }
 
+int64_t VectorIndexIvfPq::TrainSampleCount() {
+  faiss::ClusteringParameters clustering_parameters;
+  faiss::idx_t train_nlist_size = clustering_parameters.max_points_per_centroid * nlist_;
+  faiss::ProductQuantizer pq = faiss::ProductQuantizer(dimension_, nsubvector_, nbits_per_idx_);
+  faiss::idx_t train_subvector_size = pq.cp.max_points_per_centroid * (1 << nbits_per_idx_);
+
+  // not less than the data size of choosing ivf pq, see Train.
+  return std::max({static_cast<faiss::idx_t>(nlist_ * FLAGS_vector_train_sample_count_per_centroid),
+                   train_nlist_size, train_subvector_size});
+}
+
+void VectorIndexIvfPq::SetTrainDataSize(int64_t total_count) {
+  RWLockReadGuard guard(&rw_lock_);
+  if (IsTrainedImpl() && inner_index_type_ == IndexTypeInIvfPq::kIvfPq) {
+    index_raw_ivf_pq_->SetTrainDataSize(total_count);
+  }
+}
+
+butil::Status VectorIndexIvfPq::TrainByIndex(std::shared_ptr<VectorIndex> trained_index) {
+  auto other = std::dynamic_pointer_cast<VectorIndexIvfPq>(trained_index);
+  if (other == nullptr || other.get() == this) {
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "not same type vector index");
+  }
+
+  RWLockReadGuard other_guard(&other->rw_lock_);
+  // the flat of few data need not train
+  if (!other->IsTrainedImpl() || other->inner_index_type_ != IndexTypeInIvfPq::kIvfPq) {
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "trained index is not ivf pq");
+  }
+
+  BvarLatencyGuard bvar_guard(&g_ivf_pq_train_latency);
+  RWLockWriteGuard guard(&rw_lock_);
+
+  if (BAIDU_UNLIKELY(IsTrainedImpl())) {
+    return butil::Status::OK();
+  }
+
+  inner_index_type_ = IndexTypeInIvfPq::kIvfPq;
+  Init();
+
+  auto status = index_raw_ivf_pq_->TrainByIndex(*other->index_raw_ivf_pq_);
+  if (!status.ok()) {
+    Reset();
+    return status;
+  }
+
+  return butil::Status::OK();
+}
+
 bool VectorIndexIvfPq::IsTrained() {
   RWLockReadGuard guard(&rw_lock_);
   return IsTrainedImpl();
@@ -84,6 +84,9 @@ class VectorIndexIvfPq : public VectorIndex {
   bool NeedToRebuild() override;
   bool NeedTrain() override { return true; }
   bool IsTrained() override;
+  int64_t TrainSampleCount() override;
+  void SetTrainDataSize(int64_t total_count) override;
+  butil::Status TrainByIndex(std::shared_ptr<VectorIndex> trained_index) override;
   bool NeedToSave(int64_t last_save_log_behind) override;
 
   pb::common::VectorIndexType VectorIndexSubType() override;
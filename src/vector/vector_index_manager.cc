@@ -45,6 +45,7 @@
 #include "vector/vector_index_factory.h"
 #include "vector/vector_index_snapshot.h"
 #include "vector/vector_index_snapshot_manager.h"
+#include "vector/vector_index_utils.h"
 
 namespace dingodb {
 
@@ -56,6 +57,8 @@ DEFINE_int32(vector_fast_background_worker_num, 8, "vector index fast background
 DEFINE_int64(vector_fast_build_log_gap, 50, "vector index fast build log gap");
 DEFINE_int64(vector_pull_snapshot_min_log_gap, 66, "vector index pull snapshot min log gap");
 DEFINE_int64(vector_max_background_task_count, 32, "vector index max background task count");
+DEFINE_bool(vector_train_reuse_trained_index, true,
+            "vector index build reuse the trained model of share or sibling vector index, e.g. after split");
 
 std::string RebuildVectorIndexTask::Trace() {
   return fmt::format("[vector_index.rebuild][id({}).start_time({}).job_id({})] {}", vector_index_wrapper_->Id(),
@@ -236,6 +239,48 @@ void SaveVectorIndexTask::Run() {
   }
 }
 
+std::string RepairVectorIndexTask::Trace() {
+  return fmt::format("[vector_index.repair][id({}).start_time({})] {}", vector_index_wrapper_->Id(),
+                     Helper::FormatMsTime(start_time_), trace_);
+}
+
+void RepairVectorIndexTask::Run() {
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.repair][index_id({})][trace({})] run, pending tasks({}) total running({}) wait_time({}).",
+      vector_index_wrapper_->Id(), trace_, vector_index_wrapper_->PendingTaskNum(),
+      VectorIndexManager::GetVectorIndexTaskRunningNum(), Helper::TimestampMs() - start_time_);
+
+  VectorIndexManager::IncVectorIndexTaskRunningNum();
+  ON_SCOPE_EXIT([&]() {
+    VectorIndexManager::DecVectorIndexTaskRunningNum();
+    vector_index_wrapper_->DecPendingTaskNum();
+  });
+
+  if (vector_index_wrapper_->IsStop()) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[vector_index.repair][index_id({})][trace({})] vector index is stop, gave up repair vector index.",
+        vector_index_wrapper_->Id(), trace_);
+    return;
+  }
+  if (!vector_index_wrapper_->IsOwnReady()) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[vector_index.repair][index_id({})][trace({})] vector index is not ready, gave up repair vector index.",
+        vector_index_wrapper_->Id(), trace_);
+    return;
+  }
+  // maybe repaired by the previous task
+  if (!vector_index_wrapper_->NeedToRepair()) {
+    return;
+  }
+
+  auto status = vector_index_wrapper_->Repair();
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format(
+        "[vector_index.repair][index_id({}_v{})][trace({})] repair vector index failed, error {}",
+        vector_index_wrapper_->Id(), vector_index_wrapper_->Version(), trace_, status.error_str());
+  }
+}
+
 std::string LoadOrBuildVectorIndexTask::Trace() {
   return fmt::format("[vector_index.loadorbuild][id({}).start_time({}).job_id({})] {}", vector_index_wrapper_->Id(),
                      Helper::FormatMsTime(start_time_), job_id_, trace_);
@@ -925,7 +970,11 @@ VectorIndexPtr VectorIndexManager::BuildVectorIndex(VectorIndexWrapperPtr vector
 
   // build if need
   if (vector_index->NeedTrain() && !vector_index->IsTrained()) {
-    auto status = TrainForBuild(vector_index, reader, encode_range);
+    auto trained_index = vector_index_wrapper->ShareVectorIndex();
+    if (trained_index == nullptr) {
+      trained_index = vector_index_wrapper->SiblingVectorIndex();
+    }
+    auto status = TrainForBuild(vector_index, trained_index, reader, encode_range);
     DINGO_LOG(INFO) << fmt::format(
         "[vector_index.build][index_id({})][trace({})] Train finish, elapsed_time: {}ms error: {} {}", vector_index_id,
         trace, Helper::TimestampMs() - start_time, status.error_code(), status.error_cstr());
@@ -955,7 +1004,7 @@ VectorIndexPtr VectorIndexManager::BuildVectorIndex(VectorIndexWrapperPtr vector
     vector.set_id(VectorCodec::DecodeVectorIdFromEncodeKeyWithTs(key));
 
     std::string value(mvcc::Codec::UnPackageValue(iter->Value()));
-    CHECK(vector.mutable_vector()->ParseFromString(value)) << "parse vector pb failed.";
+    CHECK(VectorCodec::DecodeVectorValue(value, *vector.mutable_vector())) << "parse vector pb failed.";
     if (vector.vector().value_type() == pb::common::ValueType::FLOAT) {
       if (vector.vector().float_values_size() <= 0) {
         DINGO_LOG(WARNING) << fmt::format(
@@ -1311,6 +1360,22 @@ void VectorIndexManager::LaunchSaveVectorIndex(VectorIndexWrapperPtr vector_inde
   }
 }
 
+void VectorIndexManager::LaunchRepairVectorIndex(VectorIndexWrapperPtr vector_index_wrapper, const std::string& trace) {
+  assert(vector_index_wrapper != nullptr);
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.launch][index_id({})][trace({})] Launch repair vector index, pending tasks({}) total running({}).",
+      vector_index_wrapper->Id(), trace, vector_index_wrapper->PendingTaskNum(), GetVectorIndexTaskRunningNum());
+
+  auto task = std::make_shared<RepairVectorIndexTask>(vector_index_wrapper, trace);
+  if (!Server::GetInstance().GetVectorIndexManager()->ExecuteTask(vector_index_wrapper->Id(), task)) {
+    DINGO_LOG(ERROR) << fmt::format("[vector_index.launch][index_id({})][trace({})] Launch repair vector index failed",
+                                    vector_index_wrapper->Id(), trace);
+  } else {
+    vector_index_wrapper->IncPendingTaskNum();
+  }
+}
+
 butil::Status VectorIndexManager::ScrubVectorIndex() {
   auto regions = Server::GetInstance().GetAllAliveRegion();
   if (regions.empty()) {
@@ -1348,6 +1413,12 @@ butil::Status VectorIndexManager::ScrubVectorIndex() {
       continue;
     }
 
+    if (vector_index_wrapper->RebuildingNum() == 0 && vector_index_wrapper->NeedToRepair()) {
+      DINGO_LOG(INFO) << fmt::format("[vector_index.scrub][index_id({})] need repair, do repair vector index.",
+                                     vector_index_id);
+      LaunchRepairVectorIndex(vector_index_wrapper, "from scrub");
+    }
+
     std::string trace;
     bool need_save = vector_index_wrapper->NeedToSave(trace);
     if (need_save && vector_index_wrapper->RebuildingNum() == 0 && vector_index_wrapper->SavingNum() == 0) {
@@ -1362,20 +1433,32 @@ butil::Status VectorIndexManager::ScrubVectorIndex() {
 }
 
 // range is encode range
-butil::Status VectorIndexManager::TrainForBuild(VectorIndexPtr vector_index, mvcc::ReaderPtr reader,
-                                                const pb::common::Range& encode_range) {
+butil::Status VectorIndexManager::TrainForBuild(VectorIndexPtr vector_index, VectorIndexPtr trained_index,
+                                                mvcc::ReaderPtr reader, const pb::common::Range& encode_range) {
+  if (FLAGS_vector_train_reuse_trained_index && trained_index != nullptr) {
+    auto status = vector_index->TrainByIndex(trained_index);
+    if (status.ok()) {
+      DINGO_LOG(INFO) << fmt::format("[vector_index.build][index_id({})] train by trained index({}).",
+                                     vector_index->Id(), trained_index->Id());
+      return status;
+    }
+    DINGO_LOG(INFO) << fmt::format("[vector_index.build][index_id({})] train by trained index({}) failed, error: {}",
+                                   vector_index->Id(), trained_index->Id(), status.error_str());
+  }
+
   IteratorOptions options;
   options.upper_bound = encode_range.end_key();
   auto iter = reader->NewIterator(Constant::kVectorDataCF, 0, options);
   CHECK(iter != nullptr) << fmt::format("[vector_index.build][index_id({})] NewIterator failed.", vector_index->Id());
 
-  std::vector<float> train_vectors;
-  train_vectors.reserve(100000 * vector_index->GetDimension());  // todo opt
+  // sample in a single pass, the memory is bounded by sample count instead of region size.
+  VectorReservoirSampler sampler(vector_index->TrainSampleCount(), vector_index->GetDimension(),
+                                 static_cast<uint64_t>(vector_index->Id()));
   for (iter->Seek(encode_range.start_key()); iter->Valid(); iter->Next()) {
     pb::common::VectorWithId vector;
 
     std::string value(mvcc::Codec::UnPackageValue(iter->Value()));
-    CHECK(vector.mutable_vector()->ParseFromString(value)) << "parse vector pb failed.";
+    CHECK(VectorCodec::DecodeVectorValue(value, *vector.mutable_vector())) << "parse vector pb failed.";
 
     if (vector.vector().value_type() == pb::common::ValueType::FLOAT) {
       if (vector.vector().float_values_size() <= 0) {
@@ -1395,17 +1478,29 @@ butil::Status VectorIndexManager::TrainForBuild(VectorIndexPtr vector_index, mvc
       continue;
     }
 
-    train_vectors.insert(train_vectors.end(), vector.vector().float_values().begin(),
-                         vector.vector().float_values().end());
+    // binary vector has no float values, same as before.
+    if (vector.vector().float_values_size() != vector_index->GetDimension()) {
+      DINGO_LOG_IF(WARNING, vector.vector().value_type() == pb::common::ValueType::FLOAT)
+          << fmt::format("[vector_index.build][index_id({})] vector dimension not match {} {}.", vector_index->Id(),
+                         vector.vector().float_values_size(), vector_index->GetDimension());
+      continue;
+    }
+    sampler.Add(vector.vector().float_values().data());
   }
 
+  auto& train_vectors = sampler.Samples();
   if (!train_vectors.empty()) {
+    DINGO_LOG(INFO) << fmt::format("[vector_index.build][index_id({})] train sample count({}) total count({}).",
+                                   vector_index->Id(), sampler.SampleCount(), sampler.TotalCount());
+
     auto status = vector_index->TrainByParallel(train_vectors);
     if (!status.ok()) {
       DINGO_LOG(ERROR) << fmt::format("[vector_index.build][index_id({})] train failed, error: {}", vector_index->Id(),
                                       status.error_str());
       return status;
     }
+
+    vector_index->SetTrainDataSize(sampler.TotalCount());
   }
 
   return butil::Status::OK();
@@ -85,6 +85,27 @@ class SaveVectorIndexTask : public TaskRunnable {
   int64_t start_time_;
 };
 
+// Repair vector index task, e.g. reconnect the graph of deleted vector
+class RepairVectorIndexTask : public TaskRunnable {
+ public:
+  RepairVectorIndexTask(VectorIndexWrapperPtr vector_index_wrapper, const std::string& trace)
+      : vector_index_wrapper_(vector_index_wrapper), trace_(trace) {
+    start_time_ = Helper::TimestampMs();
+  }
+  ~RepairVectorIndexTask() override = default;
+
+  std::string Type() override { return "REPAIR_VECTOR_INDEX"; }
+
+  void Run() override;
+
+  std::string Trace() override;
+
+ private:
+  VectorIndexWrapperPtr vector_index_wrapper_;
+  std::string trace_;
+  int64_t start_time_;
+};
+
 class LoadOrBuildVectorIndexTask : public TaskRunnable {
  public:
   LoadOrBuildVectorIndexTask(VectorIndexWrapperPtr vector_index_wrapper, bool is_temp_hold_vector_index,
@@ -163,6 +184,9 @@ class VectorIndexManager {
   // Launch save vector index at execute queue.
   static void LaunchSaveVectorIndex(VectorIndexWrapperPtr vector_index_wrapper, const std::string& trace);
 
+  // Launch repair vector index at execute queue.
+  static void LaunchRepairVectorIndex(VectorIndexWrapperPtr vector_index_wrapper, const std::string& trace);
+
   // Invoke when server running.
   static butil::Status RebuildVectorIndex(VectorIndexWrapperPtr vector_index_wrapper, const std::string& trace);
   // Launch rebuild vector index at execute queue.
@@ -261,7 +285,10 @@ class VectorIndexManager {
   static butil::Status ReplayWalToVectorIndex(std::shared_ptr<VectorIndex> vector_index, int64_t start_log_id,
                                               int64_t end_log_id);
 
-  static butil::Status TrainForBuild(std::shared_ptr<VectorIndex> vector_index, mvcc::ReaderPtr reader,
+  // Train by the trained_index(e.g. share vector index of parent region after split) if possible,
+  // otherwise train by the sampled vectors of range.
+  static butil::Status TrainForBuild(std::shared_ptr<VectorIndex> vector_index,
+                                     std::shared_ptr<VectorIndex> trained_index, mvcc::ReaderPtr reader,
                                      const pb::common::Range& encode_range);
 
  private:
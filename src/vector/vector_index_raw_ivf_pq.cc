@@ -35,6 +35,7 @@
 #include "faiss/MetricType.h"
 #include "faiss/impl/AuxIndexStructures.h"
 #include "faiss/impl/IDSelector.h"
+#include "faiss/impl/ProductQuantizer.h"
 #include "faiss/index_io.h"
 #include "fmt/core.h"
 #include "proto/common.pb.h"
@@ -515,6 +516,71 @@ butil::Status VectorIndexRawIvfPq::Train([[maybe_unused]] const std::vector<pb::
   return VectorIndexRawIvfPq::Train(train_datas);
 }
 
+void VectorIndexRawIvfPq::SetTrainDataSize(int64_t total_count) {
+  RWLockWriteGuard guard(&rw_lock_);
+  if (IsTrainedImpl()) {
+    train_data_size_ = std::max(static_cast<faiss::idx_t>(total_count), train_data_size_);
+  }
+}
+
+butil::Status VectorIndexRawIvfPq::TrainByIndex(std::shared_ptr<VectorIndex> trained_index) {
+  auto other = std::dynamic_pointer_cast<VectorIndexRawIvfPq>(trained_index);
+  if (other == nullptr) {
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "not same type vector index");
+  }
+
+  return TrainByIndex(*other);
+}
+
+butil::Status VectorIndexRawIvfPq::TrainByIndex(VectorIndexRawIvfPq& trained_index) {
+  if (&trained_index == this) {
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "can not train by self");
+  }
+
+  std::vector<float> centroids;
+  std::unique_ptr<faiss::ProductQuantizer> pq;
+  faiss::idx_t other_train_data_size = 0;
+  {
+    RWLockReadGuard other_guard(&trained_index.rw_lock_);
+    if (!trained_index.IsTrainedImpl() || trained_index.nlist_ != nlist_ ||
+        trained_index.nsubvector_ != nsubvector_ || trained_index.nbits_per_idx_ != nbits_per_idx_ ||
+        trained_index.dimension_ != dimension_ || trained_index.metric_type_ != metric_type_) {
+      return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "vector index parameter or train state not match");
+    }
+
+    centroids.resize(nlist_ * dimension_);
+    trained_index.index_->quantizer->reconstruct_n(0, nlist_, centroids.data());
+    pq = std::make_unique<faiss::ProductQuantizer>(trained_index.index_->pq);
+    other_train_data_size = trained_index.train_data_size_;
+  }
+
+  RWLockWriteGuard guard(&rw_lock_);
+
+  if (BAIDU_UNLIKELY(IsTrainedImpl())) {
+    return butil::Status::OK();
+  }
+
+  Init();
+
+  try {
+    quantizer_->add(nlist_, centroids.data());
+    index_->pq = *pq;
+    index_->is_trained = true;
+    // same as the end of faiss IndexIVFPQ train
+    index_->precompute_table();
+  } catch (std::exception& e) {
+    Reset();
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("train raw_ivf_pq by index exception: {}", e.what()));
+  }
+
+  train_data_size_ = other_train_data_size;
+
+  DINGO_LOG(INFO) << fmt::format("[vector_index.raw_ivf_pq][id({})] train by index({}), train_data_size({}).", Id(),
+                                 trained_index.Id(), train_data_size_);
+
+  return butil::Status::OK();
+}
+
 bool VectorIndexRawIvfPq::NeedToRebuild() {
   RWLockReadGuard guard(&rw_lock_);
 
@@ -106,6 +106,10 @@ class VectorIndexRawIvfPq : public VectorIndex {
   bool NeedToRebuild() override;
   bool NeedTrain() override { return true; }
   bool IsTrained() override;
+  void SetTrainDataSize(int64_t total_count) override;
+  butil::Status TrainByIndex(std::shared_ptr<VectorIndex> trained_index) override;
+  // copy the coarse centroids and pq codebooks of the trained index.
+  butil::Status TrainByIndex(VectorIndexRawIvfPq& trained_index);
   bool NeedToSave(int64_t last_save_log_behind) override;
 
  private:
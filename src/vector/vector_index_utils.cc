@@ -17,7 +17,9 @@
 #include <algorithm>
 #include <climits>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <random>
 #include <set>
 #include <string>
 #include <type_traits>
@@ -1411,4 +1413,23 @@ template butil::Status VectorIndexUtils::FillSearchResult<int>(const std::vector
                                                                const std::vector<long>&, pb::common::MetricType, long,
                                                                std::vector<pb::index::VectorWithDistanceResult>&);
 
+VectorReservoirSampler::VectorReservoirSampler(int64_t sample_count, int32_t dimension, uint64_t seed)
+    : sample_count_(sample_count), dimension_(dimension), rng_(seed) {}
+
+void VectorReservoirSampler::Add(const float* vector) {
+  ++total_count_;
+  // grow on demand, the region may have far less vectors than sample_count
+  if (sample_count_ <= 0 || total_count_ <= sample_count_) {
+    samples_.insert(samples_.end(), vector, vector + dimension_);
+    return;
+  }
+
+  // replace a sample with probability sample_count / total_count
+  std::uniform_int_distribution<int64_t> distrib(0, total_count_ - 1);
+  int64_t pos = distrib(rng_);
+  if (pos < sample_count_) {
+    std::memcpy(samples_.data() + pos * dimension_, vector, dimension_ * sizeof(float));
+  }
+}
+
 }  // namespace dingodb
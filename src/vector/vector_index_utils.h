@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <random>
 #include <utility>
 #include <vector>
 
@@ -226,6 +227,32 @@ class VectorIndexUtils {
                                                 bool& is_need);  // NOLINT
 };
 
+// Sample vectors uniformly by reservoir sampling(algorithm R) in a single pass,
+// the memory is bounded by sample_count * dimension whatever the total count is.
+class VectorReservoirSampler {
+ public:
+  // sample_count 0 means keep all vectors.
+  VectorReservoirSampler(int64_t sample_count, int32_t dimension, uint64_t seed);
+  ~VectorReservoirSampler() = default;
+
+  void Add(const float* vector);
+
+  // the count of added vectors.
+  int64_t TotalCount() const { return total_count_; }
+  int64_t SampleCount() const { return static_cast<int64_t>(samples_.size()) / dimension_; }
+
+  // flat array of sampled vectors, size is SampleCount() * dimension.
+  std::vector<float>& Samples() { return samples_; }
+
+ private:
+  int64_t sample_count_;
+  int32_t dimension_;
+  int64_t total_count_{0};
+
+  std::mt19937_64 rng_;
+  std::vector<float> samples_;
+};
+
 }  // namespace dingodb
 
 #endif  // DINGODB_VECTOR_INDEX_UTILS_H_
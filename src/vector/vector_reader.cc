@@ -16,9 +16,11 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <deque>
 #include <limits>
 #include <memory>
+#include <queue>
 #include <set>
 #include <string>
 #include <string_view>
@@ -39,6 +41,7 @@
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "server/server.h"
+#include "simd/hook.h"
 #include "vector/codec.h"
 #include "vector/vector_index.h"
 #include "vector/vector_index_factory.h"
@@ -53,10 +56,17 @@ namespace dingodb {
 
 DEFINE_int64(vector_index_max_range_search_result_count, 1024, "max range search result count");
 DEFINE_int64(vector_index_bruteforce_batch_count, 2048, "bruteforce batch count");
+DEFINE_int64(vector_index_bitmap_filter_max_expand_ratio, 4,
+             "use bitmap ids filter when bitmap memory is not larger than ratio * sorted ids memory, 0 means disable");
+DEFINE_double(vector_index_bruteforce_selectivity_threshold, 0.01,
+              "use bruteforce search over allowed ids when filter selectivity(allowed count / vector index count) "
+              "below it, 0 means disable");
 DEFINE_bool(dingo_log_switch_scalar_speed_up_detail, false, "scalar speed up log");
 
 bvar::LatencyRecorder g_bruteforce_search_latency("dingo_bruteforce_search_latency");
 bvar::LatencyRecorder g_bruteforce_range_search_latency("dingo_bruteforce_range_search_latency");
+bvar::LatencyRecorder g_bruteforce_search_with_ids_latency("dingo_bruteforce_search_with_ids_latency");
+bvar::LatencyRecorder g_rerank_search_latency("dingo_vector_rerank_search_latency");
 
 DECLARE_bool(dingo_log_switch_coprocessor_scalar_detail);
 
@@ -73,7 +83,7 @@ butil::Status VectorReader::QueryVectorWithId(int64_t ts, const pb::common::Rang
 
   if (with_vector_data) {
     pb::common::Vector vector;
-    CHECK(vector.ParseFromString(plain_value)) << "Parse vector proto error";
+    CHECK(VectorCodec::DecodeVectorValue(plain_value, vector)) << "Parse vector proto error";
 
     vector_with_id.mutable_vector()->Swap(&vector);
   }
@@ -206,7 +216,7 @@ butil::Status VectorReader::SearchVector(
   } else if (dingodb::pb::common::VectorFilter::SCALAR_FILTER == vector_filter &&
              dingodb::pb::common::VectorFilterType::QUERY_PRE == vector_filter_type) {  // scalar pre filter search
 
-    butil::Status status = DoVectorSearchForScalarPreFilter(vector_index, region_range, vector_with_ids, parameter,
+    butil::Status status = DoVectorSearchForScalarPreFilter(ts, vector_index, region_range, vector_with_ids, parameter,
                                                             scalar_schema, vector_with_distance_results);
     if (!status.ok()) {
       DINGO_LOG(ERROR) << fmt::format("DoVectorSearchForScalarPreFilter failed : {}", status.error_cstr());
@@ -349,6 +359,85 @@ butil::Status VectorReader::QueryVectorScalarData(int64_t ts, const pb::common::
   return butil::Status();
 }
 
+butil::Status VectorReader::BatchQueryVectorScalarData(int64_t ts, const pb::common::Range& region_range,
+                                                       int64_t partition_id,
+                                                       const std::vector<std::string>& selected_scalar_keys,
+                                                       std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  // skip empty vector_with_id which is not exist
+  std::vector<size_t> indexes;
+  std::vector<std::string> plain_keys;
+  for (size_t i = 0; i < vector_with_ids.size(); ++i) {
+    if (vector_with_ids[i].ByteSizeLong() == 0) {
+      continue;
+    }
+    indexes.push_back(i);
+    plain_keys.push_back(
+        VectorCodec::PackageVectorKey(Helper::GetKeyPrefix(region_range), partition_id, vector_with_ids[i].id()));
+  }
+
+  std::vector<std::string> plain_values;
+  std::vector<bool> key_states;
+  auto status = reader_->KvBatchGet(Constant::kVectorScalarCF, ts, plain_keys, plain_values, key_states);
+  if (!status.ok()) {
+    return status;
+  }
+
+  for (size_t i = 0; i < indexes.size(); ++i) {
+    if (!key_states[i]) {
+      continue;
+    }
+
+    pb::common::VectorScalardata vector_scalar;
+    CHECK(vector_scalar.ParseFromString(plain_values[i])) << "Parase vector scalar data error.";
+
+    auto* scalar = vector_with_ids[indexes[i]].mutable_scalar_data()->mutable_scalar_data();
+    for (const auto& [key, value] : vector_scalar.scalar_data()) {
+      if (!selected_scalar_keys.empty() &&
+          std::find(selected_scalar_keys.begin(), selected_scalar_keys.end(), key) == selected_scalar_keys.end()) {
+        continue;
+      }
+
+      scalar->insert({key, value});
+    }
+  }
+
+  return butil::Status();
+}
+
+butil::Status VectorReader::BatchQueryVectorTableData(int64_t ts, const pb::common::Range& region_range,
+                                                      int64_t partition_id,
+                                                      std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  // skip empty vector_with_id which is not exist
+  std::vector<size_t> indexes;
+  std::vector<std::string> plain_keys;
+  for (size_t i = 0; i < vector_with_ids.size(); ++i) {
+    if (vector_with_ids[i].ByteSizeLong() == 0) {
+      continue;
+    }
+    indexes.push_back(i);
+    plain_keys.push_back(
+        VectorCodec::PackageVectorKey(region_range.start_key()[0], partition_id, vector_with_ids[i].id()));
+  }
+
+  std::vector<std::string> plain_values;
+  std::vector<bool> key_states;
+  auto status = reader_->KvBatchGet(Constant::kVectorTableCF, ts, plain_keys, plain_values, key_states);
+  if (!status.ok()) {
+    return status;
+  }
+
+  for (size_t i = 0; i < indexes.size(); ++i) {
+    if (!key_states[i]) {
+      continue;
+    }
+
+    CHECK(vector_with_ids[indexes[i]].mutable_table_data()->ParseFromString(plain_values[i]))
+        << "Prase vector table data error.";
+  }
+
+  return butil::Status();
+}
+
 butil::Status VectorReader::CompareVectorScalarData(int64_t ts, const pb::common::Range& region_range,
                                                     int64_t partition_id, int64_t vector_id,
                                                     const pb::common::VectorScalardata& source_scalar_data,
@@ -450,45 +539,49 @@ butil::Status VectorReader::VectorBatchSearch(std::shared_ptr<Engine::VectorRead
 
 butil::Status VectorReader::VectorBatchQuery(std::shared_ptr<Engine::VectorReader::Context> ctx,
                                              std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  std::vector<std::string> plain_keys;
+  plain_keys.reserve(ctx->vector_ids.size());
   for (auto vector_id : ctx->vector_ids) {
+    plain_keys.push_back(
+        VectorCodec::PackageVectorKey(Helper::GetKeyPrefix(ctx->region_range), ctx->partition_id, vector_id));
+  }
+
+  std::vector<std::string> plain_values;
+  std::vector<bool> key_states;
+  auto status = reader_->KvBatchGet(Constant::kVectorDataCF, ctx->ts, plain_keys, plain_values, key_states);
+  if (!status.ok()) {
+    DINGO_LOG(WARNING) << fmt::format("Batch query vector_with_id failed, count: {} error: {}", plain_keys.size(),
+                                      status.error_str());
+    return status;
+  }
+
+  vector_with_ids.reserve(vector_with_ids.size() + ctx->vector_ids.size());
+  for (size_t i = 0; i < ctx->vector_ids.size(); ++i) {
+    // if the id is not exist, the vector_with_id will be empty, sdk client will handle this
     pb::common::VectorWithId vector_with_id;
-    auto status = QueryVectorWithId(ctx->ts, ctx->region_range, ctx->partition_id, vector_id, ctx->with_vector_data,
-                                    vector_with_id);
-    if ((!status.ok()) && status.error_code() != pb::error::EKEY_NOT_FOUND) {
-      DINGO_LOG(WARNING) << fmt::format("Query vector_with_id failed, vector_id: {} error: {}", vector_id,
-                                        status.error_str());
+    if (key_states[i]) {
+      if (ctx->with_vector_data) {
+        CHECK(VectorCodec::DecodeVectorValue(plain_values[i], *vector_with_id.mutable_vector()))
+            << "Parse vector proto error";
+      }
+      vector_with_id.set_id(ctx->vector_ids[i]);
     }
 
-    // if the id is not exist, the vector_with_id will be empty, sdk client will handle this
-    vector_with_ids.push_back(vector_with_id);
+    vector_with_ids.push_back(std::move(vector_with_id));
   }
 
   if (ctx->with_scalar_data) {
-    for (auto& vector_with_id : vector_with_ids) {
-      if (vector_with_id.ByteSizeLong() == 0) {
-        continue;
-      }
-
-      auto status = QueryVectorScalarData(ctx->ts, ctx->region_range, ctx->partition_id, ctx->selected_scalar_keys,
-                                          vector_with_id);
-      if (!status.ok()) {
-        DINGO_LOG(WARNING) << fmt::format("Query vector scalar data failed, vector_id: {} error: {} ",
-                                          vector_with_id.id(), status.error_str());
-      }
+    auto status = BatchQueryVectorScalarData(ctx->ts, ctx->region_range, ctx->partition_id, ctx->selected_scalar_keys,
+                                             vector_with_ids);
+    if (!status.ok()) {
+      DINGO_LOG(WARNING) << fmt::format("Batch query vector scalar data failed, error: {} ", status.error_str());
     }
   }
 
   if (ctx->with_table_data) {
-    for (auto& vector_with_id : vector_with_ids) {
-      if (vector_with_id.ByteSizeLong() == 0) {
-        continue;
-      }
-
-      auto status = QueryVectorTableData(ctx->ts, ctx->region_range, ctx->partition_id, vector_with_id);
-      if (!status.ok()) {
-        DINGO_LOG(WARNING) << fmt::format("Query vector table data failed, vector_id: {} error: {} ",
-                                          vector_with_id.id(), status.error_str());
-      }
+    auto status = BatchQueryVectorTableData(ctx->ts, ctx->region_range, ctx->partition_id, vector_with_ids);
+    if (!status.ok()) {
+      DINGO_LOG(WARNING) << fmt::format("Batch query vector table data failed, error: {} ", status.error_str());
     }
   }
 
@@ -801,7 +894,7 @@ butil::Status VectorReader::DoVectorSearchForVectorIdPreFilter(  // NOLINT
 }
 
 butil::Status VectorReader::DoVectorSearchForScalarPreFilter(
-    VectorIndexWrapperPtr vector_index, pb::common::Range region_range,
+    int64_t ts, VectorIndexWrapperPtr vector_index, pb::common::Range region_range,
     const std::vector<pb::common::VectorWithId>& vector_with_ids, const pb::common::VectorSearchParameter& parameter,
     const pb::common::ScalarSchema& scalar_schema,
     std::vector<pb::index::VectorWithDistanceResult>& vector_with_distance_results) {  // NOLINT
@@ -878,7 +971,22 @@ butil::Status VectorReader::DoVectorSearchForScalarPreFilter(
 
   std::vector<int64_t> vector_ids;
   vector_ids.reserve(1024);
-  if (enable_speed_up) {
+  // vector ids from scalar index is sorted
+  bool is_hit_scalar_index = false;
+  if (enable_speed_up && !use_coprocessor) {
+    status = vector_index->ScalarIndex()->Search(reader_, ts, region_range, scalar_schema,
+                                                 vector_with_ids[0].scalar_data(), vector_ids, is_hit_scalar_index);
+    if (!status.ok()) {
+      DINGO_LOG(WARNING) << fmt::format("scalar index search failed, fallback scan, error: {}", status.error_cstr());
+      vector_ids.clear();
+      is_hit_scalar_index = false;
+    }
+  }
+
+  if (is_hit_scalar_index) {
+    DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_scalar_speed_up_detail)
+        << fmt::format("hit scalar index, vector_ids size: {}", vector_ids.size());
+  } else if (enable_speed_up) {
     const auto& std_vector_scalar = use_coprocessor ? pb::common::VectorScalardata() : vector_with_ids[0].scalar_data();
     status = InternalVectorSearchForScalarPreFilterWithScalarKeySpeedUpCF(
         region_range, compare_keys, use_coprocessor, scalar_coprocessor, std_vector_scalar, vector_ids);
@@ -897,7 +1005,7 @@ butil::Status VectorReader::DoVectorSearchForScalarPreFilter(
   }
 
   std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters;
-  status = VectorReader::SetVectorIndexIdsFilter(false, false, vector_ids, filters);
+  status = VectorReader::SetVectorIndexIdsFilter(false, is_hit_scalar_index, vector_ids, filters);
   if (!status.ok()) {
     DINGO_LOG(ERROR) << status.error_cstr();
     return status;
@@ -1501,10 +1609,56 @@ butil::Status VectorReader::SetVectorIndexIdsFilter(bool is_negation, bool is_so
   if (!is_sorted) {
     std::sort(vector_ids.begin(), vector_ids.end());
   }
+
+  // dense ids use bitmap, check is O(1), sparse ids use binary search to save memory.
+  if (!vector_ids.empty() && FLAGS_vector_index_bitmap_filter_max_expand_ratio > 0) {
+    uint64_t bitmap_words = VectorIndex::BitmapFilterFunctor::BitmapWordCount(vector_ids.front(), vector_ids.back());
+    if (bitmap_words <= vector_ids.size() * static_cast<uint64_t>(FLAGS_vector_index_bitmap_filter_max_expand_ratio)) {
+      filters.push_back(std::make_shared<VectorIndex::BitmapFilterFunctor>(vector_ids, is_negation));
+      return butil::Status::OK();
+    }
+  }
+
   filters.push_back(std::make_shared<VectorIndex::SortFilterFunctor>(vector_ids, is_negation));
   return butil::Status::OK();
 }
 
+// Get the allowed vector ids when the ids filter is highly selective, ann search with a near-empty filter is slow
+// and may return less than topk, exact bruteforce over the allowed ids is faster.
+static bool IsLowSelectivityFilter(VectorIndexWrapperPtr vector_index,
+                                   const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                   std::vector<int64_t>& allowed_vector_ids) {
+  if (FLAGS_vector_index_bruteforce_selectivity_threshold <= 0 || filters.empty()) {
+    return false;
+  }
+
+  std::shared_ptr<VectorIndex::FilterFunctor> ids_filter;
+  int64_t allowed_count = -1;
+  for (const auto& filter : filters) {
+    int64_t count = filter->AllowedCount();
+    if (count >= 0 && (allowed_count < 0 || count < allowed_count)) {
+      allowed_count = count;
+      ids_filter = filter;
+    }
+  }
+  if (ids_filter == nullptr) {
+    return false;
+  }
+
+  int64_t vector_count = 0;
+  auto status = vector_index->GetCount(vector_count);
+  if (!status.ok() || vector_count <= 0) {
+    return false;
+  }
+
+  if (static_cast<double>(allowed_count) >= vector_count * FLAGS_vector_index_bruteforce_selectivity_threshold) {
+    return false;
+  }
+
+  ids_filter->GetAllowedVectorIds(allowed_vector_ids);
+  return true;
+}
+
 butil::Status VectorReader::SearchAndRangeSearchWrapper(
     VectorIndexWrapperPtr vector_index, pb::common::Range region_range,
     const std::vector<pb::common::VectorWithId>& vector_with_ids, const pb::common::VectorSearchParameter& parameter,
@@ -1528,7 +1682,7 @@ butil::Status VectorReader::SearchAndRangeSearchWrapper(
         return status;
       }
     } else {
-      status = BruteForceSearch(vector_index, vector_with_ids, topk, region_range, filters, with_vector_data, parameter,
+      status = BruteForceSearch(vector_index, vector_with_ids, topk, region_range, filters,
                                 vector_with_distance_results);
       if (!status.ok()) {
         DINGO_LOG(ERROR) << fmt::format("Search vector index failed, error: {} {}", status.error_code(),
@@ -1550,58 +1704,162 @@ butil::Status VectorReader::SearchAndRangeSearchWrapper(
         return status;
       }
     } else {
-      status = vector_index->Search(vector_with_ids, topk, region_range, filters, with_vector_data, parameter,
+      std::vector<int64_t> allowed_vector_ids;
+      if (IsLowSelectivityFilter(vector_index, filters, allowed_vector_ids)) {
+        DINGO_LOG(DEBUG) << fmt::format("Search vector index filter is selective, try brute force, id: {} count: {}",
+                                        vector_index->Id(), allowed_vector_ids.size());
+        status = BruteForceSearchWithIds(vector_index, vector_with_ids, topk, region_range, filters,
+                                         allowed_vector_ids, vector_with_distance_results);
+        if (status.error_code() != pb::error::Errno::EVECTOR_NOT_SUPPORT) {
+          return status;
+        }
+        vector_with_distance_results.clear();
+      }
+
+      // quantized index distance is approximate, search more candidates and re-rank them by the exact vector
+      uint32_t rerank_multiple = vector_index->RerankCandidateMultiple();
+      uint32_t search_topk = rerank_multiple > 0 ? topk * rerank_multiple : topk;
+
+      status = vector_index->Search(vector_with_ids, search_topk, region_range, filters, with_vector_data, parameter,
                                     vector_with_distance_results);
       if (status.error_code() == pb::error::Errno::EVECTOR_NOT_SUPPORT) {
         DINGO_LOG(DEBUG) << "Search vector index not support, try brute force, id: " << vector_index->Id();
-        return BruteForceSearch(vector_index, vector_with_ids, topk, region_range, filters, with_vector_data, parameter,
+        return BruteForceSearch(vector_index, vector_with_ids, topk, region_range, filters,
                                 vector_with_distance_results);
       } else if (!status.ok()) {
         DINGO_LOG(ERROR) << fmt::format("Search vector index failed, error: {} {}", status.error_code(),
                                         status.error_str());
         return status;
       }
+
+      if (rerank_multiple > 0) {
+        status = RerankSearchResult(vector_index, vector_with_ids, topk, region_range, vector_with_distance_results);
+        if (!status.ok()) {
+          DINGO_LOG(ERROR) << fmt::format("Rerank search result failed, error: {} {}", status.error_code(),
+                                          status.error_str());
+          return status;
+        }
+      }
     }
   }
 
   return butil::Status::OK();
 }
 
-// DistanceResult
-// This class is used for priority queue to merge the search result from many batch scan data from raw engine.
-class DistanceResult {
- public:
-  float distance{0};
-  pb::common::VectorWithDistance vector_with_distance{};
-  DistanceResult() = default;
-  DistanceResult(float distance, pb::common::VectorWithDistance vector_with_distance)
-      : distance(distance), vector_with_distance(vector_with_distance) {}
-};
-
-// Overload the < operator.
-bool operator<(const DistanceResult& result1, const DistanceResult& result2) {
-  if (result1.distance != result2.distance) {
-    return result1.distance < result2.distance;
-  } else {
-    return result1.vector_with_distance.vector_with_id().id() < result2.vector_with_distance.vector_with_id().id();
+BruteForceSearchKernel::BruteForceSearchKernel(pb::common::MetricType metric_type, int32_t dimension, uint32_t topk,
+                                               const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                               int64_t batch_count)
+    : metric_type_(metric_type),
+      dimension_(dimension),
+      topk_(topk),
+      query_count_(vector_with_ids.size()),
+      batch_count_(batch_count > 0 ? batch_count : 1) {
+  normalize_ = (metric_type_ == pb::common::MetricType::METRIC_TYPE_COSINE);
+  queries_ = VectorIndexUtils::ExtractVectorValue<float>(vector_with_ids, dimension_, normalize_);
+
+  batch_ids_.reserve(batch_count_);
+  batch_values_.resize(batch_count_ * dimension_);
+  distances_.resize(batch_count_);
+  top_results_.resize(query_count_);
+}
+
+bool BruteForceSearchKernel::IsSupportMetricType(pb::common::MetricType metric_type) {
+  return metric_type == pb::common::MetricType::METRIC_TYPE_L2 ||
+         metric_type == pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT ||
+         metric_type == pb::common::MetricType::METRIC_TYPE_COSINE;
+}
+
+void BruteForceSearchKernel::Add(int64_t vector_id, const char* data) {
+  float* dst = batch_values_.data() + batch_ids_.size() * dimension_;
+  memcpy(dst, data, dimension_ * sizeof(float));
+  if (normalize_) {
+    VectorIndexUtils::NormalizeVectorForFaiss(dst, dimension_);
+  }
+
+  batch_ids_.push_back(vector_id);
+  if (batch_ids_.size() >= batch_count_) {
+    Flush();
   }
 }
 
-// Overload the > operator.
-bool operator>(const DistanceResult& result1, const DistanceResult& result2) {
-  if (result1.distance != result2.distance) {
-    return result1.distance > result2.distance;
-  } else {
-    return result1.vector_with_distance.vector_with_id().id() > result2.vector_with_distance.vector_with_id().id();
+void BruteForceSearchKernel::Flush() {
+  size_t row_count = batch_ids_.size();
+  if (row_count == 0) {
+    return;
   }
+
+  for (size_t i = 0; i < query_count_; ++i) {
+    const float* query = queries_.get() + i * dimension_;
+    if (metric_type_ == pb::common::MetricType::METRIC_TYPE_L2) {
+      fvec_L2sqr_ny(distances_.data(), query, batch_values_.data(), dimension_, row_count);
+    } else {
+      fvec_inner_products_ny(distances_.data(), query, batch_values_.data(), dimension_, row_count);
+      for (size_t j = 0; j < row_count; ++j) {
+        distances_[j] = 1.0F - distances_[j];
+      }
+    }
+
+    auto& top_result = top_results_[i];
+    for (size_t j = 0; j < row_count; ++j) {
+      if (top_result.size() < topk_) {
+        top_result.emplace(distances_[j], batch_ids_[j]);
+      } else if (top_result.top().first > distances_[j]) {
+        top_result.pop();
+        top_result.emplace(distances_[j], batch_ids_[j]);
+      }
+    }
+  }
+
+  batch_ids_.clear();
 }
 
-// ScanData from raw engine, build vector index and search
+// we don't do sorting by distance here, the client will do sorting by distance
+void BruteForceSearchKernel::FillResult(std::vector<pb::index::VectorWithDistanceResult>& results) {
+  results.resize(query_count_);
+  for (size_t i = 0; i < query_count_; ++i) {
+    auto& top_result = top_results_[i];
+    auto* vector_with_distances = results[i].mutable_vector_with_distances();
+    vector_with_distances->Reserve(top_result.size());
+
+    std::vector<DistanceId> distance_ids;
+    distance_ids.reserve(top_result.size());
+    while (!top_result.empty()) {
+      distance_ids.push_back(top_result.top());
+      top_result.pop();
+    }
+
+    for (auto it = distance_ids.rbegin(); it != distance_ids.rend(); ++it) {
+      auto* vector_with_distance = vector_with_distances->Add();
+      auto* vector_with_id = vector_with_distance->mutable_vector_with_id();
+      vector_with_id->set_id(it->second);
+      vector_with_id->mutable_vector()->set_dimension(dimension_);
+      vector_with_id->mutable_vector()->set_value_type(::dingodb::pb::common::ValueType::FLOAT);
+      vector_with_distance->set_distance(it->first);
+      vector_with_distance->set_metric_type(metric_type_);
+    }
+  }
+}
+
+static butil::Status CheckBruteForceSearchParam(pb::common::MetricType metric_type, int32_t dimension,
+                                                const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  if (vector_with_ids.empty()) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "vector_with_ids is empty");
+  }
+  if (!BruteForceSearchKernel::IsSupportMetricType(metric_type)) {
+    std::string s =
+        fmt::format("bruteforce search not support metric type({})", pb::common::MetricType_Name(metric_type));
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, s);
+  }
+
+  return VectorIndexUtils::CheckVectorDimension(vector_with_ids, dimension);
+}
+
+// Scan data from raw engine, stream float values into the reused batch buffer and compute distance by simd kernel.
 butil::Status VectorReader::BruteForceSearch(VectorIndexWrapperPtr vector_index,
                                              const std::vector<pb::common::VectorWithId>& vector_with_ids,
                                              uint32_t topk, const pb::common::Range& region_range,
                                              std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
-                                             bool reconstruct, const pb::common::VectorSearchParameter& parameter,
                                              std::vector<pb::index::VectorWithDistanceResult>& results) {
   auto metric_type = vector_index->GetMetricType();
   auto dimension = vector_index->GetDimension();
@@ -1615,11 +1873,6 @@ butil::Status VectorReader::BruteForceSearch(VectorIndexWrapperPtr vector_index,
 
   auto encode_range = mvcc::Codec::EncodeRange(region_range);
 
-  pb::common::RegionEpoch epoch;
-  pb::common::VectorIndexParameter index_parameter;
-  index_parameter.mutable_flat_parameter()->set_dimension(dimension);
-  index_parameter.mutable_flat_parameter()->set_metric_type(metric_type);
-
   IteratorOptions options;
   options.upper_bound = encode_range.end_key();
   auto iter = reader_->NewIterator(Constant::kVectorDataCF, 0, options);
@@ -1629,140 +1882,222 @@ butil::Status VectorReader::BruteForceSearch(VectorIndexWrapperPtr vector_index,
     return butil::Status();
   }
 
+  auto status = CheckBruteForceSearchParam(metric_type, dimension, vector_with_ids);
+  if (!status.ok()) {
+    return status;
+  }
+  if (topk == 0) {
+    results.resize(vector_with_ids.size());
+    return butil::Status::OK();
+  }
+
   BvarLatencyGuard bvar_guard(&g_bruteforce_search_latency);
 
-  // topk results
-  std::vector<std::priority_queue<DistanceResult>> top_results;
-  top_results.resize(vector_with_ids.size());
+  BruteForceSearchKernel kernel(metric_type, dimension, topk, vector_with_ids,
+                                FLAGS_vector_index_bruteforce_batch_count);
 
-  int64_t count = 0;
-  std::vector<pb::common::VectorWithId> vector_with_id_batch;
-  std::vector<pb::index::VectorWithDistanceResult> results_batch;
+  // used when the float values is not packed, rarely happen
+  pb::common::Vector vector;
+  std::string_view float_values;
 
   // scan data from raw engine
-  while (iter->Valid()) {
+  for (; iter->Valid(); iter->Next()) {
     std::string key(iter->Key());
     auto vector_id = VectorCodec::DecodeVectorIdFromEncodeKeyWithTs(key);
     CHECK(vector_id > 0) << fmt::format("vector_id({}) is invaild", vector_id);
 
-    std::string value(mvcc::Codec::UnPackageValue(iter->Value()));
+    bool is_member = true;
+    for (const auto& filter : filters) {
+      if (!filter->Check(vector_id)) {
+        is_member = false;
+        break;
+      }
+    }
+    if (!is_member) {
+      continue;
+    }
 
-    pb::common::Vector vector;
-    CHECK(vector.ParseFromString(value)) << "Parse vector proto error";
+    auto value = mvcc::Codec::UnPackageValue(iter->Value());
+    if (!VectorCodec::DecodeFloatValuesView(value, float_values)) {
+      CHECK(VectorCodec::DecodeVectorValue(value, vector)) << "Parse vector proto error";
+      float_values = std::string_view(reinterpret_cast<const char*>(vector.float_values().data()),
+                                      vector.float_values_size() * sizeof(float));
+    }
 
-    pb::common::VectorWithId vector_with_id;
-    vector_with_id.mutable_vector()->Swap(&vector);
-    vector_with_id.set_id(vector_id);
+    if (float_values.size() != dimension * sizeof(float)) {
+      std::string s = fmt::format("vector({}) dimension({}) not match index dimension({})", vector_id,
+                                  float_values.size() / sizeof(float), dimension);
+      DINGO_LOG(ERROR) << s;
+      return butil::Status(pb::error::Errno::EVECTOR_INVALID, s);
+    }
 
-    vector_with_id_batch.push_back(vector_with_id);
+    kernel.Add(vector_id, float_values.data());
+  }
 
-    if (vector_with_id_batch.size() == FLAGS_vector_index_bruteforce_batch_count) {
-      auto thread_pool = Server::GetInstance().GetVectorIndexThreadPool();
-      auto flat_index = VectorIndexFactory::NewFlat(INT64_MAX, index_parameter, epoch, region_range, thread_pool);
-      CHECK(flat_index != nullptr) << "flat_index is nullptr";
+  kernel.Flush();
+  kernel.FillResult(results);
 
-      auto ret = flat_index->AddByParallel(vector_with_id_batch);
-      if (!ret.ok()) {
-        DINGO_LOG(ERROR) << fmt::format("Add vector to flat index failed, error: {} {}", ret.error_code(),
-                                        ret.error_str());
-        return ret;
-      }
+  return butil::Status::OK();
+}
 
-      ret = flat_index->SearchByParallel(vector_with_ids, topk, filters, reconstruct, parameter, results_batch);
-      if (!ret.ok()) {
-        DINGO_LOG(ERROR) << fmt::format("Search vector index failed, error: {} {}", ret.error_code(), ret.error_str());
-        return ret;
-      }
+// Point get the allowed vector ids by batch, instead of scan the whole region, for the highly selective filter.
+butil::Status VectorReader::BruteForceSearchWithIds(VectorIndexWrapperPtr vector_index,
+                                                    const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                                    uint32_t topk, const pb::common::Range& region_range,
+                                                    std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                                    const std::vector<int64_t>& allowed_vector_ids,
+                                                    std::vector<pb::index::VectorWithDistanceResult>& results) {
+  auto metric_type = vector_index->GetMetricType();
+  auto dimension = vector_index->GetDimension();
+  if (dimension <= 0) {
+    std::string s =
+        fmt::format("This is bug. Subsequent complete repair vector index dimension({}) is invalid", dimension);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EVECTOR_INVALID, s);
+  }
+  // caller fallback to ann search
+  if (!BruteForceSearchKernel::IsSupportMetricType(metric_type)) {
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "bruteforce search not support metric type");
+  }
 
-      CHECK(results_batch.size() == vector_with_ids.size());
+  auto status = CheckBruteForceSearchParam(metric_type, dimension, vector_with_ids);
+  if (!status.ok()) {
+    return status;
+  }
 
-      for (int i = 0; i < results_batch.size(); i++) {
-        auto& result = results_batch[i];
-        auto& top_result = top_results[i];
+  results.resize(vector_with_ids.size());
+  if (topk == 0 || allowed_vector_ids.empty()) {
+    return butil::Status::OK();
+  }
 
-        for (const auto& vector_with_distance : result.vector_with_distances()) {
-          auto& top_result = top_results[i];
-          if (top_result.size() < topk) {
-            top_result.emplace(vector_with_distance.distance(), vector_with_distance);
-          } else {
-            if (top_result.top().distance > vector_with_distance.distance()) {
-              top_result.pop();
-              top_result.emplace(vector_with_distance.distance(), vector_with_distance);
-            }
-          }
-        }
-      }
+  BvarLatencyGuard bvar_guard(&g_bruteforce_search_with_ids_latency);
 
-      results_batch.clear();
-      vector_with_id_batch.clear();
-    }
+  char prefix = Helper::GetKeyPrefix(region_range);
+  int64_t partition_id = VectorCodec::UnPackagePartitionId(region_range.start_key());
+  int64_t begin_vector_id = 0, end_vector_id = 0;
+  VectorCodec::DecodeRangeToVectorId(false, region_range, begin_vector_id, end_vector_id);
 
-    iter->Next();
-  }
+  int64_t batch_count = FLAGS_vector_index_bruteforce_batch_count > 0 ? FLAGS_vector_index_bruteforce_batch_count : 1;
+  BruteForceSearchKernel kernel(metric_type, dimension, topk, vector_with_ids, batch_count);
 
-  if (!vector_with_id_batch.empty()) {
-    auto thread_pool = Server::GetInstance().GetVectorIndexThreadPool();
-    auto flat_index = VectorIndexFactory::NewFlat(INT64_MAX, index_parameter, epoch, region_range, thread_pool);
-    CHECK(flat_index != nullptr) << "flat_index is nullptr";
+  std::vector<int64_t> batch_vector_ids;
+  std::vector<std::string> plain_keys;
+  std::vector<std::string> plain_values;
+  std::vector<bool> key_states;
+  batch_vector_ids.reserve(batch_count);
+  plain_keys.reserve(batch_count);
 
-    auto ret = flat_index->AddByParallel(vector_with_id_batch);
-    if (!ret.ok()) {
-      DINGO_LOG(ERROR) << fmt::format("Add vector to flat index failed, error: {} {}", ret.error_code(),
-                                      ret.error_str());
-      return ret;
+  // used when the float values is not packed, rarely happen
+  pb::common::Vector vector;
+  std::string_view float_values;
+
+  auto search_batch = [&]() -> butil::Status {
+    auto status = reader_->KvBatchGet(Constant::kVectorDataCF, 0, plain_keys, plain_values, key_states);
+    if (!status.ok()) {
+      return status;
     }
 
-    ret = flat_index->SearchByParallel(vector_with_ids, topk, filters, reconstruct, parameter, results_batch);
-    if (!ret.ok()) {
-      DINGO_LOG(ERROR) << fmt::format("Search vector index failed, error: {} {}", ret.error_code(), ret.error_str());
-      return ret;
+    for (size_t i = 0; i < plain_keys.size(); ++i) {
+      if (!key_states[i]) {
+        continue;
+      }
+
+      const auto& value = plain_values[i];
+      if (!VectorCodec::DecodeFloatValuesView(value, float_values)) {
+        CHECK(VectorCodec::DecodeVectorValue(value, vector)) << "Parse vector proto error";
+        float_values = std::string_view(reinterpret_cast<const char*>(vector.float_values().data()),
+                                        vector.float_values_size() * sizeof(float));
+      }
+
+      if (float_values.size() != dimension * sizeof(float)) {
+        std::string s = fmt::format("vector({}) dimension({}) not match index dimension({})", batch_vector_ids[i],
+                                    float_values.size() / sizeof(float), dimension);
+        DINGO_LOG(ERROR) << s;
+        return butil::Status(pb::error::Errno::EVECTOR_INVALID, s);
+      }
+
+      kernel.Add(batch_vector_ids[i], float_values.data());
     }
 
-    CHECK(results_batch.size() == vector_with_ids.size());
+    batch_vector_ids.clear();
+    plain_keys.clear();
+    return butil::Status::OK();
+  };
 
-    for (int i = 0; i < results_batch.size(); i++) {
-      auto& result = results_batch[i];
-      auto& top_result = top_results[i];
+  for (int64_t vector_id : allowed_vector_ids) {
+    if (vector_id < begin_vector_id || vector_id >= end_vector_id) {
+      continue;
+    }
 
-      for (const auto& vector_with_distance : result.vector_with_distances()) {
-        auto& top_result = top_results[i];
-        if (top_result.size() < topk) {
-          top_result.emplace(vector_with_distance.distance(), vector_with_distance);
-        } else {
-          if (top_result.top().distance > vector_with_distance.distance()) {
-            top_result.pop();
-            top_result.emplace(vector_with_distance.distance(), vector_with_distance);
-          }
-        }
+    bool is_member = true;
+    for (const auto& filter : filters) {
+      if (!filter->Check(vector_id)) {
+        is_member = false;
+        break;
       }
     }
+    if (!is_member) {
+      continue;
+    }
 
-    results_batch.clear();
-    vector_with_id_batch.clear();
+    batch_vector_ids.push_back(vector_id);
+    plain_keys.push_back(VectorCodec::PackageVectorKey(prefix, partition_id, vector_id));
+    if (plain_keys.size() >= static_cast<size_t>(batch_count)) {
+      status = search_batch();
+      if (!status.ok()) {
+        return status;
+      }
+    }
   }
 
-  // copy top_results to results
-  // we don't do sorting by distance here
-  // the client will do sorting by distance
-  results.resize(top_results.size());
+  if (!plain_keys.empty()) {
+    status = search_batch();
+    if (!status.ok()) {
+      return status;
+    }
+  }
 
-  for (int i = 0; i < top_results.size(); i++) {
-    auto& top_result = top_results[i];
-    auto& result = results[i];
+  kernel.Flush();
+  kernel.FillResult(results);
 
-    std::deque<pb::common::VectorWithDistance> vector_with_distances_deque;
+  return butil::Status::OK();
+}
 
-    while (!top_result.empty()) {
-      auto top = top_result.top();
-      vector_with_distances_deque.emplace_front(top.vector_with_distance);
-      top_result.pop();
+// Re-rank the candidates of each query by the exact vector of vector data cf, keep the nearest topk.
+// The candidates already pass the filters, so no need to check filters again.
+butil::Status VectorReader::RerankSearchResult(VectorIndexWrapperPtr vector_index,
+                                               const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                               uint32_t topk, const pb::common::Range& region_range,
+                                               std::vector<pb::index::VectorWithDistanceResult>& results) {
+  BvarLatencyGuard bvar_guard(&g_rerank_search_latency);
+
+  std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters;
+  for (size_t row = 0; row < results.size() && row < vector_with_ids.size(); ++row) {
+    auto* vector_with_distances = results[row].mutable_vector_with_distances();
+    if (vector_with_distances->size() <= 1) {
+      continue;
     }
 
-    while (!vector_with_distances_deque.empty()) {
-      auto& vector_with_distance = *result.add_vector_with_distances();
-      vector_with_distance.Swap(&vector_with_distances_deque.front());
-      vector_with_distances_deque.pop_front();
+    std::vector<int64_t> candidate_vector_ids;
+    candidate_vector_ids.reserve(vector_with_distances->size());
+    for (const auto& vector_with_distance : *vector_with_distances) {
+      candidate_vector_ids.push_back(vector_with_distance.vector_with_id().id());
+    }
+
+    std::vector<pb::index::VectorWithDistanceResult> rerank_results;
+    auto status = BruteForceSearchWithIds(vector_index, {vector_with_ids[row]}, topk, region_range, filters,
+                                          candidate_vector_ids, rerank_results);
+    if (status.error_code() == pb::error::Errno::EVECTOR_NOT_SUPPORT) {
+      // keep the approximate order
+      if (vector_with_distances->size() > static_cast<int>(topk)) {
+        vector_with_distances->DeleteSubrange(topk, vector_with_distances->size() - topk);
+      }
+      continue;
+    } else if (!status.ok()) {
+      return status;
     }
+
+    results[row].Swap(&rerank_results[0]);
   }
 
   return butil::Status::OK();
@@ -1812,7 +2147,7 @@ butil::Status VectorReader::BruteForceRangeSearch(VectorIndexWrapperPtr vector_i
     std::string value(mvcc::Codec::UnPackageValue(iter->Value()));
 
     pb::common::Vector vector;
-    CHECK(vector.ParseFromString(value)) << "Parse vector proto error.";
+    CHECK(VectorCodec::DecodeVectorValue(value, vector)) << "Parse vector proto error.";
 
     pb::common::VectorWithId vector_with_id;
     vector_with_id.mutable_vector()->Swap(&vector);
@@ -20,8 +20,10 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <queue>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "butil/status.h"
@@ -34,6 +36,42 @@
 
 namespace dingodb {
 
+// Brute force search kernel, the distance is the smaller the closer.
+// It is same as flat index result, inner product/cosine distance is 1 - ip.
+// The result vector only has id, vector data is filled by the caller.
+class BruteForceSearchKernel {
+ public:
+  // distance and vector id, max heap by distance then id
+  using DistanceId = std::pair<float, int64_t>;
+
+  BruteForceSearchKernel(pb::common::MetricType metric_type, int32_t dimension, uint32_t topk,
+                         const std::vector<pb::common::VectorWithId>& vector_with_ids, int64_t batch_count);
+
+  static bool IsSupportMetricType(pb::common::MetricType metric_type);
+
+  // data must have dimension float values
+  void Add(int64_t vector_id, const char* data);
+  void Flush();
+  void FillResult(std::vector<pb::index::VectorWithDistanceResult>& results);
+
+ private:
+  pb::common::MetricType metric_type_;
+  int32_t dimension_;
+  uint32_t topk_;
+  size_t query_count_;
+  size_t batch_count_;
+  bool normalize_{false};
+
+  std::unique_ptr<float[]> queries_;
+
+  // reused batch buffer, avoid allocate per batch
+  std::vector<int64_t> batch_ids_;
+  std::vector<float> batch_values_;
+  std::vector<float> distances_;
+
+  std::vector<std::priority_queue<DistanceId>> top_results_;
+};
+
 // Vector reader
 class VectorReader {
  public:
@@ -103,6 +141,10 @@ class VectorReader {
                                       std::vector<std::string> selected_scalar_keys,
                                       std::vector<pb::index::VectorWithDistanceResult>& results);
 
+  butil::Status BatchQueryVectorScalarData(int64_t ts, const pb::common::Range& region_range, int64_t partition_id,
+                                           const std::vector<std::string>& selected_scalar_keys,
+                                           std::vector<pb::common::VectorWithId>& vector_with_ids);
+
   butil::Status CompareVectorScalarData(int64_t ts, const pb::common::Range& region_range, int64_t partition_id,
                                         int64_t vector_id, const pb::common::VectorScalardata& source_scalar_data,
                                         bool& compare_result);
@@ -119,6 +161,9 @@ class VectorReader {
   butil::Status QueryVectorTableData(int64_t ts, const pb::common::Range& region_range, int64_t partition_id,
                                      std::vector<pb::index::VectorWithDistanceResult>& results);
 
+  butil::Status BatchQueryVectorTableData(int64_t ts, const pb::common::Range& region_range, int64_t partition_id,
+                                          std::vector<pb::common::VectorWithId>& vector_with_ids);
+
   butil::Status GetBorderId(int64_t ts, const pb::common::Range& region_range, bool get_min, int64_t& vector_id);
   butil::Status ScanVectorId(std::shared_ptr<Engine::VectorReader::Context> ctx, std::vector<int64_t>& vector_ids);
 
@@ -129,7 +174,7 @@ class VectorReader {
 
  public:
   butil::Status DoVectorSearchForScalarPreFilter(
-      VectorIndexWrapperPtr vector_index, pb::common::Range region_range,
+      int64_t ts, VectorIndexWrapperPtr vector_index, pb::common::Range region_range,
       const std::vector<pb::common::VectorWithId>& vector_with_ids, const pb::common::VectorSearchParameter& parameter,
       const pb::common::ScalarSchema& scalar_schema,
       std::vector<pb::index::VectorWithDistanceResult>& vector_with_distance_results);
@@ -190,10 +235,23 @@ class VectorReader {
   butil::Status BruteForceSearch(VectorIndexWrapperPtr vector_index,
                                  const std::vector<pb::common::VectorWithId>& vector_with_ids, uint32_t topk,
                                  const pb::common::Range& region_range,
-                                 std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters, bool reconstruct,
-                                 const pb::common::VectorSearchParameter& parameter,
+                                 std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
                                  std::vector<pb::index::VectorWithDistanceResult>& results);
 
+  // bruteforce search only over the allowed vector ids, for highly selective filter.
+  butil::Status BruteForceSearchWithIds(VectorIndexWrapperPtr vector_index,
+                                        const std::vector<pb::common::VectorWithId>& vector_with_ids, uint32_t topk,
+                                        const pb::common::Range& region_range,
+                                        std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                        const std::vector<int64_t>& allowed_vector_ids,
+                                        std::vector<pb::index::VectorWithDistanceResult>& results);
+
+  // re-rank the approximate search result of quantized index by the exact vector.
+  butil::Status RerankSearchResult(VectorIndexWrapperPtr vector_index,
+                                   const std::vector<pb::common::VectorWithId>& vector_with_ids, uint32_t topk,
+                                   const pb::common::Range& region_range,
+                                   std::vector<pb::index::VectorWithDistanceResult>& results);
+
   butil::Status BruteForceRangeSearch(VectorIndexWrapperPtr vector_index,
                                       const std::vector<pb::common::VectorWithId>& vector_with_ids, float radius,
                                       const pb::common::Range& region_range,
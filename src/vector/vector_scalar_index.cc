@@ -0,0 +1,501 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vector/vector_scalar_index.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bvar/latency_recorder.h"
+#include "bvar/reducer.h"
+#include "common/constant.h"
+#include "common/helper.h"
+#include "common/logging.h"
+#include "common/synchronization.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "mvcc/codec.h"
+#include "mvcc/reader.h"
+#include "proto/error.pb.h"
+#include "vector/codec.h"
+
+namespace dingodb {
+
+DEFINE_bool(enable_vector_scalar_index, true, "enable scalar speed up key postings index for scalar pre filter");
+DEFINE_int64(vector_scalar_index_max_memory_size, 1024L * 1024 * 1024,
+             "max memory size of all vector scalar index, the region exceed it fallback scan");
+DEFINE_int64(vector_scalar_index_max_pending_count, 100000,
+             "max vector add/delete cached during build vector scalar index, exceed it cancel the build");
+
+bvar::LatencyRecorder g_vector_scalar_index_build_latency("dingo_vector_scalar_index_build_latency");
+bvar::LatencyRecorder g_vector_scalar_index_search_latency("dingo_vector_scalar_index_search_latency");
+bvar::Adder<int64_t> g_vector_scalar_index_memory_size("dingo_vector_scalar_index_memory_size");
+
+// check the build is cancelled every this scanned keys
+constexpr int64_t kCheckCancelKeyNum = 4096;
+
+// estimated memory of node based container element, include the allocator and hash bucket overhead.
+constexpr int64_t kPostingMemorySize = 96;
+constexpr int64_t kPostingIdMemorySize = 48;
+constexpr int64_t kVectorMemorySize = 64;
+
+static std::atomic<int64_t> total_memory_size{0};
+
+template <typename T>
+static void AppendFixed(T value, std::string& output) {
+  output.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void AppendBytes(const std::string& value, std::string& output) {
+  AppendFixed(static_cast<uint32_t>(value.size()), output);
+  output.append(value);
+}
+
+VectorScalarIndex::VectorScalarIndex() { bthread_mutex_init(&mutex_, nullptr); }
+
+VectorScalarIndex::~VectorScalarIndex() { bthread_mutex_destroy(&mutex_); }
+
+VectorScalarIndex::PostingSet::~PostingSet() { ReleaseMemory(memory_size_); }
+
+bool VectorScalarIndex::PostingSet::AcquireMemory(int64_t size) {
+  if (total_memory_size.fetch_add(size) + size > FLAGS_vector_scalar_index_max_memory_size) {
+    total_memory_size.fetch_sub(size);
+    is_exceed_memory_ = true;
+    return false;
+  }
+
+  memory_size_ += size;
+  g_vector_scalar_index_memory_size << size;
+  return true;
+}
+
+void VectorScalarIndex::PostingSet::ReleaseMemory(int64_t size) {
+  total_memory_size.fetch_sub(size);
+  memory_size_ -= size;
+  g_vector_scalar_index_memory_size << -size;
+}
+
+bool VectorScalarIndex::PostingSet::Add(int64_t vector_id, const std::string& key,
+                                        const pb::common::ScalarValue& value) {
+  std::string posting_key;
+  if (!GenPostingKey(key, value, posting_key)) {
+    return true;
+  }
+
+  auto it = postings_.find(posting_key);
+  if (it == postings_.end()) {
+    if (!AcquireMemory(kPostingMemorySize + posting_key.size())) {
+      return false;
+    }
+    it = postings_.emplace(std::move(posting_key), std::set<int64_t>()).first;
+  }
+
+  auto vector_it = vector_postings_.find(vector_id);
+  if (vector_it == vector_postings_.end()) {
+    if (!AcquireMemory(kVectorMemorySize)) {
+      return false;
+    }
+    vector_it = vector_postings_.emplace(vector_id, std::vector<PostingMap::value_type*>()).first;
+  }
+
+  if (!it->second.insert(vector_id).second) {
+    return true;
+  }
+  if (!AcquireMemory(kPostingIdMemorySize)) {
+    it->second.erase(vector_id);
+    return false;
+  }
+  vector_it->second.push_back(&(*it));
+
+  return true;
+}
+
+bool VectorScalarIndex::PostingSet::Upsert(int64_t vector_id, const std::set<std::string>& speed_up_keys,
+                                           const pb::common::VectorScalardata& scalar_data) {
+  Remove(vector_id);
+  for (const auto& key : speed_up_keys) {
+    auto it = scalar_data.scalar_data().find(key);
+    if (it != scalar_data.scalar_data().end() && !Add(vector_id, key, it->second)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void VectorScalarIndex::PostingSet::Remove(int64_t vector_id) {
+  auto it = vector_postings_.find(vector_id);
+  if (it == vector_postings_.end()) {
+    return;
+  }
+
+  for (auto* posting : it->second) {
+    posting->second.erase(vector_id);
+    ReleaseMemory(kPostingIdMemorySize);
+    if (posting->second.empty()) {
+      ReleaseMemory(kPostingMemorySize + posting->first.size());
+      postings_.erase(postings_.find(posting->first));
+    }
+  }
+
+  vector_postings_.erase(it);
+  ReleaseMemory(kVectorMemorySize);
+}
+
+bool VectorScalarIndex::GenPostingKey(const std::string& key, const pb::common::ScalarValue& value,
+                                      std::string& posting_key) {
+  posting_key.clear();
+  AppendBytes(key, posting_key);
+  AppendFixed(static_cast<int32_t>(value.field_type()), posting_key);
+  AppendFixed(static_cast<int32_t>(value.fields_size()), posting_key);
+
+  for (const auto& field : value.fields()) {
+    switch (value.field_type()) {
+      case pb::common::ScalarFieldType::BOOL:
+        posting_key.push_back(field.bool_data() ? 1 : 0);
+        break;
+      case pb::common::ScalarFieldType::INT8:
+      case pb::common::ScalarFieldType::INT16:
+      case pb::common::ScalarFieldType::INT32:
+        AppendFixed(field.int_data(), posting_key);
+        break;
+      case pb::common::ScalarFieldType::INT64:
+        AppendFixed(field.long_data(), posting_key);
+        break;
+      case pb::common::ScalarFieldType::FLOAT32: {
+        // NaN is not equal to any value, -0.0 is equal to 0.0
+        float float_data = field.float_data();
+        if (std::isnan(float_data)) {
+          return false;
+        }
+        AppendFixed(float_data == 0.0F ? 0.0F : float_data, posting_key);
+        break;
+      }
+      case pb::common::ScalarFieldType::DOUBLE: {
+        double double_data = field.double_data();
+        if (std::isnan(double_data)) {
+          return false;
+        }
+        AppendFixed(double_data == 0.0 ? 0.0 : double_data, posting_key);
+        break;
+      }
+      case pb::common::ScalarFieldType::STRING:
+        AppendBytes(field.string_data(), posting_key);
+        break;
+      case pb::common::ScalarFieldType::BYTES:
+        AppendBytes(field.bytes_data(), posting_key);
+        break;
+      default:
+        return false;
+    }
+  }
+
+  return true;
+}
+
+void VectorScalarIndex::CancelBuild() {
+  version_.fetch_add(1);
+  is_building_ = false;
+  pending_applies_.clear();
+}
+
+void VectorScalarIndex::Clear() {
+  CancelBuild();
+  is_exceed_memory_ = false;
+  start_key_.clear();
+  end_key_.clear();
+  speed_up_keys_.clear();
+  max_ts_ = 0;
+  posting_set_.reset();
+}
+
+void VectorScalarIndex::Upsert(int64_t vector_id, const pb::common::VectorScalardata& scalar_data, int64_t ts) {
+  BAIDU_SCOPED_LOCK(mutex_);
+  max_ts_ = std::max(max_ts_, ts);
+
+  if (is_building_) {
+    if (static_cast<int64_t>(pending_applies_.size()) >= FLAGS_vector_scalar_index_max_pending_count) {
+      DINGO_LOG(WARNING) << "[vector_scalar_index] too many apply during build, cancel build.";
+      CancelBuild();
+    } else {
+      PendingApply pending_apply{vector_id, false, {}};
+      for (const auto& key : speed_up_keys_) {
+        auto it = scalar_data.scalar_data().find(key);
+        if (it != scalar_data.scalar_data().end()) {
+          pending_apply.scalar_data.mutable_scalar_data()->insert({key, it->second});
+        }
+      }
+      pending_applies_.push_back(std::move(pending_apply));
+    }
+  }
+
+  if (posting_set_ != nullptr && !posting_set_->Upsert(vector_id, speed_up_keys_, scalar_data)) {
+    DINGO_LOG(WARNING) << fmt::format("[vector_scalar_index] exceed memory limit {}, drop index.",
+                                      FLAGS_vector_scalar_index_max_memory_size);
+    posting_set_.reset();
+    is_exceed_memory_ = true;
+  }
+}
+
+void VectorScalarIndex::Delete(const std::vector<int64_t>& vector_ids, int64_t ts) {
+  BAIDU_SCOPED_LOCK(mutex_);
+  max_ts_ = std::max(max_ts_, ts);
+
+  if (is_building_) {
+    if (static_cast<int64_t>(pending_applies_.size() + vector_ids.size()) >
+        FLAGS_vector_scalar_index_max_pending_count) {
+      DINGO_LOG(WARNING) << "[vector_scalar_index] too many apply during build, cancel build.";
+      CancelBuild();
+    } else {
+      for (int64_t vector_id : vector_ids) {
+        pending_applies_.push_back(PendingApply{vector_id, true, {}});
+      }
+    }
+  }
+
+  if (posting_set_ != nullptr) {
+    for (int64_t vector_id : vector_ids) {
+      posting_set_->Remove(vector_id);
+    }
+  }
+}
+
+void VectorScalarIndex::Reset() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  Clear();
+}
+
+bool VectorScalarIndex::IsBuilt() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return posting_set_ != nullptr;
+}
+
+bool VectorScalarIndex::IsBuilding() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return is_building_;
+}
+
+int64_t VectorScalarIndex::PostingCount() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return posting_set_ != nullptr ? posting_set_->Postings().size() : 0;
+}
+
+int64_t VectorScalarIndex::VectorCount() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return posting_set_ != nullptr ? posting_set_->VectorCount() : 0;
+}
+
+int64_t VectorScalarIndex::MemorySize() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return posting_set_ != nullptr ? posting_set_->MemorySize() : 0;
+}
+
+int64_t VectorScalarIndex::TotalMemorySize() { return total_memory_size.load(); }
+
+// Hold the mutex.
+void VectorScalarIndex::StartBuild(mvcc::ReaderPtr reader, const pb::common::Range& region_range) {
+  is_building_ = true;
+  pending_applies_.clear();
+
+  auto self = shared_from_this();
+  int64_t version = version_.load();
+  std::set<std::string> speed_up_keys = speed_up_keys_;
+  Bthread bth(&BTHREAD_ATTR_NORMAL, [self, reader, region_range, speed_up_keys, version]() {
+    self->Build(reader, region_range, speed_up_keys, version);
+  });
+}
+
+butil::Status VectorScalarIndex::ScanSpeedUpCF(mvcc::ReaderPtr reader, const pb::common::Range& region_range,
+                                               const std::set<std::string>& speed_up_keys, int64_t version,
+                                               PostingSet& posting_set, int64_t& max_ts) {
+  auto encode_range = mvcc::Codec::EncodeRange(region_range);
+
+  IteratorOptions options;
+  options.upper_bound = encode_range.end_key();
+  auto iter = reader->NewIterator(Constant::kVectorScalarKeySpeedUpCF, 0, options);
+  if (iter == nullptr) {
+    return butil::Status(pb::error::Errno::EINTERNAL, "New iterator failed");
+  }
+
+  int64_t count = 0;
+  for (iter->Seek(encode_range.start_key()); iter->Valid(); iter->Next()) {
+    if (++count % kCheckCancelKeyNum == 0 && version != version_.load()) {
+      return butil::Status(pb::error::Errno::EINTERNAL, "Build is cancelled");
+    }
+
+    std::string key(iter->Key());
+    int64_t partition_id = 0;
+    int64_t vector_id = 0;
+    std::string scalar_key;
+    VectorCodec::DecodeFromEncodeKeyWithTs(key, partition_id, vector_id, scalar_key);
+    if (speed_up_keys.find(scalar_key) == speed_up_keys.end()) {
+      continue;
+    }
+    max_ts = std::max(max_ts, VectorCodec::TruncateKeyForTs(key));
+
+    auto value = mvcc::Codec::UnPackageValue(iter->Value());
+    pb::common::ScalarValue scalar_value;
+    if (!scalar_value.ParseFromArray(value.data(), value.size())) {
+      return butil::Status(pb::error::Errno::EINTERNAL,
+                           fmt::format("Parse vector scalar data error, key: {}", Helper::StringToHex(key)));
+    }
+
+    if (!posting_set.Add(vector_id, scalar_key, scalar_value)) {
+      return butil::Status(pb::error::Errno::EINTERNAL, "Exceed memory limit");
+    }
+  }
+
+  return butil::Status::OK();
+}
+
+// Scan without the mutex, so search and apply is not blocked.
+// The iterator is created after is_building_ set, so every apply which is not seen by the scan is cached.
+void VectorScalarIndex::Build(mvcc::ReaderPtr reader, const pb::common::Range& region_range,
+                              const std::set<std::string>& speed_up_keys, int64_t version) {
+  BvarLatencyGuard bvar_guard(&g_vector_scalar_index_build_latency);
+
+  auto posting_set = std::make_unique<PostingSet>();
+  int64_t max_ts = 0;
+  auto status = ScanSpeedUpCF(reader, region_range, speed_up_keys, version, *posting_set, max_ts);
+
+  BAIDU_SCOPED_LOCK(mutex_);
+  if (version != version_.load()) {
+    DINGO_LOG(INFO) << fmt::format("[vector_scalar_index] build is cancelled, region range {}",
+                                   Helper::RangeToString(region_range));
+    return;
+  }
+
+  for (const auto& pending_apply : pending_applies_) {
+    if (!status.ok()) {
+      break;
+    }
+
+    if (pending_apply.is_delete) {
+      posting_set->Remove(pending_apply.vector_id);
+    } else if (!posting_set->Upsert(pending_apply.vector_id, speed_up_keys, pending_apply.scalar_data)) {
+      status = butil::Status(pb::error::Errno::EINTERNAL, "Exceed memory limit");
+    }
+  }
+  is_building_ = false;
+  pending_applies_.clear();
+
+  if (!status.ok()) {
+    DINGO_LOG(WARNING) << fmt::format("[vector_scalar_index] build failed, region range {} error: {}",
+                                      Helper::RangeToString(region_range), status.error_str());
+    is_exceed_memory_ = posting_set->IsExceedMemory();
+    return;
+  }
+
+  max_ts_ = std::max(max_ts_, max_ts);
+  posting_set_ = std::move(posting_set);
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_scalar_index] build finish, region range {} vector count {} posting count {} memory size {}",
+      Helper::RangeToString(region_range), posting_set_->VectorCount(), posting_set_->Postings().size(),
+      posting_set_->MemorySize());
+}
+
+butil::Status VectorScalarIndex::Search(mvcc::ReaderPtr reader, int64_t ts, const pb::common::Range& region_range,
+                                        const pb::common::ScalarSchema& scalar_schema,
+                                        const pb::common::VectorScalardata& std_vector_scalar,
+                                        std::vector<int64_t>& vector_ids, bool& is_hit) {
+  is_hit = false;
+  if (!FLAGS_enable_vector_scalar_index || std_vector_scalar.scalar_data().empty()) {
+    return butil::Status::OK();
+  }
+
+  BvarLatencyGuard bvar_guard(&g_vector_scalar_index_search_latency);
+
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  std::set<std::string> speed_up_keys;
+  for (const auto& field : scalar_schema.fields()) {
+    if (field.enable_speed_up()) {
+      speed_up_keys.insert(field.key());
+    }
+  }
+
+  if (speed_up_keys != speed_up_keys_ || start_key_ != region_range.start_key() ||
+      end_key_ != region_range.end_key()) {
+    Clear();
+    start_key_ = region_range.start_key();
+    end_key_ = region_range.end_key();
+    speed_up_keys_.swap(speed_up_keys);
+  }
+
+  if (posting_set_ == nullptr) {
+    if (!is_building_ && !is_exceed_memory_) {
+      StartBuild(reader, region_range);
+    }
+    return butil::Status::OK();
+  }
+
+  if (ts > 0 && ts < max_ts_) {
+    return butil::Status::OK();
+  }
+
+  const auto& postings = posting_set_->Postings();
+  std::vector<const std::set<int64_t>*> posting_lists;
+  posting_lists.reserve(std_vector_scalar.scalar_data_size());
+  for (const auto& [key, value] : std_vector_scalar.scalar_data()) {
+    if (speed_up_keys_.find(key) == speed_up_keys_.end()) {
+      return butil::Status::OK();
+    }
+
+    std::string posting_key;
+    if (!GenPostingKey(key, value, posting_key)) {
+      is_hit = true;
+      return butil::Status::OK();
+    }
+
+    auto it = postings.find(posting_key);
+    if (it == postings.end()) {
+      is_hit = true;
+      return butil::Status::OK();
+    }
+    posting_lists.push_back(&it->second);
+  }
+
+  is_hit = true;
+
+  // intersect from the shortest postings
+  std::sort(posting_lists.begin(), posting_lists.end(),
+            [](const std::set<int64_t>* lhs, const std::set<int64_t>* rhs) { return lhs->size() < rhs->size(); });
+
+  vector_ids.reserve(vector_ids.size() + posting_lists[0]->size());
+  for (int64_t vector_id : *posting_lists[0]) {
+    bool is_match = true;
+    for (size_t i = 1; i < posting_lists.size(); ++i) {
+      if (posting_lists[i]->count(vector_id) == 0) {
+        is_match = false;
+        break;
+      }
+    }
+    if (is_match) {
+      vector_ids.push_back(vector_id);
+    }
+  }
+
+  return butil::Status::OK();
+}
+
+}  // namespace dingodb
@@ -0,0 +1,160 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_VECTOR_SCALAR_INDEX_H_  // NOLINT
+#define DINGODB_VECTOR_SCALAR_INDEX_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bthread/types.h"
+#include "butil/status.h"
+#include "proto/common.pb.h"
+
+namespace dingodb {
+
+namespace mvcc {
+class Reader;
+using ReaderPtr = std::shared_ptr<Reader>;
+}  // namespace mvcc
+
+// Secondary index of the scalar speed up keys for one region, every (key, value) has a sorted vector id postings.
+// It answer scalar pre filter search by postings intersection instead of scan the vector scalar cf.
+// Only in memory, built from vector_scalar_key_speed_up cf in background at first search, and maintained by vector
+// add/delete apply. The apply during build is cached and replayed after build, Upsert/Delete are idempotent.
+// The memory of all scalar index is accounted and limited, the region exceed the limit fallback scan.
+class VectorScalarIndex : public std::enable_shared_from_this<VectorScalarIndex> {
+ public:
+  VectorScalarIndex();
+  ~VectorScalarIndex();
+
+  VectorScalarIndex(const VectorScalarIndex&) = delete;
+  VectorScalarIndex& operator=(const VectorScalarIndex&) = delete;
+
+  static std::shared_ptr<VectorScalarIndex> New() { return std::make_shared<VectorScalarIndex>(); }
+
+  // apply vector add/delete, ts is the write ts.
+  void Upsert(int64_t vector_id, const pb::common::VectorScalardata& scalar_data, int64_t ts);
+  void Delete(const std::vector<int64_t>& vector_ids, int64_t ts);
+
+  // drop all postings and cancel the running build, rebuild at next search.
+  // used when speed up cf is written without vector add/delete apply, e.g. batch add, raw write, restore, snapshot.
+  void Reset();
+
+  bool IsBuilt();
+  bool IsBuilding();
+  int64_t PostingCount();
+  int64_t VectorCount();
+  int64_t MemorySize();
+
+  // all scalar index memory size of the store.
+  static int64_t TotalMemorySize();
+
+  // get sorted vector ids which scalar value equal all of std_vector_scalar.
+  // is_hit is false and caller need fallback scan when:
+  //   1. index is not built, start build in background when region range/scalar schema changed or not built.
+  //   2. ts is older than the latest write of index, the index only has the latest version.
+  //   3. std_vector_scalar has key which is not speed up key.
+  butil::Status Search(mvcc::ReaderPtr reader, int64_t ts, const pb::common::Range& region_range,
+                       const pb::common::ScalarSchema& scalar_schema,
+                       const pb::common::VectorScalardata& std_vector_scalar, std::vector<int64_t>& vector_ids,
+                       bool& is_hit);
+
+  // posting key of (key, value), same value which Helper::IsEqualVectorScalarValue is true has same posting key.
+  // return false when value never equal to any value, e.g. NaN or invalid field type.
+  static bool GenPostingKey(const std::string& key, const pb::common::ScalarValue& value, std::string& posting_key);
+
+ private:
+  using PostingMap = std::unordered_map<std::string, std::set<int64_t>>;
+
+  // postings and the reverse map of vector id, the memory is accounted to the store total memory size.
+  class PostingSet {
+   public:
+    PostingSet() = default;
+    ~PostingSet();
+
+    PostingSet(const PostingSet&) = delete;
+    PostingSet& operator=(const PostingSet&) = delete;
+
+    // return false when exceed memory limit.
+    bool Add(int64_t vector_id, const std::string& key, const pb::common::ScalarValue& value);
+    bool Upsert(int64_t vector_id, const std::set<std::string>& speed_up_keys,
+                const pb::common::VectorScalardata& scalar_data);
+    void Remove(int64_t vector_id);
+
+    const PostingMap& Postings() const { return postings_; }
+    int64_t VectorCount() const { return vector_postings_.size(); }
+    int64_t MemorySize() const { return memory_size_; }
+    bool IsExceedMemory() const { return is_exceed_memory_; }
+
+   private:
+    bool AcquireMemory(int64_t size);
+    void ReleaseMemory(int64_t size);
+
+    // posting key -> sorted vector ids
+    PostingMap postings_;
+    // vector id -> postings which contain it, the element address of unordered_map is stable.
+    std::unordered_map<int64_t, std::vector<PostingMap::value_type*>> vector_postings_;
+    int64_t memory_size_{0};
+    bool is_exceed_memory_{false};
+  };
+  using PostingSetPtr = std::unique_ptr<PostingSet>;
+
+  // vector add/delete applied during build, replay after build.
+  struct PendingApply {
+    int64_t vector_id;
+    bool is_delete;
+    pb::common::VectorScalardata scalar_data;
+  };
+
+  void StartBuild(mvcc::ReaderPtr reader, const pb::common::Range& region_range);
+  void Build(mvcc::ReaderPtr reader, const pb::common::Range& region_range, const std::set<std::string>& speed_up_keys,
+             int64_t version);
+  butil::Status ScanSpeedUpCF(mvcc::ReaderPtr reader, const pb::common::Range& region_range,
+                              const std::set<std::string>& speed_up_keys, int64_t version, PostingSet& posting_set,
+                              int64_t& max_ts);
+  void CancelBuild();
+  void Clear();
+
+  bthread_mutex_t mutex_;
+
+  // increase at reset, the running build of old version is discarded.
+  std::atomic<int64_t> version_{0};
+  bool is_building_{false};
+  // exceed memory limit, not build again until reset or region range/scalar schema changed.
+  bool is_exceed_memory_{false};
+
+  // region range and speed up keys of built or building index
+  std::string start_key_;
+  std::string end_key_;
+  std::set<std::string> speed_up_keys_;
+
+  // max ts of the writes in index, a deleted vector before build is not counted.
+  int64_t max_ts_{0};
+
+  // nullptr when not built
+  PostingSetPtr posting_set_;
+  std::vector<PendingApply> pending_applies_;
+};
+
+using VectorScalarIndexPtr = std::shared_ptr<VectorScalarIndex>;
+
+}  // namespace dingodb
+
+#endif  // DINGODB_VECTOR_SCALAR_INDEX_H_  // NOLINT
@@ -15,8 +15,11 @@
 #include <gtest/gtest.h>
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "butil/status.h"
@@ -2784,6 +2787,72 @@ TEST_F(CoprocessorAggregationManagerTest, Execute) {
   }
 }
 
+// rows of same group in run hit the last group cache, and groups iterate in order of group by key.
+TEST_F(CoprocessorAggregationManagerTest, ExecuteGroupRun) {
+  google::protobuf::RepeatedPtrField<pb::common::Schema> pb_schemas;
+  for (int i = 0; i < 2; i++) {
+    pb::common::Schema schema;
+    schema.set_type(::dingodb::pb::common::Schema_Type::Schema_Type_LONG);
+    schema.set_is_key(false);
+    schema.set_is_nullable(true);
+    schema.set_index(i);
+    pb_schemas.Add(std::move(schema));
+  }
+
+  auto result_serial_schemas = std::make_shared<std::vector<std::shared_ptr<BaseSchema>>>();
+  butil::Status ok = Utils::TransToSerialSchema(pb_schemas, &result_serial_schemas);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  auto group_by_operator_serial_schemas = std::make_shared<std::vector<std::shared_ptr<BaseSchema>>>();
+  ok = Utils::TransToSerialSchema(pb_schemas, &group_by_operator_serial_schemas);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  ::google::protobuf::RepeatedPtrField<pb::store::AggregationOperator> aggregation_operators;
+  {
+    pb::store::AggregationOperator aggregation_operator;
+    aggregation_operator.set_index_of_column(0);
+    aggregation_operator.set_oper(::dingodb::pb::store::AggregationType::SUM);
+    aggregation_operators.Add(std::move(aggregation_operator));
+  }
+  {
+    pb::store::AggregationOperator aggregation_operator;
+    aggregation_operator.set_index_of_column(1);
+    aggregation_operator.set_oper(::dingodb::pb::store::AggregationType::COUNT);
+    aggregation_operators.Add(std::move(aggregation_operator));
+  }
+
+  auto manager = std::make_shared<AggregationManager>();
+  ok = manager->Open(group_by_operator_serial_schemas, aggregation_operators, result_serial_schemas);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  std::map<std::string, std::pair<int64_t, int64_t>> expect_results;
+  for (int64_t i = 0; i < 1000; i++) {
+    // groups in run, and some value is null
+    std::string group_by_key = "key" + std::to_string((i / 3) % 7);
+    std::vector<std::any> group_by_operator_record;
+    group_by_operator_record.emplace_back(std::optional<int64_t>(i));
+    group_by_operator_record.emplace_back(i % 5 == 0 ? std::optional<int64_t>(std::nullopt)
+                                                     : std::optional<int64_t>(i));
+
+    ok = manager->Execute(group_by_key, group_by_operator_record);
+    EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+    auto& [sum, count] = expect_results[group_by_key];
+    sum += i;
+    count += (i % 5 == 0 ? 0 : 1);
+  }
+
+  auto iter = manager->CreateIterator();
+  auto expect_iter = expect_results.begin();
+  for (; iter->HasNext() && expect_iter != expect_results.end(); iter->Next(), ++expect_iter) {
+    EXPECT_EQ(expect_iter->first, iter->GetKey());
+    EXPECT_EQ(expect_iter->second.first, std::any_cast<std::optional<int64_t>>((*iter->GetValue())[0]).value());
+    EXPECT_EQ(expect_iter->second.second, std::any_cast<std::optional<int64_t>>((*iter->GetValue())[1]).value());
+  }
+  EXPECT_EQ(7, expect_results.size());
+  EXPECT_FALSE(iter->HasNext());
+  EXPECT_TRUE(expect_iter == expect_results.end());
+}
+
 TEST_F(CoprocessorAggregationManagerTest, CreateIterator) {
   std::shared_ptr<AggregationIterator> iter = aggregation_manager->CreateIterator();
   while (iter->HasNext()) {
@@ -22,6 +22,12 @@
 #include "butil/status.h"
 #include "document/codec.h"
 #include "document/document_index_factory.h"
+#include "gflags/gflags.h"
+
+namespace dingodb {
+DECLARE_int64(document_index_group_commit_interval_ms);
+DECLARE_int64(document_index_group_commit_doc_count);
+}  // namespace dingodb
 
 static size_t log_level = 1;
 
@@ -519,4 +525,77 @@ TEST(DingoDocumentIndexTest, test_upsert) {
     EXPECT_EQ(ret.ok(), true);
     EXPECT_EQ(results.size(), 0);
   }
-}
\ No newline at end of file
+}
+
+TEST(DingoDocumentIndexTest, test_group_commit) {
+  std::filesystem::remove_all(kDocumentIndexTestIndexPath);
+  std::string index_path{kDocumentIndexTestIndexPath};
+
+  std::string error_message;
+  std::string json_parameter;
+  std::map<std::string, dingodb::TokenizerType> column_tokenizer_parameter;
+
+  dingodb::pb::common::DocumentIndexParameter document_index_parameter;
+  auto* text_field = document_index_parameter.mutable_scalar_schema()->add_fields();
+  text_field->set_key("text");
+  text_field->set_field_type(dingodb::pb::common::ScalarFieldType::STRING);
+  column_tokenizer_parameter["text"] = dingodb::TokenizerType::kTokenizerTypeText;
+
+  ASSERT_TRUE(dingodb::DocumentCodec::GenDefaultTokenizerJsonParameter(column_tokenizer_parameter, json_parameter,
+                                                                       error_message));
+  document_index_parameter.set_json_parameter(json_parameter);
+
+  dingodb::pb::common::RegionEpoch region_epoch;
+  dingodb::pb::common::Range range;
+  auto document_index =
+      dingodb::DocumentIndexFactory::CreateIndex(1, index_path, document_index_parameter, region_epoch, range, true);
+  ASSERT_TRUE(document_index != nullptr);
+
+  int64_t old_interval_ms = dingodb::FLAGS_document_index_group_commit_interval_ms;
+  int64_t old_doc_count = dingodb::FLAGS_document_index_group_commit_doc_count;
+  dingodb::FLAGS_document_index_group_commit_interval_ms = 3600 * 1000;
+  dingodb::FLAGS_document_index_group_commit_doc_count = 2;
+
+  auto search_count = [&](const std::string& query) -> size_t {
+    std::vector<dingodb::pb::common::DocumentWithScore> results;
+    auto ret = document_index->Search(10, query, false, 0, INT64_MAX, false, false, {}, {}, results);
+    EXPECT_EQ(ret.ok(), true);
+    return results.size();
+  };
+
+  auto add_document = [&](int64_t id, const std::string& text) {
+    std::vector<dingodb::pb::common::DocumentWithId> document_with_ids(1);
+    document_with_ids[0].set_id(id);
+    dingodb::pb::common::DocumentValue document_value;
+    document_value.set_field_type(dingodb::pb::common::ScalarFieldType::STRING);
+    document_value.mutable_field_value()->set_string_data(text);
+    document_with_ids[0].mutable_document()->mutable_document_data()->insert({"text", document_value});
+
+    auto ret = document_index->Add(document_with_ids, true, true);
+    EXPECT_EQ(ret.ok(), true);
+  };
+
+  // first add commit at once, last commit time is 0
+  add_document(1, "Ancient empires rise and fall.");
+  document_index->SetWriteLogId(10);
+  EXPECT_EQ(10, document_index->CommitLogId());
+  EXPECT_EQ(1, search_count("empires"));
+
+  // pending, not visible and not durable
+  add_document(2, "Explorers discover uncharted territories.");
+  document_index->SetWriteLogId(11);
+  EXPECT_EQ(10, document_index->CommitLogId());
+  EXPECT_EQ(0, search_count("discover"));
+
+  // reach doc count, commit the writes before log 12
+  add_document(3, "Explorers discover new world.");
+  EXPECT_EQ(11, document_index->CommitLogId());
+  document_index->SetWriteLogId(12);
+  EXPECT_EQ(12, document_index->CommitLogId());
+
+  ASSERT_TRUE(document_index->Flush(true).ok());
+  EXPECT_EQ(2, search_count("discover"));
+
+  dingodb::FLAGS_document_index_group_commit_interval_ms = old_interval_ms;
+  dingodb::FLAGS_document_index_group_commit_doc_count = old_doc_count;
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/helper.h"
+#include "config/yaml_config.h"
+#include "engine/rocks_raw_engine.h"
+#include "fmt/core.h"
+#include "metrics/store_bvar_metrics.h"
+
+namespace dingodb {
+
+static const std::string kDefaultCf = "default";
+static const std::string kReservedCf = "meta";
+static const std::vector<std::string> kAllCFs = {kDefaultCf, kReservedCf};
+
+static const std::string kRootPath = "./unit_test_block_cache";
+static const std::string kStorePath = kRootPath + "/db";
+
+static const int kKeyNum = 1000;
+
+static std::string GenYamlConfigContent() {
+  return "cluster:\n"
+         "  name: dingodb\n"
+         "  instance_id: 12345\n"
+         "server:\n"
+         "  host: 127.0.0.1\n"
+         "  port: 23000\n"
+         "log:\n"
+         "  path: " +
+         kRootPath +
+         "/log\n"
+         "store:\n"
+         "  path: " +
+         kStorePath +
+         "\n"
+         "  meta:\n"
+         "    block_cache_reserved: \"8388608\"\n";
+}
+
+class RocksBlockCacheTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Helper::CreateDirectories(kStorePath);
+
+    auto config = std::make_shared<YamlConfig>();
+    ASSERT_EQ(0, config->Load(GenYamlConfigContent()));
+
+    engine = std::make_shared<RocksRawEngine>();
+    ASSERT_TRUE(engine->Init(config, kAllCFs));
+
+    auto writer = engine->Writer();
+    for (const auto& cf_name : kAllCFs) {
+      std::vector<pb::common::KeyValue> kvs;
+      for (int i = 0; i < kKeyNum; ++i) {
+        pb::common::KeyValue kv;
+        kv.set_key(fmt::format("key_{:08}", i));
+        kv.set_value(fmt::format("value_{}", i));
+        kvs.push_back(kv);
+      }
+      ASSERT_TRUE(writer->KvBatchPutAndDelete(cf_name, kvs, {}).ok());
+      engine->Flush(cf_name);
+    }
+  }
+
+  static void TearDownTestSuite() {
+    engine->Close();
+    engine->Destroy();
+    engine = nullptr;
+    Helper::RemoveAllFileOrDirectory(kRootPath);
+  }
+
+  static int64_t HitCount(const std::string& cf_name) {
+    return StoreBvarMetrics::GetInstance().GetBlockCacheHitCounter(cf_name)->get_value();
+  }
+
+  static int64_t MissCount(const std::string& cf_name) {
+    return StoreBvarMetrics::GetInstance().GetBlockCacheMissCounter(cf_name)->get_value();
+  }
+
+  static std::shared_ptr<RocksRawEngine> engine;
+};
+
+std::shared_ptr<RocksRawEngine> RocksBlockCacheTest::engine = nullptr;
+
+TEST_F(RocksBlockCacheTest, HitMissCountPerCf) {
+  auto reader = engine->Reader();
+
+  for (const auto& cf_name : kAllCFs) {
+    int64_t hit_count = HitCount(cf_name);
+    int64_t miss_count = MissCount(cf_name);
+
+    // read twice, the second read hit the block cache
+    for (int round = 0; round < 2; ++round) {
+      for (int i = 0; i < kKeyNum; i += 10) {
+        std::string value;
+        ASSERT_TRUE(reader->KvGet(cf_name, fmt::format("key_{:08}", i), value).ok());
+        EXPECT_EQ(fmt::format("value_{}", i), value);
+      }
+    }
+
+    EXPECT_GT(MissCount(cf_name), miss_count) << cf_name;
+    EXPECT_GT(HitCount(cf_name), hit_count) << cf_name;
+  }
+}
+
+}  // namespace dingodb
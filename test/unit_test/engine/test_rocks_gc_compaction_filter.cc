@@ -0,0 +1,274 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/constant.h"
+#include "common/helper.h"
+#include "config/yaml_config.h"
+#include "engine/rocks_gc_compaction_filter.h"
+#include "engine/rocks_raw_engine.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "mvcc/codec.h"
+#include "proto/store.pb.h"
+
+namespace dingodb {
+
+DECLARE_bool(enable_mvcc_gc_compaction_filter);
+
+static const std::vector<std::string> kAllCFs = {Constant::kStoreDataCF, Constant::kTxnDataCF,
+                                                 Constant::kTxnWriteCF, Constant::kTxnLockCF};
+
+const std::string kRootPath = "./unit_test";
+const std::string kLogPath = kRootPath + "/log";
+const std::string kStorePath = kRootPath + "/gc_compaction_filter_db";
+
+const std::string kYamlConfigContent =
+    "cluster:\n"
+    "  name: dingodb\n"
+    "  instance_id: 12345\n"
+    "  coordinators: 127.0.0.1:19190,127.0.0.1:19191,127.0.0.1:19192\n"
+    "  keyring: TO_BE_CONTINUED\n"
+    "server:\n"
+    "  host: 127.0.0.1\n"
+    "  port: 23000\n"
+    "log:\n"
+    "  path: " +
+    kLogPath +
+    "\n"
+    "store:\n"
+    "  path: " +
+    kStorePath + "\n";
+
+class RocksGcCompactionFilterTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    // the filter is off by default
+    EXPECT_FALSE(FLAGS_enable_mvcc_gc_compaction_filter);
+    FLAGS_enable_mvcc_gc_compaction_filter = true;
+
+    Helper::CreateDirectories(kStorePath);
+
+    config = std::make_shared<YamlConfig>();
+    ASSERT_EQ(0, config->Load(kYamlConfigContent));
+
+    engine = std::make_shared<RocksRawEngine>();
+    ASSERT_TRUE(engine != nullptr);
+    ASSERT_TRUE(engine->Init(config, kAllCFs));
+  }
+
+  static void TearDownTestSuite() {
+    rocks::MvccGcCompactionFilterFactory::SetSafePointTs(0, {});
+    FLAGS_enable_mvcc_gc_compaction_filter = false;
+
+    engine->Close();
+    engine->Destroy();
+    Helper::RemoveAllFileOrDirectory(kRootPath);
+  }
+
+  static std::vector<int64_t> GetVersions(const std::string& cf_name, const std::string& plain_key) {
+    std::string encode_key = mvcc::Codec::EncodeBytes(plain_key);
+
+    IteratorOptions options;
+    options.upper_bound = Helper::PrefixNext(encode_key);
+    auto iter = engine->Reader()->NewIterator(cf_name, options);
+
+    std::vector<int64_t> versions;
+    for (iter->Seek(encode_key); iter->Valid(); iter->Next()) {
+      versions.push_back(mvcc::Codec::TruncateKeyForTs(iter->Key()));
+    }
+
+    return versions;
+  }
+
+  static std::shared_ptr<RocksRawEngine> engine;
+  static std::shared_ptr<Config> config;
+};
+
+std::shared_ptr<RocksRawEngine> RocksGcCompactionFilterTest::engine = nullptr;
+std::shared_ptr<Config> RocksGcCompactionFilterTest::config = nullptr;
+
+TEST_F(RocksGcCompactionFilterTest, NonTxn) {
+  auto writer = engine->Writer();
+
+  std::vector<pb::common::KeyValue> kvs;
+  pb::common::KeyValue kv;
+  kv.set_key("gc_key_a");
+  for (int64_t ts : {100, 200, 300}) {
+    kv.set_value(fmt::format("value_a_{}", ts));
+    kvs.push_back(mvcc::Codec::EncodeKeyValueWithPut(ts, kv));
+  }
+  kvs.push_back(mvcc::Codec::EncodeKeyValueWithDelete(400, kv));
+
+  kv.set_key("gc_key_b");
+  for (int64_t ts : {100, 200}) {
+    kv.set_value(fmt::format("value_b_{}", ts));
+    kvs.push_back(mvcc::Codec::EncodeKeyValueWithPut(ts, kv));
+  }
+
+  // delete at 150, newest version <= safe point is a delete
+  kv.set_key("gc_key_c");
+  kv.set_value("value_c_100");
+  kvs.push_back(mvcc::Codec::EncodeKeyValueWithPut(100, kv));
+  kvs.push_back(mvcc::Codec::EncodeKeyValueWithDelete(150, kv));
+
+  ASSERT_TRUE(writer->KvBatchPutAndDelete(Constant::kStoreDataCF, kvs, {}).ok());
+  engine->Flush(Constant::kStoreDataCF);
+
+  // disable, nothing is dropped
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(0, {});
+  ASSERT_TRUE(engine->Compact(Constant::kStoreDataCF).ok());
+  EXPECT_EQ(std::vector<int64_t>({400, 300, 200, 100}), GetVersions(Constant::kStoreDataCF, "gc_key_a"));
+
+  // flag off, nothing is dropped
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(250, {});
+  FLAGS_enable_mvcc_gc_compaction_filter = false;
+  ASSERT_TRUE(engine->Compact(Constant::kStoreDataCF).ok());
+  EXPECT_EQ(std::vector<int64_t>({400, 300, 200, 100}), GetVersions(Constant::kStoreDataCF, "gc_key_a"));
+  FLAGS_enable_mvcc_gc_compaction_filter = true;
+
+  ASSERT_TRUE(engine->Compact(Constant::kStoreDataCF).ok());
+
+  EXPECT_EQ(std::vector<int64_t>({400, 300, 200}), GetVersions(Constant::kStoreDataCF, "gc_key_a"));
+  EXPECT_EQ(std::vector<int64_t>({200}), GetVersions(Constant::kStoreDataCF, "gc_key_b"));
+  EXPECT_EQ(std::vector<int64_t>({150}), GetVersions(Constant::kStoreDataCF, "gc_key_c"));
+
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(0, {});
+}
+
+TEST_F(RocksGcCompactionFilterTest, Txn) {
+  auto writer = engine->Writer();
+
+  auto gen_write = [](int64_t commit_ts, int64_t start_ts, pb::store::Op op) {
+    pb::store::WriteInfo write_info;
+    write_info.set_start_ts(start_ts);
+    write_info.set_op(op);
+
+    pb::common::KeyValue kv;
+    kv.set_key(mvcc::Codec::EncodeKey(std::string("gc_txn_key"), commit_ts));
+    kv.set_value(write_info.SerializeAsString());
+    return kv;
+  };
+
+  std::vector<pb::common::KeyValue> write_kvs;
+  write_kvs.push_back(gen_write(110, 100, pb::store::Op::Put));
+  write_kvs.push_back(gen_write(150, 150, pb::store::Op::Rollback));
+  write_kvs.push_back(gen_write(210, 200, pb::store::Op::Put));
+  write_kvs.push_back(gen_write(310, 300, pb::store::Op::Put));
+
+  std::vector<pb::common::KeyValue> data_kvs;
+  for (int64_t start_ts : {100, 200, 300}) {
+    pb::common::KeyValue kv;
+    kv.set_key(mvcc::Codec::EncodeKey(std::string("gc_txn_key"), start_ts));
+    kv.set_value(fmt::format("value_{}", start_ts));
+    data_kvs.push_back(kv);
+  }
+
+  ASSERT_TRUE(writer->KvBatchPutAndDelete(Constant::kTxnWriteCF, write_kvs, {}).ok());
+  ASSERT_TRUE(writer->KvBatchPutAndDelete(Constant::kTxnDataCF, data_kvs, {}).ok());
+  engine->Flush(Constant::kTxnWriteCF);
+  engine->Flush(Constant::kTxnDataCF);
+
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(250, {});
+
+  // data cf depend on the write cf
+  ASSERT_TRUE(engine->Compact(Constant::kTxnDataCF).ok());
+  EXPECT_EQ(std::vector<int64_t>({300, 200}), GetVersions(Constant::kTxnDataCF, "gc_txn_key"));
+
+  ASSERT_TRUE(engine->Compact(Constant::kTxnWriteCF).ok());
+  EXPECT_EQ(std::vector<int64_t>({310, 210}), GetVersions(Constant::kTxnWriteCF, "gc_txn_key"));
+
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(0, {});
+}
+
+// pessimistic txn commit order not follow start order, data of the write not gc must be keep.
+TEST_F(RocksGcCompactionFilterTest, TxnCommitOutOfOrder) {
+  auto writer = engine->Writer();
+  const std::string plain_key = "gc_txn_out_of_order_key";
+
+  auto gen_write = [&](int64_t commit_ts, int64_t start_ts, pb::store::Op op) {
+    pb::store::WriteInfo write_info;
+    write_info.set_start_ts(start_ts);
+    write_info.set_op(op);
+
+    pb::common::KeyValue kv;
+    kv.set_key(mvcc::Codec::EncodeKey(plain_key, commit_ts));
+    kv.set_value(write_info.SerializeAsString());
+    return kv;
+  };
+
+  // txn C: start 5 commit 8, gc by txn B
+  // txn A: start 10 commit 100 > safe point, keep
+  // txn B: start 20 commit 30 <= safe point, the newest write <= safe point, keep
+  // txn D: start 40 locked, keep
+  // start 1: no write, the write is gc already, drop
+  std::vector<pb::common::KeyValue> write_kvs;
+  write_kvs.push_back(gen_write(8, 5, pb::store::Op::Put));
+  write_kvs.push_back(gen_write(30, 20, pb::store::Op::Put));
+  write_kvs.push_back(gen_write(100, 10, pb::store::Op::Put));
+
+  std::vector<pb::common::KeyValue> data_kvs;
+  for (int64_t start_ts : {1, 5, 10, 20, 40}) {
+    pb::common::KeyValue kv;
+    kv.set_key(mvcc::Codec::EncodeKey(plain_key, start_ts));
+    kv.set_value(fmt::format("value_{}", start_ts));
+    data_kvs.push_back(kv);
+  }
+
+  pb::store::LockInfo lock_info;
+  lock_info.set_key(plain_key);
+  lock_info.set_lock_ts(40);
+  lock_info.set_lock_type(pb::store::Op::Put);
+  pb::common::KeyValue lock_kv;
+  lock_kv.set_key(mvcc::Codec::EncodeKey(plain_key, Constant::kLockVer));
+  lock_kv.set_value(lock_info.SerializeAsString());
+
+  ASSERT_TRUE(writer->KvBatchPutAndDelete(Constant::kTxnWriteCF, write_kvs, {}).ok());
+  ASSERT_TRUE(writer->KvBatchPutAndDelete(Constant::kTxnDataCF, data_kvs, {}).ok());
+  ASSERT_TRUE(writer->KvPut(Constant::kTxnLockCF, lock_kv).ok());
+  engine->Flush(Constant::kTxnDataCF);
+
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(50, {});
+  ASSERT_TRUE(engine->Compact(Constant::kTxnDataCF).ok());
+  EXPECT_EQ(std::vector<int64_t>({40, 20, 10}), GetVersions(Constant::kTxnDataCF, plain_key));
+
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(0, {});
+}
+
+TEST_F(RocksGcCompactionFilterTest, CheckTenant) {
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(100, {1, 2});
+  EXPECT_EQ(100, rocks::MvccGcCompactionFilterFactory::GetSafePointTs());
+
+  // covered tenant
+  rocks::MvccGcCompactionFilterFactory::CheckTenant(1);
+  EXPECT_EQ(100, rocks::MvccGcCompactionFilterFactory::GetSafePointTs());
+
+  // region of new tenant arrive, disable until the safe point ts include it
+  rocks::MvccGcCompactionFilterFactory::CheckTenant(3);
+  EXPECT_EQ(0, rocks::MvccGcCompactionFilterFactory::GetSafePointTs());
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(120, {1, 2});
+  EXPECT_EQ(0, rocks::MvccGcCompactionFilterFactory::GetSafePointTs());
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(120, {1, 2, 3});
+  EXPECT_EQ(120, rocks::MvccGcCompactionFilterFactory::GetSafePointTs());
+
+  rocks::MvccGcCompactionFilterFactory::SetSafePointTs(0, {});
+}
+
+}  // namespace dingodb
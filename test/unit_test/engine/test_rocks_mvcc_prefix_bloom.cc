@@ -0,0 +1,203 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/helper.h"
+#include "config/yaml_config.h"
+#include "engine/rocks_raw_engine.h"
+#include "fmt/core.h"
+#include "mvcc/codec.h"
+#include "mvcc/reader.h"
+#include "rocksdb/statistics.h"
+
+namespace dingodb {
+
+static const std::string kDefaultCf = "default";
+static const std::vector<std::string> kAllCFs = {kDefaultCf};
+
+const std::string kRootPath = "./unit_test";
+const std::string kLogPath = kRootPath + "/log";
+
+const int kKeyNum = 200000;
+const int kFlushInterval = 20000;
+const int kMissReadNum = 10000;
+
+static std::string GenYamlConfigContent(const std::string& store_path, bool enable_mvcc_prefix_bloom_filter) {
+  return "cluster:\n"
+         "  name: dingodb\n"
+         "  instance_id: 12345\n"
+         "  coordinators: 127.0.0.1:19190,127.0.0.1:19191,127.0.0.1:19192\n"
+         "  keyring: TO_BE_CONTINUED\n"
+         "server:\n"
+         "  host: 127.0.0.1\n"
+         "  port: 23000\n"
+         "log:\n"
+         "  path: " +
+         kLogPath +
+         "\n"
+         "store:\n"
+         "  path: " +
+         store_path +
+         "\n"
+         "  default:\n"
+         "    mvcc_prefix_bloom_filter: " +
+         (enable_mvcc_prefix_bloom_filter ? "\"true\"" : "\"false\"") + "\n";
+}
+
+static std::string GenPlainKey(int i) { return fmt::format("tprefix_bloom_{:08}", i); }
+
+class RocksMvccPrefixBloomTest : public testing::Test {
+ protected:
+  static std::shared_ptr<RocksRawEngine> NewEngine(const std::string& store_path, bool enable) {
+    Helper::CreateDirectories(store_path);
+
+    auto config = std::make_shared<YamlConfig>();
+    if (config->Load(GenYamlConfigContent(store_path, enable)) != 0) {
+      return nullptr;
+    }
+
+    auto engine = std::make_shared<RocksRawEngine>();
+    if (!engine->Init(config, kAllCFs)) {
+      return nullptr;
+    }
+
+    return engine;
+  }
+
+  static void SetUpTestSuite() {
+    bloom_engine = NewEngine(kRootPath + "/prefix_bloom_db", true);
+    ASSERT_TRUE(bloom_engine != nullptr);
+    no_bloom_engine = NewEngine(kRootPath + "/no_prefix_bloom_db", false);
+    ASSERT_TRUE(no_bloom_engine != nullptr);
+
+    // only write even key, odd key is used for miss read
+    for (auto& engine : {bloom_engine, no_bloom_engine}) {
+      auto writer = engine->Writer();
+      std::vector<pb::common::KeyValue> kvs;
+      for (int i = 0; i < kKeyNum; i += 2) {
+        pb::common::KeyValue kv;
+        kv.set_key(GenPlainKey(i));
+        kv.set_value(fmt::format("value_{}", i));
+        kvs.push_back(mvcc::Codec::EncodeKeyValueWithPut(100000 + i, kv));
+
+        if (kvs.size() == kFlushInterval / 2) {
+          ASSERT_TRUE(writer->KvBatchPutAndDelete(kDefaultCf, kvs, {}).ok());
+          engine->Flush(kDefaultCf);
+          kvs.clear();
+        }
+      }
+      if (!kvs.empty()) {
+        ASSERT_TRUE(writer->KvBatchPutAndDelete(kDefaultCf, kvs, {}).ok());
+        engine->Flush(kDefaultCf);
+      }
+    }
+  }
+
+  static void TearDownTestSuite() {
+    bloom_engine->Close();
+    bloom_engine->Destroy();
+    no_bloom_engine->Close();
+    no_bloom_engine->Destroy();
+    Helper::RemoveAllFileOrDirectory(kRootPath);
+  }
+
+  static std::shared_ptr<RocksRawEngine> bloom_engine;
+  static std::shared_ptr<RocksRawEngine> no_bloom_engine;
+};
+
+std::shared_ptr<RocksRawEngine> RocksMvccPrefixBloomTest::bloom_engine = nullptr;
+std::shared_ptr<RocksRawEngine> RocksMvccPrefixBloomTest::no_bloom_engine = nullptr;
+
+TEST_F(RocksMvccPrefixBloomTest, Transform) {
+  rocks::MvccUserKeyTransform transform;
+
+  std::string encode_key = mvcc::Codec::EncodeBytes("hello world");
+  std::string encode_key_with_ts = mvcc::Codec::EncodeKey(std::string("hello world"), 100);
+
+  ASSERT_TRUE(transform.InDomain(encode_key));
+  ASSERT_TRUE(transform.InDomain(encode_key_with_ts));
+  EXPECT_EQ(encode_key, transform.Transform(encode_key).ToString());
+  EXPECT_EQ(encode_key, transform.Transform(encode_key_with_ts).ToString());
+
+  // versions of the same user key share one prefix
+  EXPECT_EQ(transform.Transform(mvcc::Codec::EncodeKey(std::string("hello"), 1)).ToString(),
+            transform.Transform(mvcc::Codec::EncodeKey(std::string("hello"), INT64_MAX)).ToString());
+
+  // 8 bytes user key has a tail pad group
+  std::string encode_key_8 = mvcc::Codec::EncodeKey(std::string("12345678"), 100);
+  ASSERT_TRUE(transform.InDomain(encode_key_8));
+  EXPECT_EQ(mvcc::Codec::EncodeBytes("12345678"), transform.Transform(encode_key_8).ToString());
+
+  // not encode key
+  EXPECT_FALSE(transform.InDomain(std::string("hello")));
+  EXPECT_FALSE(transform.InDomain(std::string("")));
+  EXPECT_FALSE(transform.InDomain(std::string(9, '\xff')));
+}
+
+TEST_F(RocksMvccPrefixBloomTest, PointRead) {
+  auto bloom_reader = mvcc::KvReader::New(bloom_engine->Reader());
+  auto no_bloom_reader = mvcc::KvReader::New(no_bloom_engine->Reader());
+
+  for (int i = 0; i < kKeyNum; i += 997) {
+    std::string plain_key = GenPlainKey(i);
+    std::string bloom_value;
+    std::string no_bloom_value;
+    auto bloom_status = bloom_reader->KvGet(kDefaultCf, 0, plain_key, bloom_value);
+    auto no_bloom_status = no_bloom_reader->KvGet(kDefaultCf, 0, plain_key, no_bloom_value);
+
+    ASSERT_EQ(i % 2 == 0, bloom_status.ok()) << plain_key;
+    ASSERT_EQ(no_bloom_status.error_code(), bloom_status.error_code()) << plain_key;
+    EXPECT_EQ(no_bloom_value, bloom_value);
+  }
+
+  // read with ts before the version
+  std::string value;
+  EXPECT_EQ(pb::error::EKEY_NOT_FOUND,
+            bloom_reader->KvGet(kDefaultCf, 100000 + 9, GenPlainKey(10), value).error_code());
+  EXPECT_TRUE(bloom_reader->KvGet(kDefaultCf, 100000 + 10, GenPlainKey(10), value).ok());
+  EXPECT_EQ("value_10", value);
+
+  // scan cross many user keys is not affected by prefix bloom filter
+  std::vector<pb::common::KeyValue> bloom_kvs;
+  std::vector<pb::common::KeyValue> no_bloom_kvs;
+  ASSERT_TRUE(bloom_reader->KvScan(kDefaultCf, 0, GenPlainKey(100), GenPlainKey(300), bloom_kvs).ok());
+  ASSERT_TRUE(no_bloom_reader->KvScan(kDefaultCf, 0, GenPlainKey(100), GenPlainKey(300), no_bloom_kvs).ok());
+  ASSERT_EQ(100, bloom_kvs.size());
+  ASSERT_EQ(no_bloom_kvs.size(), bloom_kvs.size());
+}
+
+// Miss point read, the mvcc prefix bloom filter is checked and skip sst which not contain the user key.
+TEST_F(RocksMvccPrefixBloomTest, MissPointRead) {
+  auto reader = mvcc::KvReader::New(bloom_engine->Reader());
+
+  uint64_t prefix_checked = bloom_engine->GetTickerCount(rocksdb::BLOOM_FILTER_PREFIX_CHECKED);
+  uint64_t prefix_useful = bloom_engine->GetTickerCount(rocksdb::BLOOM_FILTER_PREFIX_USEFUL);
+
+  for (int i = 0; i < kMissReadNum; ++i) {
+    std::string value;
+    auto status = reader->KvGet(kDefaultCf, 0, GenPlainKey((i * 2 + 1) % kKeyNum), value);
+    ASSERT_EQ(pb::error::EKEY_NOT_FOUND, status.error_code());
+  }
+
+  EXPECT_GT(bloom_engine->GetTickerCount(rocksdb::BLOOM_FILTER_PREFIX_CHECKED), prefix_checked);
+  EXPECT_GT(bloom_engine->GetTickerCount(rocksdb::BLOOM_FILTER_PREFIX_USEFUL), prefix_useful);
+}
+
+}  // namespace dingodb
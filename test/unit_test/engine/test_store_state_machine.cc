@@ -0,0 +1,327 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "braft/raft.h"
+#include "brpc/server.h"
+#include "bthread/bthread.h"
+#include "butil/endpoint.h"
+#include "common/constant.h"
+#include "common/context.h"
+#include "common/helper.h"
+#include "common/synchronization.h"
+#include "config/yaml_config.h"
+#include "engine/rocks_raw_engine.h"
+#include "event/event.h"
+#include "event/store_state_machine_event.h"
+#include "fmt/core.h"
+#include "log/rocks_log_storage.h"
+#include "meta/store_meta_manager.h"
+#include "mvcc/codec.h"
+#include "mvcc/reader.h"
+#include "proto/common.pb.h"
+#include "proto/raft.pb.h"
+#include "raft/raft_node.h"
+#include "raft/store_state_machine.h"
+#include "vector/codec.h"
+#include "vector/vector_index.h"
+#include "vector/vector_scalar_index.h"
+
+namespace dingodb {
+
+static const std::string kRootPath = "./unit_test_store_state_machine";
+static const std::string kStorePath = kRootPath + "/db";
+static const std::string kRaftPath = kRootPath + "/raft";
+static const std::string kRaftLogPath = kRootPath + "/raft_log";
+static const std::string kCfName = "default";
+static const std::string kKey = "key_a";
+
+static const std::string kYamlConfigContent =
+    "store:\n"
+    "  path: " +
+    kStorePath + "\n";
+
+// Record the not batched entries, it is applied by event listener.
+class RecordApplyListener : public EventListener {
+ public:
+  struct Record {
+    int64_t log_id;
+    // applied index when the entry is dispatched
+    int64_t applied_index;
+    // value of kKey when the entry is dispatched
+    std::string value;
+  };
+
+  EventType GetType() override { return EventType::kSmApply; }
+
+  int OnEvent(std::shared_ptr<Event> event) override {
+    auto apply_event = std::dynamic_pointer_cast<SmApplyEvent>(event);
+
+    Record record;
+    record.log_id = apply_event->log_id;
+    record.applied_index = state_machine->GetAppliedIndex();
+    apply_event->engine->Reader()->KvGet(kCfName, kKey, record.value);
+    records.push_back(record);
+
+    // hold on apply, the following committed entries are applied by one on_apply.
+    if (records.size() == 1) {
+      bthread_usleep(500 * 1000);
+    }
+
+    return 0;
+  }
+
+  StoreStateMachine* state_machine{nullptr};
+  std::vector<Record> records;
+};
+
+class StoreStateMachineTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Helper::RemoveAllFileOrDirectory(kRootPath);
+    Helper::CreateDirectories(kStorePath);
+
+    raft_server = std::make_unique<brpc::Server>();
+    butil::EndPoint endpoint;
+    butil::str2endpoint("127.0.0.1", kRaftPort, &endpoint);
+    ASSERT_EQ(0, braft::add_service(raft_server.get(), endpoint));
+    ASSERT_EQ(0, raft_server->Start(endpoint, nullptr));
+
+    auto config = std::make_shared<YamlConfig>();
+    ASSERT_EQ(0, config->Load(kYamlConfigContent));
+    engine = std::make_shared<RocksRawEngine>();
+    ASSERT_TRUE(engine->Init(config, {kCfName, Constant::kVectorScalarKeySpeedUpCF}));
+  }
+
+  static void TearDownTestSuite() {
+    raft_server->Stop(0);
+    raft_server->Join();
+
+    engine->Close();
+    engine->Destroy();
+    Helper::RemoveAllFileOrDirectory(kRootPath);
+  }
+
+  // start a single node raft group of region and wait it become leader
+  static void StartNode(store::RegionPtr region, std::shared_ptr<StoreStateMachine> state_machine,
+                        std::shared_ptr<RaftNode>& node) {
+    auto log_storage = std::make_shared<wal::RocksLogStorage>(fmt::format("{}/{}", kRaftLogPath, region->Id()));
+    log_storage->RegisterClientType(wal::ClientType::kRaft);
+    ASSERT_TRUE(log_storage->Init());
+
+    std::string peer = fmt::format("127.0.0.1:{}:0", kRaftPort);
+    node = std::make_shared<RaftNode>(region->Id(), region->Name(), braft::PeerId(peer), state_machine, log_storage);
+    ASSERT_EQ(0, node->Init(region, peer, fmt::format("{}/{}", kRaftPath, region->Id()), 500));
+
+    for (int i = 0; i < 100 && !node->IsLeader(); ++i) {
+      bthread_usleep(100 * 1000);
+    }
+    ASSERT_TRUE(node->IsLeader());
+  }
+
+  static std::shared_ptr<pb::raft::RaftCmdRequest> GenPutCmd(int64_t region_id, const std::string& value) {
+    auto raft_cmd = std::make_shared<pb::raft::RaftCmdRequest>();
+    raft_cmd->mutable_header()->set_region_id(region_id);
+    auto* request = raft_cmd->add_requests();
+    request->set_cmd_type(pb::raft::CmdType::PUT);
+    request->mutable_put()->set_cf_name(kCfName);
+    auto* kv = request->mutable_put()->add_kvs();
+    kv->set_key(kKey);
+    kv->set_value(value);
+    return raft_cmd;
+  }
+
+  static std::shared_ptr<pb::raft::RaftCmdRequest> GenDeleteBatchCmd(int64_t region_id) {
+    auto raft_cmd = std::make_shared<pb::raft::RaftCmdRequest>();
+    raft_cmd->mutable_header()->set_region_id(region_id);
+    auto* request = raft_cmd->add_requests();
+    request->set_cmd_type(pb::raft::CmdType::DELETEBATCH);
+    request->mutable_delete_batch()->set_cf_name(kCfName);
+    request->mutable_delete_batch()->add_keys("key_not_exist");
+    return raft_cmd;
+  }
+
+  inline static const int kRaftPort = 17021;
+
+  inline static std::unique_ptr<brpc::Server> raft_server;
+  inline static std::shared_ptr<RocksRawEngine> engine;
+};
+
+// Consecutive put entries are written by one write batch, check apply order, closure and applied index.
+TEST_F(StoreStateMachineTest, BatchApply) {
+  const int64_t region_id = 3001;
+  pb::common::RegionDefinition definition;
+  definition.set_id(region_id);
+  definition.set_name("unit_test_batch_apply");
+  auto region = store::Region::New(definition);
+  ASSERT_NE(nullptr, region);
+
+  auto listener = std::make_shared<RecordApplyListener>();
+  auto listeners = std::make_shared<EventListenerCollection>();
+  listeners->Register(listener);
+
+  auto raft_meta = store::RaftMeta::New(region_id);
+  auto state_machine = std::make_shared<StoreStateMachine>(engine, region, raft_meta, nullptr, listeners, nullptr);
+  listener->state_machine = state_machine.get();
+
+  std::shared_ptr<RaftNode> node;
+  StartNode(region, state_machine, node);
+  ASSERT_NE(nullptr, node);
+
+  // the first entry hold on apply, put entries between two delete entries are merged into one batch.
+  // keep the entry count less than 10, applied index is persisted every 10 entries by store meta manager.
+  std::vector<std::shared_ptr<pb::raft::RaftCmdRequest>> raft_cmds = {
+      GenDeleteBatchCmd(region_id), GenPutCmd(region_id, "value_1"), GenPutCmd(region_id, "value_2"),
+      GenDeleteBatchCmd(region_id), GenPutCmd(region_id, "value_3"),
+  };
+
+  std::atomic<int> done_count = 0;
+  std::atomic<int> fail_count = 0;
+  for (auto& raft_cmd : raft_cmds) {
+    auto ctx = std::make_shared<Context>();
+    ctx->SetRegionId(region_id);
+    ctx->SetWriteCb([&](std::shared_ptr<Context>, butil::Status status) {
+      if (!status.ok()) {
+        fail_count.fetch_add(1);
+      }
+      done_count.fetch_add(1);
+    });
+    ASSERT_TRUE(node->Commit(ctx, raft_cmd).ok());
+  }
+
+  // every closure run once
+  int cmd_count = raft_cmds.size();
+  for (int i = 0; i < 100 && done_count.load() < cmd_count; ++i) {
+    bthread_usleep(100 * 1000);
+  }
+  ASSERT_EQ(cmd_count, done_count.load());
+  EXPECT_EQ(0, fail_count.load());
+
+  // the waiting put entries are written before the later entry, and applied index is the prior entry
+  ASSERT_EQ(2, listener->records.size());
+  int64_t first_index = listener->records[0].log_id;
+  EXPECT_LT(listener->records[0].applied_index, first_index);
+  EXPECT_TRUE(listener->records[0].value.empty());
+
+  EXPECT_EQ(first_index + 3, listener->records[1].log_id);
+  EXPECT_EQ(first_index + 2, listener->records[1].applied_index);
+  EXPECT_EQ("value_2", listener->records[1].value);
+
+  // each entry advance applied index
+  int64_t last_index = first_index + cmd_count - 1;
+  EXPECT_EQ(last_index, state_machine->GetAppliedIndex());
+  EXPECT_EQ(last_index, raft_meta->AppliedId());
+
+  std::string value;
+  ASSERT_TRUE(engine->Reader()->KvGet(kCfName, kKey, value).ok());
+  EXPECT_EQ("value_3", value);
+
+  node->Destroy();
+}
+
+// Batch applied put to scalar speed up cf reset the scalar index of vector region, same as PutHandler.
+TEST_F(StoreStateMachineTest, BatchApplyResetScalarIndex) {
+  const int64_t region_id = 3002;
+  const char prefix = 'r';
+  const int64_t partition_id = 3002;
+
+  pb::common::RegionDefinition definition;
+  definition.set_id(region_id);
+  definition.set_name("unit_test_batch_apply_scalar_index");
+  definition.mutable_range()->set_start_key(VectorCodec::PackageVectorKey(prefix, partition_id));
+  definition.mutable_range()->set_end_key(VectorCodec::PackageVectorKey(prefix, partition_id + 1));
+  auto* index_parameter = definition.mutable_index_parameter();
+  index_parameter->set_index_type(pb::common::IndexType::INDEX_TYPE_VECTOR);
+  auto* vector_index_parameter = index_parameter->mutable_vector_index_parameter();
+  vector_index_parameter->set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  vector_index_parameter->mutable_flat_parameter()->set_dimension(8);
+  vector_index_parameter->mutable_flat_parameter()->set_metric_type(pb::common::MetricType::METRIC_TYPE_L2);
+  auto* field = vector_index_parameter->mutable_scalar_schema()->add_fields();
+  field->set_key("color");
+  field->set_field_type(pb::common::ScalarFieldType::STRING);
+  field->set_enable_speed_up(true);
+
+  auto region = store::Region::New(definition);
+  ASSERT_NE(nullptr, region);
+  ASSERT_EQ(pb::common::RegionType::INDEX_REGION, region->Type());
+  ASSERT_NE(nullptr, region->VectorIndexWrapper());
+
+  pb::common::ScalarValue scalar_value;
+  scalar_value.set_field_type(pb::common::ScalarFieldType::STRING);
+  scalar_value.add_fields()->set_string_data("red");
+  auto gen_speed_up_kv = [&](int64_t vector_id) {
+    pb::common::KeyValue kv;
+    kv.set_key(VectorCodec::EncodeVectorKey(prefix, partition_id, vector_id, "color", 100));
+    std::string value = scalar_value.SerializeAsString();
+    mvcc::Codec::PackageValue(mvcc::ValueFlag::kPut, value);
+    kv.mutable_value()->swap(value);
+    return kv;
+  };
+  ASSERT_TRUE(engine->Writer()->KvPut(Constant::kVectorScalarKeySpeedUpCF, gen_speed_up_kv(1)).ok());
+
+  // build the scalar index, the first search start build in background
+  auto scalar_index = region->VectorIndexWrapper()->ScalarIndex();
+  pb::common::VectorScalardata query;
+  query.mutable_scalar_data()->insert({"color", scalar_value});
+  std::vector<int64_t> vector_ids;
+  bool is_hit = false;
+  ASSERT_TRUE(scalar_index
+                  ->Search(mvcc::KvReader::New(engine->Reader()), 0, definition.range(),
+                           vector_index_parameter->scalar_schema(), query, vector_ids, is_hit)
+                  .ok());
+  for (int i = 0; i < 1000 && scalar_index->IsBuilding(); ++i) {
+    bthread_usleep(10 * 1000);
+  }
+  ASSERT_TRUE(scalar_index->IsBuilt());
+  EXPECT_EQ(1, scalar_index->VectorCount());
+
+  auto raft_meta = store::RaftMeta::New(region_id);
+  auto state_machine = std::make_shared<StoreStateMachine>(engine, region, raft_meta, nullptr,
+                                                           std::make_shared<EventListenerCollection>(), nullptr);
+  std::shared_ptr<RaftNode> node;
+  StartNode(region, state_machine, node);
+  ASSERT_NE(nullptr, node);
+
+  // raw write to speed up cf without vector add apply
+  auto raft_cmd = std::make_shared<pb::raft::RaftCmdRequest>();
+  raft_cmd->mutable_header()->set_region_id(region_id);
+  auto* request = raft_cmd->add_requests();
+  request->set_cmd_type(pb::raft::CmdType::PUT);
+  request->mutable_put()->set_cf_name(Constant::kVectorScalarKeySpeedUpCF);
+  *request->mutable_put()->add_kvs() = gen_speed_up_kv(2);
+
+  BthreadCond cond(1);
+  auto ctx = std::make_shared<Context>();
+  ctx->SetRegionId(region_id);
+  ctx->SetWriteCb([&](std::shared_ptr<Context>, butil::Status status) {
+    EXPECT_TRUE(status.ok()) << status.error_cstr();
+    cond.DecreaseSignal();
+  });
+  ASSERT_TRUE(node->Commit(ctx, raft_cmd).ok());
+  cond.Wait();
+
+  // the stale index is dropped and rebuilt at next search
+  EXPECT_FALSE(scalar_index->IsBuilt());
+
+  node->Destroy();
+}
+
+}  // namespace dingodb
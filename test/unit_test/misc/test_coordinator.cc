@@ -12,8 +12,14 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "coordinator/coordinator_control.h"  // Include the header file where GenWatchBitSet is defined
-#include "proto/meta.pb.h"                    // Include the protobuf file where MetaEventType is defined
+#include "proto/common.pb.h"
+#include "proto/coordinator_internal.pb.h"
+#include "proto/meta.pb.h"  // Include the protobuf file where MetaEventType is defined
 
 class CoordinatorControlTest : public testing::Test {
  protected:
@@ -151,4 +157,65 @@ TEST_F(CoordinatorControlTest, GenWatchBitSetFromSet) {
       EXPECT_TRUE(bitset.test(i));
     }
   }
-}
\ No newline at end of file
+}
+
+static dingodb::pb::common::StoreMetrics GenStoreMetrics(int64_t store_id, const std::vector<int64_t>& region_ids,
+                                                         int64_t row_count) {
+  dingodb::pb::common::StoreMetrics store_metrics;
+  store_metrics.set_id(store_id);
+  store_metrics.mutable_store_own_metrics()->set_id(store_id);
+  for (auto region_id : region_ids) {
+    dingodb::pb::common::RegionMetrics region_metrics;
+    region_metrics.set_id(region_id);
+    region_metrics.set_leader_store_id(store_id);
+    region_metrics.set_row_count(row_count);
+    store_metrics.mutable_region_metrics_map()->insert({region_id, region_metrics});
+  }
+
+  return store_metrics;
+}
+
+TEST_F(CoordinatorControlTest, UpdateStoreMetricsDeltaHeartbeat) {
+  const int64_t store_id = 1001;
+  auto coordinator_control = std::make_shared<dingodb::CoordinatorControl>(nullptr, nullptr, nullptr);
+
+  // full heartbeat
+  {
+    dingodb::pb::coordinator_internal::MetaIncrement meta_increment;
+    auto store_metrics = GenStoreMetrics(store_id, {1, 2, 3}, 10);
+    store_metrics.set_is_update_epoch_version(true);
+    EXPECT_EQ(0, coordinator_control->UpdateStoreMetrics(store_metrics, meta_increment));
+  }
+
+  // delta heartbeat is partial without epoch version, more than 2 regions is legal, only changed regions overwrite
+  {
+    dingodb::pb::coordinator_internal::MetaIncrement meta_increment;
+    auto store_metrics = GenStoreMetrics(store_id, {1, 2, 3}, 20);
+    store_metrics.mutable_region_metrics_map()->erase(1);
+    store_metrics.set_is_partial_region_metrics(true);
+    EXPECT_EQ(0, coordinator_control->UpdateStoreMetrics(store_metrics, meta_increment));
+
+    std::vector<dingodb::pb::common::StoreMetrics> store_metrics_list;
+    coordinator_control->GetStoreRegionMetrics(store_id, store_metrics_list);
+    ASSERT_EQ(1, store_metrics_list.size());
+    const auto& region_metrics_map = store_metrics_list[0].region_metrics_map();
+    ASSERT_EQ(3, region_metrics_map.size());
+    EXPECT_EQ(10, region_metrics_map.at(1).row_count());
+    EXPECT_EQ(20, region_metrics_map.at(2).row_count());
+    EXPECT_EQ(20, region_metrics_map.at(3).row_count());
+  }
+
+  // partial with epoch version is split/merge, must be 2 regions, else rejected and the store report again
+  {
+    dingodb::pb::coordinator_internal::MetaIncrement meta_increment;
+    auto store_metrics = GenStoreMetrics(store_id, {1, 2, 3}, 30);
+    store_metrics.set_is_partial_region_metrics(true);
+    store_metrics.set_is_update_epoch_version(true);
+    EXPECT_EQ(-1, coordinator_control->UpdateStoreMetrics(store_metrics, meta_increment));
+
+    store_metrics = GenStoreMetrics(store_id, {1, 2}, 30);
+    store_metrics.set_is_partial_region_metrics(true);
+    store_metrics.set_is_update_epoch_version(true);
+    EXPECT_EQ(0, coordinator_control->UpdateStoreMetrics(store_metrics, meta_increment));
+  }
+}
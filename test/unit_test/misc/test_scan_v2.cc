@@ -18,6 +18,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
@@ -30,12 +32,15 @@
 #include <thread>
 #include <vector>
 
+#include "bthread/bthread.h"
 #include "butil/status.h"
+#include "bvar/variable.h"
 #include "common/constant.h"
 #include "common/helper.h"
 #include "config/yaml_config.h"
 #include "crontab/crontab.h"
 #include "engine/rocks_raw_engine.h"
+#include "gflags/gflags.h"
 #include "mvcc/codec.h"
 #include "mvcc/reader.h"
 #include "proto/common.pb.h"
@@ -44,6 +49,8 @@
 
 namespace dingodb {
 
+DECLARE_bool(scan_enable_prefetch);
+
 static const std::string &kDefaultCf = "default";  // NOLINT
 
 static const std::vector<std::string> kAllCFs = {kDefaultCf};
@@ -632,6 +639,86 @@ TEST_F(ScanV2Test, ScanBeginOthers) {
   }
 }
 
+// scan all keys by page, sleep between continue to let the next page prefetched.
+static int64_t GetPrefetchHits() {
+  return std::stoll(bvar::Variable::describe_exposed("dingo_scan_context_prefetch_hits"));
+}
+
+static bool WaitPrefetchReady(std::shared_ptr<ScanContext> scan) {
+  for (int i = 0; i < 1000; ++i) {
+    if (scan->IsPrefetchReady()) {
+      return true;
+    }
+    bthread_usleep(1000);
+  }
+  return false;
+}
+
+// with prefetch enable, every continue is served by the prefetched page
+static std::vector<std::string> ScanAllByPage(std::shared_ptr<RocksRawEngine> engine, int64_t scan_id,
+                                              const std::vector<int64_t> &page_sizes) {
+  auto mvcc_reader = dingodb::mvcc::KvReader::New(engine->Reader());
+  auto scan = ScanManagerV2::GetInstance().CreateScan(scan_id);
+  EXPECT_NE(scan.get(), nullptr);
+
+  butil::Status ok = scan->Open(std::to_string(scan_id), mvcc_reader, kDefaultCf, 0);
+  EXPECT_EQ(ok.error_code(), dingodb::pb::error::Errno::OK);
+
+  pb::common::Range range;
+  range.set_start_key("keyAA");
+  range.set_end_key("keyZZ");
+
+  std::vector<pb::common::KeyValue> kvs;
+  ok = ScanHandler::ScanBegin(scan, 1, range, page_sizes[0], false, true, true, {}, &kvs);
+  EXPECT_EQ(ok.error_code(), dingodb::pb::error::Errno::OK);
+  EXPECT_LE(kvs.size(), page_sizes[0]);
+
+  std::vector<std::string> keys;
+  for (const auto &kv : kvs) {
+    keys.push_back(kv.key());
+  }
+
+  bool has_more = true;
+  for (size_t i = 1; has_more; ++i) {
+    int64_t hits = GetPrefetchHits();
+    if (FLAGS_scan_enable_prefetch) {
+      EXPECT_TRUE(WaitPrefetchReady(scan));
+    }
+
+    int64_t page_size = page_sizes[std::min(i, page_sizes.size() - 1)];
+    kvs.clear();
+    ok = ScanHandler::ScanContinue(scan, std::to_string(scan_id), page_size, &kvs, has_more);
+    EXPECT_EQ(ok.error_code(), dingodb::pb::error::Errno::OK);
+    EXPECT_EQ(FLAGS_scan_enable_prefetch ? hits + 1 : hits, GetPrefetchHits());
+    EXPECT_LE(kvs.size(), page_size);
+    for (const auto &kv : kvs) {
+      EXPECT_FALSE(kv.value().empty());
+      keys.push_back(kv.key());
+    }
+  }
+
+  ok = ScanHandler::ScanRelease(scan, std::to_string(scan_id));
+  EXPECT_EQ(ok.error_code(), dingodb::pb::error::Errno::OK);
+  ScanManagerV2::GetInstance().DeleteScan(scan_id);
+
+  return keys;
+}
+
+TEST_F(ScanV2Test, ScanContinuePrefetch) {
+  // [keyAA, keyAA0, keyAAA, keyAAA0, keyABB, keyABB0, keyABC, keyABC0, keyABD, keyABD0, keyAB, keyAB0 ]
+  FLAGS_scan_enable_prefetch = false;
+  auto expect_keys = ScanAllByPage(this->GetRawRocksEngine(), 100, {100});
+  EXPECT_EQ(expect_keys.size(), 12);
+
+  FLAGS_scan_enable_prefetch = true;
+  // same page size
+  EXPECT_EQ(expect_keys, ScanAllByPage(this->GetRawRocksEngine(), 101, {2, 2}));
+  // shrink page size, the rest of prefetched page is returned by next continue
+  EXPECT_EQ(expect_keys, ScanAllByPage(this->GetRawRocksEngine(), 102, {5, 2, 1, 3}));
+  // grow page size
+  EXPECT_EQ(expect_keys, ScanAllByPage(this->GetRawRocksEngine(), 103, {1, 4, 100}));
+}
+
 TEST_F(ScanV2Test, ScanBeginNormal) {
   auto raw_rocks_engine = this->GetRawRocksEngine();
   auto mvcc_reader = dingodb::mvcc::KvReader::New(raw_rocks_engine->Reader());
@@ -24,11 +24,14 @@
 #include "common/helper.h"
 #include "config/yaml_config.h"
 #include "engine/rocks_raw_engine.h"
+#include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "split/split_checker.h"
 
 namespace dingodb {  // NOLINT
 
+DECLARE_int64(rocksdb_range_properties_sample_size);
+
 const std::string kRootPath = "./unit_test";
 const std::string kLogPath = kRootPath + "/log";
 const std::string kStorePath = kRootPath + "/db";
@@ -190,7 +193,7 @@ TEST_F(SplitCheckerTest, HalfSplitKeys) {  // NOLINT
   auto split_checker =
       std::make_shared<HalfSplitChecker>(SplitCheckerTest::engine, split_threshold_size, split_chunk_size);
 
-  uint32_t count = 0;
+  int64_t count = 0;
   int64_t size = 0;
   std::vector<std::string> raft_addrs;
   dingodb::pb::common::Range range;
@@ -231,7 +234,7 @@ TEST_F(SplitCheckerTest, SizeSplitKeys) {  // NOLINT
     }
   }
 
-  uint32_t count = 0;
+  int64_t count = 0;
   int64_t size = 0;
   std::vector<std::string> raft_addrs;
   dingodb::pb::common::Range range;
@@ -272,7 +275,7 @@ TEST_F(SplitCheckerTest, KeysSplitKeys) {  // NOLINT
     }
   }
 
-  uint32_t count = 0;
+  int64_t count = 0;
   int64_t size = 0;
   std::vector<std::string> raft_addrs;
   dingodb::pb::common::Range range;
@@ -293,4 +296,98 @@ TEST_F(SplitCheckerTest, KeysSplitKeys) {  // NOLINT
   writer->KvDeleteRange(kAllCFs, range);
 }
 
-}  // namespace dingodb
\ No newline at end of file
+// Split key from the range properties of flushed sst, not scan.
+TEST_F(SplitCheckerTest, RangePropertiesSplitKeys) {  // NOLINT
+  FLAGS_rocksdb_range_properties_sample_size = 16 * 1024;
+
+  // out of the range of other cases
+  int total_key_num = 20000;
+  auto writer = SplitCheckerTest::engine->Writer();
+  std::vector<dingodb::pb::common::KeyValue> kvs;
+  dingodb::pb::common::KeyValue kv;
+  for (int i = 0; i < total_key_num; ++i) {
+    kv.set_key("zzz" + GenRandomString(30));
+    kv.set_value(GenRandomString(256));
+    writer->KvPut(kDefaultCf, kv);
+    kvs.push_back(kv);
+  }
+  SplitCheckerTest::engine->Flush(kDefaultCf);
+
+  std::vector<std::string> raft_addrs;
+  dingodb::pb::common::Range range;
+  range.set_start_key("zzz");
+  range.set_end_key("zzz~");
+  auto region = BuildRegion(1001, "unit_test", raft_addrs, range.start_key(), range.end_key());
+
+  std::vector<RawEngine::RangeSample> samples;
+  ASSERT_TRUE(SplitCheckerTest::engine->GetRangeSamples({kDefaultCf}, range, samples).ok());
+  ASSERT_GT(samples.size(), 16);
+  int64_t sample_count = 0;
+  for (int i = 0; i < samples.size(); ++i) {
+    sample_count += samples[i].count;
+    if (i > 0) {
+      ASSERT_LT(samples[i - 1].key, samples[i].key);
+    }
+  }
+  EXPECT_EQ(total_key_num, sample_count);
+
+  auto reader = SplitCheckerTest::engine->Reader();
+
+  // keys
+  {
+    float split_key_ratio = 0.5;
+    auto split_checker = std::make_shared<KeysSplitChecker>(SplitCheckerTest::engine, total_key_num, split_key_ratio);
+
+    int64_t count = 0;
+    int64_t size = 0;
+    auto split_key = split_checker->SplitKey(region, range, {kDefaultCf}, count, size);
+    ASSERT_FALSE(split_key.empty());
+    EXPECT_EQ(total_key_num, count);
+
+    int64_t left_count = 0;
+    reader->KvCount(kDefaultCf, range.start_key(), split_key, left_count);
+    EXPECT_LT(abs(left_count - total_key_num * split_key_ratio), 200);
+  }
+
+  // size
+  {
+    int64_t split_threshold_size = 1024 * 1024;
+    float split_ratio = 0.5;
+    auto split_checker =
+        std::make_shared<SizeSplitChecker>(SplitCheckerTest::engine, split_threshold_size, split_ratio);
+
+    int64_t count = 0;
+    int64_t size = 0;
+    auto split_key = split_checker->SplitKey(region, range, {kDefaultCf}, count, size);
+    ASSERT_FALSE(split_key.empty());
+
+    int64_t single_key_size = 289;
+    int64_t left_count = 0;
+    reader->KvCount(kDefaultCf, range.start_key(), split_key, left_count);
+    EXPECT_LT(abs(split_threshold_size * split_ratio - left_count * single_key_size), 32 * 1024);
+  }
+
+  // keys of multi column family, the same key in two column families is counted once
+  {
+    ASSERT_TRUE(writer->KvBatchPutAndDelete(kDataCf, kvs, {}).ok());
+    SplitCheckerTest::engine->Flush(kDataCf);
+
+    float split_key_ratio = 0.5;
+    auto split_checker = std::make_shared<KeysSplitChecker>(SplitCheckerTest::engine, total_key_num, split_key_ratio);
+
+    int64_t count = 0;
+    int64_t size = 0;
+    auto split_key = split_checker->SplitKey(region, range, {kDefaultCf, kDataCf}, count, size);
+    ASSERT_FALSE(split_key.empty());
+    EXPECT_EQ(total_key_num, count);
+
+    int64_t left_count = 0;
+    reader->KvCount(kDefaultCf, range.start_key(), split_key, left_count);
+    EXPECT_LT(abs(left_count - total_key_num * split_key_ratio), 200);
+  }
+
+  // Clean
+  writer->KvDeleteRange(kAllCFs, range);
+}
+
+}  // namespace dingodb
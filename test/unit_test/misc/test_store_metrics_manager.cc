@@ -16,14 +16,26 @@
 
 #include <cstdint>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <random>
 #include <string>
+#include <vector>
 
+#include "common/constant.h"
+#include "common/helper.h"
 #include "config/config.h"
 #include "config/yaml_config.h"
 #include "engine/rocks_raw_engine.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "metrics/store_metrics_manager.h"
+#include "mvcc/codec.h"
+#include "proto/store.pb.h"
+
+namespace dingodb {
+DECLARE_int64(region_metrics_key_count_rebase_interval_s);
+}  // namespace dingodb
 
 const std::string kYamlConfigContent =
     "cluster:\n"
@@ -144,4 +156,121 @@ TEST_F(StoreRegionMetricsTest, GetRegionMinKey) {
   std::vector<std::string> raft_addrs;
   dingodb::store::RegionPtr region = BuildRegion(11111, "unit-test-01", raft_addrs);
   EXPECT_EQ("", store_region_metrics->GetRegionMinKey(region));
-}
\ No newline at end of file
+}
+
+TEST_F(StoreRegionMetricsTest, UpdateKeyCount) {
+  auto region_metrics = dingodb::StoreRegionMetrics::NewMetrics(11112);
+  EXPECT_TRUE(region_metrics->NeedUpdateKeyCount());
+
+  int64_t now_ms = dingodb::Helper::TimestampMs();
+  region_metrics->SetKeyCount(100);
+  EXPECT_FALSE(region_metrics->NeedUpdateKeyCount());
+  EXPECT_EQ(100, region_metrics->KeyCount());
+
+  // next rebase is jittered in [interval/2, interval*3/2]
+  int64_t interval_ms = dingodb::FLAGS_region_metrics_key_count_rebase_interval_s * 1000;
+  EXPECT_GE(region_metrics->NextRebaseKeyCountTimestamp(), now_ms + interval_ms / 2);
+  EXPECT_LE(region_metrics->NextRebaseKeyCountTimestamp(), dingodb::Helper::TimestampMs() + interval_ms * 3 / 2);
+
+  // raw kv put 3 keys and delete 1 key
+  dingodb::store::RegionMetrics::PbKeyValues kvs;
+  for (int i = 0; i < 3; ++i) {
+    dingodb::pb::common::KeyValue plain_kv;
+    plain_kv.set_key(fmt::format("key{}", i));
+    plain_kv.set_value("value");
+    *kvs.Add() = dingodb::mvcc::Codec::EncodeKeyValueWithPut(1000, plain_kv);
+  }
+  dingodb::pb::common::KeyValue plain_kv;
+  plain_kv.set_key("key0");
+  *kvs.Add() = dingodb::mvcc::Codec::EncodeKeyValueWithDelete(1001, plain_kv);
+  region_metrics->UpdateKeyCount(kvs);
+
+  // delta is not visible until apply, every kv is a version
+  EXPECT_EQ(100, region_metrics->KeyCount());
+  EXPECT_EQ(0, region_metrics->VersionCount());
+  EXPECT_EQ(102, region_metrics->ApplyKeyCountDelta());
+  EXPECT_EQ(4, region_metrics->VersionCount());
+
+  // txn commit 2 put and 1 delete, rollback not change key count, gc delete 2 old versions
+  std::map<std::string, std::vector<dingodb::pb::common::KeyValue>> kv_puts_with_cf;
+  std::map<std::string, std::vector<std::string>> kv_deletes_with_cf;
+  for (auto op : {dingodb::pb::store::Op::Put, dingodb::pb::store::Op::Put, dingodb::pb::store::Op::Delete,
+                  dingodb::pb::store::Op::Rollback}) {
+    dingodb::pb::store::WriteInfo write_info;
+    write_info.set_op(op);
+    dingodb::pb::common::KeyValue kv;
+    kv.set_key("key");
+    kv.set_value(write_info.SerializeAsString());
+    kv_puts_with_cf[dingodb::Constant::kTxnWriteCF].push_back(kv);
+  }
+  kv_puts_with_cf[dingodb::Constant::kTxnDataCF].resize(2);
+  kv_deletes_with_cf[dingodb::Constant::kTxnWriteCF] = {"old_key1", "old_key2"};
+  kv_deletes_with_cf[dingodb::Constant::kTxnLockCF] = {"lock_key"};
+  region_metrics->UpdateKeyCount(kv_puts_with_cf, kv_deletes_with_cf);
+
+  EXPECT_EQ(103, region_metrics->ApplyKeyCountDelta());
+  EXPECT_EQ(6, region_metrics->VersionCount());
+
+  // key count never be negative
+  region_metrics->AddKeyCountDelta(-1000, 0);
+  EXPECT_EQ(0, region_metrics->ApplyKeyCountDelta());
+
+  // set by split/merge checker full count discard the recorded key count delta
+  region_metrics->AddKeyCountDelta(10, 1);
+  region_metrics->SetKeyCount(50);
+  EXPECT_EQ(50, region_metrics->ApplyKeyCountDelta());
+  EXPECT_EQ(7, region_metrics->VersionCount());
+
+  // rebase by range properties discard all the recorded delta
+  region_metrics->AddKeyCountDelta(5, 5);
+  region_metrics->RebaseKeyCount(20, 30);
+  EXPECT_EQ(20, region_metrics->ApplyKeyCountDelta());
+  EXPECT_EQ(30, region_metrics->VersionCount());
+
+  // split/merge need rebase
+  region_metrics->ResetMetricsForRegionVersionUpdate();
+  EXPECT_TRUE(region_metrics->NeedUpdateKeyCount());
+}
+
+TEST_F(StoreRegionMetricsTest, RangePropertiesKeyCount) {
+  auto writer = StoreRegionMetricsTest::engine->Writer();
+  // keep the kvs of other test out of the sst
+  StoreRegionMetricsTest::engine->Flush(kDefaultCf);
+
+  // 100 keys put, then 10 keys deleted and 10 keys put again
+  for (int i = 0; i < 100; ++i) {
+    dingodb::pb::common::KeyValue plain_kv;
+    plain_kv.set_key(fmt::format("zzkey{:03}", i));
+    plain_kv.set_value("value");
+    writer->KvPut(kDefaultCf, dingodb::mvcc::Codec::EncodeKeyValueWithPut(100, plain_kv));
+  }
+  for (int i = 0; i < 20; ++i) {
+    dingodb::pb::common::KeyValue plain_kv;
+    plain_kv.set_key(fmt::format("zzkey{:03}", i));
+    plain_kv.set_value("value");
+    auto kv = i < 10 ? dingodb::mvcc::Codec::EncodeKeyValueWithDelete(200, plain_kv)
+                     : dingodb::mvcc::Codec::EncodeKeyValueWithPut(200, plain_kv);
+    writer->KvPut(kDefaultCf, kv);
+  }
+
+  // the kvs of memtable not in range properties
+  std::vector<dingodb::RawEngine::RangeSample> samples;
+  auto range = dingodb::mvcc::Codec::EncodeRange("zzkey", "zzkez");
+  ASSERT_TRUE(StoreRegionMetricsTest::engine->GetRangeSamples({kDefaultCf}, range, samples).ok());
+  EXPECT_TRUE(samples.empty());
+
+  StoreRegionMetricsTest::engine->Flush(kDefaultCf);
+
+  samples.clear();
+  ASSERT_TRUE(StoreRegionMetricsTest::engine->GetRangeSamples({kDefaultCf}, range, samples).ok());
+  ASSERT_FALSE(samples.empty());
+
+  int64_t count = 0;
+  int64_t key_count = 0;
+  for (const auto& sample : samples) {
+    count += sample.count;
+    key_count += sample.key_count;
+  }
+  EXPECT_EQ(120, count);
+  EXPECT_EQ(90, key_count);
+}
@@ -20,6 +20,7 @@
 #include "common/helper.h"
 #include "config/yaml_config.h"
 #include "engine/rocks_raw_engine.h"
+#include "fmt/core.h"
 #include "mvcc/codec.h"
 #include "mvcc/iterator.h"
 
@@ -612,6 +613,126 @@ TEST_F(MvccIteratorTest, BackwardIteratorForTTLExpire) {
   writer->KvDeleteRange(kDefaultCf, range);
 }
 
+TEST_F(MvccIteratorTest, BackwardIteratorForManyVersions) {
+  // arrange data
+  auto writer = engine->Writer();
+
+  std::vector<pb::common::KeyValue> kvs;
+  for (int i = 0; i < 100; ++i) {
+    pb::common::KeyValue kv;
+    kv.set_key("hello_many_1");
+    kv.set_value(fmt::format("value_1_{}", i));
+    kvs.push_back(mvcc::Codec::EncodeKeyValueWithPut(200000 + i, kv));
+
+    kv.set_key("hello_many_3");
+    kv.set_value(fmt::format("value_3_{}", i));
+    kvs.push_back(mvcc::Codec::EncodeKeyValueWithPut(200000 + i, kv));
+  }
+
+  {
+    pb::common::KeyValue kv;
+    kv.set_key("hello_many_2");
+    kv.set_value("value_2");
+    kvs.push_back(mvcc::Codec::EncodeKeyValueWithPut(200050, kv));
+  }
+
+  writer->KvBatchPutAndDelete(kDefaultCf, kvs, {});
+
+  std::string start_key = mvcc::Codec::EncodeBytes("hello_many_1");
+  std::string end_key = mvcc::Codec::EncodeBytes("hello_many_4");
+  dingodb::IteratorOptions options;
+  options.upper_bound = end_key;
+
+  auto reader = engine->Reader();
+
+  // skip newer and older versions
+  {
+    auto iter = std::make_shared<mvcc::Iterator>(200049, reader->NewIterator(kDefaultCf, options));
+    iter->Seek(start_key);
+
+    ASSERT_TRUE(iter->Valid());
+    std::string plain_key;
+    mvcc::Codec::DecodeKey(iter->Key(), plain_key);
+    EXPECT_EQ("hello_many_1", plain_key);
+    EXPECT_EQ("value_1_49", mvcc::Codec::UnPackageValue(iter->Value()));
+
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    mvcc::Codec::DecodeKey(iter->Key(), plain_key);
+    EXPECT_EQ("hello_many_3", plain_key);
+    EXPECT_EQ("value_3_49", mvcc::Codec::UnPackageValue(iter->Value()));
+
+    iter->Next();
+    ASSERT_FALSE(iter->Valid());
+
+    EXPECT_GT(iter->ReseekCount(), 0);
+    EXPECT_GT(iter->SkipVersionCount(), 0);
+  }
+
+  // latest version
+  {
+    auto iter = std::make_shared<mvcc::Iterator>(INT64_MAX, reader->NewIterator(kDefaultCf, options));
+    iter->Seek(start_key);
+
+    std::vector<std::string> values;
+    for (; iter->Valid(); iter->Next()) {
+      values.emplace_back(mvcc::Codec::UnPackageValue(iter->Value()));
+    }
+
+    ASSERT_EQ(3, values.size());
+    EXPECT_EQ("value_1_99", values[0]);
+    EXPECT_EQ("value_2", values[1]);
+    EXPECT_EQ("value_3_99", values[2]);
+    EXPECT_GT(iter->ReseekCount(), 0);
+  }
+
+  dingodb::IteratorOptions prev_options;
+  prev_options.lower_bound = start_key;
+
+  // seek for prev, skip newer and older versions
+  {
+    auto iter = std::make_shared<mvcc::Iterator>(200049, reader->NewIterator(kDefaultCf, prev_options));
+    iter->SeekForPrev(end_key);
+
+    ASSERT_TRUE(iter->Valid());
+    std::string plain_key;
+    mvcc::Codec::DecodeKey(iter->Key(), plain_key);
+    EXPECT_EQ("hello_many_3", plain_key);
+    EXPECT_EQ("value_3_49", mvcc::Codec::UnPackageValue(iter->Value()));
+
+    iter->Prev();
+    ASSERT_TRUE(iter->Valid());
+    mvcc::Codec::DecodeKey(iter->Key(), plain_key);
+    EXPECT_EQ("hello_many_1", plain_key);
+    EXPECT_EQ("value_1_49", mvcc::Codec::UnPackageValue(iter->Value()));
+
+    iter->Prev();
+    ASSERT_FALSE(iter->Valid());
+  }
+
+  // seek for prev, latest version
+  {
+    auto iter = std::make_shared<mvcc::Iterator>(INT64_MAX, reader->NewIterator(kDefaultCf, prev_options));
+    iter->SeekForPrev(end_key);
+
+    std::vector<std::string> values;
+    for (; iter->Valid(); iter->Prev()) {
+      values.emplace_back(mvcc::Codec::UnPackageValue(iter->Value()));
+    }
+
+    ASSERT_EQ(3, values.size());
+    EXPECT_EQ("value_3_99", values[0]);
+    EXPECT_EQ("value_2", values[1]);
+    EXPECT_EQ("value_1_99", values[2]);
+  }
+
+  // clear data
+  pb::common::Range range;
+  range.set_start_key("hello");
+  range.set_end_key("hellz");
+  writer->KvDeleteRange(kDefaultCf, range);
+}
+
 TEST_F(MvccIteratorTest, ForwardIterator) {
   // arrange data
   auto writer = engine->Writer();
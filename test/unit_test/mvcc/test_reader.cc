@@ -0,0 +1,216 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/helper.h"
+#include "config/yaml_config.h"
+#include "engine/rocks_raw_engine.h"
+#include "fmt/core.h"
+#include "mvcc/codec.h"
+#include "mvcc/reader.h"
+
+namespace dingodb {
+
+static const std::string kDefaultCf = "default";
+static const std::vector<std::string> kAllCFs = {kDefaultCf};
+
+const std::string kRootPath = "./unit_test";
+const std::string kLogPath = kRootPath + "/log";
+const std::string kStorePath = kRootPath + "/mvcc_reader_db";
+
+const std::string kYamlConfigContent =
+    "cluster:\n"
+    "  name: dingodb\n"
+    "  instance_id: 12345\n"
+    "  coordinators: 127.0.0.1:19190,127.0.0.1:19191,127.0.0.1:19192\n"
+    "  keyring: TO_BE_CONTINUED\n"
+    "server:\n"
+    "  host: 127.0.0.1\n"
+    "  port: 23000\n"
+    "log:\n"
+    "  path: " +
+    kLogPath +
+    "\n"
+    "store:\n"
+    "  path: " +
+    kStorePath + "\n";
+
+class MvccReaderTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Helper::CreateDirectories(kStorePath);
+
+    config = std::make_shared<YamlConfig>();
+    ASSERT_EQ(0, config->Load(kYamlConfigContent));
+
+    engine = std::make_shared<RocksRawEngine>();
+    ASSERT_TRUE(engine != nullptr);
+    ASSERT_TRUE(engine->Init(config, kAllCFs));
+  }
+
+  static void TearDownTestSuite() {
+    engine->Close();
+    engine->Destroy();
+    Helper::RemoveAllFileOrDirectory(kRootPath);
+  }
+
+  void SetUp() override {}
+  void TearDown() override {}
+
+  static std::shared_ptr<RocksRawEngine> engine;
+  static std::shared_ptr<Config> config;
+};
+
+std::shared_ptr<RocksRawEngine> MvccReaderTest::engine = nullptr;
+std::shared_ptr<Config> MvccReaderTest::config = nullptr;
+
+TEST_F(MvccReaderTest, KvBatchGet) {
+  // arrange data
+  auto writer = engine->Writer();
+
+  std::vector<pb::common::KeyValue> kvs;
+  for (int i = 0; i < 100; ++i) {
+    pb::common::KeyValue kv;
+    kv.set_key(fmt::format("batch_get_{:04}", i));
+
+    kv.set_value(fmt::format("value_{}_v1", i));
+    kvs.push_back(mvcc::Codec::EncodeKeyValueWithPut(100000, kv));
+    kv.set_value(fmt::format("value_{}_v2", i));
+    kvs.push_back(mvcc::Codec::EncodeKeyValueWithPut(100002, kv));
+
+    // every 10th key is deleted at 100004
+    if (i % 10 == 0) {
+      kvs.push_back(mvcc::Codec::EncodeKeyValueWithDelete(100004, kv));
+    }
+  }
+  writer->KvBatchPutAndDelete(kDefaultCf, kvs, {});
+
+  auto reader = mvcc::KvReader::New(engine->Reader());
+
+  // unsorted, duplicated, sparse and missing keys
+  std::vector<std::string> plain_keys = {"batch_get_0050", "batch_get_0003", "batch_get_0001", "batch_get_0002",
+                                         "batch_get_0090", "batch_get_0003", "batch_get_0010", "batch_get_9999",
+                                         "batch_get_0000", "aaaa"};
+
+  auto check_batch_get = [&](int64_t ts) {
+    std::vector<std::string> plain_values;
+    std::vector<bool> key_states;
+    auto status = reader->KvBatchGet(kDefaultCf, ts, plain_keys, plain_values, key_states);
+    ASSERT_TRUE(status.ok()) << status.error_str();
+    ASSERT_EQ(plain_keys.size(), plain_values.size());
+    ASSERT_EQ(plain_keys.size(), key_states.size());
+
+    // must same as KvGet
+    for (size_t i = 0; i < plain_keys.size(); ++i) {
+      std::string plain_value;
+      status = reader->KvGet(kDefaultCf, ts, plain_keys[i], plain_value);
+      EXPECT_EQ(status.ok(), key_states[i]) << plain_keys[i] << " ts: " << ts;
+      if (status.ok()) {
+        EXPECT_EQ(plain_value, plain_values[i]) << plain_keys[i] << " ts: " << ts;
+      }
+    }
+  };
+
+  check_batch_get(99999);
+  check_batch_get(100000);
+  check_batch_get(100001);
+  check_batch_get(100002);
+  check_batch_get(100004);
+  check_batch_get(0);
+
+  {
+    std::vector<std::string> plain_values;
+    std::vector<bool> key_states;
+    auto status = reader->KvBatchGet(kDefaultCf, 100001, plain_keys, plain_values, key_states);
+    ASSERT_TRUE(status.ok());
+    EXPECT_TRUE(key_states[0]);
+    EXPECT_EQ("value_50_v1", plain_values[0]);
+    EXPECT_TRUE(key_states[5]);
+    EXPECT_EQ("value_3_v1", plain_values[5]);
+    EXPECT_FALSE(key_states[7]);
+    EXPECT_FALSE(key_states[9]);
+  }
+
+  {
+    std::vector<std::string> plain_values;
+    std::vector<bool> key_states;
+    auto status = reader->KvBatchGet(kDefaultCf, 0, plain_keys, plain_values, key_states);
+    ASSERT_TRUE(status.ok());
+    EXPECT_FALSE(key_states[0]);
+    EXPECT_TRUE(key_states[1]);
+    EXPECT_EQ("value_3_v2", plain_values[1]);
+    EXPECT_FALSE(key_states[6]);
+  }
+
+  // dense keys, iterator step by next
+  {
+    std::vector<std::string> dense_keys;
+    for (int i = 0; i < 100; ++i) {
+      dense_keys.push_back(fmt::format("batch_get_{:04}", i));
+    }
+
+    std::vector<std::string> plain_values;
+    std::vector<bool> key_states;
+    auto status = reader->KvBatchGet(kDefaultCf, 100003, dense_keys, plain_values, key_states);
+    ASSERT_TRUE(status.ok());
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_TRUE(key_states[i]);
+      EXPECT_EQ(fmt::format("value_{}_v2", i), plain_values[i]);
+    }
+  }
+
+  {
+    std::vector<std::string> plain_values;
+    std::vector<bool> key_states;
+    auto status = reader->KvBatchGet(kDefaultCf, 0, {}, plain_values, key_states);
+    ASSERT_TRUE(status.ok());
+    EXPECT_TRUE(plain_values.empty());
+
+    status = reader->KvBatchGet(kDefaultCf, 0, {"batch_get_0001", ""}, plain_values, key_states);
+    EXPECT_EQ(pb::error::EKEY_EMPTY, status.error_code());
+  }
+}
+
+TEST_F(MvccReaderTest, RawKvBatchGet) {
+  auto writer = engine->Writer();
+
+  std::vector<pb::common::KeyValue> kvs;
+  for (int i = 0; i < 10; ++i) {
+    pb::common::KeyValue kv;
+    kv.set_key(fmt::format("raw_batch_get_{:04}", i));
+    kv.set_value(fmt::format("value_{}", i));
+    kvs.push_back(kv);
+  }
+  writer->KvBatchPutAndDelete(kDefaultCf, kvs, {});
+
+  auto reader = engine->Reader();
+  std::vector<std::string> keys = {"raw_batch_get_0005", "raw_batch_get_0100", "raw_batch_get_0000"};
+  std::vector<std::string> values;
+  std::vector<bool> key_states;
+  auto status = reader->KvBatchGet(kDefaultCf, engine->GetSnapshot(), keys, values, key_states);
+  ASSERT_TRUE(status.ok());
+  ASSERT_EQ(3, values.size());
+  EXPECT_TRUE(key_states[0]);
+  EXPECT_EQ("value_5", values[0]);
+  EXPECT_FALSE(key_states[1]);
+  EXPECT_TRUE(key_states[2]);
+  EXPECT_EQ("value_0", values[2]);
+}
+
+}  // namespace dingodb
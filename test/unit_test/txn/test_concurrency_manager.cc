@@ -0,0 +1,119 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine/concurrency_manager.h"
+#include "fmt/core.h"
+#include "proto/store.pb.h"
+
+namespace dingodb {
+
+class ConcurrencyManagerTest : public testing::Test {
+ protected:
+  static void LockKey(ConcurrencyManager& concurrency_manager, const std::string& key, int64_t lock_ts) {
+    auto lock_entry = std::make_shared<ConcurrencyManager::LockEntry>();
+    lock_entry->lock_info.set_key(key);
+    lock_entry->lock_info.set_lock_ts(lock_ts);
+    concurrency_manager.LockKey(key, lock_entry);
+  }
+
+  static bool CheckKeys(ConcurrencyManager& concurrency_manager, const std::vector<std::string>& keys,
+                        int64_t start_ts) {
+    pb::store::TxnResultInfo txn_result_info;
+    return concurrency_manager.CheckKeys(keys, pb::store::IsolationLevel::SnapshotIsolation, start_ts, {},
+                                         txn_result_info);
+  }
+
+  static bool CheckRange(ConcurrencyManager& concurrency_manager, const std::string& start_key,
+                         const std::string& end_key, int64_t start_ts, std::string& locked_key) {
+    pb::store::TxnResultInfo txn_result_info;
+    bool is_locked = concurrency_manager.CheckRange(start_key, end_key, pb::store::IsolationLevel::SnapshotIsolation,
+                                                    start_ts, {}, txn_result_info);
+    locked_key = txn_result_info.locked().key();
+    return is_locked;
+  }
+};
+
+TEST_F(ConcurrencyManagerTest, LockAndCheck) {
+  ConcurrencyManager concurrency_manager;
+
+  for (int i = 0; i < 100; i += 2) {
+    LockKey(concurrency_manager, fmt::format("key_{:03}", i), 100);
+  }
+
+  EXPECT_TRUE(CheckKeys(concurrency_manager, {"key_001", "key_002"}, 200));
+  EXPECT_FALSE(CheckKeys(concurrency_manager, {"key_001", "key_003"}, 200));
+  // lock_ts >= start_ts, not conflict
+  EXPECT_FALSE(CheckKeys(concurrency_manager, {"key_002"}, 50));
+
+  std::string locked_key;
+  EXPECT_TRUE(CheckRange(concurrency_manager, "key_041", "key_043", 200, locked_key));
+  EXPECT_EQ("key_042", locked_key);
+  EXPECT_FALSE(CheckRange(concurrency_manager, "key_041", "key_042", 200, locked_key));
+  EXPECT_FALSE(CheckRange(concurrency_manager, "key_100", "key_200", 200, locked_key));
+
+  // locked keys of all shards in order
+  std::map<std::string, pb::store::LockInfo> lock_table;
+  concurrency_manager.GetKeys(lock_table);
+  ASSERT_EQ(50, lock_table.size());
+  EXPECT_EQ("key_000", lock_table.begin()->first);
+  EXPECT_EQ("key_098", lock_table.rbegin()->first);
+
+  concurrency_manager.UnlockKeys({"key_042", "key_002"});
+  EXPECT_FALSE(CheckRange(concurrency_manager, "key_041", "key_043", 200, locked_key));
+  EXPECT_FALSE(CheckKeys(concurrency_manager, {"key_002"}, 200));
+
+  lock_table.clear();
+  concurrency_manager.GetKeys(lock_table);
+  EXPECT_EQ(48, lock_table.size());
+}
+
+TEST_F(ConcurrencyManagerTest, ConcurrentLockAndUnlock) {
+  ConcurrencyManager concurrency_manager;
+
+  const int kThreadNum = 8;
+  const int kKeyNum = 1000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < kKeyNum; ++j) {
+        std::string key = fmt::format("key_{}_{:04}", i, j);
+        LockKey(concurrency_manager, key, 100);
+        EXPECT_TRUE(CheckKeys(concurrency_manager, {key}, 200));
+        if (j % 2 == 0) {
+          concurrency_manager.UnlockKeys({key});
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::map<std::string, pb::store::LockInfo> lock_table;
+  concurrency_manager.GetKeys(lock_table);
+  EXPECT_EQ(kThreadNum * kKeyNum / 2, lock_table.size());
+}
+
+}  // namespace dingodb
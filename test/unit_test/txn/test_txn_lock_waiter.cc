@@ -0,0 +1,99 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "common/helper.h"
+#include "engine/txn_lock_waiter.h"
+
+namespace dingodb {
+
+using WaitResult = TxnLockWaiterManager::WaitResult;
+
+class TxnLockWaiterTest : public testing::Test {
+ protected:
+  static void WaitWaiterCount(int64_t count) {
+    while (TxnLockWaiterManager::GetInstance().WaiterCount() != count) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+};
+
+TEST_F(TxnLockWaiterTest, WakeUp) {
+  auto& manager = TxnLockWaiterManager::GetInstance();
+
+  WaitResult result = WaitResult::kTimeout;
+  std::thread waiter([&]() { result = manager.Wait("key_wake_up", 200, 100, Helper::TimestampUs(), 10000); });
+
+  WaitWaiterCount(1);
+  manager.WakeUp({"key_other"});
+  manager.WakeUp({"key_wake_up"});
+  waiter.join();
+
+  EXPECT_EQ(WaitResult::kWakeUp, result);
+  EXPECT_EQ(0, manager.WaiterCount());
+}
+
+TEST_F(TxnLockWaiterTest, Timeout) {
+  auto& manager = TxnLockWaiterManager::GetInstance();
+
+  int64_t start_time_ms = Helper::TimestampMs();
+  EXPECT_EQ(WaitResult::kTimeout, manager.Wait("key_timeout", 200, 100, Helper::TimestampUs(), 50));
+  EXPECT_GE(Helper::TimestampMs() - start_time_ms, 50);
+  EXPECT_EQ(0, manager.WaiterCount());
+
+  EXPECT_EQ(WaitResult::kTimeout, manager.Wait("key_timeout", 200, 100, Helper::TimestampUs(), 0));
+}
+
+TEST_F(TxnLockWaiterTest, ReleaseBeforeWait) {
+  auto& manager = TxnLockWaiterManager::GetInstance();
+
+  // lock is released after read the lock and before wait, not wait
+  int64_t check_time_us = Helper::TimestampUs();
+  manager.WakeUp({"key_release_before_wait"});
+  EXPECT_EQ(WaitResult::kWakeUp, manager.Wait("key_release_before_wait", 200, 100, check_time_us, 10000));
+}
+
+TEST_F(TxnLockWaiterTest, Deadlock) {
+  auto& manager = TxnLockWaiterManager::GetInstance();
+
+  // txn 100 wait txn 200, txn 200 wait txn 300
+  WaitResult result1 = WaitResult::kTimeout;
+  WaitResult result2 = WaitResult::kTimeout;
+  std::thread waiter1([&]() { result1 = manager.Wait("key_b", 100, 200, Helper::TimestampUs(), 10000); });
+  WaitWaiterCount(1);
+  std::thread waiter2([&]() { result2 = manager.Wait("key_c", 200, 300, Helper::TimestampUs(), 10000); });
+  WaitWaiterCount(2);
+
+  // txn 300 wait txn 100 make a cycle, txn 300 is victim
+  EXPECT_EQ(WaitResult::kDeadlock, manager.Wait("key_a", 300, 100, Helper::TimestampUs(), 10000));
+  // not a cycle
+  EXPECT_EQ(WaitResult::kTimeout, manager.Wait("key_d", 400, 100, Helper::TimestampUs(), 10));
+
+  manager.WakeUp({"key_b", "key_c"});
+  waiter1.join();
+  waiter2.join();
+  EXPECT_EQ(WaitResult::kWakeUp, result1);
+  EXPECT_EQ(WaitResult::kWakeUp, result2);
+
+  // edges are removed after wake up
+  EXPECT_EQ(WaitResult::kTimeout, manager.Wait("key_a", 300, 100, Helper::TimestampUs(), 10));
+}
+
+}  // namespace dingodb
@@ -18,6 +18,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
@@ -28,6 +29,7 @@
 #include <random>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -44,6 +46,7 @@
 #include "engine/mono_store_engine.h"
 #include "engine/rocks_raw_engine.h"
 #include "engine/txn_engine_helper.h"
+#include "engine/txn_lock_waiter.h"
 #include "event/store_state_machine_event.h"
 #include "gflags/gflags.h"
 #include "meta/store_meta_manager.h"
@@ -61,6 +64,8 @@
 namespace dingodb {
 // DECLARE_string(role);
 
+DECLARE_int64(txn_pessimistic_lock_wait_timeout_ms);
+
 static const std::string kDefaultCf = "default";
 
 static const std::vector<std::string> kAllCFs = {Constant::kTxnWriteCF, Constant::kTxnDataCF, Constant::kTxnLockCF,
@@ -1316,6 +1321,88 @@ TEST_F(TxnPessimisticLockTest, PessimisticLockReturnValue) {
   }
 }
 
+// txn_a and txn_b lock one key each and then wait for the key of the other, the second waiter is the victim.
+TEST_F(TxnPessimisticLockTest, PessimisticLockDeadlock) {
+  auto region_id = 374;
+  auto region = store::Region::New(region_id);
+  region->SetState(pb::common::StoreRegionState::NORMAL);
+  auto store_region_meta = mono_engine->GetStoreMetaManager()->GetStoreRegionMeta();
+  store_region_meta->AddRegion(region);
+  auto region_metrics = StoreRegionMetrics::NewMetrics(region->Id());
+  mono_engine->GetStoreMetricsManager()->GetStoreRegionMetrics()->AddMetrics(region_metrics);
+
+  int64_t old_wait_timeout_ms = FLAGS_txn_pessimistic_lock_wait_timeout_ms;
+  FLAGS_txn_pessimistic_lock_wait_timeout_ms = 10000;
+
+  const std::string key_a = "deadlock_key_a";
+  const std::string key_b = "deadlock_key_b";
+  int64_t txn_a_ts = end_ts + 100;
+  int64_t txn_b_ts = end_ts + 200;
+
+  auto lock_func = [&](const std::string &key, int64_t txn_ts, pb::store::TxnPessimisticLockResponse &response) {
+    auto ctx = std::make_shared<Context>();
+    ctx->SetRegionId(region_id);
+    ctx->SetCfName(Constant::kStoreDataCF);
+    ctx->SetResponse(&response);
+
+    pb::store::Mutation mutation;
+    mutation.set_op(::dingodb::pb::store::Op::Lock);
+    mutation.set_key(key);
+    std::vector<pb::common::KeyValue> kvs;
+    return TxnEngineHelper::PessimisticLock(engine, mono_engine, ctx, {mutation}, key, txn_ts, lock_ttl, txn_ts,
+                                            false, kvs);
+  };
+
+  pb::store::TxnPessimisticLockResponse response_a1;
+  ASSERT_TRUE(lock_func(key_a, txn_a_ts, response_a1).ok());
+  ASSERT_EQ(0, response_a1.txn_result_size());
+  pb::store::TxnPessimisticLockResponse response_b1;
+  ASSERT_TRUE(lock_func(key_b, txn_b_ts, response_b1).ok());
+  ASSERT_EQ(0, response_b1.txn_result_size());
+
+  // txn_a wait key_b locked by txn_b
+  butil::Status status_a2;
+  pb::store::TxnPessimisticLockResponse response_a2;
+  std::thread thread_a([&]() { status_a2 = lock_func(key_b, txn_a_ts, response_a2); });
+  while (TxnLockWaiterManager::GetInstance().WaiterCount() != 1) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // txn_b wait key_a locked by txn_a, make a cycle, txn_b is the victim
+  int64_t start_time_ms = Helper::TimestampMs();
+  pb::store::TxnPessimisticLockResponse response_b2;
+  auto status_b2 = lock_func(key_a, txn_b_ts, response_b2);
+  EXPECT_LT(Helper::TimestampMs() - start_time_ms, FLAGS_txn_pessimistic_lock_wait_timeout_ms);
+  EXPECT_TRUE(status_b2.ok());
+  EXPECT_EQ(0, response_b2.error().errcode());
+  ASSERT_EQ(1, response_b2.txn_result_size());
+  EXPECT_FALSE(response_b2.txn_result(0).has_locked());
+  ASSERT_TRUE(response_b2.txn_result(0).has_write_conflict());
+  const auto &write_conflict = response_b2.txn_result(0).write_conflict();
+  EXPECT_NE(pb::store::WriteConflict_Reason::WriteConflict_Reason_PessimisticRetry, write_conflict.reason());
+  EXPECT_EQ(txn_b_ts, write_conflict.start_ts());
+  EXPECT_EQ(txn_a_ts, write_conflict.conflict_ts());
+  EXPECT_EQ(key_a, write_conflict.key());
+  EXPECT_EQ(key_a, write_conflict.primary_key());
+
+  // txn_b rollback, txn_a is waked up and get the lock
+  pb::store::TxnPessimisticRollbackResponse rollback_response;
+  auto rollback_ctx = std::make_shared<Context>();
+  rollback_ctx->SetRegionId(region_id);
+  rollback_ctx->SetCfName(Constant::kStoreDataCF);
+  rollback_ctx->SetResponse(&rollback_response);
+  auto status = TxnEngineHelper::PessimisticRollback(engine, mono_engine, rollback_ctx, region, txn_b_ts, txn_b_ts,
+                                                     {key_b});
+  EXPECT_TRUE(status.ok());
+
+  thread_a.join();
+  EXPECT_TRUE(status_a2.ok());
+  EXPECT_EQ(0, response_a2.txn_result_size());
+
+  FLAGS_txn_pessimistic_lock_wait_timeout_ms = old_wait_timeout_ms;
+  DeleteRange();
+}
+
 TEST_F(TxnPessimisticLockTest, KvDeleteRange) { DeleteRange(); }
 
 }  // namespace dingodb
@@ -15,13 +15,20 @@
 #include <gtest/gtest.h>
 
 #include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
 
 #include "common/helper.h"
+#include "gflags/gflags.h"
 #include "mvcc/codec.h"
+#include "proto/common.pb.h"
+#include "vector/codec.h"
 
 namespace dingodb {
 
+DECLARE_bool(vector_data_enable_raw_format);
+
 const char kPrefix = 'r';
 
 class VectorCodecTest : public testing::Test {
@@ -117,4 +124,130 @@ TEST_F(VectorCodecTest, encodeAndDecode) {
   }
 }
 
-}  // namespace dingodb
\ No newline at end of file
+TEST_F(VectorCodecTest, DecodeFloatValuesView) {
+  pb::common::Vector vector;
+  vector.set_dimension(4);
+  vector.set_value_type(pb::common::ValueType::FLOAT);
+  for (int i = 0; i < 4; ++i) {
+    vector.add_float_values(0.1F * i);
+  }
+
+  std::string value = vector.SerializeAsString();
+  std::string_view float_values;
+  ASSERT_TRUE(VectorCodec::DecodeFloatValuesView(value, float_values));
+  ASSERT_EQ(4 * sizeof(float), float_values.size());
+  for (int i = 0; i < 4; ++i) {
+    float actual_value = 0;
+    memcpy(&actual_value, float_values.data() + i * sizeof(float), sizeof(float));
+    ASSERT_FLOAT_EQ(vector.float_values(i), actual_value);
+  }
+
+  // without float values
+  pb::common::Vector binary_vector;
+  binary_vector.set_dimension(8);
+  binary_vector.set_value_type(pb::common::ValueType::UINT8);
+  binary_vector.add_binary_values("a");
+  ASSERT_FALSE(VectorCodec::DecodeFloatValuesView(binary_vector.SerializeAsString(), float_values));
+
+  // truncated value
+  ASSERT_FALSE(VectorCodec::DecodeFloatValuesView(std::string_view(value).substr(0, value.size() - 1), float_values));
+}
+
+TEST_F(VectorCodecTest, EncodeAndDecodeVectorValue) {
+  bool old_enable_raw_format = FLAGS_vector_data_enable_raw_format;
+
+  // raw format is off by default, old version store can read it
+  {
+    FLAGS_vector_data_enable_raw_format = false;
+
+    pb::common::Vector vector;
+    vector.set_dimension(2);
+    vector.set_value_type(pb::common::ValueType::FLOAT);
+    vector.add_float_values(0.25F);
+    vector.add_float_values(0.5F);
+
+    std::string value = VectorCodec::EncodeVectorValue(vector);
+    ASSERT_FALSE(VectorCodec::IsRawVectorValue(value));
+    ASSERT_EQ(vector.SerializeAsString(), value);
+  }
+
+  FLAGS_vector_data_enable_raw_format = true;
+
+  // float vector
+  {
+    pb::common::Vector vector;
+    vector.set_dimension(8);
+    vector.set_value_type(pb::common::ValueType::FLOAT);
+    for (int i = 0; i < 8; ++i) {
+      vector.add_float_values(1.5F * i - 3.0F);
+    }
+
+    std::string value = VectorCodec::EncodeVectorValue(vector);
+    ASSERT_TRUE(VectorCodec::IsRawVectorValue(value));
+    ASSERT_EQ(7 + 8 * sizeof(float), value.size());
+
+    pb::common::Vector actual_vector;
+    ASSERT_TRUE(VectorCodec::DecodeVectorValue(value, actual_vector));
+    ASSERT_EQ(vector.SerializeAsString(), actual_vector.SerializeAsString());
+
+    std::string_view float_values;
+    ASSERT_TRUE(VectorCodec::DecodeFloatValuesView(value, float_values));
+    ASSERT_EQ(8 * sizeof(float), float_values.size());
+    ASSERT_EQ(0, memcmp(vector.float_values().data(), float_values.data(), float_values.size()));
+  }
+
+  // binary vector
+  {
+    pb::common::Vector vector;
+    vector.set_dimension(16);
+    vector.set_value_type(pb::common::ValueType::UINT8);
+    vector.add_binary_values(std::string(1, '\xff'));
+    vector.add_binary_values(std::string(1, '\x00'));
+
+    std::string value = VectorCodec::EncodeVectorValue(vector);
+    ASSERT_TRUE(VectorCodec::IsRawVectorValue(value));
+    ASSERT_EQ(7 + 2, value.size());
+
+    pb::common::Vector actual_vector;
+    ASSERT_TRUE(VectorCodec::DecodeVectorValue(value, actual_vector));
+    ASSERT_EQ(vector.SerializeAsString(), actual_vector.SerializeAsString());
+
+    std::string_view float_values;
+    ASSERT_FALSE(VectorCodec::DecodeFloatValuesView(value, float_values));
+  }
+
+  // binary value is not one byte, fallback protobuf
+  {
+    pb::common::Vector vector;
+    vector.set_dimension(16);
+    vector.set_value_type(pb::common::ValueType::UINT8);
+    vector.add_binary_values("ab");
+
+    std::string value = VectorCodec::EncodeVectorValue(vector);
+    ASSERT_FALSE(VectorCodec::IsRawVectorValue(value));
+
+    pb::common::Vector actual_vector;
+    ASSERT_TRUE(VectorCodec::DecodeVectorValue(value, actual_vector));
+    ASSERT_EQ(vector.SerializeAsString(), actual_vector.SerializeAsString());
+  }
+
+  // value written by old version
+  {
+    pb::common::Vector vector;
+    vector.set_dimension(2);
+    vector.set_value_type(pb::common::ValueType::FLOAT);
+    vector.add_float_values(0.25F);
+    vector.add_float_values(0.5F);
+
+    std::string value = vector.SerializeAsString();
+    ASSERT_FALSE(VectorCodec::IsRawVectorValue(value));
+
+    pb::common::Vector actual_vector;
+    ASSERT_TRUE(VectorCodec::DecodeVectorValue(value, actual_vector));
+    ASSERT_EQ(value, actual_vector.SerializeAsString());
+  }
+
+  FLAGS_vector_data_enable_raw_format = old_enable_raw_format;
+}
+
+}  // namespace dingodb
@@ -232,6 +232,35 @@ TEST_F(VectorIndexWrapperTest, MergeSearchResult) {
   }
 }
 
+TEST_F(VectorIndexWrapperTest, BitmapFilterFunctor) {
+  std::vector<int64_t> vector_ids = {1000, 1001, 1063, 1064, 1064, 1200};
+
+  VectorIndex::BitmapFilterFunctor filter(vector_ids);
+  EXPECT_EQ(5, filter.AllowedCount());
+  EXPECT_TRUE(filter.Check(1000));
+  EXPECT_TRUE(filter.Check(1063));
+  EXPECT_TRUE(filter.Check(1064));
+  EXPECT_TRUE(filter.Check(1200));
+  EXPECT_FALSE(filter.Check(999));
+  EXPECT_FALSE(filter.Check(1002));
+  EXPECT_FALSE(filter.Check(1201));
+
+  std::vector<int64_t> allowed_vector_ids;
+  filter.GetAllowedVectorIds(allowed_vector_ids);
+  EXPECT_EQ(std::vector<int64_t>({1000, 1001, 1063, 1064, 1200}), allowed_vector_ids);
+
+  VectorIndex::BitmapFilterFunctor negation_filter(vector_ids, true);
+  EXPECT_EQ(-1, negation_filter.AllowedCount());
+  EXPECT_FALSE(negation_filter.Check(1000));
+  EXPECT_TRUE(negation_filter.Check(1002));
+  EXPECT_TRUE(negation_filter.Check(1201));
+
+  std::vector<int64_t> empty_vector_ids;
+  VectorIndex::BitmapFilterFunctor empty_filter(empty_vector_ids);
+  EXPECT_EQ(0, empty_filter.AllowedCount());
+  EXPECT_FALSE(empty_filter.Check(0));
+}
+
 TEST_F(VectorIndexWrapperTest, ConcreteFilterFunctorPerformance) {
   GTEST_SKIP() << "skip performance";
 
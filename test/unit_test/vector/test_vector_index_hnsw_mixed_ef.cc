@@ -0,0 +1,200 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "butil/status.h"
+#include "common/helper.h"
+#include "fmt/core.h"
+#include "proto/common.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index.h"
+#include "vector/vector_index_factory.h"
+
+namespace dingodb {
+
+class VectorIndexHnswMixedEfTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    pb::common::RegionEpoch epoch;
+    epoch.set_conf_version(1);
+    epoch.set_version(1);
+
+    pb::common::VectorIndexParameter index_parameter;
+    index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+    index_parameter.mutable_hnsw_parameter()->set_dimension(kDimension);
+    index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+    index_parameter.mutable_hnsw_parameter()->set_efconstruction(40);
+    index_parameter.mutable_hnsw_parameter()->set_max_elements(kDataBaseSize);
+    index_parameter.mutable_hnsw_parameter()->set_nlinks(8);
+
+    vector_index = VectorIndexFactory::NewHnsw(1, index_parameter, epoch, pb::common::Range(), nullptr);
+    ASSERT_NE(vector_index, nullptr);
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<> distrib;
+
+    data_base.resize(kDimension * kDataBaseSize);
+    std::vector<pb::common::VectorWithId> vector_with_ids;
+    for (int i = 0; i < kDataBaseSize; ++i) {
+      pb::common::VectorWithId vector_with_id;
+      vector_with_id.set_id(i + 1);
+      vector_with_id.mutable_vector()->set_dimension(kDimension);
+      for (int j = 0; j < kDimension; ++j) {
+        data_base[i * kDimension + j] = distrib(rng);
+        vector_with_id.mutable_vector()->add_float_values(data_base[i * kDimension + j]);
+      }
+      vector_with_ids.push_back(std::move(vector_with_id));
+    }
+    ASSERT_TRUE(vector_index->Add(vector_with_ids).ok());
+
+    for (int i = 0; i < kQuerySize; ++i) {
+      pb::common::VectorWithId query;
+      query.mutable_vector()->set_dimension(kDimension);
+      for (int j = 0; j < kDimension; ++j) {
+        query.mutable_vector()->add_float_values(distrib(rng));
+      }
+      queries.push_back(std::move(query));
+    }
+
+    // ground truth by brute force
+    for (const auto& query : queries) {
+      std::vector<std::pair<float, int64_t>> distances;
+      for (int i = 0; i < kDataBaseSize; ++i) {
+        float distance = 0;
+        for (int j = 0; j < kDimension; ++j) {
+          float diff = query.vector().float_values(j) - data_base[i * kDimension + j];
+          distance += diff * diff;
+        }
+        distances.emplace_back(distance, i + 1);
+      }
+      std::partial_sort(distances.begin(), distances.begin() + kTopk, distances.end());
+
+      std::set<int64_t> ids;
+      for (int i = 0; i < kTopk; ++i) {
+        ids.insert(distances[i].second);
+      }
+      ground_truths.push_back(std::move(ids));
+    }
+  }
+
+  static void TearDownTestSuite() { vector_index.reset(); }
+
+  static std::vector<std::vector<int64_t>> Search(int32_t ef) {
+    pb::common::VectorSearchParameter parameter;
+    parameter.mutable_hnsw()->set_efsearch(ef);
+
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    auto status = vector_index->Search(queries, kTopk, {}, false, parameter, results);
+    EXPECT_TRUE(status.ok()) << status.error_cstr();
+
+    std::vector<std::vector<int64_t>> result_ids;
+    for (const auto& result : results) {
+      std::vector<int64_t> ids;
+      for (const auto& vector_with_distance : result.vector_with_distances()) {
+        ids.push_back(vector_with_distance.vector_with_id().id());
+      }
+      result_ids.push_back(std::move(ids));
+    }
+
+    return result_ids;
+  }
+
+  static double Recall(const std::vector<std::vector<int64_t>>& result_ids) {
+    int64_t hit_count = 0;
+    for (size_t i = 0; i < result_ids.size(); ++i) {
+      for (auto id : result_ids[i]) {
+        hit_count += ground_truths[i].count(id);
+      }
+    }
+
+    return static_cast<double>(hit_count) / (kQuerySize * kTopk);
+  }
+
+  inline static const int kDimension = 16;
+  inline static const int kDataBaseSize = 5000;
+  inline static const int kQuerySize = 50;
+  inline static const int kTopk = 10;
+
+  inline static std::shared_ptr<VectorIndex> vector_index;
+  inline static std::vector<float> data_base;
+  inline static std::vector<pb::common::VectorWithId> queries;
+  inline static std::vector<std::set<int64_t>> ground_truths;
+};
+
+TEST_F(VectorIndexHnswMixedEfTest, EfNotShared) {
+  auto default_ef_results = Search(0);
+
+  // ef of the search not leave in index
+  Search(500);
+  EXPECT_EQ(default_ef_results, Search(0));
+}
+
+// mixed low latency(small ef) and high recall(large ef) queries, each query get the same result as run alone.
+TEST_F(VectorIndexHnswMixedEfTest, ConcurrentMixedEf) {
+  const std::vector<int32_t> efs = {10, 400};
+  const int kThreadNum = 8;
+  const int kRoundNum = 20;
+
+  std::vector<std::vector<std::vector<int64_t>>> expect_results;
+  for (auto ef : efs) {
+    expect_results.push_back(Search(ef));
+  }
+
+  double low_recall = Recall(expect_results[0]);
+  double high_recall = Recall(expect_results[1]);
+  LOG(INFO) << fmt::format("ef({}) recall({:.4f}) ef({}) recall({:.4f})", efs[0], low_recall, efs[1], high_recall);
+  EXPECT_LE(low_recall, high_recall);
+
+  std::atomic<int64_t> mismatch_count = 0;
+  std::vector<std::atomic<int64_t>> elapsed_us(efs.size());
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&, i]() {
+      size_t ef_index = i % efs.size();
+      for (int round = 0; round < kRoundNum; ++round) {
+        int64_t start_us = Helper::TimestampUs();
+        auto results = Search(efs[ef_index]);
+        elapsed_us[ef_index].fetch_add(Helper::TimestampUs() - start_us);
+
+        if (results != expect_results[ef_index]) {
+          mismatch_count.fetch_add(1);
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(0, mismatch_count.load());
+
+  int64_t search_count = kThreadNum / efs.size() * kRoundNum * kQuerySize;
+  for (size_t i = 0; i < efs.size(); ++i) {
+    LOG(INFO) << fmt::format("ef({}) avg latency({} us/query)", efs[i], elapsed_us[i].load() / search_count);
+  }
+}
+
+}  // namespace dingodb
@@ -0,0 +1,377 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "butil/status.h"
+#include "common/helper.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "proto/common.pb.h"
+#include "proto/index.pb.h"
+#include "simd/distances_ref.h"
+#include "simd/hook.h"
+#include "vector/vector_index.h"
+#include "vector/vector_index_factory.h"
+#include "vector/vector_index_hnsw.h"
+
+#if defined(__x86_64__)
+#include "simd/distances_avx.h"
+#include "simd/distances_avx512.h"
+#include "simd/distances_sse.h"
+#endif
+
+namespace dingodb {
+
+DECLARE_string(hnsw_quantization_type);
+
+static const std::string kIndexPath = "./unit_test_hnsw_quantization";
+
+class VectorIndexHnswQuantizationTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Helper::CreateDirectories(kIndexPath);
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<> distrib(-1.0, 1.0);
+
+    data_base.resize(kDimension * kDataBaseSize);
+    for (int i = 0; i < kDataBaseSize; ++i) {
+      pb::common::VectorWithId vector_with_id;
+      vector_with_id.set_id(i + 1);
+      vector_with_id.mutable_vector()->set_dimension(kDimension);
+      for (int j = 0; j < kDimension; ++j) {
+        data_base[i * kDimension + j] = distrib(rng);
+        vector_with_id.mutable_vector()->add_float_values(data_base[i * kDimension + j]);
+      }
+      vector_with_ids.push_back(std::move(vector_with_id));
+    }
+
+    for (int i = 0; i < kQuerySize; ++i) {
+      pb::common::VectorWithId query;
+      query.mutable_vector()->set_dimension(kDimension);
+      for (int j = 0; j < kDimension; ++j) {
+        query.mutable_vector()->add_float_values(distrib(rng));
+      }
+      queries.push_back(std::move(query));
+    }
+
+    // ground truth by brute force
+    for (const auto& query : queries) {
+      std::vector<std::pair<float, int64_t>> distances;
+      for (int i = 0; i < kDataBaseSize; ++i) {
+        float distance = 0;
+        for (int j = 0; j < kDimension; ++j) {
+          float diff = query.vector().float_values(j) - data_base[i * kDimension + j];
+          distance += diff * diff;
+        }
+        distances.emplace_back(distance, i + 1);
+      }
+      std::partial_sort(distances.begin(), distances.begin() + kTopk, distances.end());
+
+      std::set<int64_t> ids;
+      for (int i = 0; i < kTopk; ++i) {
+        ids.insert(distances[i].second);
+      }
+      ground_truths.push_back(std::move(ids));
+    }
+  }
+
+  static void TearDownTestSuite() { Helper::RemoveAllFileOrDirectory(kIndexPath); }
+
+  static pb::common::VectorIndexParameter GenParameter(int dimension = kDimension) {
+    pb::common::VectorIndexParameter index_parameter;
+    index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+    index_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+    index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+    index_parameter.mutable_hnsw_parameter()->set_efconstruction(100);
+    index_parameter.mutable_hnsw_parameter()->set_max_elements(kDataBaseSize);
+    index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+    return index_parameter;
+  }
+
+  static std::shared_ptr<VectorIndexHnsw> NewIndex(VectorIndexHnsw::QuantizationType quantization_type) {
+    pb::common::RegionEpoch epoch;
+    epoch.set_conf_version(1);
+    epoch.set_version(1);
+
+    auto vector_index = std::make_shared<VectorIndexHnsw>(1, GenParameter(), epoch, pb::common::Range(), nullptr,
+                                                          quantization_type);
+    EXPECT_TRUE(vector_index->Add(vector_with_ids).ok());
+    return vector_index;
+  }
+
+  // recall of ground truth topk in the search result of topk * multiple
+  static double Recall(std::shared_ptr<VectorIndex> vector_index, uint32_t multiple) {
+    pb::common::VectorSearchParameter parameter;
+    parameter.mutable_hnsw()->set_efsearch(200);
+
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    auto status = vector_index->Search(queries, kTopk * multiple, {}, false, parameter, results);
+    EXPECT_TRUE(status.ok()) << status.error_cstr();
+
+    int64_t hit_count = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+      for (const auto& vector_with_distance : results[i].vector_with_distances()) {
+        hit_count += ground_truths[i].count(vector_with_distance.vector_with_id().id());
+      }
+    }
+
+    return static_cast<double>(hit_count) / (kQuerySize * kTopk);
+  }
+
+  inline static const int kDimension = 64;
+  inline static const int kDataBaseSize = 3000;
+  inline static const int kQuerySize = 50;
+  inline static const int kTopk = 10;
+
+  inline static std::vector<float> data_base;
+  inline static std::vector<pb::common::VectorWithId> vector_with_ids;
+  inline static std::vector<pb::common::VectorWithId> queries;
+  inline static std::vector<std::set<int64_t>> ground_truths;
+};
+
+TEST_F(VectorIndexHnswQuantizationTest, MemorySizeAndRecall) {
+  auto none_index = NewIndex(VectorIndexHnsw::QuantizationType::kNone);
+  auto int8_index = NewIndex(VectorIndexHnsw::QuantizationType::kInt8);
+  auto fp16_index = NewIndex(VectorIndexHnsw::QuantizationType::kFp16);
+
+  int64_t none_memory_size = 0, int8_memory_size = 0, fp16_memory_size = 0;
+  ASSERT_TRUE(none_index->GetMemorySize(none_memory_size).ok());
+  ASSERT_TRUE(int8_index->GetMemorySize(int8_memory_size).ok());
+  ASSERT_TRUE(fp16_index->GetMemorySize(fp16_memory_size).ok());
+  EXPECT_LT(int8_memory_size, fp16_memory_size);
+  EXPECT_LT(fp16_memory_size, none_memory_size);
+
+  EXPECT_EQ(0, none_index->RerankCandidateMultiple());
+  EXPECT_LT(0, int8_index->RerankCandidateMultiple());
+
+  double none_recall = Recall(none_index, 1);
+  double int8_recall = Recall(int8_index, 1);
+  double fp16_recall = Recall(fp16_index, 1);
+  // candidates of re-rank
+  double int8_candidate_recall = Recall(int8_index, int8_index->RerankCandidateMultiple());
+  LOG(INFO) << fmt::format(
+      "memory size none({}) int8({}) fp16({}), recall none({:.4f}) int8({:.4f}) fp16({:.4f}) int8 candidate({:.4f})",
+      none_memory_size, int8_memory_size, fp16_memory_size, none_recall, int8_recall, fp16_recall,
+      int8_candidate_recall);
+
+  EXPECT_GE(fp16_recall, none_recall - 0.02);
+  EXPECT_GE(int8_recall, 0.8);
+  EXPECT_GE(int8_candidate_recall, none_recall - 0.02);
+}
+
+TEST_F(VectorIndexHnswQuantizationTest, NotReconstruct) {
+  auto vector_index = NewIndex(VectorIndexHnsw::QuantizationType::kInt8);
+
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  auto status = vector_index->Search({queries[0]}, kTopk, {}, true, pb::common::VectorSearchParameter(), results);
+  ASSERT_TRUE(status.ok()) << status.error_cstr();
+  ASSERT_EQ(1, results.size());
+  ASSERT_EQ(kTopk, results[0].vector_with_distances_size());
+
+  // code is not the vector, reconstruct by vector data
+  for (const auto& vector_with_distance : results[0].vector_with_distances()) {
+    EXPECT_EQ(0, vector_with_distance.vector_with_id().vector().float_values_size());
+  }
+}
+
+TEST_F(VectorIndexHnswQuantizationTest, LoadMismatch) {
+  auto int8_index = NewIndex(VectorIndexHnsw::QuantizationType::kInt8);
+  std::string path = kIndexPath + "/int8_index";
+  ASSERT_TRUE(int8_index->Save(path).ok());
+
+  pb::common::RegionEpoch epoch;
+  auto fp16_index = std::make_shared<VectorIndexHnsw>(2, GenParameter(), epoch, pb::common::Range(), nullptr,
+                                                      VectorIndexHnsw::QuantizationType::kFp16);
+  EXPECT_FALSE(fp16_index->Load(path).ok());
+
+  auto new_int8_index = std::make_shared<VectorIndexHnsw>(3, GenParameter(), epoch, pb::common::Range(), nullptr,
+                                                          VectorIndexHnsw::QuantizationType::kInt8);
+  ASSERT_TRUE(new_int8_index->Load(path).ok());
+  int64_t count = 0;
+  ASSERT_TRUE(new_int8_index->GetCount(count).ok());
+  EXPECT_EQ(kDataBaseSize, count);
+}
+
+// int8 code of dimension 8 and fp16 code of dimension 8 have the same element data size.
+TEST_F(VectorIndexHnswQuantizationTest, LoadMismatchSameElementSize) {
+  const int dimension = 8;
+  ASSERT_EQ(VectorIndexHnsw::CalcElementDataSize(VectorIndexHnsw::QuantizationType::kInt8, dimension),
+            VectorIndexHnsw::CalcElementDataSize(VectorIndexHnsw::QuantizationType::kFp16, dimension));
+
+  std::vector<pb::common::VectorWithId> small_vector_with_ids;
+  for (int i = 0; i < 100; ++i) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(i + 1);
+    vector_with_id.mutable_vector()->set_dimension(dimension);
+    for (int j = 0; j < dimension; ++j) {
+      vector_with_id.mutable_vector()->add_float_values(data_base[i * kDimension + j]);
+    }
+    small_vector_with_ids.push_back(std::move(vector_with_id));
+  }
+
+  pb::common::RegionEpoch epoch;
+  auto int8_index = std::make_shared<VectorIndexHnsw>(1, GenParameter(dimension), epoch, pb::common::Range(), nullptr,
+                                                      VectorIndexHnsw::QuantizationType::kInt8);
+  ASSERT_TRUE(int8_index->Add(small_vector_with_ids).ok());
+  std::string path = kIndexPath + "/int8_index_dimension_8";
+  ASSERT_TRUE(int8_index->Save(path).ok());
+
+  VectorIndexHnsw::QuantizationType quantization_type;
+  ASSERT_TRUE(VectorIndexHnsw::LoadQuantizationType(path, quantization_type).ok());
+  EXPECT_EQ(VectorIndexHnsw::QuantizationType::kInt8, quantization_type);
+
+  auto fp16_index = std::make_shared<VectorIndexHnsw>(2, GenParameter(dimension), epoch, pb::common::Range(), nullptr,
+                                                      VectorIndexHnsw::QuantizationType::kFp16);
+  EXPECT_FALSE(fp16_index->Load(path).ok());
+
+  // index file without quantization meta is saved by old version, it is not quantized.
+  Helper::RemoveFileOrDirectory(VectorIndexHnsw::QuantizationMetaPath(path));
+  ASSERT_TRUE(VectorIndexHnsw::LoadQuantizationType(path, quantization_type).ok());
+  EXPECT_EQ(VectorIndexHnsw::QuantizationType::kNone, quantization_type);
+  auto new_int8_index = std::make_shared<VectorIndexHnsw>(3, GenParameter(dimension), epoch, pb::common::Range(),
+                                                          nullptr, VectorIndexHnsw::QuantizationType::kInt8);
+  EXPECT_FALSE(new_int8_index->Load(path).ok());
+}
+
+TEST_F(VectorIndexHnswQuantizationTest, Factory) {
+  std::string old_quantization_type = FLAGS_hnsw_quantization_type;
+  FLAGS_hnsw_quantization_type = "fp16";
+
+  pb::common::RegionEpoch epoch;
+  auto vector_index = VectorIndexFactory::NewHnsw(1, GenParameter(), epoch, pb::common::Range(), nullptr);
+  FLAGS_hnsw_quantization_type = old_quantization_type;
+
+  auto hnsw_index = std::dynamic_pointer_cast<VectorIndexHnsw>(vector_index);
+  ASSERT_NE(nullptr, hnsw_index);
+  EXPECT_EQ(VectorIndexHnsw::QuantizationType::kFp16, hnsw_index->GetQuantizationType());
+
+  VectorIndexHnsw::QuantizationType quantization_type;
+  EXPECT_TRUE(VectorIndexHnsw::ParseQuantizationType("int8", quantization_type));
+  EXPECT_EQ(VectorIndexHnsw::QuantizationType::kInt8, quantization_type);
+  EXPECT_FALSE(VectorIndexHnsw::ParseQuantizationType("int4", quantization_type));
+}
+
+// simd kernels must give the same result as the ref kernels, include the tail of dimension.
+class HnswQuantizationKernelTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<> int8_distrib(-128, 127);
+    std::uniform_real_distribution<> float_distrib(-10.0, 10.0);
+
+    int8_x.resize(kMaxDimension);
+    int8_y.resize(kMaxDimension);
+    fp16_x.resize(kMaxDimension);
+    fp16_y.resize(kMaxDimension);
+    for (int i = 0; i < kMaxDimension; ++i) {
+      int8_x[i] = static_cast<int8_t>(int8_distrib(rng));
+      int8_y[i] = static_cast<int8_t>(int8_distrib(rng));
+      fp16_x[i] = fp32_to_fp16(float_distrib(rng));
+      fp16_y[i] = fp32_to_fp16(float_distrib(rng));
+    }
+  }
+
+  using Int8Kernel = int32_t (*)(const int8_t*, const int8_t*, size_t);
+  using Fp16Kernel = float (*)(const uint16_t*, const uint16_t*, size_t);
+
+  void CheckInt8Kernel(Int8Kernel kernel, const std::string& name) {
+    for (size_t dimension : kDimensions) {
+      EXPECT_EQ(int8vec_inner_product_ref(int8_x.data(), int8_y.data(), dimension),
+                kernel(int8_x.data(), int8_y.data(), dimension))
+          << name << " dimension " << dimension;
+    }
+  }
+
+  void CheckFp16Kernel(Fp16Kernel kernel, Fp16Kernel ref_kernel, const std::string& name) {
+    for (size_t dimension : kDimensions) {
+      float expect = ref_kernel(fp16_x.data(), fp16_y.data(), dimension);
+      float actual = kernel(fp16_x.data(), fp16_y.data(), dimension);
+      // summation order of simd is different
+      EXPECT_NEAR(expect, actual, std::max(1e-3F, std::fabs(expect) * 1e-5F)) << name << " dimension " << dimension;
+    }
+  }
+
+  inline static const int kMaxDimension = 1024;
+  inline static const std::vector<size_t> kDimensions = {0, 1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 100, 1024};
+
+  std::vector<int8_t> int8_x;
+  std::vector<int8_t> int8_y;
+  std::vector<uint16_t> fp16_x;
+  std::vector<uint16_t> fp16_y;
+};
+
+TEST_F(HnswQuantizationKernelTest, Fp16Convert) {
+  EXPECT_EQ(0x3C00, fp32_to_fp16(1.0F));
+  EXPECT_EQ(0xC000, fp32_to_fp16(-2.0F));
+  EXPECT_EQ(0x7BFF, fp32_to_fp16(65504.0F));
+  EXPECT_EQ(0x7C00, fp32_to_fp16(1e6F));
+
+  for (int i = 0; i < kMaxDimension; ++i) {
+    EXPECT_EQ(fp16_x[i], fp32_to_fp16(fp16_to_fp32(fp16_x[i])));
+  }
+}
+
+TEST_F(HnswQuantizationKernelTest, Hook) {
+  std::string simd_type;
+  fvec_hook(simd_type);
+  LOG(INFO) << "simd type: " << simd_type;
+
+  CheckInt8Kernel(int8vec_inner_product, "hook");
+  CheckFp16Kernel(fp16vec_L2sqr, fp16vec_L2sqr_ref, "hook_l2");
+  CheckFp16Kernel(fp16vec_inner_product, fp16vec_inner_product_ref, "hook_ip");
+}
+
+#if defined(__x86_64__)
+TEST_F(HnswQuantizationKernelTest, Sse) {
+  if (!cpu_support_sse4_2()) {
+    GTEST_SKIP() << "cpu not support sse4_2";
+  }
+
+  CheckInt8Kernel(int8vec_inner_product_sse, "sse");
+}
+
+TEST_F(HnswQuantizationKernelTest, Avx2) {
+  if (!cpu_support_avx2()) {
+    GTEST_SKIP() << "cpu not support avx2";
+  }
+
+  CheckInt8Kernel(int8vec_inner_product_avx, "avx2");
+  CheckFp16Kernel(fp16vec_L2sqr_avx, fp16vec_L2sqr_ref, "avx2_l2");
+  CheckFp16Kernel(fp16vec_inner_product_avx, fp16vec_inner_product_ref, "avx2_ip");
+}
+
+TEST_F(HnswQuantizationKernelTest, Avx512) {
+  if (!cpu_support_avx512()) {
+    GTEST_SKIP() << "cpu not support avx512";
+  }
+
+  CheckInt8Kernel(int8vec_inner_product_avx512, "avx512");
+  CheckFp16Kernel(fp16vec_L2sqr_avx512, fp16vec_L2sqr_ref, "avx512_l2");
+  CheckFp16Kernel(fp16vec_inner_product_avx512, fp16vec_inner_product_ref, "avx512_ip");
+}
+#endif
+
+}  // namespace dingodb
@@ -0,0 +1,215 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "butil/status.h"
+#include "common/threadpool.h"
+#include "gflags/gflags.h"
+#include "proto/common.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index_hnsw.h"
+
+namespace dingodb {
+
+DECLARE_int64(hnsw_repair_min_delete_count);
+DECLARE_uint32(hnsw_repair_batch_node_count);
+
+class VectorIndexHnswRepairTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    old_repair_min_delete_count_ = FLAGS_hnsw_repair_min_delete_count;
+    old_repair_batch_node_count_ = FLAGS_hnsw_repair_batch_node_count;
+    FLAGS_hnsw_repair_min_delete_count = 100;
+    FLAGS_hnsw_repair_batch_node_count = 256;
+
+    vector_index_ = NewIndex(nullptr);
+  }
+
+  static std::shared_ptr<VectorIndexHnsw> NewIndex(ThreadPoolPtr thread_pool) {
+    pb::common::VectorIndexParameter index_parameter;
+    index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+    index_parameter.mutable_hnsw_parameter()->set_dimension(kDimension);
+    index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+    index_parameter.mutable_hnsw_parameter()->set_efconstruction(100);
+    index_parameter.mutable_hnsw_parameter()->set_max_elements(kDataBaseSize * 2);
+    index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+    pb::common::RegionEpoch epoch;
+    epoch.set_conf_version(1);
+    epoch.set_version(1);
+    return std::make_shared<VectorIndexHnsw>(1, index_parameter, epoch, pb::common::Range(), thread_pool);
+  }
+
+  void TearDown() override {
+    FLAGS_hnsw_repair_min_delete_count = old_repair_min_delete_count_;
+    FLAGS_hnsw_repair_batch_node_count = old_repair_batch_node_count_;
+  }
+
+  static std::vector<pb::common::VectorWithId> GenVectors(int64_t start_id, int count) {
+    static std::mt19937 rng(12345);
+    std::uniform_real_distribution<> distrib(-1.0, 1.0);
+
+    std::vector<pb::common::VectorWithId> vector_with_ids;
+    for (int i = 0; i < count; ++i) {
+      pb::common::VectorWithId vector_with_id;
+      vector_with_id.set_id(start_id + i);
+      vector_with_id.mutable_vector()->set_dimension(kDimension);
+      for (int j = 0; j < kDimension; ++j) {
+        vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+      }
+      vector_with_ids.push_back(std::move(vector_with_id));
+    }
+    return vector_with_ids;
+  }
+
+  // search self of each vector, return the ratio of found at top1
+  double SelfRecall(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+    pb::common::VectorSearchParameter parameter;
+    parameter.mutable_hnsw()->set_efsearch(64);
+
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    auto status = vector_index_->Search(vector_with_ids, 1, {}, false, parameter, results);
+    EXPECT_TRUE(status.ok()) << status.error_cstr();
+
+    int64_t hit_count = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+      if (results[i].vector_with_distances_size() > 0 &&
+          results[i].vector_with_distances(0).vector_with_id().id() == vector_with_ids[i].id()) {
+        ++hit_count;
+      }
+    }
+    return static_cast<double>(hit_count) / vector_with_ids.size();
+  }
+
+  inline static const int kDimension = 32;
+  inline static const int kDataBaseSize = 2000;
+
+  std::shared_ptr<VectorIndexHnsw> vector_index_;
+  int64_t old_repair_min_delete_count_;
+  uint32_t old_repair_batch_node_count_;
+};
+
+TEST_F(VectorIndexHnswRepairTest, ReplaceDeleted) {
+  auto vector_with_ids = GenVectors(1, kDataBaseSize);
+  ASSERT_TRUE(vector_index_->Upsert(vector_with_ids).ok());
+
+  std::vector<int64_t> delete_ids;
+  for (int64_t id = 1; id <= kDataBaseSize / 2; ++id) {
+    delete_ids.push_back(id);
+  }
+  ASSERT_TRUE(vector_index_->Delete(delete_ids).ok());
+
+  int64_t deleted_count = 0;
+  ASSERT_TRUE(vector_index_->GetDeletedCount(deleted_count).ok());
+  EXPECT_EQ(kDataBaseSize / 2, deleted_count);
+
+  // new vectors take the slot of deleted vectors
+  auto new_vector_with_ids = GenVectors(kDataBaseSize + 1, kDataBaseSize / 4);
+  ASSERT_TRUE(vector_index_->Upsert(new_vector_with_ids).ok());
+  EXPECT_EQ(kDataBaseSize, vector_index_->GetHnswIndex()->getCurrentElementCount());
+  ASSERT_TRUE(vector_index_->GetDeletedCount(deleted_count).ok());
+  EXPECT_EQ(kDataBaseSize / 4, deleted_count);
+
+  // re-upsert the deleted vector
+  std::vector<pb::common::VectorWithId> deleted_vector_with_ids(vector_with_ids.begin(), vector_with_ids.begin() + 10);
+  ASSERT_TRUE(vector_index_->Upsert(deleted_vector_with_ids).ok());
+  EXPECT_EQ(1.0, SelfRecall(deleted_vector_with_ids));
+
+  // re-upsert the live vector, update in place
+  ASSERT_TRUE(vector_index_->Upsert(new_vector_with_ids).ok());
+  EXPECT_EQ(kDataBaseSize, vector_index_->GetHnswIndex()->getCurrentElementCount());
+
+  ASSERT_TRUE(vector_index_->GetDeletedCount(deleted_count).ok());
+  EXPECT_EQ(kDataBaseSize / 4 - 10, deleted_count);
+  EXPECT_FALSE(vector_index_->IsExceedsMaxElements(kDataBaseSize / 4));
+}
+
+TEST_F(VectorIndexHnswRepairTest, Repair) {
+  auto vector_with_ids = GenVectors(1, kDataBaseSize);
+  ASSERT_TRUE(vector_index_->Upsert(vector_with_ids).ok());
+  EXPECT_FALSE(vector_index_->NeedToRepair());
+
+  std::vector<int64_t> delete_ids;
+  for (int64_t id = 1; id <= kDataBaseSize; id += 3) {
+    delete_ids.push_back(id);
+  }
+  ASSERT_TRUE(vector_index_->Delete(delete_ids).ok());
+  EXPECT_TRUE(vector_index_->NeedToRepair());
+
+  ASSERT_TRUE(vector_index_->Repair().ok());
+  EXPECT_FALSE(vector_index_->NeedToRepair());
+
+  // no live node link to deleted node
+  auto* hnsw_index = vector_index_->GetHnswIndex();
+  for (hnswlib::tableint node = 0; node < hnsw_index->cur_element_count; ++node) {
+    if (hnsw_index->isMarkedDeleted(node)) {
+      continue;
+    }
+    auto* link_list = hnsw_index->get_linklist0(node);
+    auto* neighbors = reinterpret_cast<hnswlib::tableint*>(link_list + 1);
+    for (size_t i = 0; i < hnsw_index->getListCount(link_list); ++i) {
+      EXPECT_FALSE(hnsw_index->isMarkedDeleted(neighbors[i]));
+    }
+  }
+
+  std::vector<pb::common::VectorWithId> live_vector_with_ids;
+  for (const auto& vector_with_id : vector_with_ids) {
+    if ((vector_with_id.id() - 1) % 3 != 0) {
+      live_vector_with_ids.push_back(vector_with_id);
+    }
+  }
+  EXPECT_GE(SelfRecall(live_vector_with_ids), 0.98);
+}
+
+// the same id appears many times in one batch, upserted by thread pool, must not take more than one slot.
+TEST_F(VectorIndexHnswRepairTest, DuplicateIdInBatch) {
+  vector_index_ = NewIndex(std::make_shared<ThreadPool>("hnsw_duplicate_id", 8));
+
+  auto vector_with_ids = GenVectors(1, kDataBaseSize);
+  ASSERT_TRUE(vector_index_->Upsert(vector_with_ids).ok());
+
+  std::vector<int64_t> delete_ids;
+  for (int64_t id = 1; id <= kDataBaseSize / 2; ++id) {
+    delete_ids.push_back(id);
+  }
+  ASSERT_TRUE(vector_index_->Delete(delete_ids).ok());
+
+  // each new id repeated, the last one is the final vector
+  const int new_count = 20;
+  const int repeat_count = 10;
+  std::vector<pb::common::VectorWithId> batch;
+  std::vector<pb::common::VectorWithId> last_vector_with_ids;
+  for (int i = 0; i < repeat_count; ++i) {
+    last_vector_with_ids = GenVectors(kDataBaseSize + 1, new_count);
+    batch.insert(batch.end(), last_vector_with_ids.begin(), last_vector_with_ids.end());
+  }
+  ASSERT_TRUE(vector_index_->Upsert(batch).ok());
+
+  auto* hnsw_index = vector_index_->GetHnswIndex();
+  EXPECT_EQ(kDataBaseSize, hnsw_index->getCurrentElementCount());
+  EXPECT_EQ(kDataBaseSize, hnsw_index->label_lookup_.size());
+  int64_t deleted_count = 0;
+  ASSERT_TRUE(vector_index_->GetDeletedCount(deleted_count).ok());
+  EXPECT_EQ(kDataBaseSize / 2 - new_count, deleted_count);
+  EXPECT_EQ(1.0, SelfRecall(last_vector_with_ids));
+}
+
+}  // namespace dingodb
@@ -1652,4 +1652,60 @@ TEST_F(VectorIndexIvfFlatTest, RangeSearchAfterLoad) {
   }
 }
 
+TEST_F(VectorIndexIvfFlatTest, TrainByIndex) {
+  pb::common::Range range;
+  pb::common::RegionEpoch epoch;
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_FLAT);
+  index_parameter.mutable_ivf_flat_parameter()->set_dimension(dimension);
+  index_parameter.mutable_ivf_flat_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_ivf_flat_parameter()->set_ncentroids(ncentroids);
+
+  auto parent_index = VectorIndexFactory::NewIvfFlat(1, index_parameter, epoch, range, vector_index_thread_pool);
+  auto child_index = VectorIndexFactory::NewIvfFlat(2, index_parameter, epoch, range, vector_index_thread_pool);
+  EXPECT_EQ(ncentroids * 256, child_index->TrainSampleCount());
+
+  // not trained
+  EXPECT_FALSE(child_index->TrainByIndex(parent_index).ok());
+
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+  std::vector<float> train_datas(dimension * ncentroids * 40);
+  for (auto& elem : train_datas) {
+    elem = distrib(rng);
+  }
+  ASSERT_TRUE(parent_index->Train(train_datas).ok());
+
+  ASSERT_TRUE(child_index->TrainByIndex(parent_index).ok());
+  EXPECT_TRUE(child_index->IsTrained());
+
+  // same centroids, same search result
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int i = 0; i < 100; ++i) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(i + 1);
+    for (int j = 0; j < dimension; ++j) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+  ASSERT_TRUE(parent_index->Upsert(vector_with_ids).ok());
+  ASSERT_TRUE(child_index->Upsert(vector_with_ids).ok());
+
+  pb::common::VectorSearchParameter parameter;
+  parameter.mutable_ivf_flat()->set_nprobe(1);
+  std::vector<pb::index::VectorWithDistanceResult> parent_results, child_results;
+  ASSERT_TRUE(parent_index->Search(vector_with_ids, 5, {}, false, parameter, parent_results).ok());
+  ASSERT_TRUE(child_index->Search(vector_with_ids, 5, {}, false, parameter, child_results).ok());
+  ASSERT_EQ(parent_results.size(), child_results.size());
+  for (size_t i = 0; i < parent_results.size(); ++i) {
+    EXPECT_EQ(parent_results[i].DebugString(), child_results[i].DebugString());
+  }
+
+  // different parameter
+  index_parameter.mutable_ivf_flat_parameter()->set_ncentroids(ncentroids + 1);
+  auto other_index = VectorIndexFactory::NewIvfFlat(3, index_parameter, epoch, range, vector_index_thread_pool);
+  EXPECT_FALSE(other_index->TrainByIndex(parent_index).ok());
+}
+
 }  // namespace dingodb
@@ -14,6 +14,7 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
 #include <climits>
 #include <cstddef>
@@ -4846,4 +4847,59 @@ TEST_F(VectorIndexUtilsTest, NormalizeVectorForHnsw) {
   }
 }
 
+TEST_F(VectorIndexUtilsTest, VectorReservoirSampler) {
+  static const int32_t kDimension = 4;
+
+  // keep all
+  {
+    VectorReservoirSampler sampler(0, kDimension, 1);
+    std::vector<float> vector(kDimension);
+    for (int i = 0; i < 100; ++i) {
+      std::fill(vector.begin(), vector.end(), static_cast<float>(i));
+      sampler.Add(vector.data());
+    }
+    EXPECT_EQ(100, sampler.TotalCount());
+    EXPECT_EQ(100, sampler.SampleCount());
+    EXPECT_EQ(100 * kDimension, sampler.Samples().size());
+  }
+
+  // bounded and uniform
+  {
+    static const int kTotalCount = 100000;
+    static const int kSampleCount = 1000;
+    VectorReservoirSampler sampler(kSampleCount, kDimension, 1);
+    std::vector<float> vector(kDimension);
+    for (int i = 0; i < kTotalCount; ++i) {
+      std::fill(vector.begin(), vector.end(), static_cast<float>(i));
+      sampler.Add(vector.data());
+    }
+    EXPECT_EQ(kTotalCount, sampler.TotalCount());
+    ASSERT_EQ(kSampleCount, sampler.SampleCount());
+
+    // sample is a whole vector, the half of samples come from the second half of data
+    int64_t second_half_count = 0;
+    const auto& samples = sampler.Samples();
+    for (int i = 0; i < kSampleCount; ++i) {
+      for (int j = 1; j < kDimension; ++j) {
+        EXPECT_EQ(samples[i * kDimension], samples[i * kDimension + j]);
+      }
+      second_half_count += samples[i * kDimension] >= kTotalCount / 2 ? 1 : 0;
+    }
+    EXPECT_NEAR(kSampleCount / 2, second_half_count, kSampleCount / 10);
+  }
+
+  // less vectors than sample count, memory is not allocated by sample count
+  {
+    static const int kSampleCount = 1000000;
+    VectorReservoirSampler sampler(kSampleCount, kDimension, 1);
+    std::vector<float> vector(kDimension);
+    for (int i = 0; i < 10; ++i) {
+      std::fill(vector.begin(), vector.end(), static_cast<float>(i));
+      sampler.Add(vector.data());
+    }
+    EXPECT_EQ(10, sampler.SampleCount());
+    EXPECT_LT(sampler.Samples().capacity(), kSampleCount * kDimension / 100);
+  }
+}
+
 }  // namespace dingodb
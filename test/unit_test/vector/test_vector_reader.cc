@@ -14,16 +14,22 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <random>
+#include <string>
 #include <vector>
 
 #include "butil/status.h"
 #include "common/constant.h"
 #include "common/helper.h"
+#include "common/threadpool.h"
 #include "config/yaml_config.h"
 #include "engine/rocks_raw_engine.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "mvcc/codec.h"
 #include "mvcc/reader.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
@@ -33,6 +39,8 @@
 
 namespace dingodb {
 
+DECLARE_double(vector_index_bruteforce_selectivity_threshold);
+
 static const std::string kDefaultCf = "default";
 
 static const std::vector<std::string> kAllCFs = {Constant::kVectorDataCF, Constant::kVectorScalarCF,
@@ -1910,4 +1918,316 @@ TEST_F(VectorIndexReaderTest, IdPreFilter) {
   }
 }
 
+// bruteforce search kernel must give the same result as flat index.
+class BruteForceSearchKernelTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<> distrib(-1.0, 1.0);
+
+    for (int i = 0; i < kDataBaseSize; ++i) {
+      pb::common::VectorWithId vector_with_id;
+      vector_with_id.set_id(i + 1);
+      vector_with_id.mutable_vector()->set_dimension(kDimension);
+      vector_with_id.mutable_vector()->set_value_type(pb::common::ValueType::FLOAT);
+      for (int j = 0; j < kDimension; ++j) {
+        // scale of vector is different, so cosine is not same as inner product
+        vector_with_id.mutable_vector()->add_float_values(distrib(rng) * (i % 5 + 1));
+      }
+      vector_with_ids.push_back(std::move(vector_with_id));
+    }
+
+    for (int i = 0; i < kQuerySize; ++i) {
+      pb::common::VectorWithId query;
+      query.mutable_vector()->set_dimension(kDimension);
+      query.mutable_vector()->set_value_type(pb::common::ValueType::FLOAT);
+      for (int j = 0; j < kDimension; ++j) {
+        query.mutable_vector()->add_float_values(distrib(rng) * (i % 3 + 1));
+      }
+      queries.push_back(std::move(query));
+    }
+  }
+
+  static void TearDownTestSuite() {
+    vector_with_ids.clear();
+    queries.clear();
+  }
+
+  static std::vector<pb::index::VectorWithDistanceResult> FlatSearch(pb::common::MetricType metric_type,
+                                                                     uint32_t topk) {
+    pb::common::VectorIndexParameter index_parameter;
+    index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+    index_parameter.mutable_flat_parameter()->set_dimension(kDimension);
+    index_parameter.mutable_flat_parameter()->set_metric_type(metric_type);
+
+    auto flat_index = VectorIndexFactory::NewFlat(1, index_parameter, pb::common::RegionEpoch(), pb::common::Range(),
+                                                  thread_pool);
+    EXPECT_NE(nullptr, flat_index);
+
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    EXPECT_TRUE(flat_index->Add(vector_with_ids).ok());
+    EXPECT_TRUE(flat_index->Search(queries, topk, {}, false, {}, results).ok());
+    return results;
+  }
+
+  static std::vector<pb::index::VectorWithDistanceResult> KernelSearch(pb::common::MetricType metric_type,
+                                                                       uint32_t topk, int64_t batch_count) {
+    BruteForceSearchKernel kernel(metric_type, kDimension, topk, queries, batch_count);
+    for (const auto& vector_with_id : vector_with_ids) {
+      kernel.Add(vector_with_id.id(), reinterpret_cast<const char*>(vector_with_id.vector().float_values().data()));
+    }
+    kernel.Flush();
+
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    kernel.FillResult(results);
+    return results;
+  }
+
+  static void CheckSameResult(pb::common::MetricType metric_type, uint32_t topk, int64_t batch_count) {
+    auto expect_results = FlatSearch(metric_type, topk);
+    auto results = KernelSearch(metric_type, topk, batch_count);
+    std::string name = fmt::format("metric({}) topk({}) batch_count({})", pb::common::MetricType_Name(metric_type),
+                                   topk, batch_count);
+
+    ASSERT_EQ(expect_results.size(), results.size()) << name;
+    for (size_t i = 0; i < results.size(); ++i) {
+      const auto& expect_distances = expect_results[i].vector_with_distances();
+      const auto& distances = results[i].vector_with_distances();
+      ASSERT_EQ(std::min(topk, static_cast<uint32_t>(kDataBaseSize)), distances.size()) << name;
+      ASSERT_EQ(expect_distances.size(), distances.size()) << name;
+
+      for (int j = 0; j < distances.size(); ++j) {
+        // nearest first, same order as flat index
+        if (j > 0) {
+          EXPECT_LE(distances[j - 1].distance(), distances[j].distance()) << name;
+        }
+        EXPECT_EQ(expect_distances[j].vector_with_id().id(), distances[j].vector_with_id().id()) << name;
+        EXPECT_NEAR(expect_distances[j].distance(), distances[j].distance(), 1e-4) << name;
+        EXPECT_EQ(metric_type, distances[j].metric_type()) << name;
+        EXPECT_EQ(kDimension, distances[j].vector_with_id().vector().dimension()) << name;
+      }
+    }
+  }
+
+  inline static const int kDimension = 32;
+  inline static const int kDataBaseSize = 1000;
+  inline static const int kQuerySize = 8;
+
+  inline static std::vector<pb::common::VectorWithId> vector_with_ids;
+  inline static std::vector<pb::common::VectorWithId> queries;
+  inline static ThreadPoolPtr thread_pool = std::make_shared<ThreadPool>("bruteforce_search_kernel", 2);
+};
+
+TEST_F(BruteForceSearchKernelTest, L2) {
+  CheckSameResult(pb::common::MetricType::METRIC_TYPE_L2, 10, 128);
+  // flush many times, the last batch is not full
+  CheckSameResult(pb::common::MetricType::METRIC_TYPE_L2, 10, 7);
+}
+
+TEST_F(BruteForceSearchKernelTest, InnerProduct) {
+  CheckSameResult(pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT, 10, 128);
+  CheckSameResult(pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT, 10, 7);
+}
+
+TEST_F(BruteForceSearchKernelTest, Cosine) {
+  CheckSameResult(pb::common::MetricType::METRIC_TYPE_COSINE, 10, 128);
+  CheckSameResult(pb::common::MetricType::METRIC_TYPE_COSINE, 10, 7);
+
+  // query and data are normalized, the nearest of vector itself is 0
+  BruteForceSearchKernel kernel(pb::common::MetricType::METRIC_TYPE_COSINE, kDimension, 1, {vector_with_ids[3]}, 16);
+  for (const auto& vector_with_id : vector_with_ids) {
+    kernel.Add(vector_with_id.id(), reinterpret_cast<const char*>(vector_with_id.vector().float_values().data()));
+  }
+  kernel.Flush();
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  kernel.FillResult(results);
+  ASSERT_EQ(1, results.size());
+  ASSERT_EQ(1, results[0].vector_with_distances_size());
+  EXPECT_EQ(vector_with_ids[3].id(), results[0].vector_with_distances(0).vector_with_id().id());
+  EXPECT_NEAR(0.0F, results[0].vector_with_distances(0).distance(), 1e-5);
+}
+
+TEST_F(BruteForceSearchKernelTest, TopkMoreThanCount) {
+  CheckSameResult(pb::common::MetricType::METRIC_TYPE_L2, kDataBaseSize + 10, 128);
+
+  // no vector
+  BruteForceSearchKernel kernel(pb::common::MetricType::METRIC_TYPE_L2, kDimension, 10, queries, 128);
+  kernel.Flush();
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  kernel.FillResult(results);
+  ASSERT_EQ(kQuerySize, results.size());
+  for (const auto& result : results) {
+    EXPECT_EQ(0, result.vector_with_distances_size());
+  }
+}
+
+// Search with vector ids filter switch to bruteforce over the allowed ids when the filter is selective.
+// The vector of data cf is different from the vector index, so the distance tell which path is taken.
+class VectorReaderBruteForceWithIdsTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Helper::CreateDirectories(kBruteForceStorePath);
+
+    auto config = std::make_shared<YamlConfig>();
+    ASSERT_EQ(0, config->Load(kBruteForceYamlConfigContent));
+    engine = std::make_shared<RocksRawEngine>();
+    ASSERT_TRUE(engine->Init(config, kAllCFs));
+
+    // data cf: value of vector id is id, vector index: value of vector id is id + 0.5
+    std::vector<pb::common::KeyValue> kvs;
+    std::vector<pb::common::VectorWithId> index_vector_with_ids;
+    for (int64_t id = 1; id <= kDataBaseSize; ++id) {
+      auto data_vector_with_id = GenVectorWithId(id, static_cast<float>(id));
+      pb::common::KeyValue kv;
+      kv.set_key(VectorCodec::EncodeVectorKey(kPrefix, kPartitionId, id, kTs));
+      std::string value = VectorCodec::EncodeVectorValue(data_vector_with_id.vector());
+      mvcc::Codec::PackageValue(mvcc::ValueFlag::kPut, value);
+      kv.set_value(value);
+      kvs.push_back(std::move(kv));
+
+      index_vector_with_ids.push_back(GenVectorWithId(id, static_cast<float>(id) + 0.5F));
+    }
+    ASSERT_TRUE(engine->Writer()->KvBatchPutAndDelete(Constant::kVectorDataCF, kvs, {}).ok());
+
+    pb::common::VectorIndexParameter index_parameter;
+    index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+    index_parameter.mutable_flat_parameter()->set_dimension(kDimension);
+    index_parameter.mutable_flat_parameter()->set_metric_type(pb::common::MetricType::METRIC_TYPE_L2);
+    auto flat_index = VectorIndexFactory::NewFlat(kIndexId, index_parameter, pb::common::RegionEpoch(),
+                                                  GenRange(0, 0), thread_pool);
+    ASSERT_NE(nullptr, flat_index);
+    ASSERT_TRUE(flat_index->Add(index_vector_with_ids).ok());
+
+    vector_index = VectorIndexWrapper::New(kIndexId, index_parameter);
+    vector_index->SetIsTempHoldVectorIndex(true);
+    vector_index->UpdateVectorIndex(flat_index, "unit test");
+    ASSERT_TRUE(vector_index->IsReady());
+  }
+
+  static void TearDownTestSuite() {
+    vector_index = nullptr;
+    engine->Close();
+    engine->Destroy();
+    Helper::RemoveAllFileOrDirectory(kBruteForceStorePath);
+  }
+
+  void SetUp() override { old_threshold = FLAGS_vector_index_bruteforce_selectivity_threshold; }
+
+  void TearDown() override { FLAGS_vector_index_bruteforce_selectivity_threshold = old_threshold; }
+
+  static pb::common::VectorWithId GenVectorWithId(int64_t id, float value) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    vector_with_id.mutable_vector()->set_dimension(kDimension);
+    vector_with_id.mutable_vector()->set_value_type(pb::common::ValueType::FLOAT);
+    for (int i = 0; i < kDimension; ++i) {
+      vector_with_id.mutable_vector()->add_float_values(value);
+    }
+    return vector_with_id;
+  }
+
+  // plain range of vector id [start_id, end_id), 0 end_id means the whole partition
+  static pb::common::Range GenRange(int64_t start_id, int64_t end_id) {
+    pb::common::Range range;
+    range.set_start_key(start_id > 0 ? VectorCodec::PackageVectorKey(kPrefix, kPartitionId, start_id)
+                                     : VectorCodec::PackageVectorKey(kPrefix, kPartitionId));
+    range.set_end_key(end_id > 0 ? VectorCodec::PackageVectorKey(kPrefix, kPartitionId, end_id)
+                                 : VectorCodec::PackageVectorKey(kPrefix, kPartitionId + 1));
+    return range;
+  }
+
+  // l2 distance of query 0 to vector with all value is value
+  static float Distance(float value) { return kDimension * value * value; }
+
+  static std::vector<pb::index::VectorWithDistance> Search(const std::vector<int64_t>& vector_ids, bool is_negation,
+                                                           const pb::common::Range& region_range) {
+    pb::common::VectorSearchParameter parameter;
+    parameter.set_top_n(kTopk);
+    parameter.set_without_vector_data(true);
+    parameter.set_is_negation(is_negation);
+    for (int64_t vector_id : vector_ids) {
+      parameter.add_vector_ids(vector_id);
+    }
+
+    VectorReader vector_reader(mvcc::VectorReader::New(engine->Reader()));
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    int64_t deserialization_id_time_us = 0;
+    int64_t search_time_us = 0;
+    auto status = vector_reader.DoVectorSearchForVectorIdPreFilterDebug(
+        vector_index, {GenVectorWithId(0, 0.0F)}, parameter, region_range, results, deserialization_id_time_us,
+        search_time_us);
+    EXPECT_TRUE(status.ok()) << status.error_str();
+    EXPECT_EQ(1, results.size());
+    if (results.empty()) {
+      return {};
+    }
+
+    return {results[0].vector_with_distances().begin(), results[0].vector_with_distances().end()};
+  }
+
+  static void CheckResult(const std::vector<pb::index::VectorWithDistance>& vector_with_distances,
+                          const std::vector<int64_t>& expect_ids, bool is_bruteforce) {
+    ASSERT_EQ(expect_ids.size(), vector_with_distances.size());
+    for (size_t i = 0; i < expect_ids.size(); ++i) {
+      int64_t id = expect_ids[i];
+      float value = is_bruteforce ? static_cast<float>(id) : static_cast<float>(id) + 0.5F;
+      EXPECT_EQ(id, vector_with_distances[i].vector_with_id().id());
+      EXPECT_NEAR(Distance(value), vector_with_distances[i].distance(), 1e-3);
+    }
+  }
+
+  inline static const std::string kBruteForceStorePath = kRootPath + "/bruteforce_with_ids_db";
+  inline static const std::string kBruteForceYamlConfigContent = "store:\n  path: " + kBruteForceStorePath + "\n";
+  inline static const char kPrefix = 'r';
+  inline static const int64_t kPartitionId = 1000;
+  inline static const int64_t kIndexId = 1000;
+  inline static const int64_t kTs = 100;
+  inline static const int kDimension = 8;
+  inline static const int kDataBaseSize = 1000;
+  inline static const uint32_t kTopk = 10;
+
+  inline static std::shared_ptr<RocksRawEngine> engine;
+  inline static VectorIndexWrapperPtr vector_index;
+  inline static ThreadPoolPtr thread_pool = std::make_shared<ThreadPool>("bruteforce_with_ids", 2);
+
+  double old_threshold{0};
+};
+
+TEST_F(VectorReaderBruteForceWithIdsTest, SelectiveFilter) {
+  FLAGS_vector_index_bruteforce_selectivity_threshold = 0.01;
+
+  // 3 / 1000 < 0.01, bruteforce over the allowed ids
+  CheckResult(Search({500, 3, 10}, false, GenRange(0, 0)), {3, 10, 500}, true);
+}
+
+TEST_F(VectorReaderBruteForceWithIdsTest, NotSelectiveFilter) {
+  FLAGS_vector_index_bruteforce_selectivity_threshold = 0.01;
+
+  // 20 / 1000 >= 0.01, search by vector index
+  std::vector<int64_t> vector_ids;
+  for (int64_t id = 101; id <= 120; ++id) {
+    vector_ids.push_back(id);
+  }
+  CheckResult(Search(vector_ids, false, GenRange(0, 0)), {101, 102, 103, 104, 105, 106, 107, 108, 109, 110}, false);
+}
+
+TEST_F(VectorReaderBruteForceWithIdsTest, SwitchDisabled) {
+  FLAGS_vector_index_bruteforce_selectivity_threshold = 0;
+  CheckResult(Search({500, 3, 10}, false, GenRange(0, 0)), {3, 10, 500}, false);
+}
+
+TEST_F(VectorReaderBruteForceWithIdsTest, NegationFilter) {
+  FLAGS_vector_index_bruteforce_selectivity_threshold = 0.01;
+
+  // the allowed count of negation filter is unknown, search by vector index
+  CheckResult(Search({1, 2, 3}, true, GenRange(0, 0)), {4, 5, 6, 7, 8, 9, 10, 11, 12, 13}, false);
+}
+
+TEST_F(VectorReaderBruteForceWithIdsTest, SkipMissingAndOutOfRangeIds) {
+  FLAGS_vector_index_bruteforce_selectivity_threshold = 0.01;
+
+  // 3 is out of region range [5, 2000), 1500 is not exist
+  CheckResult(Search({3, 10, 500, 1500}, false, GenRange(5, 2000)), {10, 500}, true);
+}
+
 }  // namespace dingodb
@@ -0,0 +1,263 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bthread/bthread.h"
+#include "common/constant.h"
+#include "common/helper.h"
+#include "config/yaml_config.h"
+#include "engine/rocks_raw_engine.h"
+#include "gflags/gflags.h"
+#include "mvcc/codec.h"
+#include "mvcc/reader.h"
+#include "proto/common.pb.h"
+#include "vector/codec.h"
+#include "vector/vector_scalar_index.h"
+
+namespace dingodb {
+
+DECLARE_int64(vector_scalar_index_max_memory_size);
+
+static const std::vector<std::string> kAllCFs = {Constant::kVectorDataCF, Constant::kVectorScalarKeySpeedUpCF};
+
+const std::string kRootPath = "./unit_test";
+const std::string kLogPath = kRootPath + "/log";
+const std::string kStorePath = kRootPath + "/vector_scalar_index_db";
+
+const std::string kYamlConfigContent =
+    "cluster:\n"
+    "  name: dingodb\n"
+    "  instance_id: 12345\n"
+    "  coordinators: 127.0.0.1:19190,127.0.0.1:19191,127.0.0.1:19192\n"
+    "  keyring: TO_BE_CONTINUED\n"
+    "server:\n"
+    "  host: 127.0.0.1\n"
+    "  port: 23000\n"
+    "log:\n"
+    "  path: " +
+    kLogPath +
+    "\n"
+    "store:\n"
+    "  path: " +
+    kStorePath + "\n";
+
+class VectorScalarIndexTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Helper::CreateDirectories(kStorePath);
+
+    config = std::make_shared<YamlConfig>();
+    ASSERT_EQ(0, config->Load(kYamlConfigContent));
+
+    engine = std::make_shared<RocksRawEngine>();
+    ASSERT_TRUE(engine != nullptr);
+    ASSERT_TRUE(engine->Init(config, kAllCFs));
+
+    auto* item = scalar_schema.add_fields();
+    item->set_key("color");
+    item->set_field_type(pb::common::ScalarFieldType::STRING);
+    item->set_enable_speed_up(true);
+
+    item = scalar_schema.add_fields();
+    item->set_key("size");
+    item->set_field_type(pb::common::ScalarFieldType::INT64);
+    item->set_enable_speed_up(true);
+
+    region_range.set_start_key(VectorCodec::PackageVectorKey(prefix, partition_id));
+    region_range.set_end_key(VectorCodec::PackageVectorKey(prefix, partition_id + 1));
+  }
+
+  static void TearDownTestSuite() {
+    engine->Close();
+    engine->Destroy();
+    Helper::RemoveAllFileOrDirectory(kRootPath);
+  }
+
+  static pb::common::ScalarValue GenStringValue(const std::string& value) {
+    pb::common::ScalarValue scalar_value;
+    scalar_value.set_field_type(pb::common::ScalarFieldType::STRING);
+    scalar_value.add_fields()->set_string_data(value);
+    return scalar_value;
+  }
+
+  static pb::common::ScalarValue GenLongValue(int64_t value) {
+    pb::common::ScalarValue scalar_value;
+    scalar_value.set_field_type(pb::common::ScalarFieldType::INT64);
+    scalar_value.add_fields()->set_long_data(value);
+    return scalar_value;
+  }
+
+  static pb::common::VectorScalardata GenScalarData(const std::string& color, int64_t size) {
+    pb::common::VectorScalardata scalar_data;
+    scalar_data.mutable_scalar_data()->insert({"color", GenStringValue(color)});
+    scalar_data.mutable_scalar_data()->insert({"size", GenLongValue(size)});
+    return scalar_data;
+  }
+
+  // same as the speed up kvs written by vector add apply
+  static void PutScalarData(int64_t vector_id, const pb::common::VectorScalardata& scalar_data, int64_t ts) {
+    std::vector<pb::common::KeyValue> kvs;
+    for (const auto& [key, scalar_value] : scalar_data.scalar_data()) {
+      pb::common::KeyValue kv;
+      kv.set_key(VectorCodec::EncodeVectorKey(prefix, partition_id, vector_id, key, ts));
+      std::string value = scalar_value.SerializeAsString();
+      mvcc::Codec::PackageValue(mvcc::ValueFlag::kPut, value);
+      kv.mutable_value()->swap(value);
+      kvs.push_back(std::move(kv));
+    }
+
+    ASSERT_TRUE(engine->Writer()->KvBatchPutAndDelete(Constant::kVectorScalarKeySpeedUpCF, kvs, {}).ok());
+  }
+
+  static std::vector<int64_t> Search(VectorScalarIndexPtr scalar_index, const pb::common::VectorScalardata& query,
+                                     bool expect_hit = true, int64_t ts = 0) {
+    std::vector<int64_t> vector_ids;
+    bool is_hit = false;
+    auto status = scalar_index->Search(mvcc::KvReader::New(engine->Reader()), ts, region_range, scalar_schema, query,
+                                       vector_ids, is_hit);
+    EXPECT_TRUE(status.ok()) << status.error_cstr();
+    EXPECT_EQ(expect_hit, is_hit);
+    return vector_ids;
+  }
+
+  // first search start build in background and fallback scan
+  static void WaitBuild(VectorScalarIndexPtr scalar_index, const pb::common::VectorScalardata& query) {
+    Search(scalar_index, query, false);
+    for (int i = 0; i < 1000 && scalar_index->IsBuilding(); ++i) {
+      bthread_usleep(10 * 1000);
+    }
+    ASSERT_FALSE(scalar_index->IsBuilding());
+  }
+
+  static inline char prefix = 'c';
+  static inline int64_t partition_id = 1001;
+
+  static inline std::shared_ptr<RocksRawEngine> engine;
+  static inline std::shared_ptr<Config> config;
+  static inline pb::common::ScalarSchema scalar_schema;
+  static inline pb::common::Range region_range;
+};
+
+TEST_F(VectorScalarIndexTest, GenPostingKey) {
+  std::string posting_key1;
+  std::string posting_key2;
+
+  ASSERT_TRUE(VectorScalarIndex::GenPostingKey("color", GenStringValue("red"), posting_key1));
+  ASSERT_TRUE(VectorScalarIndex::GenPostingKey("color", GenStringValue("red"), posting_key2));
+  EXPECT_EQ(posting_key1, posting_key2);
+
+  ASSERT_TRUE(VectorScalarIndex::GenPostingKey("colo", GenStringValue("rred"), posting_key2));
+  EXPECT_NE(posting_key1, posting_key2);
+
+  // -0.0 equal 0.0, NaN not equal any value
+  pb::common::ScalarValue double_value;
+  double_value.set_field_type(pb::common::ScalarFieldType::DOUBLE);
+  double_value.add_fields()->set_double_data(0.0);
+  ASSERT_TRUE(VectorScalarIndex::GenPostingKey("weight", double_value, posting_key1));
+  double_value.mutable_fields(0)->set_double_data(-0.0);
+  ASSERT_TRUE(VectorScalarIndex::GenPostingKey("weight", double_value, posting_key2));
+  EXPECT_EQ(posting_key1, posting_key2);
+
+  double_value.mutable_fields(0)->set_double_data(std::nan(""));
+  EXPECT_FALSE(VectorScalarIndex::GenPostingKey("weight", double_value, posting_key2));
+}
+
+TEST_F(VectorScalarIndexTest, SearchAndApply) {
+  PutScalarData(1, GenScalarData("red", 1), 100);
+  PutScalarData(2, GenScalarData("red", 2), 100);
+  PutScalarData(3, GenScalarData("blue", 1), 100);
+  PutScalarData(4, GenScalarData("red", 1), 100);
+
+  auto scalar_index = VectorScalarIndex::New();
+  ASSERT_FALSE(scalar_index->IsBuilt());
+
+  pb::common::VectorScalardata query;
+  query.mutable_scalar_data()->insert({"color", GenStringValue("red")});
+  WaitBuild(scalar_index, query);
+  ASSERT_TRUE(scalar_index->IsBuilt());
+  EXPECT_EQ(std::vector<int64_t>({1, 2, 4}), Search(scalar_index, query));
+  EXPECT_EQ(4, scalar_index->VectorCount());
+  EXPECT_GT(scalar_index->MemorySize(), 0);
+  EXPECT_EQ(scalar_index->MemorySize(), VectorScalarIndex::TotalMemorySize());
+
+  EXPECT_EQ(std::vector<int64_t>({1, 4}), Search(scalar_index, GenScalarData("red", 1)));
+  EXPECT_EQ(std::vector<int64_t>({}), Search(scalar_index, GenScalarData("green", 1)));
+
+  // apply update and delete
+  scalar_index->Upsert(4, GenScalarData("blue", 1), 200);
+  scalar_index->Upsert(5, GenScalarData("red", 1), 200);
+  scalar_index->Delete({1}, 200);
+  EXPECT_EQ(std::vector<int64_t>({5}), Search(scalar_index, GenScalarData("red", 1)));
+  EXPECT_EQ(std::vector<int64_t>({3, 4}), Search(scalar_index, GenScalarData("blue", 1), true, 200));
+
+  // read older than the latest write of index, fallback scan
+  Search(scalar_index, GenScalarData("blue", 1), false, 150);
+
+  // not speed up key, fallback scan
+  pb::common::VectorScalardata not_speed_up_query;
+  not_speed_up_query.mutable_scalar_data()->insert({"name", GenStringValue("red")});
+  Search(scalar_index, not_speed_up_query, false);
+
+  // rebuild from speed up cf after reset
+  scalar_index->Reset();
+  ASSERT_FALSE(scalar_index->IsBuilt());
+  EXPECT_EQ(0, VectorScalarIndex::TotalMemorySize());
+  WaitBuild(scalar_index, GenScalarData("red", 1));
+  ASSERT_TRUE(scalar_index->IsBuilt());
+  EXPECT_EQ(std::vector<int64_t>({1, 4}), Search(scalar_index, GenScalarData("red", 1)));
+}
+
+TEST_F(VectorScalarIndexTest, ApplyDuringBuild) {
+  auto scalar_index = VectorScalarIndex::New();
+
+  // apply before build is ignored, the build scan the speed up cf
+  scalar_index->Upsert(6, GenScalarData("green", 1), 300);
+  Search(scalar_index, GenScalarData("green", 1), false);
+  scalar_index->Upsert(7, GenScalarData("green", 1), 300);
+  scalar_index->Delete({3}, 300);
+  WaitBuild(scalar_index, GenScalarData("green", 1));
+  ASSERT_TRUE(scalar_index->IsBuilt());
+
+  // apply during build is replayed
+  EXPECT_EQ(std::vector<int64_t>({7}), Search(scalar_index, GenScalarData("green", 1)));
+  EXPECT_EQ(std::vector<int64_t>({}), Search(scalar_index, GenScalarData("blue", 1)));
+}
+
+TEST_F(VectorScalarIndexTest, ExceedMemory) {
+  int64_t max_memory_size = FLAGS_vector_scalar_index_max_memory_size;
+  FLAGS_vector_scalar_index_max_memory_size = 128;
+
+  auto scalar_index = VectorScalarIndex::New();
+  WaitBuild(scalar_index, GenScalarData("red", 1));
+  EXPECT_FALSE(scalar_index->IsBuilt());
+  EXPECT_EQ(0, VectorScalarIndex::TotalMemorySize());
+
+  // not build again until reset
+  Search(scalar_index, GenScalarData("red", 1), false);
+  EXPECT_FALSE(scalar_index->IsBuilding());
+
+  FLAGS_vector_scalar_index_max_memory_size = max_memory_size;
+  scalar_index->Reset();
+  WaitBuild(scalar_index, GenScalarData("red", 1));
+  EXPECT_TRUE(scalar_index->IsBuilt());
+}
+
+}  // namespace dingodb